@@ -0,0 +1,96 @@
+#include <array>
+#include <benchmark/benchmark.h>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "marketPacketHelpers/marketPacketHelpers.h"
+
+namespace bench
+{
+    /**
+     * @brief A few thousand random trades, so the branch predictor can't just learn one
+     */
+    const std::vector<marketPacket::trade_t> &randomTrades()
+    {
+        static const std::vector<marketPacket::trade_t> trades = []
+        {
+            std::vector<marketPacket::trade_t> tmp(4096);
+            for (auto &t : tmp)
+            {
+                t.updateHeader = {marketPacket::UPDATE_SIZE, marketPacket::updateType_e::TRADE};
+                t.tradeSize = marketPacket::rand();
+                t.tradePrice = marketPacket::rand() >> (marketPacket::rand() % 64);
+
+                std::string symbol = marketPacket::generateRandomSymbol();
+                std::memcpy(t.symbol, symbol.data(), marketPacket::SYMBOL_LENGTH);
+            }
+            return tmp;
+        }();
+
+        return trades;
+    }
+
+    /**
+     * The human readable string, allocation and all. Per call
+     */
+    void BM_generateTradeString(benchmark::State &state)
+    {
+        const auto &trades = randomTrades();
+
+        size_t i = 0;
+        size_t numBytes = 0;
+        for (auto _ : state)
+        {
+            std::string s = marketPacket::generateTradeString(&trades[i++ % trades.size()]);
+            numBytes += s.size();
+            benchmark::DoNotOptimize(s.data());
+        }
+
+        state.SetItemsProcessed(state.iterations());
+        state.SetBytesProcessed(numBytes);
+    }
+    BENCHMARK(BM_generateTradeString);
+
+    /**
+     * What the processor actually does, straight into a buffer. Per call
+     */
+    void BM_formatTrade(benchmark::State &state)
+    {
+        const auto &trades = randomTrades();
+        std::array<char, marketPacket::MAX_TRADE_STRING_LENGTH> buffer;
+
+        size_t i = 0;
+        size_t numBytes = 0;
+        for (auto _ : state)
+        {
+            char *end = marketPacket::formatTrade(buffer.data(), &trades[i++ % trades.size()]);
+            numBytes += end - buffer.data();
+            benchmark::DoNotOptimize(buffer.data());
+            benchmark::ClobberMemory();
+        }
+
+        state.SetItemsProcessed(state.iterations());
+        state.SetBytesProcessed(numBytes);
+    }
+    BENCHMARK(BM_formatTrade);
+
+    /**
+     * The integer part of formatTrade() on its own, across every digit count
+     */
+    void BM_formatDecimal(benchmark::State &state)
+    {
+        const auto &trades = randomTrades();
+        std::array<char, 32> buffer;
+
+        size_t i = 0;
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(marketPacket::formatDecimal(buffer.data(), trades[i++ % trades.size()].tradePrice));
+            benchmark::ClobberMemory();
+        }
+
+        state.SetItemsProcessed(state.iterations());
+    }
+    BENCHMARK(BM_formatDecimal);
+}
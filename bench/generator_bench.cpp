@@ -0,0 +1,80 @@
+#include <benchmark/benchmark.h>
+#include <fstream>
+
+#include "marketPacketGenerator/marketPacketGenerator.h"
+#include "marketPacketHelpers/marketPacketHelpers.h"
+
+namespace bench
+{
+    // Enough packets per iteration that the per call setup doesn't show up
+    constexpr const size_t PACKETS_PER_ITERATION = 1024;
+
+    /**
+     * generatePackets() straight into /dev/null, so it's all generation and none of it disk.
+     * Packets are always full, so exactly how many updates and bytes went out is known up front
+     *
+     *  Args: max updates per packet, number of threads
+     */
+    void BM_generatePackets(benchmark::State &state)
+    {
+        const size_t numUpdates = state.range(0);
+        const size_t numThreads = state.range(1);
+
+        marketPacket::generatorConfig_t config;
+        config.seed = 1;
+        config.numThreads = numThreads;
+        config.workload.packetSizes = marketPacket::packetSizeDistribution_e::FIXED;
+
+        marketPacket::marketPacketGenerator_t mpg(std::ofstream("/dev/null", std::ios::binary));
+        mpg.initialize(config);
+
+        for (auto _ : state)
+        {
+            if (mpg.generatePackets(PACKETS_PER_ITERATION, numUpdates).has_value())
+            {
+                state.SkipWithError("Generation failed");
+                break;
+            }
+        }
+
+        state.SetItemsProcessed(state.iterations() * PACKETS_PER_ITERATION * numUpdates);
+        state.SetBytesProcessed(state.iterations() * PACKETS_PER_ITERATION * (marketPacket::PACKET_HEADER_SIZE + numUpdates * marketPacket::UPDATE_SIZE));
+    }
+    BENCHMARK(BM_generatePackets)->ArgsProduct({{1, 16, 256}, {1, 4}})->UseRealTime();
+
+    /**
+     * Same thing with a realistic workload, to see what the symbol universe, walks and clock cost on top
+     *
+     *  Args: if prices random walk
+     */
+    void BM_generateWorkload(benchmark::State &state)
+    {
+        constexpr const size_t NUM_UPDATES = 64;
+
+        marketPacket::generatorConfig_t config;
+        config.seed = 1;
+        config.workload.numSymbols = 5000;
+        config.workload.packetSizes = marketPacket::packetSizeDistribution_e::FIXED;
+        config.workload.startTimeOfDay = 0;
+        if (state.range(0))
+        {
+            config.workload.maxPriceStep = 4;
+        }
+
+        marketPacket::marketPacketGenerator_t mpg(std::ofstream("/dev/null", std::ios::binary));
+        mpg.initialize(config);
+
+        for (auto _ : state)
+        {
+            if (mpg.generatePackets(PACKETS_PER_ITERATION, NUM_UPDATES).has_value())
+            {
+                state.SkipWithError("Generation failed");
+                break;
+            }
+        }
+
+        state.SetItemsProcessed(state.iterations() * PACKETS_PER_ITERATION * NUM_UPDATES);
+        state.SetBytesProcessed(state.iterations() * PACKETS_PER_ITERATION * (marketPacket::PACKET_HEADER_SIZE + NUM_UPDATES * marketPacket::UPDATE_SIZE));
+    }
+    BENCHMARK(BM_generateWorkload)->Arg(0)->Arg(1);
+}
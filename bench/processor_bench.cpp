@@ -0,0 +1,165 @@
+#include <benchmark/benchmark.h>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <utility>
+
+#include "marketPacketGenerator/marketPacketGenerator.h"
+#include "marketPacketHelpers/marketPacketHelpers.h"
+#include "marketPacketProcessor/marketPacketProcessor.h"
+
+namespace bench
+{
+    // Roughly how big each capture is. Big enough to blow through L2, small enough to build quickly
+    constexpr const size_t CAPTURE_SIZE = 4 * 1024 * 1024;
+
+    /**
+     * @brief A generated capture, and what's in it
+     */
+    struct capture_t
+    {
+        std::string bytes;
+        size_t numUpdates = 0;
+        size_t numTrades = 0;
+    };
+
+    /**
+     * @brief Capture with up to maxUpdates per packet (uniform), tradePercent% trades. Built once per combination
+     */
+    const capture_t &capture(size_t maxUpdates, size_t tradePercent)
+    {
+        static std::map<std::pair<size_t, size_t>, capture_t> captures;
+
+        auto [it, isNew] = captures.try_emplace({maxUpdates, tradePercent});
+        capture_t &c = it->second;
+        if (!isNew)
+        {
+            return c;
+        }
+
+        // Generator only writes to files, so go through one
+        const std::string path = (std::filesystem::temp_directory_path() / "processor_bench.dat").string();
+        {
+            size_t meanPacketSize = marketPacket::PACKET_HEADER_SIZE + (maxUpdates + 1) / 2 * marketPacket::UPDATE_SIZE;
+
+            marketPacket::generatorConfig_t config;
+            config.seed = 1;
+            config.workload.numSymbols = 5000;
+            config.workload.tradeRatio = tradePercent / 100.0;
+
+            marketPacket::marketPacketGenerator_t mpg(std::ofstream(path, std::ios::binary));
+            mpg.initialize(config);
+            mpg.generatePackets(CAPTURE_SIZE / meanPacketSize, maxUpdates);
+        }
+
+        std::stringstream ss;
+        ss << std::ifstream(path, std::ios::binary).rdbuf();
+        c.bytes = ss.str();
+        std::filesystem::remove(path);
+
+        for (size_t offset = 0; offset < c.bytes.size();)
+        {
+            marketPacket::packetHeader_t ph;
+            std::memcpy(&ph, c.bytes.data() + offset, sizeof(ph));
+
+            for (size_t i = 0; i < ph.numMarketUpdates; i++)
+            {
+                marketPacket::updateHeader_t uh;
+                std::memcpy(&uh, c.bytes.data() + offset + sizeof(ph) + i * marketPacket::UPDATE_SIZE, sizeof(uh));
+                c.numTrades += uh.type == marketPacket::updateType_e::TRADE;
+            }
+
+            c.numUpdates += ph.numMarketUpdates;
+            offset += ph.packetLength;
+        }
+
+        return c;
+    }
+
+    std::unique_ptr<marketPacket::inputSource_t> memoryInput(const capture_t &c)
+    {
+        return std::make_unique<marketPacket::memoryInputSource_t>(reinterpret_cast<const std::byte *>(c.bytes.data()), c.bytes.size());
+    }
+
+    /**
+     * Takes everything and does nothing with it, so only the processor gets measured
+     */
+    class nullOutputSink_t : public marketPacket::outputSink_t
+    {
+    public:
+        bool write(const char * /*data*/, size_t /*numBytes*/) override { return true; }
+    };
+
+    /**
+     * Counts updates and nothing else. The cheapest handler there can be that still sees everything
+     */
+    struct countingHandler_t
+    {
+        size_t numTrades = 0;
+        size_t numQuotes = 0;
+
+        void onTrade(const marketPacket::trade_t & /*t*/) { numTrades++; }
+        void onQuote(const marketPacket::quote_t & /*q*/) { numQuotes++; }
+    };
+
+    /**
+     * The whole thing: decode, validate, format every trade as text and hand it to a sink
+     *
+     *  Args: max updates per packet, % of updates that are trades
+     */
+    void BM_processNextPacket(benchmark::State &state)
+    {
+        const capture_t &c = capture(state.range(0), state.range(1));
+
+        for (auto _ : state)
+        {
+            // A fresh processor every time, but don't count setting it up (the output buffer's a big allocation)
+            state.PauseTiming();
+            marketPacket::marketPacketProcessor_t mpp(memoryInput(c), std::make_unique<nullOutputSink_t>());
+            mpp.initialize();
+            state.ResumeTiming();
+
+            if (mpp.processNextPacket().value() != marketPacket::END_OF_FILE)
+            {
+                state.SkipWithError("Processing failed");
+                break;
+            }
+        }
+
+        state.SetItemsProcessed(state.iterations() * c.numUpdates);
+        state.SetBytesProcessed(state.iterations() * c.bytes.size());
+        state.counters["trades"] = benchmark::Counter(state.iterations() * c.numTrades, benchmark::Counter::kIsRate);
+    }
+    BENCHMARK(BM_processNextPacket)->ArgsProduct({{1, 16, 256}, {10, 50, 90}})->Unit(benchmark::kMillisecond);
+
+    /**
+     * Just getting updates out of the capture: readHeader(), readPartBody()'s validation and the dispatch to the handler.
+     * Everything the processor does per update before any formatting happens
+     *
+     *  Args: max updates per packet, % of updates that are trades
+     */
+    void BM_readPartBody(benchmark::State &state)
+    {
+        const capture_t &c = capture(state.range(0), state.range(1));
+
+        for (auto _ : state)
+        {
+            marketPacket::basicMarketPacketProcessor_t<countingHandler_t> processor(memoryInput(c));
+            processor.initialize();
+
+            if (processor.processNextPacket().value() != marketPacket::END_OF_FILE ||
+                processor.handler().numTrades + processor.handler().numQuotes != c.numUpdates)
+            {
+                state.SkipWithError("Processing failed");
+                break;
+            }
+        }
+
+        state.SetItemsProcessed(state.iterations() * c.numUpdates);
+        state.SetBytesProcessed(state.iterations() * c.bytes.size());
+    }
+    BENCHMARK(BM_readPartBody)->ArgsProduct({{1, 16, 256}, {10, 50, 90}})->Unit(benchmark::kMillisecond);
+}
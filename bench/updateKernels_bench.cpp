@@ -0,0 +1,133 @@
+#include <array>
+#include <benchmark/benchmark.h>
+#include <vector>
+
+#include "marketPacketHelpers/marketPacketHelpers.h"
+#include "marketPacketProcessor/updateKernels.h"
+
+namespace bench
+{
+    /**
+     * @brief One full packet body worth of valid, randomly mixed trades and quotes
+     */
+    const std::vector<marketPacket::update_t> &fullBody()
+    {
+        static const std::vector<marketPacket::update_t> updates = []
+        {
+            std::vector<marketPacket::update_t> tmp(marketPacket::MAX_UPDATES_IN_BODY);
+            for (auto &update : tmp)
+            {
+                update.updateHeader = {marketPacket::UPDATE_SIZE, (marketPacket::rand() % 2) ? marketPacket::updateType_e::TRADE : marketPacket::updateType_e::QUOTE};
+            }
+            return tmp;
+        }();
+
+        return updates;
+    }
+
+    /**
+     * The processor's original loop: validate, switch on type, remember the trade, one update at a time
+     */
+    void BM_perUpdateWalk(benchmark::State &state)
+    {
+        const auto &updates = fullBody();
+        const std::byte *body = reinterpret_cast<const std::byte *>(updates.data());
+        size_t bodySize = updates.size() * marketPacket::UPDATE_SIZE;
+
+        std::vector<const std::byte *> tradeLocs;
+        tradeLocs.reserve(updates.size());
+
+        for (auto _ : state)
+        {
+            tradeLocs.clear();
+
+            size_t offset = 0;
+            while (offset < bodySize)
+            {
+                const marketPacket::updateHeader_t *uh = reinterpret_cast<const marketPacket::updateHeader_t *>(body + offset);
+                if (!marketPacket::isUpdateValid(uh))
+                {
+                    state.SkipWithError("Bad update");
+                    break;
+                }
+
+                switch (uh->type)
+                {
+                case marketPacket::updateType_e::TRADE:
+                    tradeLocs.emplace_back(body + offset);
+                    break;
+                default:
+                    break;
+                }
+
+                offset += uh->length;
+            }
+
+            benchmark::DoNotOptimize(tradeLocs.data());
+            benchmark::ClobberMemory();
+        }
+
+        state.SetItemsProcessed(state.iterations() * updates.size());
+        state.SetBytesProcessed(state.iterations() * bodySize);
+    }
+    BENCHMARK(BM_perUpdateWalk);
+
+    /**
+     * Classify the whole body with one kernel, then pull the trades out of the mask
+     */
+    void BM_classifyKernel(benchmark::State &state, marketPacket::classifyUpdatesFn_t kernel, bool (*cpuSupported)())
+    {
+        if (!cpuSupported())
+        {
+            state.SkipWithError("CPU doesn't support this kernel");
+            return;
+        }
+
+        const auto &updates = fullBody();
+        const std::byte *body = reinterpret_cast<const std::byte *>(updates.data());
+
+        std::array<uint64_t, marketPacket::TRADE_MASK_WORDS> tradeMask;
+        std::vector<const std::byte *> tradeLocs;
+        tradeLocs.reserve(updates.size());
+
+        for (auto _ : state)
+        {
+            tradeLocs.clear();
+
+            if (kernel(body, updates.size(), tradeMask.data()) != updates.size())
+            {
+                state.SkipWithError("Bad update");
+                break;
+            }
+
+            for (size_t word = 0; word < (updates.size() + 63) / 64; word++)
+            {
+                for (uint64_t trades = tradeMask[word]; trades != 0; trades &= trades - 1)
+                {
+                    tradeLocs.emplace_back(body + (word * 64 + __builtin_ctzll(trades)) * marketPacket::UPDATE_SIZE);
+                }
+            }
+
+            benchmark::DoNotOptimize(tradeLocs.data());
+            benchmark::ClobberMemory();
+        }
+
+        state.SetItemsProcessed(state.iterations() * updates.size());
+        state.SetBytesProcessed(state.iterations() * updates.size() * marketPacket::UPDATE_SIZE);
+        if (kernel == marketPacket::classifyUpdates)
+        {
+            state.SetLabel(std::string(marketPacket::activeClassifyKernelName()));
+        }
+    }
+    // __builtin_cpu_supports() only takes literals, and registration happens too early to call it directly
+    BENCHMARK_CAPTURE(BM_classifyKernel, scalar, marketPacket::classifyUpdatesScalar, []
+                      { return true; });
+    BENCHMARK_CAPTURE(BM_classifyKernel, sse42, marketPacket::classifyUpdatesSse42, []
+                      { return static_cast<bool>(__builtin_cpu_supports("sse4.2")); });
+    BENCHMARK_CAPTURE(BM_classifyKernel, avx2, marketPacket::classifyUpdatesAvx2, []
+                      { return static_cast<bool>(__builtin_cpu_supports("avx2")); });
+    BENCHMARK_CAPTURE(BM_classifyKernel, avx512, marketPacket::classifyUpdatesAvx512, []
+                      { return static_cast<bool>(__builtin_cpu_supports("avx512f")); });
+    BENCHMARK_CAPTURE(BM_classifyKernel, dispatched, marketPacket::classifyUpdates, []
+                      { return true; });
+}
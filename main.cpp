@@ -2,6 +2,7 @@
 #include <string_view>
 
 #include "marketPacketGenerator/marketPacketGenerator.h"
+#include "marketPacketProcessor/latencyHandler.h"
 #include "marketPacketProcessor/marketPacketProcessor.h"
 
 // Ideally, all these go into a config file
@@ -14,12 +15,21 @@ const std::string OUTPUT_PATH = PWD + "/output.dat";
 constexpr const size_t NUM_PACKETS = 2;
 constexpr const size_t MAX_UPDATES_PACKET = 1000;
 
+// Turn on to stamp every update on the way out and report how long they took to get through the processor
+constexpr const bool MEASURE_LATENCY = false;
+
 int main()
 {
     // Generate packets
     {
+        marketPacket::generatorConfig_t config;
+        if constexpr (MEASURE_LATENCY)
+        {
+            config.stampLatency = true;
+        }
+
         marketPacket::marketPacketGenerator_t mpg(std::ofstream{GENERATE_PATH});
-        mpg.initialize();
+        mpg.initialize(config);
 
         const auto &generatorFailReason = mpg.generatePackets(NUM_PACKETS, MAX_UPDATES_PACKET);
         if (generatorFailReason.has_value())
@@ -29,6 +39,7 @@ int main()
     }
 
     // Process all the packets our input stream gives us
+    if constexpr (!MEASURE_LATENCY)
     {
         marketPacket::marketPacketProcessor_t mpp(std::ifstream{INPUT_PATH}, std::ofstream{OUTPUT_PATH, std::ofstream::out});
         mpp.initialize();
@@ -39,5 +50,24 @@ int main()
             std::cout << "Reason we're stopped processing early: " << processorFailReason.value() << std::endl;
         }
     }
+    else
+    {
+        // Same trades out as ever, just timed on the way through
+        marketPacket::tradeOutput_t tradeOutput(std::make_unique<marketPacket::fdOutputSink_t>(OUTPUT_PATH));
+        tradeOutput.initialize(marketPacket::outputFormat_e::TEXT);
+
+        marketPacket::basicMarketPacketProcessor_t<marketPacket::latencyHandler_t<marketPacket::tradeOutput_t>> mpp(
+            std::make_unique<marketPacket::mappedInputSource_t>(INPUT_PATH), std::move(tradeOutput));
+        mpp.initialize();
+
+        const auto& processorFailReason = mpp.processNextPacket(NUM_PACKETS);
+        if (processorFailReason.has_value())
+        {
+            std::cout << "Reason we're stopped processing early: " << processorFailReason.value() << std::endl;
+        }
+
+        // Generator to processor, through the capture on disk
+        mpp.handler().writeReport(std::cout);
+    }
     return EXIT_SUCCESS;
 }
@@ -0,0 +1,52 @@
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include "columnarWriter.h"
+#include "marketPacketProcessor/inputSource.h"
+#include "marketPacketProcessor/marketPacketProcessor.h"
+#include "marketPacketProcessor/outputSink.h"
+
+/**
+ * Turns a capture into a columnar archive, instead of the usual text of trades
+ *
+ *  archive <capture> <archive> [rowsPerBlock]
+ */
+
+int main(int argc, char **argv)
+{
+    if (argc < 3 || argc > 4)
+    {
+        std::cerr << "Usage: " << argv[0] << " <capture> <archive> [rowsPerBlock]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    const size_t rowsPerBlock = argc == 4 ? std::stoull(argv[3]) : marketPacket::DEFAULT_ARCHIVE_BLOCK_ROWS;
+
+    marketPacket::columnarWriter_t writer(std::make_unique<marketPacket::fdOutputSink_t>(std::string(argv[2])), rowsPerBlock);
+    writer.initialize();
+
+    marketPacket::basicMarketPacketProcessor_t<marketPacket::columnarWriter_t> mpp(std::make_unique<marketPacket::mappedInputSource_t>(argv[1]),
+                                                                                   std::move(writer));
+    mpp.initialize();
+
+    const auto &failReason = mpp.processNextPacket();
+    if (failReason.value() != marketPacket::END_OF_FILE)
+    {
+        std::cerr << "Reason we stopped archiving early: " << failReason.value() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    mpp.handler().closeBlocks();
+    const auto &flushFailReason = mpp.handler().onFlush();
+    if (flushFailReason.has_value())
+    {
+        std::cerr << "Reason we couldn't finish the archive: " << flushFailReason.value() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::cerr << "Blocks written: " << mpp.handler().numBlocksWritten()
+              << " Updates dropped: " << mpp.handler().numUpdatesDropped() << std::endl;
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,183 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace marketPacket
+{
+    /**
+     * On disk layout of a columnar archive. Everything is little endian and 8 byte aligned.
+     *
+     *  archiveFileHeader_t
+     *  Blocks, one after another, each of them:
+     *      archiveBlockHeader_t
+     *      NUM_ARCHIVE_COLUMNS * archiveColumnHeader_t, in archiveColumn_e order
+     *      Each column's payload, in the same order
+     *
+     * A block holds only trades or only quotes, one value per row in each column. Symbols are dictionary encoded
+     * with IDs that hold for the whole archive. A block's symbol payload starts with the keys of any symbols that
+     * got their ID since the last block, so every ID a block uses was handed out in it or before it.
+     *
+     * Numeric payloads (and the IDs after the dictionary) are bit packed, LSB first, into 64 bit words
+     */
+
+    constexpr const char ARCHIVE_MAGIC[4] = {'M', 'P', 'C', 'A'};
+    constexpr const uint32_t ARCHIVE_VERSION = 1;
+
+    /**
+     * @brief What each row of a block is
+     */
+    enum class archiveBlock_e : uint8_t
+    {
+        TRADES = 0,
+        QUOTES = 1,
+    };
+
+    /**
+     * @brief Which field of the update a column holds
+     *
+     *  Trades: symbol, tradeSize, tradePrice, and the latest quote timeOfDay when the trade came in
+     *  Quotes: symbol, priceLevelSize, priceLevel, timeOfDay
+     */
+    enum class archiveColumn_e : uint8_t
+    {
+        SYMBOL = 0,
+        SIZE = 1,
+        PRICE = 2,
+        TIME = 3,
+    };
+
+    constexpr const size_t NUM_ARCHIVE_COLUMNS = 4;
+
+    /**
+     * @brief How a column's values got packed
+     */
+    enum class columnEncoding_e : uint8_t
+    {
+        FRAME_OF_REFERENCE = 0, // value - base
+        DELTA = 1,              // Zigzagged difference from the row before. base is the first row
+        DICTIONARY = 2,         // Symbol IDs, packed as ID - base
+    };
+
+    struct archiveFileHeader_t
+    {
+        char magic[4];    // Always ARCHIVE_MAGIC
+        uint32_t version; // Always ARCHIVE_VERSION
+    };
+
+    struct archiveBlockHeader_t
+    {
+        archiveBlock_e type; // What the rows are
+        uint8_t numColumns;  // Always NUM_ARCHIVE_COLUMNS
+        uint16_t reserved;   // Always 0
+        uint32_t numRows;    // Rows in every column
+        uint64_t blockSize;  // Whole block, this header included
+    };
+
+    struct archiveColumnHeader_t
+    {
+        archiveColumn_e column;        // Which field this is
+        columnEncoding_e encoding;     // How it got packed
+        uint8_t bitWidth;              // Bits per packed value. 0 means every row is base
+        uint8_t reserved;              // Always 0
+        uint32_t numDictionaryEntries; // Symbol keys at the start of the payload. Always 0 for other columns
+        uint64_t min;                  // Smallest value in the column
+        uint64_t max;                  // Biggest value in the column
+        uint64_t base;                 // See columnEncoding_e
+        uint64_t dataSize;             // Bytes of payload
+    };
+
+    static_assert(sizeof(archiveFileHeader_t) == 8);
+    static_assert(sizeof(archiveBlockHeader_t) == 16);
+    static_assert(sizeof(archiveColumnHeader_t) == 40);
+
+    /**
+     * @brief How many bits it takes to hold value
+     */
+    inline uint8_t bitWidthOf(uint64_t value)
+    {
+        return 64 - std::countl_zero(value);
+    }
+
+    /**
+     * @brief How many 64 bit words numValues packed values take up
+     */
+    inline size_t numPackedWords(size_t numValues, uint8_t bitWidth)
+    {
+        return (numValues * bitWidth + 63) / 64;
+    }
+
+    inline uint64_t zigzagEncode(uint64_t delta)
+    {
+        return (delta << 1) ^ static_cast<uint64_t>(static_cast<int64_t>(delta) >> 63);
+    }
+
+    inline uint64_t zigzagDecode(uint64_t value)
+    {
+        return (value >> 1) ^ (0 - (value & 1));
+    }
+
+    /**
+     * @brief Packs values into words, LSB first
+     *
+     *  ASSUMPTION: words has numPackedWords(numValues, bitWidth) zeroed words, and every value fits in bitWidth bits
+     */
+    inline void packBits(const uint64_t *values, size_t numValues, uint8_t bitWidth, uint64_t *words)
+    {
+        // Nothing to pack, and there might not even be a word to pack it into
+        if (bitWidth == 0)
+        {
+            return;
+        }
+
+        size_t bitOffset = 0;
+        for (size_t valueIdx = 0; valueIdx < numValues; valueIdx++, bitOffset += bitWidth)
+        {
+            size_t wordIdx = bitOffset / 64;
+            size_t shift = bitOffset % 64;
+
+            words[wordIdx] |= values[valueIdx] << shift;
+            if (shift + bitWidth > 64)
+            {
+                words[wordIdx + 1] |= values[valueIdx] >> (64 - shift);
+            }
+        }
+    }
+
+    /**
+     * @brief Undoes packBits(). Words don't have to be aligned, and with a bitWidth of 0 there don't need to be any
+     */
+    inline void unpackBits(const std::byte *words, size_t numValues, uint8_t bitWidth, uint64_t *values)
+    {
+        // Every value is 0, and there are no words to read
+        if (bitWidth == 0)
+        {
+            std::fill(values, values + numValues, 0);
+            return;
+        }
+
+        const uint64_t mask = bitWidth == 64 ? ~0ull : (1ull << bitWidth) - 1;
+
+        size_t bitOffset = 0;
+        for (size_t valueIdx = 0; valueIdx < numValues; valueIdx++, bitOffset += bitWidth)
+        {
+            size_t wordIdx = bitOffset / 64;
+            size_t shift = bitOffset % 64;
+
+            uint64_t word;
+            std::memcpy(&word, words + wordIdx * sizeof(uint64_t), sizeof(word));
+            uint64_t value = word >> shift;
+
+            if (shift + bitWidth > 64)
+            {
+                std::memcpy(&word, words + (wordIdx + 1) * sizeof(uint64_t), sizeof(word));
+                value |= word << (64 - shift);
+            }
+
+            values[valueIdx] = value & mask;
+        }
+    }
+};
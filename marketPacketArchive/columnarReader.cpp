@@ -0,0 +1,169 @@
+#include "columnarReader.h"
+
+#include <algorithm>
+
+namespace marketPacket
+{
+    std::optional<failReason_t> columnarReader_t::open()
+    {
+        m_isOpen = false;
+        m_blocks.clear();
+        m_symbolKeys.clear();
+
+        if (!m_file.isOpen())
+        {
+            return INPUT_STREAM_CLOSED;
+        }
+
+        archiveFileHeader_t fileHeader;
+        if (m_file.size() < sizeof(fileHeader))
+        {
+            return ARCHIVE_POORLY_FORMED;
+        }
+
+        std::memcpy(&fileHeader, m_file.data(), sizeof(fileHeader));
+        if (std::memcmp(fileHeader.magic, ARCHIVE_MAGIC, sizeof(ARCHIVE_MAGIC)) != 0 || fileHeader.version != ARCHIVE_VERSION)
+        {
+            return ARCHIVE_POORLY_FORMED;
+        }
+
+        size_t offset = sizeof(fileHeader);
+        while (offset != m_file.size())
+        {
+            const auto &blockSize = m_file.size() - offset < sizeof(archiveBlockHeader_t) ? std::nullopt : indexBlock(offset);
+            if (!blockSize.has_value())
+            {
+                m_blocks.clear();
+                m_symbolKeys.clear();
+                return ARCHIVE_POORLY_FORMED;
+            }
+
+            offset += blockSize.value();
+        }
+
+        m_isOpen = true;
+        return std::nullopt;
+    }
+
+    bool columnarReader_t::readColumn(size_t blockIdx, archiveColumn_e column, std::vector<uint64_t> &values) const
+    {
+        if (!m_isOpen || blockIdx >= m_blocks.size())
+        {
+            return false;
+        }
+
+        const archiveBlockInfo_t &info = m_blocks[blockIdx];
+        const archiveColumnHeader_t &header = info.columns[static_cast<size_t>(column)];
+
+        // Dictionary comes first, but open() already took what it needed from it
+        const std::byte *words = m_file.data() + info.payloadOffsets[static_cast<size_t>(column)] + header.numDictionaryEntries * sizeof(symbolKey_t);
+
+        values.resize(info.numRows);
+        unpackBits(words, info.numRows, header.bitWidth, values.data());
+
+        if (header.encoding == columnEncoding_e::DELTA)
+        {
+            uint64_t value = header.base;
+            for (uint64_t &delta : values)
+            {
+                value += zigzagDecode(delta);
+                delta = value;
+            }
+        }
+        else
+        {
+            for (uint64_t &value : values)
+            {
+                value += header.base;
+            }
+        }
+
+        return true;
+    }
+
+    std::optional<uint64_t> columnarReader_t::findSymbol(std::string_view symbol) const
+    {
+        const auto &key = packSymbol(symbol);
+        if (!key.has_value())
+        {
+            return std::nullopt;
+        }
+
+        // Only ever done once per scan, not worth a table
+        auto it = std::find(m_symbolKeys.begin(), m_symbolKeys.end(), key.value());
+        if (it == m_symbolKeys.end())
+        {
+            return std::nullopt;
+        }
+
+        return it - m_symbolKeys.begin();
+    }
+
+    std::optional<size_t> columnarReader_t::indexBlock(size_t offset)
+    {
+        archiveBlockHeader_t blockHeader;
+        std::memcpy(&blockHeader, m_file.data() + offset, sizeof(blockHeader));
+
+        archiveBlockInfo_t info;
+        constexpr const size_t headersSize = sizeof(archiveBlockHeader_t) + sizeof(info.columns);
+
+        if (blockHeader.type > archiveBlock_e::QUOTES || blockHeader.numColumns != NUM_ARCHIVE_COLUMNS ||
+            blockHeader.blockSize < headersSize || blockHeader.blockSize > m_file.size() - offset)
+        {
+            return std::nullopt;
+        }
+
+        info.type = blockHeader.type;
+        info.numRows = blockHeader.numRows;
+        std::memcpy(info.columns.data(), m_file.data() + offset + sizeof(blockHeader), sizeof(info.columns));
+
+        size_t payloadOffset = offset + headersSize;
+        for (size_t columnIdx = 0; columnIdx < NUM_ARCHIVE_COLUMNS; columnIdx++)
+        {
+            const archiveColumnHeader_t &header = info.columns[columnIdx];
+            bool isSymbol = static_cast<archiveColumn_e>(columnIdx) == archiveColumn_e::SYMBOL;
+
+            // Symbols are always a dictionary, and nothing else ever is
+            bool isEncodingValid = isSymbol ? header.encoding == columnEncoding_e::DICTIONARY
+                                            : header.encoding == columnEncoding_e::FRAME_OF_REFERENCE || header.encoding == columnEncoding_e::DELTA;
+            if (static_cast<size_t>(header.column) != columnIdx || !isEncodingValid || header.bitWidth > 64 ||
+                (!isSymbol && header.numDictionaryEntries != 0))
+            {
+                return std::nullopt;
+            }
+
+            size_t expectedSize = (numPackedWords(info.numRows, header.bitWidth) + header.numDictionaryEntries) * sizeof(uint64_t);
+            if (header.dataSize != expectedSize || offset + blockHeader.blockSize - payloadOffset < expectedSize)
+            {
+                return std::nullopt;
+            }
+
+            info.payloadOffsets[columnIdx] = payloadOffset;
+            payloadOffset += expectedSize;
+        }
+
+        if (payloadOffset != offset + blockHeader.blockSize)
+        {
+            return std::nullopt;
+        }
+
+        // New symbols get the next IDs, in order
+        const archiveColumnHeader_t &symbolHeader = info.columns[static_cast<size_t>(archiveColumn_e::SYMBOL)];
+        const std::byte *entries = m_file.data() + info.payloadOffsets[static_cast<size_t>(archiveColumn_e::SYMBOL)];
+        for (uint32_t entryIdx = 0; entryIdx < symbolHeader.numDictionaryEntries; entryIdx++)
+        {
+            symbolKey_t key;
+            std::memcpy(&key, entries + entryIdx * sizeof(key), sizeof(key));
+            m_symbolKeys.push_back(key);
+        }
+
+        // Every ID a block uses has to have been handed out by now
+        if (info.numRows != 0 && symbolHeader.max >= m_symbolKeys.size())
+        {
+            return std::nullopt;
+        }
+
+        m_blocks.push_back(info);
+        return blockHeader.blockSize;
+    }
+};
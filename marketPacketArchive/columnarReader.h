@@ -0,0 +1,110 @@
+#pragma once
+
+#include <array>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "columnarFormat.h"
+#include "marketPacketHelpers/marketPacketHelpers.h"
+#include "marketPacketHelpers/symbolTable.h"
+#include "marketPacketProcessor/inputSource.h"
+
+namespace marketPacket
+{
+    /**
+     * @brief Where a block sits in the archive, and what its headers say
+     */
+    struct archiveBlockInfo_t
+    {
+        archiveBlock_e type;                                            // What the rows are
+        uint32_t numRows;                                               // Rows in every column
+        std::array<archiveColumnHeader_t, NUM_ARCHIVE_COLUMNS> columns; // Indexed by archiveColumn_e
+        std::array<size_t, NUM_ARCHIVE_COLUMNS> payloadOffsets;         // Where each column's payload starts in the file
+    };
+
+    /**
+     * Reads a columnar archive written by a columnarWriter_t, a column at a time.
+     *
+     * The file gets mapped in and open() walks the block headers once, checking them and gathering up the symbol
+     * dictionary. After that, reading a column only touches that column's payload, so a scan over one or two fields
+     * pulls in a fraction of the bytes the whole updates would. Per block min/max let a scan skip blocks without
+     * touching their payloads at all
+     */
+    class columnarReader_t
+    {
+    public:
+        /**
+         * @brief Construct a new columnarReader_t object. Nothing's readable until open() is called
+         *
+         * @param path Archive to map
+         */
+        columnarReader_t(const std::string &path)
+            : m_file(path),
+              m_isOpen(false),
+              m_blocks(),
+              m_symbolKeys(){};
+
+        /**
+         * @brief Checks every header and builds the block index and symbol dictionary
+         *
+         * @return INPUT_STREAM_CLOSED if the file couldn't be mapped, ARCHIVE_POORLY_FORMED if it isn't an archive
+         *         or got cut off. Reader stays empty if so
+         */
+        std::optional<failReason_t> open();
+
+        /**
+         * @brief How many blocks there are
+         */
+        size_t numBlocks() const { return m_blocks.size(); }
+
+        /**
+         * @brief Headers of a block
+         */
+        const archiveBlockInfo_t &block(size_t blockIdx) const { return m_blocks[blockIdx]; }
+
+        /**
+         * @brief Unpacks one column of one block
+         *
+         * @param blockIdx  Which block
+         * @param column    Which column. Symbols come out as IDs, see symbolKey()
+         * @param values    Gets numRows values, whatever was in it before goes
+         * @return False if there's no such block
+         */
+        bool readColumn(size_t blockIdx, archiveColumn_e column, std::vector<uint64_t> &values) const;
+
+        /**
+         * @brief How many symbols are in the dictionary
+         */
+        size_t numSymbols() const { return m_symbolKeys.size(); }
+
+        /**
+         * @brief Key for a symbol ID out of the symbol column
+         */
+        symbolKey_t symbolKey(uint64_t symbolId) const { return m_symbolKeys[symbolId]; }
+
+        /**
+         * @brief ID a symbol goes by in this archive
+         *
+         * @param symbol SYMBOL_LENGTH characters
+         * @return Nothing if it's the wrong length or never shows up
+         */
+        std::optional<uint64_t> findSymbol(std::string_view symbol) const;
+
+    private:
+        /**
+         * @brief Checks one block's headers and adds it to the index
+         *
+         * @param offset Where the block starts. Has room for at least an archiveBlockHeader_t
+         * @return How big the block is, nothing if anything about it is off
+         */
+        std::optional<size_t> indexBlock(size_t offset);
+
+        mappedFile_t m_file; // The whole archive
+        bool m_isOpen;       // If open() made it all the way through
+
+        std::vector<archiveBlockInfo_t> m_blocks; // Every block, in file order
+        std::vector<symbolKey_t> m_symbolKeys;    // ID -> key
+    };
+};
@@ -0,0 +1,254 @@
+#include "columnarWriter.h"
+
+#include <algorithm>
+#include <assert.h>
+#include <limits>
+
+namespace marketPacket
+{
+    namespace
+    {
+        /**
+         * @brief Copies a trivially copyable object out to dst
+         *
+         * @return Just past where it went
+         */
+        template <typename object_t>
+        std::byte *appendObject(std::byte *dst, const object_t &object)
+        {
+            std::memcpy(dst, &object, sizeof(object));
+            return dst + sizeof(object);
+        }
+    }
+
+    void columnarWriter_t::initialize()
+    {
+        // Make sure this only gets called once
+        if (m_isInitialized)
+        {
+            assert(false);
+            return;
+        }
+
+        // A block of nothing would never fill up
+        m_rowsPerBlock = std::max<size_t>(m_rowsPerBlock, 1);
+
+        // Rows in a block have to fit in its header
+        m_rowsPerBlock = std::min<size_t>(m_rowsPerBlock, std::numeric_limits<uint32_t>::max());
+
+        m_symbols = symbolTable_t(m_maxSymbols);
+        for (stagedBlock_t *block : {&m_trades, &m_quotes})
+        {
+            block->symbolIds.reserve(m_rowsPerBlock);
+            block->sizes.reserve(m_rowsPerBlock);
+            block->prices.reserve(m_rowsPerBlock);
+            block->times.reserve(m_rowsPerBlock);
+        }
+        for (std::vector<uint64_t> &toPack : m_toPack)
+        {
+            toPack.reserve(m_rowsPerBlock);
+        }
+        m_outputBuffer.reserve(OUTPUT_BUFFER_SIZE);
+
+        archiveFileHeader_t fileHeader;
+        std::memcpy(fileHeader.magic, ARCHIVE_MAGIC, sizeof(ARCHIVE_MAGIC));
+        fileHeader.version = ARCHIVE_VERSION;
+
+        m_outputBuffer.resize(sizeof(fileHeader));
+        appendObject(m_outputBuffer.data(), fileHeader);
+
+        m_isInitialized = true;
+    }
+
+    void columnarWriter_t::onQuote(const quote_t &q)
+    {
+        // Clock never goes backwards, an older quote is still a quote though
+        m_clock = std::max(m_clock, q.timeOfDay);
+        appendRow(archiveBlock_e::QUOTES, m_quotes, q.symbol, q.priceLevelSize, q.priceLevel, q.timeOfDay);
+    }
+
+    void columnarWriter_t::onTrade(const trade_t &t)
+    {
+        appendRow(archiveBlock_e::TRADES, m_trades, t.symbol, t.tradeSize, t.tradePrice, m_clock);
+    }
+
+    std::optional<failReason_t> columnarWriter_t::onPacketEnd()
+    {
+        if (m_writeFailed)
+        {
+            return ARCHIVE_WRITE_FAILED;
+        }
+
+        return std::nullopt;
+    }
+
+    std::optional<failReason_t> columnarWriter_t::onFlush()
+    {
+        if (m_isInitialized)
+        {
+            flushBuffer();
+        }
+
+        return onPacketEnd();
+    }
+
+    void columnarWriter_t::closeBlocks()
+    {
+        writeBlock(archiveBlock_e::TRADES, m_trades);
+        writeBlock(archiveBlock_e::QUOTES, m_quotes);
+    }
+
+    void columnarWriter_t::appendRow(archiveBlock_e type, stagedBlock_t &block, const char *symbol, uint64_t size, uint64_t price, uint64_t time)
+    {
+        // Until we're initialized, the table has no room, so this also covers that
+        const auto &symbolId = m_symbols.findOrInsert(packSymbol(symbol));
+        if (!symbolId.has_value())
+        {
+            m_numUpdatesDropped++;
+            return;
+        }
+
+        block.symbolIds.push_back(symbolId.value());
+        block.sizes.push_back(size);
+        block.prices.push_back(price);
+        block.times.push_back(time);
+
+        if (block.symbolIds.size() == m_rowsPerBlock)
+        {
+            writeBlock(type, block);
+        }
+    }
+
+    void columnarWriter_t::writeBlock(archiveBlock_e type, stagedBlock_t &block)
+    {
+        size_t numRows = block.symbolIds.size();
+        if (numRows == 0)
+        {
+            return;
+        }
+
+        const std::array<const std::vector<uint64_t> *, NUM_ARCHIVE_COLUMNS> columns = {&block.symbolIds, &block.sizes, &block.prices, &block.times};
+        std::array<archiveColumnHeader_t, NUM_ARCHIVE_COLUMNS> columnHeaders{};
+
+        size_t blockSize = sizeof(archiveBlockHeader_t) + sizeof(columnHeaders);
+        for (size_t columnIdx = 0; columnIdx < NUM_ARCHIVE_COLUMNS; columnIdx++)
+        {
+            archiveColumn_e column = static_cast<archiveColumn_e>(columnIdx);
+            archiveColumnHeader_t &columnHeader = columnHeaders[columnIdx];
+
+            // IDs only mean something next to the dictionary, differences between them don't
+            encodeColumn(*columns[columnIdx], column != archiveColumn_e::SYMBOL, columnHeader, m_toPack[columnIdx]);
+            columnHeader.column = column;
+
+            if (column == archiveColumn_e::SYMBOL)
+            {
+                // Symbols that got their ID since the last block, whichever staged block they showed up in
+                columnHeader.encoding = columnEncoding_e::DICTIONARY;
+                columnHeader.numDictionaryEntries = m_symbols.size() - m_numSymbolsWritten;
+                columnHeader.dataSize += columnHeader.numDictionaryEntries * sizeof(symbolKey_t);
+            }
+
+            blockSize += columnHeader.dataSize;
+        }
+
+        archiveBlockHeader_t blockHeader{};
+        blockHeader.type = type;
+        blockHeader.numColumns = NUM_ARCHIVE_COLUMNS;
+        blockHeader.numRows = numRows;
+        blockHeader.blockSize = blockSize;
+
+        // Payloads get OR'd in, so they need to start out zeroed
+        size_t blockOffset = m_outputBuffer.size();
+        m_outputBuffer.resize(blockOffset + blockSize, std::byte{0});
+
+        std::byte *dst = m_outputBuffer.data() + blockOffset;
+        dst = appendObject(dst, blockHeader);
+        dst = appendObject(dst, columnHeaders);
+
+        for (size_t columnIdx = 0; columnIdx < NUM_ARCHIVE_COLUMNS; columnIdx++)
+        {
+            const archiveColumnHeader_t &columnHeader = columnHeaders[columnIdx];
+            std::byte *payloadEnd = dst + columnHeader.dataSize;
+
+            for (uint32_t entryIdx = 0; entryIdx < columnHeader.numDictionaryEntries; entryIdx++)
+            {
+                dst = appendObject(dst, m_symbols.key(m_numSymbolsWritten + entryIdx));
+            }
+
+            if (columnHeader.bitWidth != 0)
+            {
+                // Buffer comes from the heap and everything in it is a multiple of 8 bytes, so the words are aligned
+                packBits(m_toPack[columnIdx].data(), numRows, columnHeader.bitWidth, reinterpret_cast<uint64_t *>(dst));
+            }
+
+            dst = payloadEnd;
+        }
+
+        m_numSymbolsWritten = m_symbols.size();
+        m_numBlocksWritten++;
+
+        block.symbolIds.clear();
+        block.sizes.clear();
+        block.prices.clear();
+        block.times.clear();
+
+        if (m_outputBuffer.size() >= OUTPUT_BUFFER_SIZE)
+        {
+            flushBuffer();
+        }
+    }
+
+    void columnarWriter_t::encodeColumn(const std::vector<uint64_t> &values, bool allowDelta, archiveColumnHeader_t &header, std::vector<uint64_t> &toPack)
+    {
+        const auto &[minIt, maxIt] = std::minmax_element(values.begin(), values.end());
+        header.min = *minIt;
+        header.max = *maxIt;
+
+        // OR'ing them all together has the same highest bit as the biggest one
+        uint64_t deltaBits = 0;
+        for (size_t valueIdx = 1; valueIdx < values.size(); valueIdx++)
+        {
+            deltaBits |= zigzagEncode(values[valueIdx] - values[valueIdx - 1]);
+        }
+
+        uint8_t frameOfReferenceWidth = bitWidthOf(header.max - header.min);
+        uint8_t deltaWidth = bitWidthOf(deltaBits);
+
+        toPack.resize(values.size());
+        if (allowDelta && deltaWidth < frameOfReferenceWidth)
+        {
+            header.encoding = columnEncoding_e::DELTA;
+            header.bitWidth = deltaWidth;
+            header.base = values[0];
+
+            toPack[0] = 0;
+            for (size_t valueIdx = 1; valueIdx < values.size(); valueIdx++)
+            {
+                toPack[valueIdx] = zigzagEncode(values[valueIdx] - values[valueIdx - 1]);
+            }
+        }
+        else
+        {
+            header.encoding = columnEncoding_e::FRAME_OF_REFERENCE;
+            header.bitWidth = frameOfReferenceWidth;
+            header.base = header.min;
+
+            for (size_t valueIdx = 0; valueIdx < values.size(); valueIdx++)
+            {
+                toPack[valueIdx] = values[valueIdx] - header.min;
+            }
+        }
+
+        header.dataSize = numPackedWords(values.size(), header.bitWidth) * sizeof(uint64_t);
+    }
+
+    void columnarWriter_t::flushBuffer()
+    {
+        if (!m_outputBuffer.empty() && !m_outputSink->write(reinterpret_cast<const char *>(m_outputBuffer.data()), m_outputBuffer.size()))
+        {
+            m_writeFailed = true;
+        }
+
+        m_outputBuffer.clear();
+    }
+};
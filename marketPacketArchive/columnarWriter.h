@@ -0,0 +1,161 @@
+#pragma once
+
+#include <array>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "columnarFormat.h"
+#include "marketPacketHelpers/marketPacketHelpers.h"
+#include "marketPacketHelpers/symbolTable.h"
+#include "marketPacketProcessor/outputSink.h"
+
+namespace marketPacket
+{
+    // How many rows go in a block, unless told otherwise
+    constexpr const size_t DEFAULT_ARCHIVE_BLOCK_ROWS = 64 * 1024;
+
+    // How many symbols an archive makes room for up front, unless told otherwise
+    constexpr const size_t DEFAULT_MAX_ARCHIVE_SYMBOLS = 64 * 1024;
+
+    /**
+     * Writes trades and quotes out as a columnar archive (see columnarFormat.h) instead of text.
+     *
+     * Trades and quotes each get their own block, staged a column at a time in flat arrays. Once a block has
+     * rowsPerBlock rows, every column gets packed whichever of frame of reference or delta is narrower, and the block
+     * goes into the output buffer. Trades don't carry a time, so theirs is the latest timeOfDay any quote has shown us.
+     *
+     * Everything gets allocated in initialize(), after that the only allocation is the output buffer growing to fit
+     * a block bigger than anything it's held before.
+     *
+     * Plugs straight into a basicMarketPacketProcessor_t as a handler. Call closeBlocks() once the input's done to get
+     * the last, partly filled, blocks out
+     */
+    class columnarWriter_t
+    {
+    public:
+        /**
+         * @brief Construct a new columnarWriter_t object
+         *
+         * @param outputSink    Where the archive gets written
+         * @param rowsPerBlock  How many rows a block holds before it gets written
+         * @param maxSymbols    How many symbols to make room for. Updates for any symbols past that get dropped
+         */
+        columnarWriter_t(std::unique_ptr<outputSink_t> &&outputSink,
+                         size_t rowsPerBlock = DEFAULT_ARCHIVE_BLOCK_ROWS,
+                         size_t maxSymbols = DEFAULT_MAX_ARCHIVE_SYMBOLS)
+            : m_isInitialized(false),
+              m_rowsPerBlock(rowsPerBlock),
+              m_maxSymbols(maxSymbols),
+              m_numUpdatesDropped(0),
+              m_numBlocksWritten(0),
+              m_clock(0),
+              m_symbols(),
+              m_numSymbolsWritten(0),
+              m_trades(),
+              m_quotes(),
+              m_toPack(),
+              m_outputBuffer(),
+              m_writeFailed(false),
+              m_outputSink(std::move(outputSink)){};
+
+        /**
+         * @brief Sets up the writer for use and puts the file header in the buffer. Writer won't take updates unless this is called
+         */
+        void initialize();
+
+        /**
+         * @brief Adds a row to the quote block, and moves the clock forward
+         */
+        void onQuote(const quote_t &q);
+
+        /**
+         * @brief Adds a row to the trade block
+         */
+        void onTrade(const trade_t &t);
+
+        /**
+         * @return ARCHIVE_WRITE_FAILED if the buffer filled up along the way and didn't make it out
+         */
+        std::optional<failReason_t> onPacketEnd();
+
+        /**
+         * @brief Hands everything in the buffer over to the output sink
+         *
+         * @return ARCHIVE_WRITE_FAILED if any write to the sink has ever failed
+         */
+        std::optional<failReason_t> onFlush();
+
+        /**
+         * @brief Writes out any block with rows in it, even if it isn't full. Doesn't flush
+         */
+        void closeBlocks();
+
+        /**
+         * @brief How many updates got thrown away because we were out of room for new symbols (or weren't initialized)
+         */
+        size_t numUpdatesDropped() const { return m_numUpdatesDropped; }
+
+        /**
+         * @brief How many blocks have gone into the buffer
+         */
+        size_t numBlocksWritten() const { return m_numBlocksWritten; }
+
+    private:
+        /**
+         * @brief One block's rows, a column at a time
+         */
+        struct stagedBlock_t
+        {
+            std::vector<uint64_t> symbolIds;
+            std::vector<uint64_t> sizes;
+            std::vector<uint64_t> prices;
+            std::vector<uint64_t> times;
+        };
+
+        /**
+         * @brief Adds a row, writing the block out if that fills it
+         */
+        void appendRow(archiveBlock_e type, stagedBlock_t &block, const char *symbol, uint64_t size, uint64_t price, uint64_t time);
+
+        /**
+         * @brief Packs a block into the output buffer and empties it
+         */
+        void writeBlock(archiveBlock_e type, stagedBlock_t &block);
+
+        /**
+         * @brief Picks whichever of frame of reference or delta packs a column narrower and fills in its header
+         *
+         * @param values        The column
+         * @param allowDelta    If delta is on the table at all
+         * @param header        Gets everything but the column and numDictionaryEntries
+         * @param toPack        Gets the values that actually go into the payload
+         */
+        static void encodeColumn(const std::vector<uint64_t> &values, bool allowDelta, archiveColumnHeader_t &header, std::vector<uint64_t> &toPack);
+
+        /**
+         * @brief Hands everything in the buffer over to the output sink, and marks it down if that didn't work
+         */
+        void flushBuffer();
+
+        bool m_isInitialized;       // If initialize() has been called
+        size_t m_rowsPerBlock;      // How many rows a block holds
+        size_t m_maxSymbols;        // How many symbols we have room for
+        size_t m_numUpdatesDropped; // Updates we had to throw away
+        size_t m_numBlocksWritten;  // Blocks that have gone into the buffer
+        uint64_t m_clock;           // Latest timeOfDay a quote has shown us
+
+        symbolTable_t m_symbols;    // Symbol -> ID in the archive
+        size_t m_numSymbolsWritten; // IDs below this are already in some block's dictionary
+
+        stagedBlock_t m_trades; // Trades waiting on a full block
+        stagedBlock_t m_quotes; // Quotes waiting on a full block
+
+        std::array<std::vector<uint64_t>, NUM_ARCHIVE_COLUMNS> m_toPack; // Per column values ready to pack, so we don't allocate for every block
+
+        std::vector<std::byte> m_outputBuffer; // Packed blocks waiting to go out in one big write
+
+        bool m_writeFailed;                         // If the sink ever let us down
+        std::unique_ptr<outputSink_t> m_outputSink; // Where the output buffer gets flushed to
+    };
+};
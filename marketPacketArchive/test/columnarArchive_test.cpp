@@ -0,0 +1,365 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "marketPacketArchive/columnarReader.h"
+#include "marketPacketArchive/columnarWriter.h"
+#include "marketPacketGenerator/marketPacketGenerator.h"
+#include "marketPacketHelpers/marketPacketHelpers.h"
+#include "marketPacketHelpers/randomEngine.h"
+#include "marketPacketProcessor/marketPacketProcessor.h"
+
+namespace test
+{
+  // Ideally, all these go into a config file
+  const std::string INPUT_PATH = "./archive_input_test.dat";
+  const std::string ARCHIVE_PATH = "./archive_test.mpca";
+
+  constexpr const size_t NUM_PACKETS_TO_GENERATE = 50;
+  constexpr const size_t ROWS_PER_BLOCK = 100;
+
+  marketPacket::quote_t makeQuote(const char *symbol, uint16_t price, uint64_t size, uint64_t timeOfDay)
+  {
+    marketPacket::quote_t q{};
+    q.updateHeader.type = marketPacket::updateType_e::QUOTE;
+    std::memcpy(q.symbol, symbol, marketPacket::SYMBOL_LENGTH);
+    q.priceLevel = price;
+    q.priceLevelSize = size;
+    q.timeOfDay = timeOfDay;
+    return q;
+  }
+
+  marketPacket::trade_t makeTrade(const char *symbol, uint64_t price, uint16_t size)
+  {
+    marketPacket::trade_t t{};
+    t.updateHeader.type = marketPacket::updateType_e::TRADE;
+    std::memcpy(t.symbol, symbol, marketPacket::SYMBOL_LENGTH);
+    t.tradePrice = price;
+    t.tradeSize = size;
+    return t;
+  }
+
+  /**
+   * @brief One update, the way an archive row sees it
+   */
+  struct row_t
+  {
+    std::string symbol;
+    uint64_t size;
+    uint64_t price;
+    uint64_t time;
+
+    bool operator==(const row_t &) const = default;
+  };
+
+  /**
+   * @brief Same rows, the slow, obvious way
+   */
+  struct referenceRows_t
+  {
+    uint64_t clock = 0;
+    std::vector<row_t> trades;
+    std::vector<row_t> quotes;
+
+    void onQuote(const marketPacket::quote_t &q)
+    {
+      clock = std::max(clock, q.timeOfDay);
+      quotes.push_back({std::string(q.symbol, marketPacket::SYMBOL_LENGTH), q.priceLevelSize, q.priceLevel, q.timeOfDay});
+    }
+
+    void onTrade(const marketPacket::trade_t &t)
+    {
+      trades.push_back({std::string(t.symbol, marketPacket::SYMBOL_LENGTH), t.tradeSize, t.tradePrice, clock});
+    }
+  };
+
+  /**
+   * @brief Reads every block of an archive back into rows, checking each block's min/max along the way
+   */
+  void readRows(const marketPacket::columnarReader_t &reader, std::vector<row_t> &trades, std::vector<row_t> &quotes)
+  {
+    std::array<std::vector<uint64_t>, marketPacket::NUM_ARCHIVE_COLUMNS> columns;
+    for (size_t blockIdx = 0; blockIdx < reader.numBlocks(); blockIdx++)
+    {
+      const marketPacket::archiveBlockInfo_t &info = reader.block(blockIdx);
+      for (size_t columnIdx = 0; columnIdx < marketPacket::NUM_ARCHIVE_COLUMNS; columnIdx++)
+      {
+        ASSERT_TRUE(reader.readColumn(blockIdx, static_cast<marketPacket::archiveColumn_e>(columnIdx), columns[columnIdx]));
+        ASSERT_EQ(columns[columnIdx].size(), info.numRows);
+
+        EXPECT_EQ(*std::min_element(columns[columnIdx].begin(), columns[columnIdx].end()), info.columns[columnIdx].min);
+        EXPECT_EQ(*std::max_element(columns[columnIdx].begin(), columns[columnIdx].end()), info.columns[columnIdx].max);
+      }
+
+      std::vector<row_t> &rows = info.type == marketPacket::archiveBlock_e::TRADES ? trades : quotes;
+      for (size_t rowIdx = 0; rowIdx < info.numRows; rowIdx++)
+      {
+        char symbol[marketPacket::SYMBOL_LENGTH];
+        marketPacket::unpackSymbol(symbol, reader.symbolKey(columns[0][rowIdx]));
+        rows.push_back({std::string(symbol, marketPacket::SYMBOL_LENGTH), columns[1][rowIdx], columns[2][rowIdx], columns[3][rowIdx]});
+      }
+    }
+  }
+
+  TEST(columnarArchiveTest, bitPackingRoundTrips)
+  {
+    marketPacket::randomEngine_t rng(1);
+
+    for (uint8_t bitWidth = 0; bitWidth <= 64; bitWidth++)
+    {
+      const uint64_t mask = bitWidth == 64 ? ~0ull : (1ull << bitWidth) - 1;
+
+      // Odd count, so the last word's only partly used
+      std::vector<uint64_t> values(77);
+      for (uint64_t &value : values)
+      {
+        value = rng() & mask;
+      }
+
+      std::vector<uint64_t> words(marketPacket::numPackedWords(values.size(), bitWidth), 0);
+      marketPacket::packBits(values.data(), values.size(), bitWidth, words.data());
+
+      std::vector<uint64_t> unpacked(values.size(), ~0ull);
+      marketPacket::unpackBits(reinterpret_cast<const std::byte *>(words.data()), values.size(), bitWidth, unpacked.data());
+      EXPECT_EQ(unpacked, values) << "bitWidth " << static_cast<int>(bitWidth);
+    }
+  }
+
+  TEST(columnarArchiveTest, picksEncodingPerColumn)
+  {
+    {
+      marketPacket::columnarWriter_t writer(std::make_unique<marketPacket::fdOutputSink_t>(ARCHIVE_PATH));
+      writer.initialize();
+
+      // Times creep forward, sizes never change, prices jump all over the place
+      const uint16_t prices[] = {3, 60000, 17, 40000, 9, 1};
+      for (size_t quoteIdx = 0; quoteIdx < 6; quoteIdx++)
+      {
+        writer.onQuote(makeQuote(quoteIdx % 2 ? "AAAAA" : "BBBBB", prices[quoteIdx], 100, 1'000'000'000 + quoteIdx * 3));
+      }
+
+      writer.closeBlocks();
+      ASSERT_FALSE(writer.onFlush().has_value());
+      EXPECT_EQ(writer.numBlocksWritten(), 1);
+    }
+
+    marketPacket::columnarReader_t reader(ARCHIVE_PATH);
+    ASSERT_FALSE(reader.open().has_value());
+    ASSERT_EQ(reader.numBlocks(), 1);
+
+    const marketPacket::archiveBlockInfo_t &info = reader.block(0);
+    EXPECT_EQ(info.type, marketPacket::archiveBlock_e::QUOTES);
+    EXPECT_EQ(info.numRows, 6);
+
+    const auto &symbols = info.columns[static_cast<size_t>(marketPacket::archiveColumn_e::SYMBOL)];
+    EXPECT_EQ(symbols.encoding, marketPacket::columnEncoding_e::DICTIONARY);
+    EXPECT_EQ(symbols.numDictionaryEntries, 2);
+    EXPECT_EQ(symbols.bitWidth, 1);
+
+    const auto &sizes = info.columns[static_cast<size_t>(marketPacket::archiveColumn_e::SIZE)];
+    EXPECT_EQ(sizes.bitWidth, 0);
+    EXPECT_EQ(sizes.dataSize, 0);
+    EXPECT_EQ(sizes.min, 100);
+    EXPECT_EQ(sizes.max, 100);
+
+    const auto &prices = info.columns[static_cast<size_t>(marketPacket::archiveColumn_e::PRICE)];
+    EXPECT_EQ(prices.encoding, marketPacket::columnEncoding_e::FRAME_OF_REFERENCE);
+    EXPECT_EQ(prices.min, 1);
+    EXPECT_EQ(prices.max, 60000);
+
+    const auto &times = info.columns[static_cast<size_t>(marketPacket::archiveColumn_e::TIME)];
+    EXPECT_EQ(times.encoding, marketPacket::columnEncoding_e::DELTA);
+    EXPECT_EQ(times.bitWidth, 3);
+    EXPECT_EQ(times.min, 1'000'000'000);
+    EXPECT_EQ(times.max, 1'000'000'015);
+
+    std::vector<uint64_t> values;
+    ASSERT_TRUE(reader.readColumn(0, marketPacket::archiveColumn_e::TIME, values));
+    EXPECT_EQ(values, (std::vector<uint64_t>{1'000'000'000, 1'000'000'003, 1'000'000'006, 1'000'000'009, 1'000'000'012, 1'000'000'015}));
+
+    ASSERT_TRUE(reader.readColumn(0, marketPacket::archiveColumn_e::SYMBOL, values));
+    EXPECT_EQ(values, (std::vector<uint64_t>{0, 1, 0, 1, 0, 1}));
+    EXPECT_EQ(reader.findSymbol("BBBBB").value(), 0);
+    EXPECT_EQ(reader.findSymbol("AAAAA").value(), 1);
+    EXPECT_FALSE(reader.findSymbol("CCCCC").has_value());
+
+    EXPECT_FALSE(reader.readColumn(1, marketPacket::archiveColumn_e::TIME, values));
+  }
+
+  TEST(columnarArchiveTest, tradesTakeTheQuoteClock)
+  {
+    {
+      marketPacket::columnarWriter_t writer(std::make_unique<marketPacket::fdOutputSink_t>(ARCHIVE_PATH), 2);
+      writer.initialize();
+
+      writer.onTrade(makeTrade("AAAAA", 10, 1));
+      writer.onQuote(makeQuote("BBBBB", 1, 1, 500));
+      writer.onTrade(makeTrade("CCCCC", 20, 2));
+
+      // Clock doesn't go backwards
+      writer.onQuote(makeQuote("BBBBB", 1, 1, 100));
+      writer.onTrade(makeTrade("AAAAA", 30, 3));
+
+      writer.closeBlocks();
+      ASSERT_FALSE(writer.onFlush().has_value());
+    }
+
+    marketPacket::columnarReader_t reader(ARCHIVE_PATH);
+    ASSERT_FALSE(reader.open().has_value());
+
+    std::vector<row_t> trades, quotes;
+    readRows(reader, trades, quotes);
+
+    EXPECT_EQ(trades, (std::vector<row_t>{{"AAAAA", 1, 10, 0}, {"CCCCC", 2, 20, 500}, {"AAAAA", 3, 30, 500}}));
+    EXPECT_EQ(quotes, (std::vector<row_t>{{"BBBBB", 1, 1, 500}, {"BBBBB", 1, 1, 100}}));
+    EXPECT_EQ(reader.numSymbols(), 3);
+  }
+
+  TEST(columnarArchiveTest, matchesReferenceOverCapture)
+  {
+    // Generator has to go away before we read, or the end of the capture might still be sitting in its buffer
+    {
+      marketPacket::generatorConfig_t config;
+      config.seed = 25;
+      config.workload.numSymbols = 64;
+      config.workload.startTimeOfDay = 34'200'000'000;
+      config.workload.maxPriceStep = 4;
+
+      marketPacket::marketPacketGenerator_t mpg(std::ofstream{INPUT_PATH});
+      mpg.initialize(config);
+      ASSERT_FALSE(mpg.generatePackets(NUM_PACKETS_TO_GENERATE, marketPacket::MAX_UPDATES_ALLOWED_IN_PACKET).has_value());
+    }
+
+    // Small blocks, so there are plenty of them and symbols keep turning up in the middle
+    marketPacket::columnarWriter_t writer(std::make_unique<marketPacket::fdOutputSink_t>(ARCHIVE_PATH), ROWS_PER_BLOCK);
+    writer.initialize();
+
+    marketPacket::basicMarketPacketProcessor_t<marketPacket::columnarWriter_t> mpp(std::make_unique<marketPacket::mappedInputSource_t>(INPUT_PATH),
+                                                                                   std::move(writer));
+    mpp.initialize();
+    ASSERT_EQ(mpp.processNextPacket().value(), marketPacket::END_OF_FILE);
+    mpp.handler().closeBlocks();
+    ASSERT_FALSE(mpp.handler().onFlush().has_value());
+    EXPECT_EQ(mpp.handler().numUpdatesDropped(), 0);
+
+    marketPacket::basicMarketPacketProcessor_t<referenceRows_t> reference(std::make_unique<marketPacket::mappedInputSource_t>(INPUT_PATH),
+                                                                          referenceRows_t{});
+    reference.initialize();
+    ASSERT_EQ(reference.processNextPacket().value(), marketPacket::END_OF_FILE);
+
+    marketPacket::columnarReader_t reader(ARCHIVE_PATH);
+    ASSERT_FALSE(reader.open().has_value());
+    EXPECT_EQ(reader.numBlocks(), mpp.handler().numBlocksWritten());
+    EXPECT_GT(reader.numBlocks(), 2);
+    EXPECT_LE(reader.numSymbols(), 64);
+
+    std::vector<row_t> trades, quotes;
+    readRows(reader, trades, quotes);
+
+    ASSERT_FALSE(trades.empty());
+    ASSERT_FALSE(quotes.empty());
+    EXPECT_EQ(trades, reference.handler().trades);
+    EXPECT_EQ(quotes, reference.handler().quotes);
+
+    // Time only moves forward a little at a time, so it should never take the full width
+    for (size_t blockIdx = 0; blockIdx < reader.numBlocks(); blockIdx++)
+    {
+      const auto &times = reader.block(blockIdx).columns[static_cast<size_t>(marketPacket::archiveColumn_e::TIME)];
+      EXPECT_LT(times.bitWidth, 32);
+    }
+
+    // The archive is a lot smaller than the capture it came from
+    std::ifstream capture(INPUT_PATH, std::ios::binary | std::ios::ate);
+    std::ifstream archive(ARCHIVE_PATH, std::ios::binary | std::ios::ate);
+    EXPECT_LT(archive.tellg(), capture.tellg());
+  }
+
+  TEST(columnarArchiveTest, poorlyFormedArchives)
+  {
+    {
+      marketPacket::columnarReader_t reader("./archive_does_not_exist.mpca");
+      EXPECT_EQ(reader.open().value(), marketPacket::INPUT_STREAM_CLOSED);
+    }
+
+    std::string archive;
+    {
+      marketPacket::columnarWriter_t writer(std::make_unique<marketPacket::memoryOutputSink_t>(archive));
+      writer.initialize();
+      writer.onQuote(makeQuote("AAAAA", 5, 10, 20));
+      writer.onTrade(makeTrade("BBBBB", 7, 3));
+      writer.closeBlocks();
+      ASSERT_FALSE(writer.onFlush().has_value());
+    }
+
+    auto writeArchive = [](const std::string &bytes)
+    {
+      std::ofstream(ARCHIVE_PATH, std::ios::binary | std::ios::trunc).write(bytes.data(), bytes.size());
+    };
+
+    // Whole thing's fine
+    writeArchive(archive);
+    {
+      marketPacket::columnarReader_t reader(ARCHIVE_PATH);
+      ASSERT_FALSE(reader.open().has_value());
+      EXPECT_EQ(reader.numBlocks(), 2);
+    }
+
+    // Cut off anywhere past the file header
+    for (size_t size : {size_t{0}, size_t{4}, size_t{12}, archive.size() / 2, archive.size() - 8})
+    {
+      writeArchive(archive.substr(0, size));
+      marketPacket::columnarReader_t reader(ARCHIVE_PATH);
+      EXPECT_EQ(reader.open().value(), marketPacket::ARCHIVE_POORLY_FORMED) << "size " << size;
+      EXPECT_EQ(reader.numBlocks(), 0);
+    }
+
+    // Not an archive at all
+    std::string badMagic = archive;
+    badMagic[0] = 'X';
+    writeArchive(badMagic);
+    {
+      marketPacket::columnarReader_t reader(ARCHIVE_PATH);
+      EXPECT_EQ(reader.open().value(), marketPacket::ARCHIVE_POORLY_FORMED);
+    }
+
+    // Block that uses a symbol nobody ever gave an ID to
+    std::string badSymbol = archive;
+    size_t symbolMaxOffset = sizeof(marketPacket::archiveFileHeader_t) + sizeof(marketPacket::archiveBlockHeader_t) +
+                             offsetof(marketPacket::archiveColumnHeader_t, max);
+    badSymbol[symbolMaxOffset] = 5;
+    writeArchive(badSymbol);
+    {
+      marketPacket::columnarReader_t reader(ARCHIVE_PATH);
+      EXPECT_EQ(reader.open().value(), marketPacket::ARCHIVE_POORLY_FORMED);
+    }
+  }
+
+  TEST(columnarArchiveTest, uninitialized)
+  {
+    std::string archive;
+    marketPacket::columnarWriter_t writer(std::make_unique<marketPacket::memoryOutputSink_t>(archive));
+
+    writer.onQuote(makeQuote("AAAAA", 1, 1, 1));
+    writer.onTrade(makeTrade("AAAAA", 1, 1));
+    writer.closeBlocks();
+
+    ASSERT_FALSE(writer.onFlush().has_value());
+    EXPECT_EQ(writer.numUpdatesDropped(), 2);
+    EXPECT_EQ(writer.numBlocksWritten(), 0);
+    EXPECT_TRUE(archive.empty());
+  }
+
+  TEST(columnarArchiveTest, writeFailure)
+  {
+    marketPacket::columnarWriter_t writer(std::make_unique<marketPacket::streamOutputSink_t>(std::ofstream{}));
+    writer.initialize();
+
+    writer.onTrade(makeTrade("AAAAA", 1, 1));
+    writer.closeBlocks();
+
+    EXPECT_EQ(writer.onFlush().value(), marketPacket::ARCHIVE_WRITE_FAILED);
+    EXPECT_EQ(writer.onPacketEnd().value(), marketPacket::ARCHIVE_WRITE_FAILED);
+  }
+}
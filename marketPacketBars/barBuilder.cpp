@@ -0,0 +1,166 @@
+#include "barBuilder.h"
+
+#include <algorithm>
+#include <assert.h>
+#include <cstring>
+
+namespace marketPacket
+{
+    namespace
+    {
+        /**
+         * @brief Writes out a label followed by a number
+         */
+        char *appendField(char *dst, std::string_view label, uint64_t value)
+        {
+            std::memcpy(dst, label.data(), label.size());
+            return formatDecimal(dst + label.size(), value);
+        }
+    }
+
+    void barBuilder_t::initialize(uint64_t barInterval)
+    {
+        // Make sure this only gets called once
+        if (m_isInitialized)
+        {
+            assert(false);
+            return;
+        }
+
+        // Every trade being its own interval is as fine grained as it gets
+        m_barInterval = std::max<uint64_t>(barInterval, 1);
+
+        m_symbols = symbolTable_t(m_maxSymbols);
+        m_openBars.reserve(m_maxSymbols);
+        m_open.resize(m_maxSymbols);
+        m_high.resize(m_maxSymbols);
+        m_low.resize(m_maxSymbols);
+        m_close.resize(m_maxSymbols);
+        m_volume.resize(m_maxSymbols);
+        m_notional.resize(m_maxSymbols);
+        m_numTrades.resize(m_maxSymbols);
+        m_outputBuffer = std::make_unique<char[]>(OUTPUT_BUFFER_SIZE);
+
+        m_isInitialized = true;
+    }
+
+    void barBuilder_t::onQuote(const quote_t &q)
+    {
+        if (!m_isInitialized)
+        {
+            return;
+        }
+
+        uint64_t bar = q.timeOfDay / m_barInterval;
+        if (bar <= m_currentBar)
+        {
+            return;
+        }
+
+        closeBars();
+        m_currentBar = bar;
+    }
+
+    void barBuilder_t::onTrade(const trade_t &t)
+    {
+        // Until we're initialized, the table has no room, so this also covers that
+        const auto &symbolId = m_symbols.findOrInsert(packSymbol(t.symbol));
+        if (!symbolId.has_value())
+        {
+            m_numTradesDropped++;
+            return;
+        }
+
+        symbolId_t id = symbolId.value();
+        if (m_numTrades[id] == 0)
+        {
+            m_openBars.push_back(id);
+            m_open[id] = t.tradePrice;
+            m_high[id] = t.tradePrice;
+            m_low[id] = t.tradePrice;
+            m_volume[id] = 0;
+            m_notional[id] = 0;
+        }
+
+        m_high[id] = std::max(m_high[id], t.tradePrice);
+        m_low[id] = std::min(m_low[id], t.tradePrice);
+        m_close[id] = t.tradePrice;
+        m_volume[id] += t.tradeSize;
+        m_notional[id] += static_cast<unsigned __int128>(t.tradePrice) * t.tradeSize;
+        m_numTrades[id]++;
+    }
+
+    std::optional<failReason_t> barBuilder_t::onPacketEnd()
+    {
+        if (m_writeFailed)
+        {
+            return BAR_WRITE_FAILED;
+        }
+
+        return std::nullopt;
+    }
+
+    std::optional<failReason_t> barBuilder_t::onFlush()
+    {
+        if (m_isInitialized)
+        {
+            flushBuffer();
+        }
+
+        return onPacketEnd();
+    }
+
+    void barBuilder_t::closeBars()
+    {
+        for (symbolId_t id : m_openBars)
+        {
+            appendBarString(id);
+            m_numTrades[id] = 0;
+        }
+
+        m_openBars.clear();
+    }
+
+    void barBuilder_t::flushBuffer()
+    {
+        if (m_outputBufferUsed != 0 && !m_outputSink->write(m_outputBuffer.get(), m_outputBufferUsed))
+        {
+            m_writeFailed = true;
+        }
+
+        m_outputBufferUsed = 0;
+    }
+
+    void barBuilder_t::appendBarString(symbolId_t id)
+    {
+        // Make sure the next bar has room, no matter how long it ends up being
+        if (OUTPUT_BUFFER_SIZE - m_outputBufferUsed < MAX_BAR_STRING_LENGTH)
+        {
+            flushBuffer();
+        }
+
+        char *dst = m_outputBuffer.get() + m_outputBufferUsed;
+
+        constexpr const std::string_view barPrefix = "Bar: ";
+        std::memcpy(dst, barPrefix.data(), barPrefix.size());
+        dst += barPrefix.size();
+
+        unpackSymbol(dst, m_symbols.key(id));
+        dst += SYMBOL_LENGTH;
+
+        // A bar of nothing but 0 sized trades has no VWAP. Call it the close
+        uint64_t vwap = m_volume[id] == 0 ? m_close[id] : static_cast<uint64_t>(m_notional[id] / m_volume[id]);
+
+        dst = appendField(dst, " Start: ", m_currentBar * m_barInterval);
+        dst = appendField(dst, " Open: ", m_open[id]);
+        dst = appendField(dst, " High: ", m_high[id]);
+        dst = appendField(dst, " Low: ", m_low[id]);
+        dst = appendField(dst, " Close: ", m_close[id]);
+        dst = appendField(dst, " Volume: ", m_volume[id]);
+        dst = appendField(dst, " VWAP: ", vwap);
+        dst = appendField(dst, " Trades: ", m_numTrades[id]);
+        *dst++ = '\n';
+
+        m_outputBufferUsed = dst - m_outputBuffer.get();
+    }
+};
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "marketPacketHelpers/marketPacketHelpers.h"
+#include "marketPacketHelpers/symbolTable.h"
+#include "marketPacketProcessor/outputSink.h"
+
+namespace marketPacket
+{
+    // How many symbols a bar builder makes room for up front, unless told otherwise
+    constexpr const size_t DEFAULT_MAX_BAR_SYMBOLS = 64 * 1024;
+
+    // "Bar: " + SYMBOL_LENGTH + 7 * (label + 20 digits), Start through VWAP, + " Trades: " + 10 digits + '\n' = 222. Round it up
+    constexpr const size_t MAX_BAR_STRING_LENGTH = 256;
+
+    /**
+     * Rolls trades up into per symbol time bars: open, high, low, close, volume, VWAP and trade count.
+     *
+     * Trades don't carry a time, so the clock is the latest timeOfDay any quote has shown us. Once the clock moves
+     * into a new bar interval, every bar that saw a trade in the old one gets written out as a line of text, in the
+     * order their first trades came in. Clock never goes backwards, an older quote doesn't reopen anything.
+     *
+     * Accumulators are flat arrays indexed by symbol ID, so a trade touches one entry in each. Everything gets
+     * allocated in initialize(), nothing after that.
+     *
+     * Plugs straight into a basicMarketPacketProcessor_t as a handler. Call closeBars() once the input's done to get
+     * the last, still open, bars out
+     */
+    class barBuilder_t
+    {
+    public:
+        /**
+         * @brief Construct a new barBuilder_t object
+         *
+         * @param outputSink Where closed bars get written
+         * @param maxSymbols How many symbols to make room for. Trades for any symbols past that get dropped
+         */
+        barBuilder_t(std::unique_ptr<outputSink_t> &&outputSink, size_t maxSymbols = DEFAULT_MAX_BAR_SYMBOLS)
+            : m_isInitialized(false),
+              m_barInterval(),
+              m_maxSymbols(maxSymbols),
+              m_numTradesDropped(0),
+              m_currentBar(0),
+              m_symbols(),
+              m_openBars(),
+              m_open(),
+              m_high(),
+              m_low(),
+              m_close(),
+              m_volume(),
+              m_notional(),
+              m_numTrades(),
+              m_outputBuffer(),
+              m_outputBufferUsed(),
+              m_writeFailed(false),
+              m_outputSink(std::move(outputSink)){};
+
+        /**
+         * @brief Sets up the builder for use. Builder won't take trades unless this is called
+         *
+         * @param barInterval How much timeOfDay each bar covers
+         */
+        void initialize(uint64_t barInterval);
+
+        /**
+         * @brief Moves the clock forward, closing out the current bars if it crosses into a new interval
+         */
+        void onQuote(const quote_t &q);
+
+        /**
+         * @brief Adds a trade to its symbol's current bar
+         */
+        void onTrade(const trade_t &t);
+
+        /**
+         * @return BAR_WRITE_FAILED if the buffer filled up along the way and didn't make it out
+         */
+        std::optional<failReason_t> onPacketEnd();
+
+        /**
+         * @brief Hands everything in the buffer over to the output sink
+         *
+         * @return BAR_WRITE_FAILED if any write to the sink has ever failed
+         */
+        std::optional<failReason_t> onFlush();
+
+        /**
+         * @brief Writes out every bar that's seen a trade and starts them all over. Doesn't flush
+         */
+        void closeBars();
+
+        /**
+         * @brief How many trades got thrown away because we were out of room for new symbols (or weren't initialized)
+         */
+        size_t numTradesDropped() const { return m_numTradesDropped; }
+
+    private:
+        /**
+         * @brief Hands everything in the buffer over to the output sink, and marks it down if that didn't work
+         */
+        void flushBuffer();
+
+        /**
+         * @brief Outputs a symbol's bar to the output buffer
+         */
+        void appendBarString(symbolId_t symbolId);
+
+        bool m_isInitialized;      // If initialize() has been called
+        uint64_t m_barInterval;    // How much timeOfDay each bar covers
+        size_t m_maxSymbols;       // How many symbols we have room for
+        size_t m_numTradesDropped; // Trades we had to throw away
+        uint64_t m_currentBar;     // Which interval the clock is in. timeOfDay / m_barInterval
+
+        symbolTable_t m_symbols;            // Symbol -> accumulator slot
+        std::vector<symbolId_t> m_openBars; // Slots that have seen a trade this bar, in order
+
+        std::vector<uint64_t> m_open;              // First trade price this bar
+        std::vector<uint64_t> m_high;              // Highest trade price this bar
+        std::vector<uint64_t> m_low;               // Lowest trade price this bar
+        std::vector<uint64_t> m_close;             // Last trade price this bar
+        std::vector<uint64_t> m_volume;            // Sum of trade sizes this bar
+        std::vector<unsigned __int128> m_notional; // Sum of price * size this bar. Full range prices overflow 64 bits
+        std::vector<uint32_t> m_numTrades;         // How many trades this bar. 0 means the bar isn't open
+
+        std::unique_ptr<char[]> m_outputBuffer; // Where we format bars before they go out in one big write
+        size_t m_outputBufferUsed;              // How much of the output buffer is filled
+
+        bool m_writeFailed;                         // If the sink ever let us down
+        std::unique_ptr<outputSink_t> m_outputSink; // Where the output buffer gets flushed to
+    };
+};
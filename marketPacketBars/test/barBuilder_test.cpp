@@ -0,0 +1,224 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include <map>
+#include <vector>
+
+#include "marketPacketBars/barBuilder.h"
+#include "marketPacketGenerator/marketPacketGenerator.h"
+#include "marketPacketHelpers/marketPacketHelpers.h"
+#include "marketPacketProcessor/marketPacketProcessor.h"
+
+namespace test
+{
+  // Ideally, all these go into a config file
+  const std::string INPUT_PATH = "./bars_input_test.dat";
+
+  constexpr const size_t NUM_PACKETS_TO_GENERATE = 20;
+
+  marketPacket::quote_t makeQuote(uint64_t timeOfDay)
+  {
+    marketPacket::quote_t q{};
+    q.updateHeader.type = marketPacket::updateType_e::QUOTE;
+    std::memcpy(q.symbol, "QUOTE", marketPacket::SYMBOL_LENGTH);
+    q.timeOfDay = timeOfDay;
+    return q;
+  }
+
+  marketPacket::trade_t makeTrade(const char *symbol, uint64_t price, uint16_t size)
+  {
+    marketPacket::trade_t t{};
+    t.updateHeader.type = marketPacket::updateType_e::TRADE;
+    std::memcpy(t.symbol, symbol, marketPacket::SYMBOL_LENGTH);
+    t.tradePrice = price;
+    t.tradeSize = size;
+    return t;
+  }
+
+  /**
+   * @brief Same bars, the slow, obvious way
+   */
+  struct referenceBars_t
+  {
+    struct bar_t
+    {
+      uint64_t open, high, low, close, volume = 0, numTrades = 0;
+      unsigned __int128 notional = 0;
+    };
+
+    uint64_t barInterval;
+    uint64_t currentBar = 0;
+    std::vector<std::string> openOrder;
+    std::map<std::string, bar_t> bars;
+    std::string output;
+
+    void onQuote(const marketPacket::quote_t &q)
+    {
+      if (q.timeOfDay / barInterval > currentBar)
+      {
+        closeBars();
+        currentBar = q.timeOfDay / barInterval;
+      }
+    }
+
+    void onTrade(const marketPacket::trade_t &t)
+    {
+      std::string symbol(t.symbol, marketPacket::SYMBOL_LENGTH);
+      auto it = bars.find(symbol);
+      if (it == bars.end())
+      {
+        openOrder.push_back(symbol);
+        it = bars.emplace(symbol, bar_t{t.tradePrice, t.tradePrice, t.tradePrice, t.tradePrice}).first;
+      }
+
+      bar_t &bar = it->second;
+      bar.high = std::max(bar.high, t.tradePrice);
+      bar.low = std::min(bar.low, t.tradePrice);
+      bar.close = t.tradePrice;
+      bar.volume += t.tradeSize;
+      bar.notional += static_cast<unsigned __int128>(t.tradePrice) * t.tradeSize;
+      bar.numTrades++;
+    }
+
+    void closeBars()
+    {
+      for (const std::string &symbol : openOrder)
+      {
+        const bar_t &bar = bars[symbol];
+        uint64_t vwap = bar.volume == 0 ? bar.close : static_cast<uint64_t>(bar.notional / bar.volume);
+        output += "Bar: " + symbol + " Start: " + std::to_string(currentBar * barInterval) +
+                  " Open: " + std::to_string(bar.open) + " High: " + std::to_string(bar.high) +
+                  " Low: " + std::to_string(bar.low) + " Close: " + std::to_string(bar.close) +
+                  " Volume: " + std::to_string(bar.volume) + " VWAP: " + std::to_string(vwap) +
+                  " Trades: " + std::to_string(bar.numTrades) + "\n";
+      }
+      openOrder.clear();
+      bars.clear();
+    }
+  };
+
+  TEST(barBuilderTest, barsCloseOnNewInterval)
+  {
+    std::string output;
+    marketPacket::barBuilder_t bars(std::make_unique<marketPacket::memoryOutputSink_t>(output));
+    bars.initialize(100);
+
+    bars.onQuote(makeQuote(10));
+    bars.onTrade(makeTrade("BBBBB", 50, 1));
+    bars.onTrade(makeTrade("AAAAA", 10, 2));
+    bars.onTrade(makeTrade("AAAAA", 20, 2));
+    bars.onTrade(makeTrade("AAAAA", 5, 4));
+    bars.onTrade(makeTrade("AAAAA", 15, 2));
+
+    // Same interval, nothing closes
+    bars.onQuote(makeQuote(99));
+    ASSERT_FALSE(bars.onFlush().has_value());
+    EXPECT_TRUE(output.empty());
+
+    bars.onQuote(makeQuote(250));
+    ASSERT_FALSE(bars.onFlush().has_value());
+    EXPECT_EQ(output, "Bar: BBBBB Start: 0 Open: 50 High: 50 Low: 50 Close: 50 Volume: 1 VWAP: 50 Trades: 1\n"
+                      "Bar: AAAAA Start: 0 Open: 10 High: 20 Low: 5 Close: 15 Volume: 10 VWAP: 11 Trades: 4\n");
+    output.clear();
+
+    // Clock doesn't go backwards
+    bars.onTrade(makeTrade("AAAAA", 7, 1));
+    bars.onQuote(makeQuote(0));
+    ASSERT_FALSE(bars.onFlush().has_value());
+    EXPECT_TRUE(output.empty());
+
+    bars.closeBars();
+    ASSERT_FALSE(bars.onFlush().has_value());
+    EXPECT_EQ(output, "Bar: AAAAA Start: 200 Open: 7 High: 7 Low: 7 Close: 7 Volume: 1 VWAP: 7 Trades: 1\n");
+  }
+
+  TEST(barBuilderTest, emptyIntervalsWriteNothing)
+  {
+    std::string output;
+    marketPacket::barBuilder_t bars(std::make_unique<marketPacket::memoryOutputSink_t>(output));
+    bars.initialize(10);
+
+    for (uint64_t timeOfDay = 0; timeOfDay < 1000; timeOfDay += 10)
+    {
+      bars.onQuote(makeQuote(timeOfDay));
+    }
+    bars.closeBars();
+
+    ASSERT_FALSE(bars.onFlush().has_value());
+    EXPECT_TRUE(output.empty());
+  }
+
+  TEST(barBuilderTest, dropsSymbolsPastCapacity)
+  {
+    std::string output;
+    marketPacket::barBuilder_t bars(std::make_unique<marketPacket::memoryOutputSink_t>(output), 1);
+    bars.initialize(10);
+
+    bars.onTrade(makeTrade("AAAAA", 1, 1));
+    bars.onTrade(makeTrade("BBBBB", 1, 1));
+    bars.closeBars();
+
+    ASSERT_FALSE(bars.onFlush().has_value());
+    EXPECT_EQ(bars.numTradesDropped(), 1);
+    EXPECT_EQ(output, "Bar: AAAAA Start: 0 Open: 1 High: 1 Low: 1 Close: 1 Volume: 1 VWAP: 1 Trades: 1\n");
+  }
+
+  TEST(barBuilderTest, uninitialized)
+  {
+    std::string output;
+    marketPacket::barBuilder_t bars(std::make_unique<marketPacket::memoryOutputSink_t>(output));
+
+    bars.onQuote(makeQuote(100));
+    bars.onTrade(makeTrade("AAAAA", 1, 1));
+    bars.closeBars();
+
+    ASSERT_FALSE(bars.onFlush().has_value());
+    EXPECT_EQ(bars.numTradesDropped(), 1);
+    EXPECT_TRUE(output.empty());
+  }
+
+  TEST(barBuilderTest, writeFailure)
+  {
+    marketPacket::barBuilder_t bars(std::make_unique<marketPacket::streamOutputSink_t>(std::ofstream{}));
+    bars.initialize(10);
+
+    bars.onTrade(makeTrade("AAAAA", 1, 1));
+    bars.closeBars();
+
+    EXPECT_EQ(bars.onFlush().value(), marketPacket::BAR_WRITE_FAILED);
+    EXPECT_EQ(bars.onPacketEnd().value(), marketPacket::BAR_WRITE_FAILED);
+  }
+
+  TEST(barBuilderTest, matchesReferenceOverCapture)
+  {
+    // Generator has to go away before we read, or the end of the capture might still be sitting in its buffer
+    {
+      marketPacket::marketPacketGenerator_t mpg(std::ofstream{INPUT_PATH});
+      mpg.initialize();
+      ASSERT_FALSE(mpg.generatePackets(NUM_PACKETS_TO_GENERATE, marketPacket::MAX_UPDATES_ALLOWED_IN_PACKET).has_value());
+    }
+
+    // Generated times are all over the place, so make the bars wide enough to hold more than one trade
+    constexpr const uint64_t barInterval = std::numeric_limits<uint64_t>::max() / 4;
+
+    std::string output;
+    marketPacket::barBuilder_t bars(std::make_unique<marketPacket::memoryOutputSink_t>(output),
+                                    NUM_PACKETS_TO_GENERATE * marketPacket::MAX_UPDATES_ALLOWED_IN_PACKET);
+    bars.initialize(barInterval);
+
+    marketPacket::basicMarketPacketProcessor_t<marketPacket::barBuilder_t> mpp(std::make_unique<marketPacket::mappedInputSource_t>(INPUT_PATH),
+                                                                               std::move(bars));
+    mpp.initialize();
+    ASSERT_EQ(mpp.processNextPacket().value(), marketPacket::END_OF_FILE);
+    mpp.handler().closeBars();
+    ASSERT_FALSE(mpp.handler().onFlush().has_value());
+
+    marketPacket::basicMarketPacketProcessor_t<referenceBars_t> reference(std::make_unique<marketPacket::mappedInputSource_t>(INPUT_PATH),
+                                                                          referenceBars_t{barInterval});
+    reference.initialize();
+    ASSERT_EQ(reference.processNextPacket().value(), marketPacket::END_OF_FILE);
+    reference.handler().closeBars();
+
+    EXPECT_FALSE(output.empty());
+    EXPECT_EQ(output, reference.handler().output);
+  }
+}
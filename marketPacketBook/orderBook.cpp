@@ -0,0 +1,135 @@
+#include "orderBook.h"
+
+#include <algorithm>
+#include <assert.h>
+#include <cstring>
+
+namespace marketPacket
+{
+    void orderBook_t::initialize()
+    {
+        // Make sure this only gets called once
+        if (m_isInitialized)
+        {
+            assert(false);
+            return;
+        }
+
+        m_symbols = symbolTable_t(m_maxSymbols);
+        m_levelPrices.resize(m_maxSymbols * BOOK_DEPTH);
+        m_levelSizes.resize(m_maxSymbols * BOOK_DEPTH);
+        m_numLevels.resize(m_maxSymbols);
+        m_lastUpdateTimes.resize(m_maxSymbols);
+
+        m_isInitialized = true;
+    }
+
+    void orderBook_t::onQuote(const quote_t &q)
+    {
+        // Until we're initialized, the table has no room, so this also covers that
+        const auto &symbolId = m_symbols.findOrInsert(packSymbol(q.symbol));
+        if (!symbolId.has_value())
+        {
+            m_numQuotesDropped++;
+            return;
+        }
+
+        applyLevel(symbolId.value(), q.priceLevel, q.priceLevelSize);
+        m_lastUpdateTimes[symbolId.value()] = q.timeOfDay;
+    }
+
+    void orderBook_t::applyLevel(symbolId_t symbolId, uint16_t price, uint64_t size)
+    {
+        uint16_t *prices = m_levelPrices.data() + symbolId * BOOK_DEPTH;
+        uint64_t *sizes = m_levelSizes.data() + symbolId * BOOK_DEPTH;
+        size_t numLevels = m_numLevels[symbolId];
+
+        // Best first, so stop at the first level that isn't better than us
+        size_t levelIdx = 0;
+        while (levelIdx < numLevels && prices[levelIdx] > price)
+        {
+            levelIdx++;
+        }
+
+        if (levelIdx < numLevels && prices[levelIdx] == price)
+        {
+            if (size != 0)
+            {
+                sizes[levelIdx] = size;
+                return;
+            }
+
+            // Level's gone, close up the gap
+            std::memmove(prices + levelIdx, prices + levelIdx + 1, (numLevels - levelIdx - 1) * sizeof(uint16_t));
+            std::memmove(sizes + levelIdx, sizes + levelIdx + 1, (numLevels - levelIdx - 1) * sizeof(uint64_t));
+            m_numLevels[symbolId]--;
+            return;
+        }
+
+        // Removing a level we don't have, or one too deep to keep track of
+        if (size == 0 || levelIdx == BOOK_DEPTH)
+        {
+            return;
+        }
+
+        // Make room, pushing the worst level off the end if we're full
+        size_t numToShift = std::min(numLevels, BOOK_DEPTH - 1) - levelIdx;
+        std::memmove(prices + levelIdx + 1, prices + levelIdx, numToShift * sizeof(uint16_t));
+        std::memmove(sizes + levelIdx + 1, sizes + levelIdx, numToShift * sizeof(uint64_t));
+
+        prices[levelIdx] = price;
+        sizes[levelIdx] = size;
+        m_numLevels[symbolId] = std::min(numLevels + 1, BOOK_DEPTH);
+    }
+
+    std::optional<symbolId_t> orderBook_t::findSymbol(std::string_view symbol) const
+    {
+        const auto &key = packSymbol(symbol);
+        if (!key.has_value())
+        {
+            return std::nullopt;
+        }
+
+        return m_symbols.find(key.value());
+    }
+
+    std::optional<bookLevel_t> orderBook_t::topOfBook(std::string_view symbol) const
+    {
+        bookLevel_t level;
+        if (depthSnapshot(symbol, &level, 1) == 0)
+        {
+            return std::nullopt;
+        }
+
+        return level;
+    }
+
+    size_t orderBook_t::depthSnapshot(std::string_view symbol, bookLevel_t *levels, size_t maxLevels) const
+    {
+        const auto &symbolId = findSymbol(symbol);
+        if (!symbolId.has_value())
+        {
+            return 0;
+        }
+
+        size_t numLevels = std::min<size_t>(m_numLevels[symbolId.value()], maxLevels);
+        for (size_t levelIdx = 0; levelIdx < numLevels; levelIdx++)
+        {
+            levels[levelIdx] = {m_levelPrices[symbolId.value() * BOOK_DEPTH + levelIdx],
+                                m_levelSizes[symbolId.value() * BOOK_DEPTH + levelIdx]};
+        }
+
+        return numLevels;
+    }
+
+    std::optional<uint64_t> orderBook_t::lastUpdateTime(std::string_view symbol) const
+    {
+        const auto &symbolId = findSymbol(symbol);
+        if (!symbolId.has_value())
+        {
+            return std::nullopt;
+        }
+
+        return m_lastUpdateTimes[symbolId.value()];
+    }
+};
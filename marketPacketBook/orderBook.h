@@ -0,0 +1,122 @@
+#pragma once
+
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#include "marketPacketHelpers/marketPacketHelpers.h"
+#include "marketPacketHelpers/symbolTable.h"
+
+namespace marketPacket
+{
+    // How many price levels we keep per symbol. Anything worse than this falls off the book
+    constexpr const size_t BOOK_DEPTH = 16;
+
+    // How many symbols a book makes room for up front, unless told otherwise
+    constexpr const size_t DEFAULT_MAX_BOOK_SYMBOLS = 64 * 1024;
+
+    /**
+     * @brief One price level on a book
+     */
+    struct bookLevel_t
+    {
+        uint16_t price; // Price of the level, in ticks
+        uint64_t size;  // Everything resting at that price
+    };
+
+    /**
+     * Keeps the best BOOK_DEPTH price levels for every symbol it's seen, built from quote_t updates.
+     *
+     * A quote says "there's now priceLevelSize resting at priceLevel" for its symbol, and a size of 0 takes the level
+     * away. Quotes don't carry a side, so each symbol gets one ladder, best (highest) price first.
+     *
+     * Every symbol's levels sit in fixed size slots of a few flat arrays, prices apart from sizes, so finding a level
+     * is a scan over a single cache line. Everything, the symbol lookup included, gets allocated in initialize().
+     * Nothing allocates after that
+     *
+     * Plugs straight into a basicMarketPacketProcessor_t as a handler
+     */
+    class orderBook_t
+    {
+    public:
+        /**
+         * @brief Construct a new orderBook_t object
+         *
+         * @param maxSymbols How many symbols to make room for. Quotes for any symbols past that get dropped
+         */
+        orderBook_t(size_t maxSymbols = DEFAULT_MAX_BOOK_SYMBOLS)
+            : m_isInitialized(false),
+              m_maxSymbols(maxSymbols),
+              m_numQuotesDropped(0),
+              m_symbols(),
+              m_levelPrices(),
+              m_levelSizes(),
+              m_numLevels(),
+              m_lastUpdateTimes(){};
+
+        /**
+         * @brief Sets up the book for use. Book won't take quotes unless this is called
+         */
+        void initialize();
+
+        /**
+         * @brief Applies a quote to its symbol's book
+         */
+        void onQuote(const quote_t &q);
+
+        /**
+         * @brief Best price level for a symbol
+         *
+         * @param symbol SYMBOL_LENGTH characters
+         * @return Nothing if we've never seen the symbol or its book is empty
+         */
+        std::optional<bookLevel_t> topOfBook(std::string_view symbol) const;
+
+        /**
+         * @brief Copies out the best levels for a symbol, best first
+         *
+         * @param symbol    SYMBOL_LENGTH characters
+         * @param levels    Where to put them
+         * @param maxLevels How many levels there's room for
+         * @return How many levels got copied
+         */
+        size_t depthSnapshot(std::string_view symbol, bookLevel_t *levels, size_t maxLevels) const;
+
+        /**
+         * @brief timeOfDay of the last quote that touched a symbol
+         */
+        std::optional<uint64_t> lastUpdateTime(std::string_view symbol) const;
+
+        /**
+         * @brief How many symbols have a book
+         */
+        size_t numSymbols() const { return m_symbols.size(); }
+
+        /**
+         * @brief How many quotes got thrown away because we were out of room for new symbols (or weren't initialized)
+         */
+        size_t numQuotesDropped() const { return m_numQuotesDropped; }
+
+    private:
+        /**
+         * @brief Symbol's slot, if it has one
+         */
+        std::optional<symbolId_t> findSymbol(std::string_view symbol) const;
+
+        /**
+         * @brief Sets, changes, or (on a size of 0) removes a price level
+         */
+        void applyLevel(symbolId_t symbolId, uint16_t price, uint64_t size);
+
+        bool m_isInitialized;      // If initialize() has been called
+        size_t m_maxSymbols;       // How many symbols we have room for
+        size_t m_numQuotesDropped; // Quotes we had to throw away
+
+        symbolTable_t m_symbols; // Symbol -> slot
+
+        std::vector<uint16_t> m_levelPrices;     // BOOK_DEPTH prices per slot, best first
+        std::vector<uint64_t> m_levelSizes;      // BOOK_DEPTH sizes per slot, lined up with m_levelPrices
+        std::vector<uint8_t> m_numLevels;        // How many levels each slot has in use
+        std::vector<uint64_t> m_lastUpdateTimes; // timeOfDay of the last quote for each slot
+    };
+};
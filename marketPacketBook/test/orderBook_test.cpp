@@ -0,0 +1,204 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include <map>
+#include <unordered_map>
+
+#include "marketPacketBook/orderBook.h"
+#include "marketPacketGenerator/marketPacketGenerator.h"
+#include "marketPacketHelpers/marketPacketHelpers.h"
+#include "marketPacketProcessor/marketPacketProcessor.h"
+
+namespace test
+{
+  // Ideally, all these go into a config file
+  const std::string INPUT_PATH = "./book_input_test.dat";
+
+  constexpr const size_t NUM_PACKETS_TO_GENERATE = 20;
+
+  marketPacket::quote_t makeQuote(const char *symbol, uint16_t price, uint64_t size, uint64_t timeOfDay = 0)
+  {
+    marketPacket::quote_t q{};
+    q.updateHeader.type = marketPacket::updateType_e::QUOTE;
+    std::memcpy(q.symbol, symbol, marketPacket::SYMBOL_LENGTH);
+    q.priceLevel = price;
+    q.priceLevelSize = size;
+    q.timeOfDay = timeOfDay;
+    return q;
+  }
+
+  /**
+   * @brief Same book, the slow, obvious way
+   */
+  struct referenceBook_t
+  {
+    std::unordered_map<std::string, std::map<uint16_t, uint64_t, std::greater<uint16_t>>> books;
+
+    void onQuote(const marketPacket::quote_t &q)
+    {
+      auto &book = books[std::string(q.symbol, marketPacket::SYMBOL_LENGTH)];
+      if (q.priceLevelSize == 0)
+      {
+        book.erase(q.priceLevel);
+        return;
+      }
+
+      book[q.priceLevel] = q.priceLevelSize;
+
+      // Only the best BOOK_DEPTH levels survive
+      while (book.size() > marketPacket::BOOK_DEPTH)
+      {
+        book.erase(std::prev(book.end()));
+      }
+    }
+  };
+
+  TEST(orderBookTest, levelsStaySorted)
+  {
+    marketPacket::orderBook_t book;
+    book.initialize();
+
+    book.onQuote(makeQuote("AAAAA", 100, 10, 1));
+    book.onQuote(makeQuote("AAAAA", 105, 20, 2));
+    book.onQuote(makeQuote("AAAAA", 95, 30, 3));
+    book.onQuote(makeQuote("AAAAA", 100, 40, 4));
+
+    marketPacket::bookLevel_t levels[marketPacket::BOOK_DEPTH];
+    ASSERT_EQ(book.depthSnapshot("AAAAA", levels, marketPacket::BOOK_DEPTH), 3);
+    EXPECT_EQ(levels[0].price, 105);
+    EXPECT_EQ(levels[0].size, 20);
+    EXPECT_EQ(levels[1].price, 100);
+    EXPECT_EQ(levels[1].size, 40);
+    EXPECT_EQ(levels[2].price, 95);
+    EXPECT_EQ(levels[2].size, 30);
+
+    EXPECT_EQ(book.lastUpdateTime("AAAAA").value(), 4);
+    EXPECT_EQ(book.numSymbols(), 1);
+  }
+
+  TEST(orderBookTest, zeroSizeRemovesLevel)
+  {
+    marketPacket::orderBook_t book;
+    book.initialize();
+
+    book.onQuote(makeQuote("AAAAA", 100, 10));
+    book.onQuote(makeQuote("AAAAA", 105, 20));
+    book.onQuote(makeQuote("AAAAA", 105, 0));
+
+    // Removing something that isn't there shouldn't do anything
+    book.onQuote(makeQuote("AAAAA", 50, 0));
+
+    const auto &top = book.topOfBook("AAAAA");
+    ASSERT_TRUE(top.has_value());
+    EXPECT_EQ(top->price, 100);
+    EXPECT_EQ(top->size, 10);
+
+    book.onQuote(makeQuote("AAAAA", 100, 0));
+    EXPECT_FALSE(book.topOfBook("AAAAA").has_value());
+  }
+
+  TEST(orderBookTest, depthIsBounded)
+  {
+    marketPacket::orderBook_t book;
+    book.initialize();
+
+    for (uint16_t price = 1; price <= marketPacket::BOOK_DEPTH * 2; price++)
+    {
+      book.onQuote(makeQuote("AAAAA", price, price));
+    }
+
+    // Too deep to keep
+    book.onQuote(makeQuote("AAAAA", 1, 1));
+
+    marketPacket::bookLevel_t levels[marketPacket::BOOK_DEPTH * 2];
+    ASSERT_EQ(book.depthSnapshot("AAAAA", levels, marketPacket::BOOK_DEPTH * 2), marketPacket::BOOK_DEPTH);
+    for (size_t i = 0; i < marketPacket::BOOK_DEPTH; i++)
+    {
+      EXPECT_EQ(levels[i].price, marketPacket::BOOK_DEPTH * 2 - i);
+    }
+
+    // Asking for less gets the best ones
+    ASSERT_EQ(book.depthSnapshot("AAAAA", levels, 2), 2);
+    EXPECT_EQ(levels[0].price, marketPacket::BOOK_DEPTH * 2);
+  }
+
+  TEST(orderBookTest, symbolsAreSeparate)
+  {
+    marketPacket::orderBook_t book;
+    book.initialize();
+
+    book.onQuote(makeQuote("AAAAA", 100, 10));
+    book.onQuote(makeQuote("BBBBB", 200, 20));
+
+    EXPECT_EQ(book.topOfBook("AAAAA")->price, 100);
+    EXPECT_EQ(book.topOfBook("BBBBB")->price, 200);
+    EXPECT_FALSE(book.topOfBook("CCCCC").has_value());
+    EXPECT_FALSE(book.topOfBook("AAAA").has_value());
+    EXPECT_EQ(book.numSymbols(), 2);
+  }
+
+  TEST(orderBookTest, dropsSymbolsPastCapacity)
+  {
+    marketPacket::orderBook_t book(1);
+    book.initialize();
+
+    book.onQuote(makeQuote("AAAAA", 100, 10));
+    book.onQuote(makeQuote("BBBBB", 200, 20));
+    book.onQuote(makeQuote("AAAAA", 101, 10));
+
+    EXPECT_EQ(book.numSymbols(), 1);
+    EXPECT_EQ(book.numQuotesDropped(), 1);
+    EXPECT_EQ(book.topOfBook("AAAAA")->price, 101);
+    EXPECT_FALSE(book.topOfBook("BBBBB").has_value());
+  }
+
+  TEST(orderBookTest, uninitialized)
+  {
+    marketPacket::orderBook_t book;
+    book.onQuote(makeQuote("AAAAA", 100, 10));
+
+    EXPECT_EQ(book.numQuotesDropped(), 1);
+    EXPECT_FALSE(book.topOfBook("AAAAA").has_value());
+  }
+
+  TEST(orderBookTest, matchesReferenceOverCapture)
+  {
+    // Generator has to go away before we read, or the end of the capture might still be sitting in its buffer
+    {
+      marketPacket::marketPacketGenerator_t mpg(std::ofstream{INPUT_PATH});
+      mpg.initialize();
+      ASSERT_FALSE(mpg.generatePackets(NUM_PACKETS_TO_GENERATE, marketPacket::MAX_UPDATES_ALLOWED_IN_PACKET).has_value());
+    }
+
+    // Generated symbols are random, so make room for every quote having its own
+    marketPacket::orderBook_t book(NUM_PACKETS_TO_GENERATE * marketPacket::MAX_UPDATES_ALLOWED_IN_PACKET);
+    book.initialize();
+
+    marketPacket::basicMarketPacketProcessor_t<marketPacket::orderBook_t> mpp(std::make_unique<marketPacket::mappedInputSource_t>(INPUT_PATH),
+                                                                              std::move(book));
+    mpp.initialize();
+    ASSERT_EQ(mpp.processNextPacket().value(), marketPacket::END_OF_FILE);
+
+    marketPacket::basicMarketPacketProcessor_t<referenceBook_t> reference(std::make_unique<marketPacket::mappedInputSource_t>(INPUT_PATH));
+    reference.initialize();
+    ASSERT_EQ(reference.processNextPacket().value(), marketPacket::END_OF_FILE);
+
+    const marketPacket::orderBook_t &result = mpp.handler();
+    const referenceBook_t &expected = reference.handler();
+    ASSERT_EQ(result.numSymbols(), expected.books.size());
+    EXPECT_EQ(result.numQuotesDropped(), 0);
+
+    for (const auto &[symbol, levels] : expected.books)
+    {
+      marketPacket::bookLevel_t snapshot[marketPacket::BOOK_DEPTH];
+      ASSERT_EQ(result.depthSnapshot(symbol, snapshot, marketPacket::BOOK_DEPTH), levels.size());
+
+      size_t levelIdx = 0;
+      for (const auto &[price, size] : levels)
+      {
+        EXPECT_EQ(snapshot[levelIdx].price, price);
+        EXPECT_EQ(snapshot[levelIdx].size, size);
+        levelIdx++;
+      }
+    }
+  }
+}
@@ -1,16 +1,55 @@
+#include <algorithm>
 #include <assert.h>
+#include <cerrno>
 #include <cmath>
+#include <condition_variable>
 #include <cstring>
 #include <fstream>
 #include <memory>
+#include <mutex>
+#include <sys/socket.h>
+#include <thread>
 #include <vector>
 
 #include "marketPacketGenerator.h"
+#include "marketPacketHelpers/latencyStamp.h"
 
 namespace marketPacket
 {
+    // How many blocks can be generated (or in progress) but not yet written, per worker. Bounds how much we hold onto
+    constexpr const size_t BLOCKS_IN_FLIGHT_PER_WORKER = 2;
 
-    void marketPacketGenerator_t::initialize()
+    namespace
+    {
+        /**
+         * @brief A block of packets a worker put together, waiting to get written out
+         */
+        struct generatedBlock_t
+        {
+            std::vector<std::byte> packets; // Whole packets, back to back
+            bool isDone = false;            // If the worker is finished with it
+        };
+
+        /**
+         * @brief Everything workers and the writer share for one parallel run
+         */
+        struct parallelRun_t
+        {
+            size_t firstPacket; // First packet of the run, counting over every run
+            size_t endPacket;   // One past the last packet of the run
+            size_t firstBlock;  // Block the first packet is in
+
+            std::vector<generatedBlock_t> blocks; // Every block the run touches, in order
+
+            std::mutex mutex;                  // Guards everything below and the isDone flags in blocks
+            std::condition_variable blockDone; // Signalled whenever a block finishes or gets written
+            size_t nextBlockToGenerate = 0;    // Next block a worker should pick up
+            size_t nextBlockToWrite = 0;       // Next block that needs writing
+            bool stopWorkers = false;          // Something went wrong, no point doing any more
+        };
+    }
+
+    void marketPacketGenerator_t::initialize(const generatorConfig_t &config)
     {
         // Make sure this only gets called once
         if (m_state != state_t::UNINITIALIZED)
@@ -20,6 +59,14 @@ namespace marketPacket
             return;
         }
 
+        m_workload = std::make_unique<const workload_t>(config.workload, config.seed.value_or(randomSeed()));
+        m_isStampingLatency = config.stampLatency;
+        m_numThreads = config.numThreads;
+        if (m_numThreads == 0)
+        {
+            m_numThreads = std::max(1u, std::thread::hardware_concurrency());
+        }
+
         m_state = state_t::WRITE_HEADER;
     };
 
@@ -27,11 +74,147 @@ namespace marketPacket
     {
         resetPerRunVariables(numPackets, numMaxUpdates);
 
+        if (m_numThreads > 1 && m_state != state_t::UNINITIALIZED)
+        {
+            generateInParallel();
+            return m_failReason;
+        }
+
         runStateMachine();
 
         return m_failReason;
     };
 
+    void marketPacketGenerator_t::generateInParallel()
+    {
+        if (m_failReason.has_value() || m_numPackets == 0)
+        {
+            return;
+        }
+
+        parallelRun_t run;
+        run.firstPacket = m_packetNum;
+        run.endPacket = m_packetNum + m_numPackets;
+        run.firstBlock = run.firstPacket / GENERATOR_BLOCK_PACKETS;
+        run.blocks = std::vector<generatedBlock_t>((run.endPacket + GENERATOR_BLOCK_PACKETS - 1) / GENERATOR_BLOCK_PACKETS - run.firstBlock);
+
+        const size_t maxBlocksInFlight = m_numThreads * BLOCKS_IN_FLIGHT_PER_WORKER;
+        auto generateBlocks = [this, &run, maxBlocksInFlight]
+        {
+            // One per worker, so walk prices it's already looked up carry over to its next block
+            workloadBlock_t block;
+            while (true)
+            {
+                size_t blockIdx;
+                {
+                    // Don't get too far ahead of the writer or we'll hold the whole run in memory
+                    std::unique_lock lock(run.mutex);
+                    run.blockDone.wait(lock, [&]
+                                       { return run.stopWorkers || run.nextBlockToGenerate < run.nextBlockToWrite + maxBlocksInFlight; });
+
+                    if (run.stopWorkers || run.nextBlockToGenerate == run.blocks.size())
+                    {
+                        return;
+                    }
+
+                    blockIdx = run.nextBlockToGenerate++;
+                }
+
+                // Always start from the top of the block so the random stream lines up, even if the run doesn't
+                size_t blockNum = run.firstBlock + blockIdx;
+                size_t packetNum = blockNum * GENERATOR_BLOCK_PACKETS;
+                size_t endPacket = std::min(packetNum + GENERATOR_BLOCK_PACKETS, run.endPacket);
+
+                m_workload->startBlock(block, blockNum);
+                std::vector<std::byte> packets;
+                for (; packetNum < endPacket; packetNum++)
+                {
+                    appendRandomPacket(*m_workload, block, packetNum, m_numMaxUpdates, packets);
+
+                    // Last run already wrote this one out
+                    if (packetNum < run.firstPacket)
+                    {
+                        packets.clear();
+                    }
+                }
+
+                {
+                    std::lock_guard lock(run.mutex);
+                    run.blocks[blockIdx].packets.swap(packets);
+                    run.blocks[blockIdx].isDone = true;
+                }
+                run.blockDone.notify_all();
+            }
+        };
+
+        std::vector<std::thread> workers;
+        for (size_t i = 0; i < std::min(m_numThreads, run.blocks.size()); i++)
+        {
+            workers.emplace_back(generateBlocks);
+        }
+
+        for (size_t blockIdx = 0; blockIdx < run.blocks.size() && !m_failReason.has_value(); blockIdx++)
+        {
+            // Workers never touch a block again once it's done, so no need to hold the lock past this
+            {
+                std::unique_lock lock(run.mutex);
+                run.blockDone.wait(lock, [&]
+                                   { return run.blocks[blockIdx].isDone; });
+            }
+            std::vector<std::byte> &packets = run.blocks[blockIdx].packets;
+
+            if (m_socketFd < 0)
+            {
+                if (m_isStampingLatency)
+                {
+                    writeLatencyStamps(packets.data(), packets.size(), latencyClockNs());
+                }
+
+                if (!m_oStream.write(reinterpret_cast<const char *>(packets.data()), packets.size()))
+                {
+                    m_failReason.emplace(UPDATE_WRITE_FAILED);
+                }
+            }
+            else
+            {
+                // Every packet still needs its own datagram
+                for (size_t offset = 0; offset < packets.size() && !m_failReason.has_value();)
+                {
+                    packetHeader_t ph;
+                    std::memcpy(&ph, packets.data() + offset, PACKET_HEADER_SIZE);
+
+                    if (m_isStampingLatency)
+                    {
+                        writeLatencyStamps(packets.data() + offset, ph.packetLength, latencyClockNs());
+                    }
+
+                    if (!sendDatagram(packets.data() + offset, ph.packetLength))
+                    {
+                        m_failReason.emplace(PACKET_SEND_FAILED);
+                    }
+                    offset += ph.packetLength;
+                }
+            }
+
+            // Don't hang on to packets we're done with
+            std::vector<std::byte>().swap(packets);
+
+            {
+                std::lock_guard lock(run.mutex);
+                run.nextBlockToWrite = blockIdx + 1;
+                run.stopWorkers = m_failReason.has_value();
+            }
+            run.blockDone.notify_all();
+        }
+
+        for (auto &worker : workers)
+        {
+            worker.join();
+        }
+
+        m_packetNum = run.endPacket;
+    }
+
     void marketPacketGenerator_t::runStateMachine()
     {
         while (!m_failReason.has_value())
@@ -60,8 +243,12 @@ namespace marketPacket
                 // Have we written the right number of updates for this packet
                 if (m_numUpdatesWritten == m_numUpdates)
                 {
+                    // Datagrams only go out once the whole packet's there
+                    sendPacket();
+
                     m_state = state_t::WRITE_HEADER;
                     m_numPacketsWritten++;
+                    m_packetNum++;
 
                     // Have we written the right number of packets
                     if (m_numPacketsWritten == m_numPackets)
@@ -92,16 +279,20 @@ namespace marketPacket
 
     void marketPacketGenerator_t::writeHeader()
     {
+        // Every block gets its own random stream
+        if (m_packetNum % GENERATOR_BLOCK_PACKETS == 0)
+        {
+            m_workload->startBlock(m_block, m_packetNum / GENERATOR_BLOCK_PACKETS);
+        }
+
         // Figure out how many updates we're going to do this packet
-        // Gives us [1, n_numMaxUpdates]
-        m_numUpdates = rand() % m_numMaxUpdates;
-        m_numUpdates++;
+        m_numUpdates = m_workload->nextNumUpdates(m_block, m_numMaxUpdates);
 
         // This is kind of an annoying write you can't easily pack into the other writes
         m_ph.numMarketUpdates = m_numUpdates;
         m_ph.packetLength = sizeof(packetHeader_t) + m_numUpdates * sizeof(trade_t);
 
-        if (!(m_oStream.write(reinterpret_cast<char *>(&m_ph), sizeof(m_ph))))
+        if (!writeOut(&m_ph, sizeof(m_ph)))
         {
             m_failReason.emplace(HEADER_WRITE_FAILED);
             return;
@@ -118,13 +309,19 @@ namespace marketPacket
             numUpdatesToGenerate = m_numUpdates - m_numUpdatesWritten;
         }
 
-        for (size_t i = 0; i < numUpdatesToGenerate; i++)
+        m_workload->fillUpdates(m_block, m_updates.data(), numUpdatesToGenerate, m_packetNum, m_numUpdatesWritten, m_numUpdates);
+
+        // As close to going out as we can get
+        if (m_isStampingLatency)
         {
-            // Pick randomly betweern a trade or quote and write it to buffer
-            (rand() % 2) ? writeRandomQuoteToBuffer(m_updates[i]) : writeRandomTradeToBuffer(m_updates[i]);
+            uint64_t now = latencyClockNs();
+            for (size_t i = 0; i < numUpdatesToGenerate; i++)
+            {
+                writeLatencyStamp(reinterpret_cast<std::byte *>(&m_updates[i]), now);
+            }
         }
 
-        if (!(m_oStream.write(reinterpret_cast<char *>(m_updates.data()), numUpdatesToGenerate * sizeof(update_t))))
+        if (!writeOut(m_updates.data(), numUpdatesToGenerate * sizeof(update_t)))
         {
             m_failReason.emplace(UPDATE_WRITE_FAILED);
             return;
@@ -153,26 +350,66 @@ namespace marketPacket
         m_numUpdatesWritten = 0;
     }
 
-    void marketPacketGenerator_t::writeRandomTradeToBuffer(update_t &buf)
+    bool marketPacketGenerator_t::writeOut(const void *data, size_t numBytes)
     {
-        trade_t *t = reinterpret_cast<trade_t *>(&buf);
+        if (m_socketFd < 0)
+        {
+            return m_oStream.write(reinterpret_cast<const char *>(data), numBytes).good();
+        }
 
-        t->updateHeader = {sizeof(trade_t), updateType_e::TRADE};
-        t->tradeSize = static_cast<uint16_t>(rand());
-        t->tradePrice = static_cast<uint64_t>(rand());
+        const std::byte *bytes = reinterpret_cast<const std::byte *>(data);
+        m_datagram.insert(m_datagram.end(), bytes, bytes + numBytes);
+        return true;
+    }
 
-        std::memcpy(t->symbol, generateRandomSymbol().c_str(), SYMBOL_LENGTH);
-    };
+    void marketPacketGenerator_t::sendPacket()
+    {
+        if (m_socketFd < 0)
+        {
+            return;
+        }
+
+        if (!sendDatagram(m_datagram.data(), m_datagram.size()))
+        {
+            m_failReason.emplace(PACKET_SEND_FAILED);
+        }
+
+        m_datagram.clear();
+    }
 
-    void marketPacketGenerator_t::writeRandomQuoteToBuffer(update_t &buf)
+    bool marketPacketGenerator_t::sendDatagram(const std::byte *data, size_t numBytes)
     {
-        quote_t *q = reinterpret_cast<quote_t *>(&buf);
+        ssize_t sent;
+        do
+        {
+            sent = ::send(m_socketFd, data, numBytes, 0);
+        } while (sent < 0 && errno == EINTR);
 
-        q->updateHeader = {sizeof(quote_t), updateType_e::QUOTE},
-        q->priceLevel = static_cast<uint16_t>(rand()),
-        q->priceLevelSize = static_cast<uint64_t>(rand()),
-        q->timeOfDay = static_cast<uint64_t>(rand());
+        return sent == static_cast<ssize_t>(numBytes);
+    }
 
-        std::memcpy(q->symbol, generateRandomSymbol().c_str(), SYMBOL_LENGTH);
-    };
+    std::optional<failReason_t> marketPacketGenerator_t::sendEndOfInput()
+    {
+        if (m_socketFd < 0 || ::send(m_socketFd, nullptr, 0, 0) != 0)
+        {
+            return PACKET_SEND_FAILED;
+        }
+
+        return std::nullopt;
+    }
+
+    void marketPacketGenerator_t::appendRandomPacket(const workload_t &workload, workloadBlock_t &block, size_t packetNum,
+                                                     uint16_t numMaxUpdates, std::vector<std::byte> &buffer)
+    {
+        // Same as writeHeader()
+        uint16_t numUpdates = workload.nextNumUpdates(block, numMaxUpdates);
+        packetHeader_t ph{static_cast<uint16_t>(sizeof(packetHeader_t) + numUpdates * sizeof(trade_t)), numUpdates};
+
+        size_t packetStart = buffer.size();
+        buffer.resize(packetStart + ph.packetLength);
+        std::memcpy(buffer.data() + packetStart, &ph, sizeof(ph));
+
+        // Same as generateUpdates(), which only splits the updates into chunks that don't change the random stream
+        workload.fillUpdates(block, reinterpret_cast<update_t *>(buffer.data() + packetStart + sizeof(ph)), numUpdates, packetNum, 0, numUpdates);
+    }
 };
@@ -3,15 +3,37 @@
 #include <array>
 #include <iostream>
 #include <fstream>
+#include <memory>
 #include <optional>
 #include <vector>
 
 #include "marketPacketHelpers/marketPacketHelpers.h"
+#include "workload.h"
 
 namespace marketPacket
 {
+    // Packets get generated in blocks this big, each from its own random stream off the seed. That's what lets
+    // threads split up the work and still come out with exactly the same bytes. Changing it changes the output
+    constexpr const size_t GENERATOR_BLOCK_PACKETS = 64;
+
+    /**
+     * @brief Knobs for how a generator behaves. Defaults give you the classic behavior
+     */
+    struct generatorConfig_t
+    {
+        std::optional<uint64_t> seed; // If set, the same seed always generates the same packets. Random otherwise
+        size_t numThreads = 1;        // How many threads generate packets. 1 does it all on the calling thread, 0 means one per core
+        workloadProfile_t workload;   // What the generated traffic looks like
+        bool stampLatency = false;    // If set, every update carries when it went out in its padding. See latencyStamp.h
+    };
+
     /**
-     * Generates packets to an output stream
+     * Generates packets to an output stream, or as datagrams on a socket, one packet per datagram
+     *
+     * With more than one thread, workers each generate whole blocks of packets into their own buffers and the
+     * calling thread writes the blocks out in order. Every block's random stream only depends on the seed and
+     * which block it is, so a seed gives the same output no matter how many threads there are or how the
+     * packets get split across generatePackets() calls
      */
     class marketPacketGenerator_t
     {
@@ -31,14 +53,47 @@ namespace marketPacket
               m_numUpdatesWritten(),
               m_ph(),
               m_updates(),
-              m_oStream(std::move(oStream)){};
+              m_workload(),
+              m_block(),
+              m_numThreads(1),
+              m_packetNum(),
+              m_isStampingLatency(false),
+              m_oStream(std::move(oStream)),
+              m_socketFd(-1),
+              m_datagram(){};
+
+        /**
+         * @brief Construct a new marketPacketGenerator object that sends every packet as its own datagram
+         *
+         * @param socketFd Connected datagram socket (UDP, Unix) to send on. Has to stay open as long as the generator's around
+         */
+        marketPacketGenerator_t(int socketFd)
+            : m_state(state_t::UNINITIALIZED),
+              m_failReason(),
+              m_numPackets(),
+              m_numPacketsWritten(),
+              m_numMaxUpdates(),
+              m_numUpdates(),
+              m_numUpdatesWritten(),
+              m_ph(),
+              m_updates(),
+              m_workload(),
+              m_block(),
+              m_numThreads(1),
+              m_packetNum(),
+              m_isStampingLatency(false),
+              m_oStream(),
+              m_socketFd(socketFd),
+              m_datagram(){};
 
         /**
          * @brief Sets up class to do work
          *
          * No work will be done until this is called
+         *
+         * @param config How the generator should behave
          */
-        void initialize();
+        void initialize(const generatorConfig_t &config = generatorConfig_t());
 
         /**
          * @brief Generate packets of a certain format.
@@ -49,6 +104,13 @@ namespace marketPacket
          */
         const std::optional<failReason_t> &generatePackets(size_t numPackets, size_t numMaxUpdates);
 
+        /**
+         * @brief When sending datagrams, sends an empty one. A datagramInputSource_t takes that as the end of the input
+         *
+         * @return If we couldn't, why
+         */
+        std::optional<failReason_t> sendEndOfInput();
+
     private:
         /**
          * @brief Possible states for a generator to be in
@@ -77,12 +139,37 @@ namespace marketPacket
         void resetPerPacketVariables();
 
         /**
-         * @brief Write directly to the buffer without having to make a temporary
+         * @brief Generates this run's packets across worker threads and writes them out in order
+         */
+        void generateInParallel();
+
+        /**
+         * @brief Writes part of a packet to the stream, or adds it to the datagram we're putting together
+         *
+         * @return False if the write failed
+         */
+        bool writeOut(const void *data, size_t numBytes);
+
+        /**
+         * @brief When sending datagrams, sends the packet we just finished as one
+         */
+        void sendPacket();
+
+        /**
+         * @brief Sends one whole packet as a datagram
+         *
+         * @return False if it didn't all go out
+         */
+        bool sendDatagram(const std::byte *data, size_t numBytes);
+
+        /**
+         * @brief Appends one whole random packet to a buffer. Makes exactly the same calls on the block as the state
+         *        machine does for a packet, so both come out the same
          *
-         * ASSUMPTION: The buffer has enough memory allocated to write tp
+         * @param packetNum Which packet this is, counting over every run
          */
-        void writeRandomTradeToBuffer(update_t &buffer);
-        void writeRandomQuoteToBuffer(update_t &buffer);
+        static void appendRandomPacket(const workload_t &workload, workloadBlock_t &block, size_t packetNum,
+                                       uint16_t numMaxUpdates, std::vector<std::byte> &buffer);
 
         state_t m_state;                          // Current state of the generator
         std::optional<failReason_t> m_failReason; // If populated, why we stopped generating
@@ -96,7 +183,14 @@ namespace marketPacket
 
         packetHeader_t m_ph;                                  // Header we write to the stream
         std::array<update_t, UPDATES_IN_WRITE_BUF> m_updates; // Where we store the updates before we write
+        std::unique_ptr<const workload_t> m_workload;         // What the traffic looks like. Shared with workers, read only
+        workloadBlock_t m_block;                              // Random stream and prices for the current block
+        size_t m_numThreads;                                  // How many threads generate packets
+        size_t m_packetNum;                                   // How many packets we've generated, over every run
+        bool m_isStampingLatency;                             // If updates get a send time written into their padding
 
-        std::ofstream m_oStream; // Output stream
+        std::ofstream m_oStream;           // Output stream
+        int m_socketFd;                    // If >= 0, where packets go as datagrams instead of the output stream
+        std::vector<std::byte> m_datagram; // Packet being put together before it goes out as a datagram
     };
 };
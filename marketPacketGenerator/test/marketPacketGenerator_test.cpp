@@ -1,6 +1,12 @@
 #include <gtest/gtest.h>
+#include <cstring>
+#include <map>
+#include <sstream>
+#include <sys/socket.h>
+#include <unistd.h>
 
 #include "marketPacketGenerator/marketPacketGenerator.h"
+#include "marketPacketHelpers/latencyStamp.h"
 #include "marketPacketProcessor/marketPacketProcessor.h"
 
 namespace test
@@ -10,6 +16,11 @@ namespace test
     const std::string OUTPUT_PATH = "./output_test.dat";
     constexpr const size_t MANY_PACKETS = 1000;
 
+    // Enough packets for a handful of generator blocks, small enough to run a bunch of times
+    constexpr const uint64_t SEED = 0xC0FFEE;
+    constexpr const size_t SEEDED_PACKETS = 500;
+    constexpr const size_t SEEDED_MAX_UPDATES = 64;
+
     marketPacket::marketPacketGenerator_t createDefaultGenerator()
     {
         return marketPacket::marketPacketGenerator_t(std::ofstream{GENERATE_PATH});
@@ -144,6 +155,309 @@ namespace test
         EXPECT_EQ(mpp.processNextPacket(1).value(), marketPacket::END_OF_FILE);
     }
 
+    TEST(marketPacketGeneratorTest, datagramPerPacket)
+    {
+        constexpr const size_t NUM_DATAGRAM_PACKETS = 8;
+        constexpr const size_t NUM_DATAGRAM_MAX_UPDATES = 16;
+
+        int fds[2];
+        ASSERT_EQ(::socketpair(AF_UNIX, SOCK_DGRAM, 0, fds), 0);
+
+        {
+            marketPacket::marketPacketGenerator_t mpg(fds[1]);
+            mpg.initialize();
+
+            EXPECT_FALSE(mpg.generatePackets(NUM_DATAGRAM_PACKETS, NUM_DATAGRAM_MAX_UPDATES).has_value());
+            EXPECT_FALSE(mpg.sendEndOfInput().has_value());
+        }
+
+        // Every datagram is exactly one whole packet
+        std::array<std::byte, 64 * 1024> datagram;
+        for (size_t i = 0; i < NUM_DATAGRAM_PACKETS; i++)
+        {
+            ssize_t datagramSize = ::recv(fds[0], datagram.data(), datagram.size(), 0);
+            ASSERT_GE(datagramSize, sizeof(marketPacket::packetHeader_t));
+
+            marketPacket::packetHeader_t ph;
+            std::memcpy(&ph, datagram.data(), sizeof(ph));
+            EXPECT_EQ(ph.packetLength, datagramSize);
+            EXPECT_LE(ph.numMarketUpdates, NUM_DATAGRAM_MAX_UPDATES);
+            EXPECT_EQ(ph.packetLength, sizeof(ph) + ph.numMarketUpdates * sizeof(marketPacket::update_t));
+        }
+
+        EXPECT_EQ(::recv(fds[0], datagram.data(), datagram.size(), 0), 0);
+
+        ::close(fds[0]);
+        ::close(fds[1]);
+
+        // Nowhere to send anything when we're writing to a stream
+        EXPECT_EQ(createDefaultGenerator().sendEndOfInput(), marketPacket::PACKET_SEND_FAILED);
+    }
+
+    /**
+     * @brief Generates packets with a config, in however many calls, and hands back exactly what got written
+     */
+    std::string generateWithConfig(const marketPacket::generatorConfig_t &config, const std::vector<size_t> &numPacketsPerCall)
+    {
+        {
+            marketPacket::marketPacketGenerator_t mpg = createDefaultGenerator();
+            mpg.initialize(config);
+
+            for (size_t numPackets : numPacketsPerCall)
+            {
+                EXPECT_FALSE(mpg.generatePackets(numPackets, SEEDED_MAX_UPDATES).has_value());
+            }
+        }
+
+        std::stringstream ss;
+        ss << std::ifstream(GENERATE_PATH).rdbuf();
+        return ss.str();
+    }
+
+    TEST(marketPacketGeneratorTest, seededIsReproducible)
+    {
+        marketPacket::generatorConfig_t config{.seed = SEED};
+        const std::string expected = generateWithConfig(config, {SEEDED_PACKETS});
+        EXPECT_FALSE(expected.empty());
+        EXPECT_EQ(generateWithConfig(config, {SEEDED_PACKETS}), expected);
+
+        // Doesn't matter how the packets get split up between calls
+        EXPECT_EQ(generateWithConfig(config, {1, 63, 100, SEEDED_PACKETS - 164}), expected);
+
+        config.seed = SEED + 1;
+        EXPECT_NE(generateWithConfig(config, {SEEDED_PACKETS}), expected);
+    }
+
+    TEST(marketPacketGeneratorTest, threadsDontChangeOutput)
+    {
+        const std::string expected = generateWithConfig({.seed = SEED, .numThreads = 1}, {SEEDED_PACKETS});
+
+        for (size_t numThreads : {2, 3, 8})
+        {
+            marketPacket::generatorConfig_t config{.seed = SEED, .numThreads = numThreads};
+            EXPECT_EQ(generateWithConfig(config, {SEEDED_PACKETS}), expected);
+            EXPECT_EQ(generateWithConfig(config, {1, 63, 100, SEEDED_PACKETS - 164}), expected);
+        }
+
+        // And the processor still makes sense of it
+        {
+            marketPacket::marketPacketGenerator_t mpg = createDefaultGenerator();
+            mpg.initialize({.numThreads = 4});
+
+            EXPECT_FALSE(mpg.generatePackets(MANY_PACKETS, marketPacket::MAX_UPDATES_ALLOWED_IN_PACKET).has_value());
+        }
+
+        marketPacket::marketPacketProcessor_t mpp = createDefaultProcessor();
+        mpp.initialize();
+
+        EXPECT_FALSE(mpp.processNextPacket(MANY_PACKETS).has_value());
+        EXPECT_EQ(mpp.processNextPacket(1).value(), marketPacket::END_OF_FILE);
+    }
+
+    /**
+     * @brief Every update in a generated capture, in order, along with which packet it came in and how big that packet was
+     */
+    struct generatedUpdate_t
+    {
+        marketPacket::update_t update;
+        size_t packetNum;
+        uint16_t numUpdatesInPacket;
+    };
+
+    std::vector<generatedUpdate_t> splitUpdates(const std::string &generated)
+    {
+        std::vector<generatedUpdate_t> updates;
+        size_t packetNum = 0;
+        for (size_t offset = 0; offset < generated.size(); packetNum++)
+        {
+            marketPacket::packetHeader_t ph;
+            std::memcpy(&ph, generated.data() + offset, sizeof(ph));
+
+            for (size_t i = 0; i < ph.numMarketUpdates; i++)
+            {
+                generatedUpdate_t u{{}, packetNum, ph.numMarketUpdates};
+                std::memcpy(&u.update, generated.data() + offset + sizeof(ph) + i * sizeof(marketPacket::update_t), sizeof(u.update));
+                updates.push_back(u);
+            }
+
+            offset += ph.packetLength;
+        }
+
+        return updates;
+    }
+
+    TEST(marketPacketGeneratorTest, workloadSymbolsAreZipf)
+    {
+        constexpr const size_t NUM_SYMBOLS = 50;
+
+        marketPacket::generatorConfig_t config{.seed = SEED, .workload = {.numSymbols = NUM_SYMBOLS, .zipfExponent = 1.0}};
+        const std::vector<generatedUpdate_t> updates = splitUpdates(generateWithConfig(config, {SEEDED_PACKETS}));
+
+        std::map<std::string, size_t> symbolCounts;
+        for (const auto &u : updates)
+        {
+            const auto *t = reinterpret_cast<const marketPacket::trade_t *>(&u.update);
+            symbolCounts[std::string(t->symbol, marketPacket::SYMBOL_LENGTH)]++;
+        }
+
+        // Nothing outside the universe, and the favourite gets about 1 / H(50) ~ 22% of everything
+        EXPECT_LE(symbolCounts.size(), NUM_SYMBOLS);
+
+        size_t mostPopular = 0;
+        for (const auto &[symbol, count] : symbolCounts)
+        {
+            mostPopular = std::max(mostPopular, count);
+        }
+        EXPECT_NEAR(static_cast<double>(mostPopular) / updates.size(), 0.22, 0.03);
+
+        // Flat popularity spreads it all out
+        config.workload.zipfExponent = 0;
+        const std::vector<generatedUpdate_t> flatUpdates = splitUpdates(generateWithConfig(config, {SEEDED_PACKETS}));
+
+        symbolCounts.clear();
+        for (const auto &u : flatUpdates)
+        {
+            const auto *t = reinterpret_cast<const marketPacket::trade_t *>(&u.update);
+            symbolCounts[std::string(t->symbol, marketPacket::SYMBOL_LENGTH)]++;
+        }
+
+        EXPECT_EQ(symbolCounts.size(), NUM_SYMBOLS);
+        for (const auto &[symbol, count] : symbolCounts)
+        {
+            EXPECT_NEAR(static_cast<double>(count) / flatUpdates.size(), 1.0 / NUM_SYMBOLS, 0.01);
+        }
+    }
+
+    TEST(marketPacketGeneratorTest, workloadTradeRatio)
+    {
+        for (double tradeRatio : {0.0, 0.25, 0.9, 1.0})
+        {
+            marketPacket::generatorConfig_t config{.seed = SEED, .workload = {.tradeRatio = tradeRatio}};
+            const std::vector<generatedUpdate_t> updates = splitUpdates(generateWithConfig(config, {SEEDED_PACKETS}));
+
+            size_t numTrades = 0;
+            for (const auto &u : updates)
+            {
+                numTrades += u.update.updateHeader.type == marketPacket::updateType_e::TRADE;
+            }
+
+            EXPECT_NEAR(static_cast<double>(numTrades) / updates.size(), tradeRatio, 0.02);
+        }
+    }
+
+    TEST(marketPacketGeneratorTest, workloadPacketSizes)
+    {
+        marketPacket::generatorConfig_t config{.seed = SEED, .workload = {.packetSizes = marketPacket::packetSizeDistribution_e::FIXED}};
+        std::vector<generatedUpdate_t> updates = splitUpdates(generateWithConfig(config, {SEEDED_PACKETS}));
+
+        EXPECT_EQ(updates.size(), SEEDED_PACKETS * SEEDED_MAX_UPDATES);
+
+        // Mostly small, but the mean's where we asked
+        config.workload = {.packetSizes = marketPacket::packetSizeDistribution_e::GEOMETRIC, .meanUpdatesPerPacket = 4.0};
+        updates = splitUpdates(generateWithConfig(config, {SEEDED_PACKETS}));
+
+        size_t numSinglePackets = 0;
+        for (const auto &u : updates)
+        {
+            numSinglePackets += u.numUpdatesInPacket == 1;
+        }
+
+        EXPECT_NEAR(static_cast<double>(updates.size()) / SEEDED_PACKETS, 4.0, 0.4);
+        EXPECT_NEAR(static_cast<double>(numSinglePackets) / SEEDED_PACKETS, 0.25, 0.05);
+    }
+
+    TEST(marketPacketGeneratorTest, workloadTimeMovesForward)
+    {
+        constexpr const uint64_t START_TIME = 34200000000000;
+        constexpr const uint64_t TIME_STEP = 1000;
+
+        marketPacket::generatorConfig_t config{.seed = SEED, .workload = {.startTimeOfDay = START_TIME, .packetTimeStep = TIME_STEP}};
+        const std::string expected = generateWithConfig(config, {SEEDED_PACKETS});
+
+        uint64_t lastTimeOfDay = START_TIME;
+        for (const auto &u : splitUpdates(expected))
+        {
+            if (u.update.updateHeader.type != marketPacket::updateType_e::QUOTE)
+            {
+                continue;
+            }
+
+            const auto *q = reinterpret_cast<const marketPacket::quote_t *>(&u.update);
+            EXPECT_GE(q->timeOfDay, lastTimeOfDay);
+            EXPECT_GE(q->timeOfDay, START_TIME + u.packetNum * TIME_STEP);
+            EXPECT_LT(q->timeOfDay, START_TIME + (u.packetNum + 1) * TIME_STEP);
+            lastTimeOfDay = q->timeOfDay;
+        }
+
+        // Threads don't get to mess with it
+        config.numThreads = 3;
+        EXPECT_EQ(generateWithConfig(config, {1, 63, 100, SEEDED_PACKETS - 164}), expected);
+    }
+
+    TEST(marketPacketGeneratorTest, workloadPricesWalk)
+    {
+        constexpr const uint16_t MAX_PRICE_STEP = 5;
+
+        // Long enough for walks to cross from one cached subtree into the next a couple of times
+        constexpr const size_t NUM_PACKETS = 3 << marketPacket::WALK_SUBTREE_LEVELS;
+
+        marketPacket::generatorConfig_t config{.seed = SEED,
+                                               .workload = {.numSymbols = 10, .tradeRatio = 0.0, .maxPriceStep = MAX_PRICE_STEP}};
+        const std::string expected = generateWithConfig(config, {NUM_PACKETS});
+
+        // Walks carry on across blocks, never moving more than a step a packet
+        std::map<std::string, std::pair<size_t, uint16_t>> lastPrices;
+        size_t numMoves = 0;
+        for (const auto &u : splitUpdates(expected))
+        {
+            const auto *q = reinterpret_cast<const marketPacket::quote_t *>(&u.update);
+
+            auto [it, isNew] = lastPrices.try_emplace(std::string(q->symbol, marketPacket::SYMBOL_LENGTH), u.packetNum, q->priceLevel);
+            if (!isNew)
+            {
+                EXPECT_LE(static_cast<size_t>(std::abs(q->priceLevel - it->second.second)), MAX_PRICE_STEP * (u.packetNum - it->second.first));
+                numMoves += q->priceLevel != it->second.second;
+            }
+
+            it->second = {u.packetNum, q->priceLevel};
+        }
+        EXPECT_GT(numMoves, 0);
+
+        config.numThreads = 3;
+        EXPECT_EQ(generateWithConfig(config, {1, 63, 100, NUM_PACKETS - 164}), expected);
+    }
+
+    TEST(marketPacketGeneratorTest, latencyStampsOnlyTouchPadding)
+    {
+        const std::string unstamped = generateWithConfig({.seed = SEED}, {SEEDED_PACKETS});
+
+        for (size_t numThreads : {1, 3})
+        {
+            std::string stamped = generateWithConfig({.seed = SEED, .numThreads = numThreads, .stampLatency = true}, {SEEDED_PACKETS});
+            ASSERT_EQ(stamped.size(), unstamped.size());
+
+            // Every update got one. Take them all back out and it's the same capture
+            uint64_t beforeTaking = marketPacket::latencyClockNs() & marketPacket::LATENCY_STAMP_MASK;
+            for (size_t offset = 0; offset < stamped.size();)
+            {
+                marketPacket::packetHeader_t ph;
+                std::memcpy(&ph, stamped.data() + offset, sizeof(ph));
+
+                for (size_t i = 0; i < ph.numMarketUpdates; i++)
+                {
+                    std::byte *update = reinterpret_cast<std::byte *>(stamped.data() + offset + sizeof(ph) + i * marketPacket::UPDATE_SIZE);
+                    EXPECT_NE(marketPacket::readLatencyStamp(update), 0);
+                    EXPECT_LT(marketPacket::latencyStampAge(marketPacket::readLatencyStamp(update), beforeTaking), 1000000000);
+                    marketPacket::writeLatencyStamp(update, 0);
+                }
+
+                offset += ph.packetLength;
+            }
+
+            EXPECT_EQ(stamped, unstamped);
+        }
+    }
+
     /**
      * This is a weird case of two classes verifying the other.
      * Past basic tests, we assume basic functionality works at scale for the processor for this test.
@@ -0,0 +1,325 @@
+#include "workload.h"
+
+#include <algorithm>
+#include <assert.h>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <string_view>
+#include <unordered_set>
+
+#include "marketPacketHelpers/symbolTable.h"
+
+namespace marketPacket
+{
+    namespace
+    {
+        // Blocks count up from 0 and never get anywhere near these, so the universe and price walks get streams all to themselves
+        constexpr const uint64_t UNIVERSE_STREAM = std::numeric_limits<uint64_t>::max();
+        constexpr const uint64_t WALK_STREAM = std::numeric_limits<uint64_t>::max() - 1;
+
+        // How many packets a price walk covers before it starts over
+        constexpr const uint64_t WALK_LENGTH = uint64_t(1) << WALK_LEVELS;
+
+        // Where reference prices land. Far enough from the ends of a uint16_t that walks have room to wander
+        constexpr const uint16_t MIN_REFERENCE_PRICE = 1000;
+        constexpr const uint16_t MAX_REFERENCE_PRICE = 60000;
+
+        /**
+         * @brief Uniformly random integer within spread of centre, pulled into [lowest, highest]
+         */
+        int64_t drawAround(uint64_t randomBits, int64_t centre, int64_t spread, int64_t lowest, int64_t highest)
+        {
+            uint64_t numChoices = 2 * spread + 1;
+            int64_t draw = centre - spread + static_cast<int64_t>((static_cast<unsigned __int128>(randomBits) * numChoices) >> 64);
+            return std::clamp(draw, lowest, highest);
+        }
+    }
+
+    workload_t::workload_t(const workloadProfile_t &profile, uint64_t seed)
+        : m_profile(profile),
+          m_seed(seed),
+          m_tradeThreshold(static_cast<uint32_t>(std::lround(std::clamp(profile.tradeRatio, 0.0, 1.0) * 256))),
+          m_isWalkingPrices(profile.maxPriceStep.has_value() && profile.numSymbols > 0),
+          m_symbols(),
+          m_referencePrices(),
+          m_walkSeeds(),
+          m_walkTotalSpread(),
+          m_walkSpreads(),
+          m_aliasThresholds(),
+          m_aliases()
+    {
+        if (m_profile.numSymbols == 0)
+        {
+            return;
+        }
+
+        randomEngine_t rng(streamSeed(m_seed, UNIVERSE_STREAM));
+        buildUniverse(rng);
+        buildAliasTable();
+
+        if (m_isWalkingPrices)
+        {
+            uint64_t walkSeed = streamSeed(m_seed, WALK_STREAM);
+            m_walkSeeds.resize(m_symbols.size());
+            for (size_t symbolIdx = 0; symbolIdx < m_symbols.size(); symbolIdx++)
+            {
+                m_walkSeeds[symbolIdx] = streamSeed(walkSeed, symbolIdx);
+            }
+
+            // Spreads are about what an unconstrained walk would give. The whole path is free at the far end,
+            // a split between halves is a Brownian bridge midpoint
+            const int64_t maxStep = m_profile.maxPriceStep.value();
+            m_walkTotalSpread = maxStep * std::sqrt(static_cast<double>(WALK_LENGTH));
+            for (size_t level = 0; level < WALK_LEVELS; level++)
+            {
+                m_walkSpreads[level] = maxStep * std::sqrt(static_cast<double>(WALK_LENGTH >> level)) / 2;
+            }
+        }
+    }
+
+    void workload_t::startBlock(workloadBlock_t &block, size_t blockNum) const
+    {
+        block.rng = randomEngine_t(streamSeed(m_seed, blockNum));
+
+        // First block this has been used for
+        if (m_isWalkingPrices && block.walkPacketNums.size() != m_symbols.size())
+        {
+            block.walkPacketNums.assign(m_symbols.size(), std::numeric_limits<size_t>::max());
+            block.walkPrices.assign(m_symbols.size(), 0);
+            block.walkTops.assign(m_symbols.size(), walkNode_t());
+        }
+    }
+
+    uint16_t workload_t::nextNumUpdates(workloadBlock_t &block, uint16_t numMaxUpdates) const
+    {
+        numMaxUpdates = std::max<uint16_t>(numMaxUpdates, 1);
+
+        switch (m_profile.packetSizes)
+        {
+        case packetSizeDistribution_e::GEOMETRIC:
+        {
+            if (m_profile.meanUpdatesPerPacket <= 1.0)
+            {
+                return 1;
+            }
+
+            // Inverse CDF. Top 53 bits make a uniform double in [0, 1)
+            double uniform = (block.rng() >> 11) * 0x1.0p-53;
+            double extraUpdates = std::floor(std::log1p(-uniform) / std::log1p(-1.0 / m_profile.meanUpdatesPerPacket));
+            return static_cast<uint16_t>(std::min(1.0 + extraUpdates, static_cast<double>(numMaxUpdates)));
+        }
+
+        case packetSizeDistribution_e::FIXED:
+        {
+            return numMaxUpdates;
+        }
+
+        default:
+        {
+            // Gives us [1, numMaxUpdates]
+            return block.rng.below(numMaxUpdates) + 1;
+        }
+        }
+    }
+
+    void workload_t::fillUpdates(workloadBlock_t &block, update_t *updates, size_t numUpdates,
+                                 size_t packetNum, size_t updateIdx, size_t numUpdatesInPacket) const
+    {
+        for (size_t i = 0; i < numUpdates; i++, updateIdx++)
+        {
+            // Top byte picks between a trade or quote, the next 16 bits go in the 16 bit field and the low 40 make a symbol
+            uint64_t randomBits = block.rng();
+            uint32_t symbolIdx = m_symbols.empty() ? 0 : pickSymbol(block.rng);
+
+            if ((randomBits >> 56) < m_tradeThreshold)
+            {
+                writeTrade(block, *reinterpret_cast<trade_t *>(&updates[i]), randomBits, symbolIdx, packetNum);
+                continue;
+            }
+
+            // Spread the packet's updates evenly over its time step, so time only ever moves forward
+            uint64_t timeOfDay = m_profile.startTimeOfDay.has_value()
+                                     ? m_profile.startTimeOfDay.value() + packetNum * m_profile.packetTimeStep +
+                                           updateIdx * m_profile.packetTimeStep / numUpdatesInPacket
+                                     : 0;
+            writeQuote(block, *reinterpret_cast<quote_t *>(&updates[i]), randomBits, symbolIdx, packetNum, timeOfDay);
+        }
+    }
+
+    void workload_t::buildUniverse(randomEngine_t &rng)
+    {
+        // There's only so many distinct symbols to go around
+        assert(m_profile.numSymbols < std::pow(SYMBOL_ALPHABET_SIZE, SYMBOL_LENGTH) / 2);
+
+        m_symbols.reserve(m_profile.numSymbols);
+        m_referencePrices.reserve(m_profile.numSymbols);
+
+        std::unordered_set<symbolKey_t> seen;
+        while (m_symbols.size() < m_profile.numSymbols)
+        {
+            std::array<char, SYMBOL_LENGTH> symbol;
+            writeRandomSymbol(symbol.data(), rng());
+
+            if (seen.insert(packSymbol(std::string_view(symbol.data(), SYMBOL_LENGTH)).value()).second)
+            {
+                m_symbols.push_back(symbol);
+                m_referencePrices.push_back(MIN_REFERENCE_PRICE + rng.below(MAX_REFERENCE_PRICE - MIN_REFERENCE_PRICE));
+            }
+        }
+    }
+
+    void workload_t::buildAliasTable()
+    {
+        const size_t numSymbols = m_symbols.size();
+
+        // Symbol i gets weight 1 / (i + 1)^s, scaled so the average weight is 1
+        std::vector<double> weights(numSymbols);
+        double totalWeight = 0;
+        for (size_t i = 0; i < numSymbols; i++)
+        {
+            weights[i] = 1.0 / std::pow(static_cast<double>(i + 1), m_profile.zipfExponent);
+            totalWeight += weights[i];
+        }
+        for (double &weight : weights)
+        {
+            weight *= numSymbols / totalWeight;
+        }
+
+        m_aliasThresholds.assign(numSymbols, uint64_t(1) << 32);
+        m_aliases.resize(numSymbols);
+        for (size_t i = 0; i < numSymbols; i++)
+        {
+            m_aliases[i] = i;
+        }
+
+        // Pair every under-weight slot up with an over-weight one that fills in the rest of it
+        std::vector<uint32_t> small, large;
+        for (size_t i = 0; i < numSymbols; i++)
+        {
+            (weights[i] < 1.0 ? small : large).push_back(i);
+        }
+
+        while (!small.empty() && !large.empty())
+        {
+            uint32_t under = small.back();
+            uint32_t over = large.back();
+            small.pop_back();
+
+            m_aliasThresholds[under] = static_cast<uint64_t>(weights[under] * 0x1.0p32);
+            m_aliases[under] = over;
+
+            weights[over] -= 1.0 - weights[under];
+            if (weights[over] < 1.0)
+            {
+                large.pop_back();
+                small.push_back(over);
+            }
+        }
+
+        // Whatever's left is (within rounding) exactly full, and keeps the default of always keeping itself
+    }
+
+    uint32_t workload_t::pickSymbol(randomEngine_t &rng) const
+    {
+        // Low half picks a slot, high half picks between the slot and its alias
+        uint64_t randomBits = rng();
+        uint32_t slot = ((randomBits & 0xFFFFFFFF) * m_symbols.size()) >> 32;
+        return (randomBits >> 32) < m_aliasThresholds[slot] ? slot : m_aliases[slot];
+    }
+
+    uint16_t workload_t::walkPrice(workloadBlock_t &block, uint32_t symbolIdx, size_t packetNum) const
+    {
+        // Popular symbols show up over and over in the same packet
+        if (block.walkPacketNums[symbolIdx] == packetNum)
+        {
+            return block.walkPrices[symbolIdx];
+        }
+
+        const uint64_t walkSeed = m_walkSeeds[symbolIdx];
+        const uint64_t targetPacket = packetNum % WALK_LENGTH;
+        constexpr const size_t topLevel = WALK_LEVELS - WALK_SUBTREE_LEVELS;
+
+        // Only go all the way from the root if the symbol's moved on to a different subtree since we last saw it
+        walkNode_t &top = block.walkTops[symbolIdx];
+        if (top.level != topLevel || targetPacket >> WALK_SUBTREE_LEVELS != top.firstPacket >> WALK_SUBTREE_LEVELS)
+        {
+            const int64_t maxStep = m_profile.maxPriceStep.value();
+            int64_t reach = maxStep * static_cast<int64_t>(WALK_LENGTH);
+
+            top = {0, 1, 0, drawAround(streamSeed(walkSeed, 0), 0, m_walkTotalSpread, -reach, reach), 0};
+            walkDown(walkSeed, top, targetPacket, topLevel);
+        }
+
+        // A price is every step before its packet
+        walkNode_t node = top;
+        walkDown(walkSeed, node, targetPacket, WALK_LEVELS);
+
+        block.walkPacketNums[symbolIdx] = packetNum;
+        block.walkPrices[symbolIdx] = static_cast<uint16_t>(std::clamp<int64_t>(m_referencePrices[symbolIdx] + node.offset, 1,
+                                                                                  std::numeric_limits<uint16_t>::max()));
+        return block.walkPrices[symbolIdx];
+    }
+
+    void workload_t::walkDown(uint64_t walkSeed, walkNode_t &node, uint64_t targetPacket, size_t endLevel) const
+    {
+        const int64_t maxStep = m_profile.maxPriceStep.value();
+
+        for (; node.level < endLevel; node.level++)
+        {
+            int64_t halfPackets = (WALK_LENGTH >> node.level) / 2;
+            int64_t reach = maxStep * halfPackets;
+
+            // Whatever the left half takes, the right half has to be able to make up the rest
+            int64_t leftSum = drawAround(streamSeed(walkSeed, node.nodeIdx), node.sum / 2, m_walkSpreads[node.level],
+                                         std::max(-reach, node.sum - reach), std::min(reach, node.sum + reach));
+
+            if (targetPacket >= node.firstPacket + halfPackets)
+            {
+                node.offset += leftSum;
+                node.sum -= leftSum;
+                node.firstPacket += halfPackets;
+                node.nodeIdx = 2 * node.nodeIdx + 1;
+            }
+            else
+            {
+                node.sum = leftSum;
+                node.nodeIdx = 2 * node.nodeIdx;
+            }
+        }
+    }
+
+    void workload_t::writeTrade(workloadBlock_t &block, trade_t &t, uint64_t randomBits, uint32_t symbolIdx, size_t packetNum) const
+    {
+        t.updateHeader = {sizeof(trade_t), updateType_e::TRADE};
+        t.tradeSize = static_cast<uint16_t>(randomBits >> (8 * SYMBOL_LENGTH));
+        t.tradePrice = m_isWalkingPrices ? walkPrice(block, symbolIdx, packetNum) : block.rng();
+
+        writeSymbol(t.symbol, randomBits, symbolIdx);
+
+        // Buffers get reused, don't leave whatever was there last time lying around
+        std::memset(t.dynamicData, 0, sizeof(t.dynamicData));
+    }
+
+    void workload_t::writeQuote(workloadBlock_t &block, quote_t &q, uint64_t randomBits, uint32_t symbolIdx, size_t packetNum, uint64_t timeOfDay) const
+    {
+        q.updateHeader = {sizeof(quote_t), updateType_e::QUOTE};
+        q.priceLevel = m_isWalkingPrices ? walkPrice(block, symbolIdx, packetNum) : static_cast<uint16_t>(randomBits >> (8 * SYMBOL_LENGTH));
+        q.priceLevelSize = block.rng();
+        q.timeOfDay = m_profile.startTimeOfDay.has_value() ? timeOfDay : block.rng();
+
+        writeSymbol(q.symbol, randomBits, symbolIdx);
+        std::memset(q.dynamicData, 0, sizeof(q.dynamicData));
+    }
+
+    void workload_t::writeSymbol(char *symbol, uint64_t randomBits, uint32_t symbolIdx) const
+    {
+        if (m_symbols.empty())
+        {
+            writeRandomSymbol(symbol, randomBits);
+            return;
+        }
+
+        std::memcpy(symbol, m_symbols[symbolIdx].data(), SYMBOL_LENGTH);
+    }
+};
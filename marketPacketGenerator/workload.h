@@ -0,0 +1,190 @@
+#pragma once
+
+#include <array>
+#include <optional>
+#include <vector>
+
+#include "marketPacketHelpers/marketPacketHelpers.h"
+#include "marketPacketHelpers/randomEngine.h"
+
+namespace marketPacket
+{
+    // Price walks are paths over 2^WALK_LEVELS packets, then start over
+    constexpr const size_t WALK_LEVELS = 32;
+
+    // Blocks hold on to where each symbol's walk is at the top of a subtree of 2^WALK_SUBTREE_LEVELS packets,
+    // so going back to the same symbol anywhere under it only walks this many levels rather than all of them
+    constexpr const size_t WALK_SUBTREE_LEVELS = 10;
+
+    /**
+     * @brief How many updates packets get
+     */
+    enum class packetSizeDistribution_e : uint8_t
+    {
+        UNIFORM = 0, // Anywhere from 1 to the max, all equally likely
+        GEOMETRIC,   // Mostly small packets with a long tail, averaging meanUpdatesPerPacket
+        FIXED        // Always the max
+    };
+
+    /**
+     * @brief What generated traffic looks like. Defaults give you the classic, everything uniformly random, behavior
+     */
+    struct workloadProfile_t
+    {
+        size_t numSymbols = 0;     // How many symbols there are. 0 means a brand new random symbol every update
+        double zipfExponent = 1.0; // How lopsided symbol popularity is. 0 is even, around 1 is what real feeds look like
+        double tradeRatio = 0.5;   // What fraction of updates are trades, to the nearest 1/256
+
+        packetSizeDistribution_e packetSizes = packetSizeDistribution_e::UNIFORM; // How many updates packets get
+        double meanUpdatesPerPacket = 8.0;                                        // Only for GEOMETRIC
+
+        std::optional<uint64_t> startTimeOfDay; // If set, quote timeOfDay starts here and never goes backwards. Random otherwise
+        uint64_t packetTimeStep = 1000;         // How far timeOfDay moves per packet. Updates in a packet are spread across it
+
+        std::optional<uint16_t> maxPriceStep; // If set (and there are symbols), prices random walk per symbol by at most this much a packet
+    };
+
+    /**
+     * @brief Somewhere on the way down a symbol's walk path tree (see workload_t)
+     */
+    struct walkNode_t
+    {
+        uint64_t firstPacket; // First packet under the node
+        uint64_t nodeIdx;     // Numbered like a heap, so the root is 1 and every node gets its own random bits
+        size_t level;         // How far down the tree. The root is 0, single packets are WALK_LEVELS
+        int64_t sum;          // Every step under the node, added up
+        int64_t offset;       // Every step before firstPacket, added up
+    };
+
+    /**
+     * @brief Random stream for one block of packets, and how far down the walk trees it's already been
+     *
+     *  The walk state is only a cache, prices come out the same either way. So a block can get reused for the next one
+     *  without throwing it out
+     */
+    struct workloadBlock_t
+    {
+        randomEngine_t rng{0};              // Everything random in the block comes from here
+        std::vector<size_t> walkPacketNums; // Per symbol, which packet walkPrices is for. SIZE_MAX if none yet
+        std::vector<uint16_t> walkPrices;   // Per symbol, where its walk is at in that packet
+        std::vector<walkNode_t> walkTops;   // Per symbol, the top of the subtree it was last looked up under
+    };
+
+    /**
+     * Turns a profile into actual updates.
+     *
+     * Everything that's fixed for a whole run (the symbol universe, how popular each symbol is, where prices start)
+     * gets worked out once up front. Everything else comes from a workloadBlock_t, which only depends on the seed and
+     * which block it is, so blocks can get generated in any order, on any thread, and come out the same.
+     *
+     * Price walks can't carry over from one block to the next for the same reason, so instead each symbol's walk is a
+     * fixed path over packet numbers that can be looked up anywhere along it. The path's total over every packet gets
+     * picked first, then split randomly between its two halves, then each half between its halves, and so on down to
+     * single packets, keeping every split within reach of maxPriceStep a packet. A price is the reference plus the sum
+     * of every step before its packet, which is one walk down that tree. The path repeats every 2^WALK_LEVELS packets.
+     * Each level's spread only depends on the level, so those get worked out up front. A block holds on to each
+     * symbol's price for the packet it's on, and to the top of the WALK_SUBTREE_LEVELS subtree that packet is under,
+     * so most lookups are either free or only the bottom few levels of the tree
+     */
+    class workload_t
+    {
+    public:
+        /**
+         * @brief Construct a new workload_t object
+         *
+         * @param profile   What the traffic should look like
+         * @param seed      What the symbol universe and every block's random stream come from
+         */
+        workload_t(const workloadProfile_t &profile, uint64_t seed);
+
+        /**
+         * @brief Sets up the random stream for a block
+         *
+         * @param block     Gets reset to the start of the block. Any walk prices it's holding on to stay good
+         * @param blockNum  Which block it is
+         */
+        void startBlock(workloadBlock_t &block, size_t blockNum) const;
+
+        /**
+         * @brief How many updates the next packet gets
+         *
+         * @param numMaxUpdates Never more than this
+         */
+        uint16_t nextNumUpdates(workloadBlock_t &block, uint16_t numMaxUpdates) const;
+
+        /**
+         * @brief Fills updates with random trades and quotes, written straight into the records
+         *
+         * @param block                 Where the randomness comes from
+         * @param updates               Where to write them
+         * @param numUpdates            How many to write
+         * @param packetNum             Which packet they're in, counting over every run
+         * @param updateIdx             Where in the packet the first one goes
+         * @param numUpdatesInPacket    How many updates the whole packet has
+         */
+        void fillUpdates(workloadBlock_t &block, update_t *updates, size_t numUpdates,
+                         size_t packetNum, size_t updateIdx, size_t numUpdatesInPacket) const;
+
+        /**
+         * @brief How many symbols are in the universe. 0 if every update gets a brand new one
+         */
+        size_t numSymbols() const { return m_symbols.size(); }
+
+        /**
+         * @brief A symbol in the universe. Lower numbers are more popular
+         */
+        const char *symbol(size_t symbolIdx) const { return m_symbols[symbolIdx].data(); }
+
+    private:
+        /**
+         * @brief Makes up numSymbols distinct symbols and a reference price for each
+         */
+        void buildUniverse(randomEngine_t &rng);
+
+        /**
+         * @brief Vose's alias method, so picking a Zipf distributed symbol is one random number and a couple of lookups
+         */
+        void buildAliasTable();
+
+        /**
+         * @brief Zipf distributed symbol from the universe
+         */
+        uint32_t pickSymbol(randomEngine_t &rng) const;
+
+        /**
+         * @brief Where a symbol's random walk is at in a packet. Only walks the tree if the block hasn't already
+         */
+        uint16_t walkPrice(workloadBlock_t &block, uint32_t symbolIdx, size_t packetNum) const;
+
+        /**
+         * @brief Walks down a symbol's tree toward a packet
+         *
+         * @param walkSeed      The symbol's walk seed
+         * @param node          Where to start, has to have targetPacket under it. Ends up at endLevel
+         * @param targetPacket  Which packet we're after, within the path
+         * @param endLevel      How far down to go
+         */
+        void walkDown(uint64_t walkSeed, walkNode_t &node, uint64_t targetPacket, size_t endLevel) const;
+
+        void writeTrade(workloadBlock_t &block, trade_t &t, uint64_t randomBits, uint32_t symbolIdx, size_t packetNum) const;
+        void writeQuote(workloadBlock_t &block, quote_t &q, uint64_t randomBits, uint32_t symbolIdx, size_t packetNum, uint64_t timeOfDay) const;
+
+        /**
+         * @brief Symbol from the universe, or a random one if there isn't a universe
+         */
+        void writeSymbol(char *symbol, uint64_t randomBits, uint32_t symbolIdx) const;
+
+        workloadProfile_t m_profile; // What the traffic should look like
+        uint64_t m_seed;             // What every block's random stream comes from
+        uint32_t m_tradeThreshold;   // Top byte of an update's random bits below this makes it a trade
+        bool m_isWalkingPrices;      // If prices random walk rather than being uniformly random
+
+        std::vector<std::array<char, SYMBOL_LENGTH>> m_symbols; // The universe, most popular first
+        std::vector<uint16_t> m_referencePrices;                // Where each symbol's walk starts
+        std::vector<uint64_t> m_walkSeeds;                      // What each symbol's walk path comes from
+        int64_t m_walkTotalSpread;                              // How far a whole walk path tends to end up from where it started
+        std::array<int64_t, WALK_LEVELS> m_walkSpreads;         // Per tree level, how far a split tends to stray from even
+        std::vector<uint64_t> m_aliasThresholds;                // Alias table. Below this (out of 2^32), keep the symbol
+        std::vector<uint32_t> m_aliases;                        // Alias table. Otherwise, take this one instead
+    };
+};
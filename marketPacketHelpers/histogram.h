@@ -0,0 +1,147 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+namespace marketPacket
+{
+    /**
+     * Counts values into log-linear buckets: every power of two gets split into 2^SUB_BUCKET_BITS evenly sized
+     * buckets, so any value lands in a bucket no wider than 1 / 2^SUB_BUCKET_BITS of itself. Covers all of uint64_t
+     * in a fixed array, so recording is a couple of shifts and an increment. No allocation, no floating point
+     *
+     * Percentiles come back as the top of whichever bucket they fall in, so they're never under the real thing
+     *
+     * @tparam SUB_BUCKET_BITS Precision. 3 is within 12.5%, 7 is within 1%
+     */
+    template <size_t SUB_BUCKET_BITS>
+    class logLinearHistogram_t
+    {
+    public:
+        static_assert(SUB_BUCKET_BITS > 0 && SUB_BUCKET_BITS < 16);
+
+        static constexpr size_t SUB_BUCKETS = size_t(1) << SUB_BUCKET_BITS;
+        static constexpr size_t NUM_BUCKETS = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+        /**
+         * @brief Construct a new, empty, logLinearHistogram_t object
+         */
+        logLinearHistogram_t()
+            : m_counts(),
+              m_count(0),
+              m_sum(0),
+              m_min(std::numeric_limits<uint64_t>::max()),
+              m_max(0){};
+
+        void record(uint64_t value)
+        {
+            m_counts[bucketIndex(value)]++;
+            m_count++;
+            m_sum += value;
+            m_min = std::min(m_min, value);
+            m_max = std::max(m_max, value);
+        }
+
+        /**
+         * @brief Adds everything another histogram has counted to this one
+         */
+        void merge(const logLinearHistogram_t &other)
+        {
+            for (size_t i = 0; i < NUM_BUCKETS; i++)
+            {
+                m_counts[i] += other.m_counts[i];
+            }
+            m_count += other.m_count;
+            m_sum += other.m_sum;
+            m_min = std::min(m_min, other.m_min);
+            m_max = std::max(m_max, other.m_max);
+        }
+
+        void reset() { *this = logLinearHistogram_t(); }
+
+        uint64_t count() const { return m_count; }
+        uint64_t sum() const { return m_sum; }
+        uint64_t min() const { return m_count ? m_min : 0; }
+        uint64_t max() const { return m_max; }
+        double mean() const { return m_count ? static_cast<double>(m_sum) / m_count : 0; }
+
+        /**
+         * @brief Smallest value (to bucket precision) that at least percent% of the values are at or under
+         *
+         * @param percent [0, 100]
+         * @return 0 if nothing's been recorded
+         */
+        uint64_t percentile(double percent) const
+        {
+            if (m_count == 0)
+            {
+                return 0;
+            }
+
+            uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(std::clamp(percent, 0.0, 100.0) / 100 * m_count)));
+
+            uint64_t seen = 0;
+            for (size_t i = 0; i < NUM_BUCKETS; i++)
+            {
+                seen += m_counts[i];
+                if (seen >= rank)
+                {
+                    return std::clamp(bucketUpperBound(i), m_min, m_max);
+                }
+            }
+
+            return m_max;
+        }
+
+        /**
+         * @brief How many values landed in a bucket
+         */
+        uint64_t bucketCount(size_t bucketIdx) const { return m_counts[bucketIdx]; }
+
+        /**
+         * @brief Which bucket a value lands in
+         */
+        static size_t bucketIndex(uint64_t value)
+        {
+            // Small enough that every value gets a bucket to itself
+            if (value < SUB_BUCKETS)
+            {
+                return value;
+            }
+
+            // Top SUB_BUCKET_BITS bits under the leading one pick the bucket within its power of two
+            size_t shift = (63 - __builtin_clzll(value)) - SUB_BUCKET_BITS;
+            return (shift + 1) * SUB_BUCKETS + ((value >> shift) & (SUB_BUCKETS - 1));
+        }
+
+        /**
+         * @brief Smallest and largest value that land in a bucket
+         */
+        static uint64_t bucketLowerBound(size_t bucketIdx)
+        {
+            if (bucketIdx < SUB_BUCKETS)
+            {
+                return bucketIdx;
+            }
+
+            size_t shift = bucketIdx / SUB_BUCKETS - 1;
+            return (SUB_BUCKETS + bucketIdx % SUB_BUCKETS) << shift;
+        }
+
+        static uint64_t bucketUpperBound(size_t bucketIdx)
+        {
+            size_t shift = bucketIdx < SUB_BUCKETS ? 0 : bucketIdx / SUB_BUCKETS - 1;
+            return bucketLowerBound(bucketIdx) + ((uint64_t(1) << shift) - 1);
+        }
+
+    private:
+        std::array<uint64_t, NUM_BUCKETS> m_counts; // How many values landed in each bucket
+        uint64_t m_count;                           // How many values there are
+        uint64_t m_sum;                             // All of them added up
+        uint64_t m_min;                             // Smallest one
+        uint64_t m_max;                             // Biggest one
+    };
+};
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <time.h>
+
+#include "marketPacketHelpers.h"
+
+namespace marketPacket
+{
+    // The last 6 bytes of every update are dynamicData in both a trade_t and a quote_t, so that's where a send time
+    // goes. Records stay 32 bytes, and nobody has to look at the type to find it
+    constexpr const size_t LATENCY_STAMP_BYTES = 6;
+    constexpr const size_t LATENCY_STAMP_OFFSET = UPDATE_SIZE - LATENCY_STAMP_BYTES;
+    constexpr const uint64_t LATENCY_STAMP_MASK = (uint64_t(1) << (8 * LATENCY_STAMP_BYTES)) - 1;
+
+    static_assert(offsetof(trade_t, dynamicData) <= LATENCY_STAMP_OFFSET);
+    static_assert(offsetof(quote_t, dynamicData) <= LATENCY_STAMP_OFFSET);
+
+    /**
+     * @brief What stamps are taken off. CLOCK_MONOTONIC nanoseconds, which every process on the box agrees on,
+     *        unlike a TSC that would need calibrating on both ends
+     */
+    inline uint64_t latencyClockNs()
+    {
+        timespec ts;
+        ::clock_gettime(CLOCK_MONOTONIC, &ts);
+        return static_cast<uint64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+    }
+
+    /**
+     * @brief Writes the low 48 bits of a time into an update's padding. Wraps every ~78 hours, which only matters
+     *        for latencies that long
+     *
+     * @param update Start of the update
+     * @param timeNs latencyClockNs() when it went out
+     */
+    inline void writeLatencyStamp(std::byte *update, uint64_t timeNs)
+    {
+        // Little endian, so the low bytes are the first bytes
+        std::memcpy(update + LATENCY_STAMP_OFFSET, &timeNs, LATENCY_STAMP_BYTES);
+    }
+
+    /**
+     * @brief Whatever's in an update's stamp. 0 if nobody stamped it, since generated padding is zeroed
+     */
+    inline uint64_t readLatencyStamp(const std::byte *update)
+    {
+        uint64_t stamp = 0;
+        std::memcpy(&stamp, update + LATENCY_STAMP_OFFSET, LATENCY_STAMP_BYTES);
+        return stamp;
+    }
+
+    /**
+     * @brief How long ago a stamp was taken, taking care of the wrap
+     */
+    inline uint64_t latencyStampAge(uint64_t stamp, uint64_t nowNs)
+    {
+        return (nowNs - stamp) & LATENCY_STAMP_MASK;
+    }
+
+    /**
+     * @brief Stamps every update in some back to back, whole packets
+     */
+    inline void writeLatencyStamps(std::byte *packets, size_t numBytes, uint64_t timeNs)
+    {
+        for (size_t offset = 0; offset < numBytes;)
+        {
+            packetHeader_t ph;
+            std::memcpy(&ph, packets + offset, PACKET_HEADER_SIZE);
+
+            for (size_t i = 0; i < ph.numMarketUpdates; i++)
+            {
+                writeLatencyStamp(packets + offset + PACKET_HEADER_SIZE + i * UPDATE_SIZE, timeNs);
+            }
+
+            offset += ph.packetLength;
+        }
+    }
+};
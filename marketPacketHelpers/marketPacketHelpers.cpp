@@ -1,52 +1,102 @@
 #include "marketPacketHelpers.h"
 
+#include <bit>
+#include <cstring>
+
+#include "randomEngine.h"
+
 namespace marketPacket
 {
     size_t rand()
     {
-        static std::random_device rd;
-        static std::mt19937 gen(rd());
-        static std::uniform_int_distribution<size_t> dist(0, std::numeric_limits<size_t>::max());
+        // Every thread gets its own engine, so nobody has to share (or lock) one
+        static thread_local randomEngine_t rng(randomSeed());
 
-        return dist(gen);
+        return rng();
     }
 
     std::string generateRandomSymbol()
     {
-        static constexpr const std::string_view alphanum = "0123456789"
-                                                           "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
-                                                           "abcdefghijklmnopqrstuvwxyz";
-
-        std::string tmp_s;
-        tmp_s.reserve(SYMBOL_LENGTH);
-
-        for (int i = 0; i < SYMBOL_LENGTH; i++)
-        {
-            tmp_s += alphanum[rand() % (sizeof(alphanum) - 1)];
-        }
+        std::string symbol(SYMBOL_LENGTH, '\0');
+        writeRandomSymbol(symbol.data(), rand());
 
-        return tmp_s;
+        return symbol;
     }
 
     std::string generateTradeString(const trade_t *t)
     {
         assert(t != nullptr);
-        std::string tradeStr;
-
-        // We *could* make this a compile time computation... but c'mon
-        // sizeof("Trade: ") + SYMBOL_LENGTH +
-        // sizeof(" Size: ") + numDigits(decltype(t->tradeSize)::max())) + 
-        // sizeof(" Price: ") + numDigits(decltype(t->tradePrice)::max())) = 47
-        // Just call it 64
-        tradeStr.reserve(64);
-
-        tradeStr.append("Trade: ");
-        tradeStr.append(t->symbol, SYMBOL_LENGTH); // This one is finicky since the symbol isn't guaranteed to be null-terminated
-        tradeStr.append(" Size: ");
-        tradeStr.append(std::to_string(t->tradeSize));
-        tradeStr.append(" Price: ");
-        tradeStr.append(std::to_string(t->tradePrice));
-        
-        return tradeStr;
+
+        char tradeStr[MAX_TRADE_STRING_LENGTH];
+        const char *end = formatTrade(tradeStr, t);
+
+        return std::string(tradeStr, end - tradeStr);
+    }
+
+    char *formatTrade(char *dst, const trade_t *t)
+    {
+        static constexpr const std::string_view TRADE_PREFIX = "Trade: ";
+        static constexpr const std::string_view SIZE_PREFIX = " Size: ";
+        static constexpr const std::string_view PRICE_PREFIX = " Price: ";
+
+        std::memcpy(dst, TRADE_PREFIX.data(), TRADE_PREFIX.size());
+        dst += TRADE_PREFIX.size();
+
+        // This one is finicky since the symbol isn't guaranteed to be null-terminated
+        std::memcpy(dst, t->symbol, SYMBOL_LENGTH);
+        dst += SYMBOL_LENGTH;
+
+        std::memcpy(dst, SIZE_PREFIX.data(), SIZE_PREFIX.size());
+        dst = formatDecimal(dst + SIZE_PREFIX.size(), t->tradeSize);
+
+        std::memcpy(dst, PRICE_PREFIX.data(), PRICE_PREFIX.size());
+        return formatDecimal(dst + PRICE_PREFIX.size(), t->tradePrice);
+    }
+
+    char *formatDecimal(char *dst, uint64_t value)
+    {
+        // Every two digit pair, so we do half as many divisions as the naive way
+        static constexpr const char DIGIT_PAIRS[] = "00010203040506070809"
+                                                    "10111213141516171819"
+                                                    "20212223242526272829"
+                                                    "30313233343536373839"
+                                                    "40414243444546474849"
+                                                    "50515253545556575859"
+                                                    "60616263646566676869"
+                                                    "70717273747576777879"
+                                                    "80818283848586878889"
+                                                    "90919293949596979899";
+
+        static constexpr const uint64_t POWERS_OF_10[] = {1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull,
+                                                          10000000ull, 100000000ull, 1000000000ull, 10000000000ull,
+                                                          100000000000ull, 1000000000000ull, 10000000000000ull,
+                                                          100000000000000ull, 1000000000000000ull, 10000000000000000ull,
+                                                          100000000000000000ull, 1000000000000000000ull, 10000000000000000000ull};
+
+        // log10(x) ~= log2(x) * 1233 / 4096, then fix up the off by one. '| 1' keeps us away from log(0)
+        uint32_t log10Guess = (std::bit_width(value | 1) * 1233) >> 12;
+        uint32_t numDigits = log10Guess + 1 - ((value | 1) < POWERS_OF_10[log10Guess]);
+
+        // Fill it in backwards since we know exactly where it ends
+        char *end = dst + numDigits;
+        char *curr = end;
+        while (value >= 100)
+        {
+            curr -= 2;
+            std::memcpy(curr, DIGIT_PAIRS + (value % 100) * 2, 2);
+            value /= 100;
+        }
+
+        if (value >= 10)
+        {
+            curr -= 2;
+            std::memcpy(curr, DIGIT_PAIRS + value * 2, 2);
+        }
+        else
+        {
+            *--curr = static_cast<char>('0' + value);
+        }
+
+        return end;
     }
 }
@@ -58,6 +58,10 @@ namespace marketPacket
 
     constexpr const size_t READ_BUFFER_SIZE = 16384;
     constexpr const size_t WRITE_BUFFER_SIZE = 16384;
+    constexpr const size_t OUTPUT_BUFFER_SIZE = 1024 * 1024;
+
+    // "Trade: " + SYMBOL_LENGTH + " Size: " + 5 digits + " Price: " + 20 digits + '\n' = 54. Round it up
+    constexpr const size_t MAX_TRADE_STRING_LENGTH = 64;
 
     constexpr const size_t UPDATE_SIZE = sizeof(update_t);
     constexpr const size_t PACKET_HEADER_SIZE = sizeof(packetHeader_t);
@@ -98,4 +102,27 @@ namespace marketPacket
      * @return std::string How we want the trade should look to a human
      */
     std::string generateTradeString(const trade_t *t);
+
+    /**
+     * @brief Same thing as generateTradeString(), but written straight into a caller's buffer. No allocations
+     *
+     *  NOTE: This function does NOT error check the ptr. Assumes a correctly formed trade is behind that ptr
+     *  ASSUMPTION: dst has at least MAX_TRADE_STRING_LENGTH bytes available
+     *
+     * @param dst Where to write the string to
+     * @param t trade ptr
+     * @return One past the last character written
+     */
+    char *formatTrade(char *dst, const trade_t *t);
+
+    /**
+     * @brief Writes out the base 10 representation of a number, no allocations
+     *
+     *  ASSUMPTION: dst has at least 20 bytes available
+     *
+     * @param dst Where to write the digits to
+     * @param value What to write
+     * @return One past the last digit written
+     */
+    char *formatDecimal(char *dst, uint64_t value);
 }
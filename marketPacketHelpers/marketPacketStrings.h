@@ -14,6 +14,7 @@ namespace marketPacket
     static constexpr failReason_t HEADER_WRITE_FAILED{"writeHeader() failed"};
     static constexpr failReason_t UPDATE_WRITE_FAILED{"Update write failed"};
     static constexpr failReason_t TOO_MANY_UPDATES{"Can't request that many updates in a packet"};
+    static constexpr failReason_t PACKET_SEND_FAILED{"Packet send failed"};
 
     // Processor specific failures
     static constexpr failReason_t INPUT_STREAM_CLOSED{"Input stream isn't open"};
@@ -26,4 +27,29 @@ namespace marketPacket
 
     static constexpr failReason_t UPDATE_POORLY_FORMED{"Poorly formed update"};
     static constexpr failReason_t TRADE_WRITE_FAILED{"Failure in writing trade to stream"};
+
+    // Packet index specific failures
+    static constexpr failReason_t INDEX_READ_FAILED{"Couldn't read packet index"};
+    static constexpr failReason_t INDEX_WRITE_FAILED{"Couldn't write packet index"};
+    static constexpr failReason_t INDEX_DOESNT_MATCH{"Packet index wasn't built from this capture"};
+    static constexpr failReason_t PACKET_NOT_INDEXED{"Packet isn't in the index"};
+    static constexpr failReason_t SEEK_FAILED{"Input source couldn't seek"};
+
+    // Checkpoint specific failures
+    static constexpr failReason_t CHECKPOINT_READ_FAILED{"Couldn't read checkpoint"};
+    static constexpr failReason_t CHECKPOINT_WRITE_FAILED{"Couldn't write checkpoint"};
+    static constexpr failReason_t OUTPUT_RESUME_FAILED{"Output sink couldn't pick up from checkpoint"};
+
+    // Multi stream specific failures
+    static constexpr failReason_t EPOLL_FAILED{"epoll failed"};
+
+    // Replay specific failures
+    static constexpr failReason_t REPLAY_WRITE_FAILED{"Failure in writing packet to replay output"};
+
+    // Bar specific failures
+    static constexpr failReason_t BAR_WRITE_FAILED{"Failure in writing bar to stream"};
+
+    // Archive specific failures
+    static constexpr failReason_t ARCHIVE_WRITE_FAILED{"Failure in writing archive block to stream"};
+    static constexpr failReason_t ARCHIVE_POORLY_FORMED{"Archive is cut off or isn't an archive"};
 }
\ No newline at end of file
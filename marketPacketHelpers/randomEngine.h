@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <random>
+
+#include "marketPacketHelpers.h"
+
+namespace marketPacket
+{
+    // What random symbols are made of
+    constexpr const char SYMBOL_ALPHABET[] = "0123456789"
+                                             "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+                                             "abcdefghijklmnopqrstuvwxyz";
+    constexpr const size_t SYMBOL_ALPHABET_SIZE = sizeof(SYMBOL_ALPHABET) - 1;
+
+    /**
+     * wyrand. One add and one 64x64->128 bit multiply per number, and 8 bytes of state, so it lives in a register.
+     * Plenty random for generating test data, and several times faster than a std::mt19937.
+     *
+     * Works as a standard UniformRandomBitGenerator, so std distributions take it too. The same seed always
+     * gives the same numbers
+     */
+    class randomEngine_t
+    {
+    public:
+        using result_type = uint64_t;
+
+        /**
+         * @brief Construct a new randomEngine_t object
+         *
+         * @param seed Where the sequence starts. Any value's fine
+         */
+        explicit randomEngine_t(uint64_t seed)
+            : m_state(seed){};
+
+        static constexpr result_type min() { return 0; }
+        static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+        /**
+         * @brief Next 64 random bits
+         */
+        result_type operator()()
+        {
+            m_state += 0xa0761d6478bd642full;
+            unsigned __int128 product = static_cast<unsigned __int128>(m_state) * (m_state ^ 0xe7037ed1a0b428dbull);
+            return static_cast<uint64_t>(product) ^ static_cast<uint64_t>(product >> 64);
+        }
+
+        /**
+         * @brief Random number in [0, bound). No division, a multiply and a shift.
+         *        Off from perfectly even by at most bound / 2^64, which is nothing for anything we use it for
+         */
+        uint64_t below(uint64_t bound)
+        {
+            return static_cast<uint64_t>((static_cast<unsigned __int128>((*this)()) * bound) >> 64);
+        }
+
+    private:
+        uint64_t m_state; // Everything there is to the engine
+    };
+
+    /**
+     * @brief A seed nobody can guess, for when the output doesn't need to be reproducible
+     */
+    inline uint64_t randomSeed()
+    {
+        std::random_device rd;
+        return (static_cast<uint64_t>(rd()) << 32) ^ rd();
+    }
+
+    /**
+     * @brief Seed for one of many independent streams off a single seed. splitmix64 of the two,
+     *        so neighbouring streams (or seeds) don't start anywhere near each other
+     *
+     * @param seed      What everything comes from
+     * @param stream    Which stream
+     */
+    inline uint64_t streamSeed(uint64_t seed, uint64_t stream)
+    {
+        uint64_t z = seed + (stream + 1) * 0x9E3779B97F4A7C15ull;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    /**
+     * @brief Writes SYMBOL_LENGTH random characters straight into a symbol. No string in between
+     *
+     * @param symbol        Where to write them. Doesn't get null terminated
+     * @param randomBits    Only the low 8 * SYMBOL_LENGTH bits get used, so the rest are free for something else
+     */
+    inline void writeRandomSymbol(char *symbol, uint64_t randomBits)
+    {
+        // Each byte scaled onto the alphabet, multiply and shift instead of a modulo
+        for (size_t i = 0; i < SYMBOL_LENGTH; i++)
+        {
+            symbol[i] = SYMBOL_ALPHABET[((randomBits & 0xFF) * SYMBOL_ALPHABET_SIZE) >> 8];
+            randomBits >>= 8;
+        }
+    }
+};
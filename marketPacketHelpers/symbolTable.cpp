@@ -0,0 +1,144 @@
+#include "symbolTable.h"
+
+#include <algorithm>
+#include <bit>
+
+namespace marketPacket
+{
+    namespace
+    {
+        // How many displacements a bucket gets to try before we give up on the whole layout
+        constexpr const uint32_t MAX_DISPLACEMENT = 1 << 20;
+
+        /**
+         * @brief splitmix64's finalizer. Every bit of the input ends up affecting every bit of the output
+         */
+        uint64_t mix(uint64_t x)
+        {
+            x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+            x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+            return x ^ (x >> 31);
+        }
+    }
+
+    symbolTable_t::symbolTable_t(size_t maxSymbols)
+        : m_maxSymbols(maxSymbols),
+          m_slotMask(),
+          m_slotShift(),
+          m_slots(),
+          m_keys()
+    {
+        // At least half the slots are always empty, so probes stay short and always end
+        size_t numSlots = std::max<size_t>(std::bit_ceil(maxSymbols * 2), 2);
+
+        m_slotMask = numSlots - 1;
+        m_slotShift = 64 - std::countr_zero(numSlots);
+        m_slots.resize(numSlots, {EMPTY_SYMBOL_KEY, 0});
+        m_keys.reserve(maxSymbols);
+    }
+
+    size_t perfectSymbolTable_t::bucketFor(symbolKey_t key) const
+    {
+        return mix(key) >> m_bucketShift;
+    }
+
+    size_t perfectSymbolTable_t::slotFor(symbolKey_t key, uint32_t displacement) const
+    {
+        return mix(key ^ (displacement * 0x9E3779B97F4A7C15ull)) & m_slotMask;
+    }
+
+    bool perfectSymbolTable_t::build(const std::vector<symbolKey_t> &keys)
+    {
+        m_numSymbols = 0;
+        m_displacements.clear();
+        m_slots.clear();
+
+        if (keys.empty())
+        {
+            return true;
+        }
+
+        // Duplicates can never be placed
+        std::vector<symbolKey_t> sortedKeys(keys);
+        std::sort(sortedKeys.begin(), sortedKeys.end());
+        if (std::adjacent_find(sortedKeys.begin(), sortedKeys.end()) != sortedKeys.end())
+        {
+            return false;
+        }
+
+        // ~2 keys per bucket, ~80% full table. Small buckets, and there's always room left for the last ones
+        size_t numBuckets = std::max<size_t>(std::bit_ceil(keys.size() / 2), 2);
+        size_t numSlots = std::max<size_t>(std::bit_ceil(keys.size() + keys.size() / 4), 2);
+
+        m_bucketShift = 64 - std::countr_zero(numBuckets);
+        m_slotMask = numSlots - 1;
+
+        std::vector<std::vector<symbolId_t>> buckets(numBuckets);
+        for (symbolId_t id = 0; id < keys.size(); id++)
+        {
+            buckets[bucketFor(keys[id])].push_back(id);
+        }
+
+        // Biggest buckets are the hardest to place, so they go while the table is still empty
+        std::vector<size_t> bucketOrder(numBuckets);
+        for (size_t bucketIdx = 0; bucketIdx < numBuckets; bucketIdx++)
+        {
+            bucketOrder[bucketIdx] = bucketIdx;
+        }
+        std::stable_sort(bucketOrder.begin(), bucketOrder.end(), [&](size_t a, size_t b)
+                         { return buckets[a].size() > buckets[b].size(); });
+
+        std::vector<uint32_t> displacements(numBuckets, 0);
+        std::vector<bool> isSlotTaken(numSlots, false);
+        std::vector<size_t> bucketSlots;
+
+        for (size_t bucketIdx : bucketOrder)
+        {
+            const std::vector<symbolId_t> &bucket = buckets[bucketIdx];
+            if (bucket.empty())
+            {
+                break;
+            }
+
+            bool isPlaced = false;
+            for (uint32_t displacement = 0; displacement < MAX_DISPLACEMENT && !isPlaced; displacement++)
+            {
+                bucketSlots.clear();
+                for (symbolId_t id : bucket)
+                {
+                    size_t slotIdx = slotFor(keys[id], displacement);
+                    if (isSlotTaken[slotIdx] || std::find(bucketSlots.begin(), bucketSlots.end(), slotIdx) != bucketSlots.end())
+                    {
+                        break;
+                    }
+                    bucketSlots.push_back(slotIdx);
+                }
+
+                if (bucketSlots.size() == bucket.size())
+                {
+                    for (size_t slotIdx : bucketSlots)
+                    {
+                        isSlotTaken[slotIdx] = true;
+                    }
+                    displacements[bucketIdx] = displacement;
+                    isPlaced = true;
+                }
+            }
+
+            if (!isPlaced)
+            {
+                return false;
+            }
+        }
+
+        m_displacements.swap(displacements);
+        m_slots.resize(numSlots, {EMPTY_SYMBOL_KEY, 0});
+        for (symbolId_t id = 0; id < keys.size(); id++)
+        {
+            m_slots[slotFor(keys[id], m_displacements[bucketFor(keys[id])])] = {keys[id], id};
+        }
+        m_numSymbols = keys.size();
+
+        return true;
+    }
+};
@@ -0,0 +1,244 @@
+#pragma once
+
+#include <cstring>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#include "marketPacketHelpers.h"
+
+namespace marketPacket
+{
+    using symbolKey_t = uint64_t; // A symbol's bytes packed into the low SYMBOL_LENGTH bytes of an integer
+    using symbolId_t = uint32_t;  // Dense ID handed out per symbol. 0, 1, 2, ... in the order they were first seen
+
+    // Only the low SYMBOL_LENGTH bytes of a key mean anything
+    constexpr const symbolKey_t SYMBOL_KEY_MASK = (symbolKey_t(1) << (SYMBOL_LENGTH * 8)) - 1;
+
+    // Can't come out of packSymbol(), so it marks an empty slot
+    constexpr const symbolKey_t EMPTY_SYMBOL_KEY = ~symbolKey_t(0);
+
+    static_assert(SYMBOL_LENGTH < sizeof(symbolKey_t));
+
+    /**
+     * @brief Packs a symbol sitting inside an update into a key. One unaligned load and a mask
+     *
+     *  ASSUMPTION: There are at least sizeof(symbolKey_t) readable bytes at symbol. Always true for the symbol
+     *              field of a quote_t or trade_t since there's more of the update after it
+     *
+     * @param symbol Start of the SYMBOL_LENGTH characters
+     * @return Key for the symbol
+     */
+    inline symbolKey_t packSymbol(const char *symbol)
+    {
+        symbolKey_t key;
+        std::memcpy(&key, symbol, sizeof(key));
+        return key & SYMBOL_KEY_MASK;
+    }
+
+    /**
+     * @brief Packs a symbol that isn't inside an update, so we can't read past the end of it
+     *
+     * @param symbol SYMBOL_LENGTH characters
+     * @return Key for the symbol, nothing if it's the wrong length
+     */
+    inline std::optional<symbolKey_t> packSymbol(std::string_view symbol)
+    {
+        if (symbol.size() != SYMBOL_LENGTH)
+        {
+            return std::nullopt;
+        }
+
+        symbolKey_t key = 0;
+        std::memcpy(&key, symbol.data(), SYMBOL_LENGTH);
+        return key;
+    }
+
+    /**
+     * @brief Undoes packSymbol()
+     *
+     *  ASSUMPTION: dst has at least SYMBOL_LENGTH bytes available
+     *
+     * @param dst Where to write the SYMBOL_LENGTH characters. Not null terminated
+     * @param key Key to unpack
+     */
+    inline void unpackSymbol(char *dst, symbolKey_t key)
+    {
+        std::memcpy(dst, &key, SYMBOL_LENGTH);
+    }
+
+    /**
+     * Hands out dense IDs for symbols as they show up, so per symbol state can live in flat arrays indexed by ID.
+     *
+     * Flat open addressing table with linear probing, sized up front to a power of two at least twice the number
+     * of symbols it can hold. Never grows, never allocates after construction, never deletes
+     */
+    class symbolTable_t
+    {
+    public:
+        /**
+         * @brief Construct a new symbolTable_t object
+         *
+         * @param maxSymbols How many symbols it can hold. Default constructed tables can't hold any
+         */
+        symbolTable_t(size_t maxSymbols = 0);
+
+        /**
+         * @brief Looks a symbol up
+         *
+         * @return Its ID, nothing if it's never been inserted
+         */
+        std::optional<symbolId_t> find(symbolKey_t key) const
+        {
+            for (size_t slotIdx = slotFor(key);; slotIdx = (slotIdx + 1) & m_slotMask)
+            {
+                const slot_t &slot = m_slots[slotIdx];
+                if (slot.key == key)
+                {
+                    return slot.id;
+                }
+
+                if (slot.key == EMPTY_SYMBOL_KEY)
+                {
+                    return std::nullopt;
+                }
+            }
+        }
+
+        /**
+         * @brief Looks a symbol up, giving it the next ID if it's new
+         *
+         * @return Its ID, nothing if it's new and the table's already full
+         */
+        std::optional<symbolId_t> findOrInsert(symbolKey_t key)
+        {
+            for (size_t slotIdx = slotFor(key);; slotIdx = (slotIdx + 1) & m_slotMask)
+            {
+                slot_t &slot = m_slots[slotIdx];
+                if (slot.key == key)
+                {
+                    return slot.id;
+                }
+
+                if (slot.key == EMPTY_SYMBOL_KEY)
+                {
+                    if (m_keys.size() == m_maxSymbols)
+                    {
+                        return std::nullopt;
+                    }
+
+                    slot.key = key;
+                    slot.id = m_keys.size();
+                    m_keys.push_back(key);
+                    return slot.id;
+                }
+            }
+        }
+
+        /**
+         * @brief Key for an ID we handed out
+         */
+        symbolKey_t key(symbolId_t id) const { return m_keys[id]; }
+
+        /**
+         * @brief How many symbols have an ID
+         */
+        size_t size() const { return m_keys.size(); }
+
+        /**
+         * @brief How many symbols there's room for
+         */
+        size_t maxSymbols() const { return m_maxSymbols; }
+
+    private:
+        struct slot_t
+        {
+            symbolKey_t key; // EMPTY_SYMBOL_KEY if nobody's here
+            symbolId_t id;   // ID handed out for key
+        };
+
+        /**
+         * @brief Where a key's probe starts. Fibonacci hashing, high bits of a multiply
+         */
+        size_t slotFor(symbolKey_t key) const
+        {
+            return (key * 0x9E3779B97F4A7C15ull) >> m_slotShift;
+        }
+
+        size_t m_maxSymbols;             // How many symbols we have room for
+        size_t m_slotMask;               // Number of slots - 1
+        size_t m_slotShift;              // 64 - log2(number of slots)
+        std::vector<slot_t> m_slots;     // The table itself
+        std::vector<symbolKey_t> m_keys; // ID -> key
+    };
+
+    /**
+     * Maps a fixed set of symbols known up front to their index in that set, with no probing on lookup.
+     *
+     * Built with hash and displace: keys are split into small buckets, then each bucket, biggest first, searches
+     * for a displacement that drops all its keys into free slots. A lookup is two hashes and one compare
+     */
+    class perfectSymbolTable_t
+    {
+    public:
+        /**
+         * @brief Construct a new perfectSymbolTable_t object. Doesn't know any symbols until build() is called
+         */
+        perfectSymbolTable_t()
+            : m_numSymbols(),
+              m_bucketShift(),
+              m_slotMask(),
+              m_displacements(),
+              m_slots(){};
+
+        /**
+         * @brief Builds the table from the whole universe of symbols
+         *
+         * @param keys Every symbol we'll ever want an ID for. A symbol's ID is its index in here
+         * @return False if there are duplicates or we couldn't find a layout. Table is left empty if so
+         */
+        bool build(const std::vector<symbolKey_t> &keys);
+
+        /**
+         * @brief Looks a symbol up
+         *
+         * @return Its ID, nothing if it wasn't in the universe
+         */
+        std::optional<symbolId_t> find(symbolKey_t key) const
+        {
+            if (m_slots.empty())
+            {
+                return std::nullopt;
+            }
+
+            const slot_t &slot = m_slots[slotFor(key, m_displacements[bucketFor(key)])];
+            if (slot.key != key)
+            {
+                return std::nullopt;
+            }
+
+            return slot.id;
+        }
+
+        /**
+         * @brief How many symbols are in the table
+         */
+        size_t size() const { return m_numSymbols; }
+
+    private:
+        struct slot_t
+        {
+            symbolKey_t key; // EMPTY_SYMBOL_KEY if nobody's here
+            symbolId_t id;   // Index of key in what we were built from
+        };
+
+        size_t bucketFor(symbolKey_t key) const;
+        size_t slotFor(symbolKey_t key, uint32_t displacement) const;
+
+        size_t m_numSymbols;                   // How many symbols we were built from
+        size_t m_bucketShift;                  // 64 - log2(number of buckets)
+        size_t m_slotMask;                     // Number of slots - 1
+        std::vector<uint32_t> m_displacements; // Per bucket seed that keeps its keys from colliding
+        std::vector<slot_t> m_slots;           // The table itself
+    };
+};
@@ -1,7 +1,14 @@
 #include <gtest/gtest.h>
+#include <chrono>
 #include <memory>
+#include <set>
+#include <thread>
+#include <vector>
 
+#include "marketPacketHelpers/histogram.h"
 #include "marketPacketHelpers/marketPacketHelpers.h"
+#include "marketPacketHelpers/randomEngine.h"
+#include "marketPacketHelpers/tscClock.h"
 
 namespace test
 {
@@ -19,4 +26,173 @@ namespace test
 
         EXPECT_EQ(expectedString, marketPacket::generateTradeString(&trade));
     }
+
+    TEST(marketPacketHelpersTest, decimalFormat)
+    {
+        std::vector<uint64_t> values{0, std::numeric_limits<uint64_t>::max(), std::numeric_limits<uint64_t>::max() - 1};
+
+        // Digit count boundaries are where a fast formatter is most likely to trip up
+        for (uint64_t powerOf10 = 1; powerOf10 <= std::numeric_limits<uint64_t>::max() / 10; powerOf10 *= 10)
+        {
+            values.insert(values.end(), {powerOf10 - 1, powerOf10, powerOf10 + 1, powerOf10 * 10 - 1});
+        }
+
+        for (size_t i = 0; i < 10000; i++)
+        {
+            values.push_back(marketPacket::rand() >> (marketPacket::rand() % 64));
+        }
+
+        char buffer[32];
+        for (uint64_t value : values)
+        {
+            char *end = marketPacket::formatDecimal(buffer, value);
+            EXPECT_EQ(std::string(buffer, end - buffer), std::to_string(value));
+        }
+    }
+
+    TEST(marketPacketHelpersTest, tradeStringMatchesToString)
+    {
+        for (size_t i = 0; i < 10000; i++)
+        {
+            marketPacket::trade_t trade{
+                .tradeSize = static_cast<uint16_t>(marketPacket::rand()),
+                .tradePrice = static_cast<uint64_t>(marketPacket::rand())};
+            memcpy(trade.symbol, marketPacket::generateRandomSymbol().c_str(), marketPacket::SYMBOL_LENGTH);
+
+            // How this string was put together before there was a fast path
+            std::string expectedString("Trade: ");
+            expectedString.append(trade.symbol, marketPacket::SYMBOL_LENGTH);
+            expectedString.append(" Size: " + std::to_string(trade.tradeSize));
+            expectedString.append(" Price: " + std::to_string(trade.tradePrice));
+
+            char buffer[marketPacket::MAX_TRADE_STRING_LENGTH];
+            char *end = marketPacket::formatTrade(buffer, &trade);
+
+            ASSERT_LE(end - buffer, marketPacket::MAX_TRADE_STRING_LENGTH);
+            EXPECT_EQ(std::string(buffer, end - buffer), expectedString);
+            EXPECT_EQ(marketPacket::generateTradeString(&trade), expectedString);
+        }
+    }
+
+    TEST(marketPacketHelpersTest, randomEngineReproducible)
+    {
+        constexpr const uint64_t SEED = 12345;
+
+        marketPacket::randomEngine_t rng(SEED);
+        marketPacket::randomEngine_t sameRng(SEED);
+        marketPacket::randomEngine_t otherRng(SEED + 1);
+
+        size_t numDifferent = 0;
+        for (size_t i = 0; i < 1000; i++)
+        {
+            uint64_t value = rng();
+            EXPECT_EQ(value, sameRng());
+            numDifferent += (value != otherRng());
+        }
+
+        EXPECT_EQ(numDifferent, 1000);
+    }
+
+    TEST(marketPacketHelpersTest, randomEngineBelow)
+    {
+        marketPacket::randomEngine_t rng(marketPacket::randomSeed());
+
+        for (uint64_t bound : {uint64_t(1), uint64_t(2), uint64_t(7), uint64_t(1000), std::numeric_limits<uint64_t>::max()})
+        {
+            for (size_t i = 0; i < 1000; i++)
+            {
+                EXPECT_LT(rng.below(bound), bound);
+            }
+        }
+
+        // Small bounds should hit everything
+        std::set<uint64_t> seen;
+        for (size_t i = 0; i < 1000; i++)
+        {
+            seen.insert(rng.below(7));
+        }
+        EXPECT_EQ(seen.size(), 7);
+    }
+
+    TEST(marketPacketHelpersTest, randomSymbolsUseWholeAlphabet)
+    {
+        std::set<char> seen;
+        for (size_t i = 0; i < 10000; i++)
+        {
+            std::string symbol = marketPacket::generateRandomSymbol();
+            ASSERT_EQ(symbol.size(), marketPacket::SYMBOL_LENGTH);
+            seen.insert(symbol.begin(), symbol.end());
+        }
+
+        EXPECT_EQ(seen, std::set<char>(marketPacket::SYMBOL_ALPHABET, marketPacket::SYMBOL_ALPHABET + marketPacket::SYMBOL_ALPHABET_SIZE));
+    }
+
+    TEST(marketPacketHelpersTest, tscTracksSteadyClock)
+    {
+        auto startTime = std::chrono::steady_clock::now();
+        uint64_t startTsc = marketPacket::readTsc();
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        uint64_t elapsedTsc = marketPacket::readTsc() - startTsc;
+        auto elapsedNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - startTime).count();
+
+        // Both ways round, to within a percent or so of what steady_clock says
+        EXPECT_NEAR(static_cast<double>(marketPacket::tscToNs(elapsedTsc)), elapsedNs, elapsedNs / 50.0);
+        EXPECT_NEAR(static_cast<double>(marketPacket::nsToTsc(elapsedNs)), elapsedTsc, elapsedTsc / 50.0);
+    }
+
+    TEST(marketPacketHelpersTest, histogramBuckets)
+    {
+        using histogram_t = marketPacket::logLinearHistogram_t<3>;
+
+        // Buckets line up end to end, over everything a uint64_t can hold
+        EXPECT_EQ(histogram_t::bucketLowerBound(0), 0);
+        EXPECT_EQ(histogram_t::bucketUpperBound(histogram_t::NUM_BUCKETS - 1), std::numeric_limits<uint64_t>::max());
+        for (size_t i = 1; i < histogram_t::NUM_BUCKETS; i++)
+        {
+            ASSERT_EQ(histogram_t::bucketLowerBound(i), histogram_t::bucketUpperBound(i - 1) + 1);
+        }
+
+        // And every value lands in the one that covers it, no wider than an eighth of itself
+        for (size_t i = 0; i < 100000; i++)
+        {
+            uint64_t value = marketPacket::rand() >> (marketPacket::rand() % 64);
+            size_t bucketIdx = histogram_t::bucketIndex(value);
+
+            ASSERT_LE(histogram_t::bucketLowerBound(bucketIdx), value);
+            ASSERT_GE(histogram_t::bucketUpperBound(bucketIdx), value);
+            ASSERT_LE(histogram_t::bucketUpperBound(bucketIdx) - histogram_t::bucketLowerBound(bucketIdx), value / 8);
+        }
+    }
+
+    TEST(marketPacketHelpersTest, histogramPercentiles)
+    {
+        marketPacket::logLinearHistogram_t<7> histogram;
+        EXPECT_EQ(histogram.percentile(50), 0);
+
+        for (uint64_t value = 1; value <= 10000; value++)
+        {
+            histogram.record(value);
+        }
+
+        EXPECT_EQ(histogram.count(), 10000);
+        EXPECT_EQ(histogram.min(), 1);
+        EXPECT_EQ(histogram.max(), 10000);
+        EXPECT_DOUBLE_EQ(histogram.mean(), 5000.5);
+
+        // Never under, and within 1% over
+        for (double percent : {1.0, 50.0, 90.0, 99.0, 99.9})
+        {
+            uint64_t exact = static_cast<uint64_t>(percent * 100);
+            EXPECT_GE(histogram.percentile(percent), exact);
+            EXPECT_LE(histogram.percentile(percent), exact + exact / 100);
+        }
+        EXPECT_EQ(histogram.percentile(0), 1);
+        EXPECT_EQ(histogram.percentile(100), 10000);
+
+        marketPacket::logLinearHistogram_t<7> other;
+        other.record(20000);
+        histogram.merge(other);
+        EXPECT_EQ(histogram.count(), 10001);
+        EXPECT_EQ(histogram.percentile(100), 20000);
+    }
 }
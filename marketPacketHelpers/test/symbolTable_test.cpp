@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+#include <set>
+#include <vector>
+
+#include "marketPacketHelpers/symbolTable.h"
+
+namespace test
+{
+    std::vector<marketPacket::symbolKey_t> generateUniqueKeys(size_t numKeys)
+    {
+        std::set<marketPacket::symbolKey_t> seen;
+        std::vector<marketPacket::symbolKey_t> keys;
+        while (keys.size() < numKeys)
+        {
+            marketPacket::symbolKey_t key = marketPacket::packSymbol(std::string_view(marketPacket::generateRandomSymbol())).value();
+            if (seen.insert(key).second)
+            {
+                keys.push_back(key);
+            }
+        }
+
+        return keys;
+    }
+
+    TEST(symbolTableTest, packSymbol)
+    {
+        marketPacket::quote_t quote{};
+        memcpy(quote.symbol, "ABCDE", marketPacket::SYMBOL_LENGTH);
+        quote.priceLevel = 0xFFFF;
+        quote.priceLevelSize = std::numeric_limits<uint64_t>::max();
+
+        // Whatever's after the symbol can't leak into the key
+        marketPacket::symbolKey_t key = marketPacket::packSymbol(quote.symbol);
+        EXPECT_EQ(key, marketPacket::packSymbol(std::string_view("ABCDE")).value());
+        EXPECT_EQ(key & ~marketPacket::SYMBOL_KEY_MASK, 0);
+
+        char symbol[marketPacket::SYMBOL_LENGTH];
+        marketPacket::unpackSymbol(symbol, key);
+        EXPECT_EQ(std::string_view(symbol, marketPacket::SYMBOL_LENGTH), "ABCDE");
+
+        EXPECT_FALSE(marketPacket::packSymbol(std::string_view("ABCD")).has_value());
+        EXPECT_FALSE(marketPacket::packSymbol(std::string_view("ABCDEF")).has_value());
+    }
+
+    TEST(symbolTableTest, denseIds)
+    {
+        std::vector<marketPacket::symbolKey_t> keys = generateUniqueKeys(1000);
+        marketPacket::symbolTable_t table(keys.size());
+
+        for (size_t i = 0; i < keys.size(); i++)
+        {
+            EXPECT_FALSE(table.find(keys[i]).has_value());
+            EXPECT_EQ(table.findOrInsert(keys[i]).value(), i);
+        }
+
+        // Everything should still be where we left it
+        for (size_t i = 0; i < keys.size(); i++)
+        {
+            EXPECT_EQ(table.find(keys[i]).value(), i);
+            EXPECT_EQ(table.findOrInsert(keys[i]).value(), i);
+            EXPECT_EQ(table.key(i), keys[i]);
+        }
+        EXPECT_EQ(table.size(), keys.size());
+    }
+
+    TEST(symbolTableTest, full)
+    {
+        std::vector<marketPacket::symbolKey_t> keys = generateUniqueKeys(3);
+        marketPacket::symbolTable_t table(2);
+
+        EXPECT_EQ(table.findOrInsert(keys[0]).value(), 0);
+        EXPECT_EQ(table.findOrInsert(keys[1]).value(), 1);
+        EXPECT_FALSE(table.findOrInsert(keys[2]).has_value());
+        EXPECT_FALSE(table.find(keys[2]).has_value());
+        EXPECT_EQ(table.size(), 2);
+
+        // Can't hold anything at all
+        marketPacket::symbolTable_t emptyTable;
+        EXPECT_FALSE(emptyTable.findOrInsert(keys[0]).has_value());
+        EXPECT_FALSE(emptyTable.find(keys[0]).has_value());
+    }
+
+    TEST(symbolTableTest, perfectHash)
+    {
+        for (size_t numKeys : {1, 2, 3, 100, 65536})
+        {
+            std::vector<marketPacket::symbolKey_t> keys = generateUniqueKeys(numKeys * 2);
+            std::vector<marketPacket::symbolKey_t> universe(keys.begin(), keys.begin() + numKeys);
+
+            marketPacket::perfectSymbolTable_t table;
+            ASSERT_TRUE(table.build(universe));
+            EXPECT_EQ(table.size(), numKeys);
+
+            for (size_t i = 0; i < numKeys; i++)
+            {
+                EXPECT_EQ(table.find(keys[i]).value(), i);
+            }
+
+            // Nothing outside the universe should be found
+            for (size_t i = numKeys; i < keys.size(); i++)
+            {
+                EXPECT_FALSE(table.find(keys[i]).has_value());
+            }
+        }
+    }
+
+    TEST(symbolTableTest, perfectHashBadUniverse)
+    {
+        std::vector<marketPacket::symbolKey_t> keys = generateUniqueKeys(10);
+        keys.push_back(keys.front());
+
+        marketPacket::perfectSymbolTable_t table;
+        EXPECT_FALSE(table.build(keys));
+        EXPECT_EQ(table.size(), 0);
+        EXPECT_FALSE(table.find(keys.front()).has_value());
+
+        // Nothing's in an empty universe
+        EXPECT_TRUE(table.build({}));
+        EXPECT_FALSE(table.find(keys.front()).has_value());
+    }
+}
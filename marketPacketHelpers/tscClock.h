@@ -0,0 +1,64 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace marketPacket
+{
+    /**
+     * @brief Raw timestamp counter. A couple of ns to read, no syscall, no vDSO
+     *
+     *  Anywhere without a TSC, it's steady_clock nanoseconds instead, and tscTicksPerNs() works out to 1
+     */
+    inline uint64_t readTsc()
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+
+    /**
+     * @brief Lets the core know we're spinning, so a hyperthread sibling gets the pipeline in the meantime
+     */
+    inline void cpuRelax()
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        _mm_pause();
+#endif
+    }
+
+    /**
+     * @brief How many TSC ticks go by per nanosecond. Measured against steady_clock the first time it's asked for,
+     *        which spins for about 10ms, then never again
+     *
+     *  ASSUMPTION: Invariant TSC, so the rate doesn't move with frequency scaling. True of anything recent
+     */
+    inline double tscTicksPerNs()
+    {
+        static const double ticksPerNs = []
+        {
+            auto startTime = std::chrono::steady_clock::now();
+            uint64_t startTsc = readTsc();
+
+            auto endTime = startTime;
+            while (endTime - startTime < std::chrono::milliseconds(10))
+            {
+                endTime = std::chrono::steady_clock::now();
+            }
+            uint64_t endTsc = readTsc();
+
+            return static_cast<double>(endTsc - startTsc) / std::chrono::duration_cast<std::chrono::nanoseconds>(endTime - startTime).count();
+        }();
+
+        return ticksPerNs;
+    }
+
+    inline uint64_t tscToNs(uint64_t ticks) { return static_cast<uint64_t>(ticks / tscTicksPerNs()); }
+    inline uint64_t nsToTsc(uint64_t ns) { return static_cast<uint64_t>(ns * tscTicksPerNs()); }
+};
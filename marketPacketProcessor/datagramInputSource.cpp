@@ -0,0 +1,172 @@
+#include "datagramInputSource.h"
+
+#include <cerrno>
+#include <cstring>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace marketPacket
+{
+    datagramInputSource_t::datagramInputSource_t(int fd, bool ownsFd, const datagramConfig_t &config)
+        : m_config(config),
+          m_fd(fd),
+          m_ownsFd(ownsFd),
+          m_boundPath(),
+          m_bufferStride(),
+          m_buffers(),
+          m_iovecs(),
+          m_messages(),
+          m_numReceived(0),
+          m_current(0),
+          m_offset(0),
+          m_isEndOfInput(false),
+          m_numDatagrams(0),
+          m_numBatches(0)
+    {
+        setup();
+    }
+
+    datagramInputSource_t::datagramInputSource_t(const std::string &socketPath, const datagramConfig_t &config)
+        : datagramInputSource_t(::socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0), true, config)
+    {
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        if (m_fd < 0 || socketPath.size() >= sizeof(addr.sun_path))
+        {
+            return;
+        }
+        std::memcpy(addr.sun_path, socketPath.c_str(), socketPath.size() + 1);
+
+        // Whatever's left over from the last run would make bind() fail
+        ::unlink(socketPath.c_str());
+        if (::bind(m_fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0)
+        {
+            ::close(m_fd);
+            m_fd = -1;
+            return;
+        }
+
+        m_boundPath = socketPath;
+    }
+
+    datagramInputSource_t::~datagramInputSource_t()
+    {
+        if (m_ownsFd && m_fd >= 0)
+        {
+            ::close(m_fd);
+        }
+
+        if (!m_boundPath.empty())
+        {
+            ::unlink(m_boundPath.c_str());
+        }
+    }
+
+    void datagramInputSource_t::setup()
+    {
+        assert(m_config.batchSize > 0 && m_config.maxDatagramSize > 0);
+
+        // Keep every datagram starting on its own cache line
+        m_bufferStride = (m_config.maxDatagramSize + 63) & ~size_t(63);
+        m_buffers.resize(m_bufferStride * m_config.batchSize);
+        m_iovecs.resize(m_config.batchSize);
+        m_messages.resize(m_config.batchSize);
+
+        for (size_t i = 0; i < m_config.batchSize; i++)
+        {
+            m_iovecs[i] = {m_buffers.data() + i * m_bufferStride, m_config.maxDatagramSize};
+
+            m_messages[i] = {};
+            m_messages[i].msg_hdr.msg_iov = &m_iovecs[i];
+            m_messages[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        // The kernel does our waiting for us. Timing out shows up as EAGAIN
+        if (m_fd >= 0 && m_config.idleTimeout.has_value())
+        {
+            auto timeout = m_config.idleTimeout.value();
+            timeval tv{static_cast<time_t>(timeout.count() / 1000000), static_cast<suseconds_t>(timeout.count() % 1000000)};
+            ::setsockopt(m_fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+        }
+    }
+
+    std::optional<failReason_t> datagramInputSource_t::checkValidity()
+    {
+        if (m_fd < 0)
+        {
+            return INPUT_STREAM_CLOSED;
+        }
+
+        if (m_isEndOfInput)
+        {
+            return END_OF_FILE;
+        }
+
+        // We're between packets. Anything left in the datagram we were reading belonged to the last one
+        if (m_current < m_numReceived && m_offset != 0)
+        {
+            m_current++;
+            m_offset = 0;
+        }
+
+        if (m_current == m_numReceived)
+        {
+            const auto &failReason = receiveBatch();
+            if (failReason.has_value())
+            {
+                return failReason;
+            }
+        }
+
+        if (m_messages[m_current].msg_len == 0)
+        {
+            m_isEndOfInput = true;
+            return END_OF_FILE;
+        }
+
+        return std::nullopt;
+    }
+
+    const std::byte *datagramInputSource_t::read(size_t numBytes)
+    {
+        if (m_current >= m_numReceived || m_messages[m_current].msg_len - m_offset < numBytes)
+        {
+            return nullptr;
+        }
+
+        const std::byte *data = m_buffers.data() + m_current * m_bufferStride + m_offset;
+        m_offset += numBytes;
+        return data;
+    }
+
+    std::optional<failReason_t> datagramInputSource_t::receiveBatch()
+    {
+        m_numReceived = 0;
+        m_current = 0;
+        m_offset = 0;
+
+        int numReceived;
+        do
+        {
+            // Block for the first one, then take whatever else is already waiting
+            numReceived = ::recvmmsg(m_fd, m_messages.data(), m_messages.size(), MSG_WAITFORONE, nullptr);
+        } while (numReceived < 0 && errno == EINTR);
+
+        if (numReceived < 0)
+        {
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+            {
+                m_isEndOfInput = true;
+                return END_OF_FILE;
+            }
+
+            return BAD_STREAM;
+        }
+
+        m_numReceived = numReceived;
+        m_numDatagrams += numReceived;
+        m_numBatches++;
+
+        return std::nullopt;
+    }
+};
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <chrono>
+#include <optional>
+#include <string>
+#include <sys/socket.h>
+#include <vector>
+
+#include "marketPacketHelpers/marketPacketHelpers.h"
+#include "inputSource.h"
+
+namespace marketPacket
+{
+    /**
+     * @brief Knobs for how a datagram source receives
+     */
+    struct datagramConfig_t
+    {
+        size_t batchSize = 64;                                // Most datagrams one recvmmsg() can pick up
+        size_t maxDatagramSize = 64 * 1024;                   // Biggest datagram we have room for. The default fits any packet
+        std::optional<std::chrono::microseconds> idleTimeout; // Give up once nothing's shown up for this long. Never, if unset
+    };
+
+    /**
+     * Reads packets off a datagram socket (UDP, Unix), one packet per datagram, like a live feed would hand them over.
+     *
+     * Datagrams come in batches with recvmmsg(), straight into a pool of buffers allocated up front, and reads hand
+     * out ptrs into those buffers, so the processor decodes every packet right where the kernel put it.
+     *
+     * Every packet starts a new datagram. Anything in a datagram past the end of its packet gets ignored, and a packet
+     * that runs past the end of its datagram is a short read like any other cut off packet.
+     * An empty datagram is the end of the input, and so is going idleTimeout without anything showing up
+     */
+    class datagramInputSource_t : public inputSource_t
+    {
+    public:
+        /**
+         * @brief Reads off a socket somebody else has already set up and bound
+         *
+         * @param fd        Datagram socket to read from
+         * @param ownsFd    If we should close it when we're done
+         * @param config    How to receive
+         */
+        datagramInputSource_t(int fd, bool ownsFd, const datagramConfig_t &config = datagramConfig_t());
+
+        /**
+         * @brief Binds a Unix datagram socket at a path and reads off that. Anything already at the path gets replaced
+         *
+         * @param socketPath    Where senders should send to. If we can't bind it, the source behaves like a closed stream
+         * @param config        How to receive
+         */
+        datagramInputSource_t(const std::string &socketPath, const datagramConfig_t &config = datagramConfig_t());
+
+        ~datagramInputSource_t() override;
+
+        // We (might) own the socket, so no copying it around
+        datagramInputSource_t(const datagramInputSource_t &) = delete;
+        datagramInputSource_t &operator=(const datagramInputSource_t &) = delete;
+
+        std::optional<failReason_t> checkValidity() override;
+        const std::byte *read(size_t numBytes) override;
+        size_t maxReadSize() const override { return m_config.maxDatagramSize; }
+
+        /**
+         * @brief How many datagrams have come in, and how many recvmmsg() calls that took
+         */
+        size_t numDatagrams() const { return m_numDatagrams; }
+        size_t numBatches() const { return m_numBatches; }
+
+    private:
+        /**
+         * @brief Sets up the buffer pool and the receive timeout
+         */
+        void setup();
+
+        /**
+         * @brief Waits for at least one datagram, and takes however many more are already there, up to a batch
+         *
+         * @return If there weren't any, why
+         */
+        std::optional<failReason_t> receiveBatch();
+
+        datagramConfig_t m_config; // How to receive
+
+        int m_fd;                // Socket we're reading from
+        bool m_ownsFd;           // If we need to close m_fd
+        std::string m_boundPath; // Unix socket path we bound, so it can get cleaned up. Empty if we didn't
+
+        size_t m_bufferStride;            // Distance between buffers in the pool. maxDatagramSize, rounded up to a cache line
+        std::vector<std::byte> m_buffers; // One buffer per datagram in a batch
+        std::vector<iovec> m_iovecs;      // Where each datagram in a batch goes
+        std::vector<mmsghdr> m_messages;  // What recvmmsg() fills in
+
+        size_t m_numReceived; // How many datagrams the last batch got
+        size_t m_current;     // Which datagram in the batch we're reading
+        size_t m_offset;      // How far into that datagram we've read
+        bool m_isEndOfInput;  // If we've hit an empty datagram or the idle timeout
+
+        size_t m_numDatagrams; // Datagrams received so far
+        size_t m_numBatches;   // recvmmsg() calls that got something
+    };
+};
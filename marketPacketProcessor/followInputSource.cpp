@@ -0,0 +1,196 @@
+#include "followInputSource.h"
+
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+namespace marketPacket
+{
+    // How much we try to pull off the file at a time
+    constexpr const size_t FOLLOW_READ_SIZE = 64 * 1024;
+
+    followInputSource_t::followInputSource_t(const std::string &path, const followConfig_t &config)
+        : m_config(config),
+          m_fd(::open(path.c_str(), O_RDONLY | O_CLOEXEC)),
+          m_inotifyFd(-1),
+          m_stopFd(::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)),
+          m_isBadStream(false),
+          m_buffer(),
+          m_lastGrowth(std::chrono::steady_clock::now())
+    {
+        if (m_fd < 0 || !m_config.useInotify)
+        {
+            return;
+        }
+
+        // Anything goes wrong here, we just poll instead
+        m_inotifyFd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (m_inotifyFd >= 0 && ::inotify_add_watch(m_inotifyFd, path.c_str(), IN_MODIFY) < 0)
+        {
+            ::close(m_inotifyFd);
+            m_inotifyFd = -1;
+        }
+    }
+
+    followInputSource_t::~followInputSource_t()
+    {
+        for (int fd : {m_fd, m_inotifyFd, m_stopFd})
+        {
+            if (fd >= 0)
+            {
+                ::close(fd);
+            }
+        }
+    }
+
+    std::optional<failReason_t> followInputSource_t::checkValidity()
+    {
+        if (m_fd < 0 || m_stopFd < 0)
+        {
+            return INPUT_STREAM_CLOSED;
+        }
+
+        // Nothing new yet isn't the end, unless we've stopped following
+        while (m_buffer.unreadSize() == 0)
+        {
+            if (fill())
+            {
+                continue;
+            }
+
+            if (m_isBadStream)
+            {
+                return BAD_STREAM;
+            }
+
+            if (!waitForData())
+            {
+                return END_OF_FILE;
+            }
+        }
+
+        return std::nullopt;
+    }
+
+    const std::byte *followInputSource_t::read(size_t numBytes)
+    {
+        // Rest of the packet just hasn't been written yet, hang on until it is
+        while (m_buffer.unreadSize() < numBytes)
+        {
+            if (fill())
+            {
+                continue;
+            }
+
+            // Done following. Let the buffer fail the read like a cut off capture would
+            if (m_isBadStream || !waitForData())
+            {
+                break;
+            }
+        }
+
+        return m_buffer.read(numBytes);
+    }
+
+    bool followInputSource_t::seek(size_t offset)
+    {
+        if (m_fd < 0 || ::lseek(m_fd, offset, SEEK_SET) < 0)
+        {
+            return false;
+        }
+
+        m_buffer = bufferedInputSource_t();
+        m_isBadStream = false;
+        return true;
+    }
+
+    void followInputSource_t::stop()
+    {
+        if (m_stopFd >= 0)
+        {
+            uint64_t one = 1;
+            [[maybe_unused]] ssize_t written = ::write(m_stopFd, &one, sizeof(one));
+        }
+    }
+
+    bool followInputSource_t::fill()
+    {
+        std::byte *dst = m_buffer.prepareAppend(FOLLOW_READ_SIZE);
+
+        ssize_t bytesRead;
+        do
+        {
+            bytesRead = ::read(m_fd, dst, FOLLOW_READ_SIZE);
+        } while (bytesRead < 0 && errno == EINTR);
+
+        if (bytesRead < 0)
+        {
+            m_isBadStream = true;
+            return false;
+        }
+
+        if (bytesRead == 0)
+        {
+            return false;
+        }
+
+        m_buffer.commitAppend(bytesRead);
+        m_lastGrowth = std::chrono::steady_clock::now();
+        return true;
+    }
+
+    bool followInputSource_t::waitForData()
+    {
+        using namespace std::chrono;
+
+        // Work out how long we're willing to sleep. Forever, if we have inotify and no idle timeout
+        std::optional<microseconds> timeout;
+        if (m_config.idleTimeout.has_value())
+        {
+            microseconds idleFor = duration_cast<microseconds>(steady_clock::now() - m_lastGrowth);
+            if (idleFor >= m_config.idleTimeout.value())
+            {
+                return false;
+            }
+            timeout = m_config.idleTimeout.value() - idleFor;
+        }
+
+        if (!isUsingInotify())
+        {
+            timeout = std::min(timeout.value_or(m_config.pollInterval), m_config.pollInterval);
+        }
+
+        timespec ts;
+        if (timeout.has_value())
+        {
+            ts.tv_sec = duration_cast<seconds>(timeout.value()).count();
+            ts.tv_nsec = duration_cast<nanoseconds>(timeout.value() % seconds(1)).count();
+        }
+
+        pollfd fds[2] = {{m_stopFd, POLLIN, 0}, {m_inotifyFd, POLLIN, 0}};
+        if (::ppoll(fds, isUsingInotify() ? 2 : 1, timeout.has_value() ? &ts : nullptr, nullptr) < 0 && errno != EINTR)
+        {
+            m_isBadStream = true;
+            return false;
+        }
+
+        if (fds[0].revents & POLLIN)
+        {
+            return false;
+        }
+
+        // We only care that something happened, not what
+        if (isUsingInotify() && (fds[1].revents & POLLIN))
+        {
+            alignas(inotify_event) char events[4096];
+            while (::read(m_inotifyFd, events, sizeof(events)) > 0)
+            {
+            }
+        }
+
+        return true;
+    }
+};
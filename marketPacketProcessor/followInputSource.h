@@ -0,0 +1,88 @@
+#pragma once
+
+#include <chrono>
+#include <optional>
+#include <string>
+
+#include "marketPacketHelpers/marketPacketHelpers.h"
+#include "inputSource.h"
+
+namespace marketPacket
+{
+    /**
+     * @brief Knobs for how a follow source waits on a file that's still being written
+     */
+    struct followConfig_t
+    {
+        bool useInotify = true;                               // Wake up as soon as the file changes. Falls back to polling if inotify isn't there
+        std::chrono::microseconds pollInterval{100};          // How often to look for more data when we're polling
+        std::optional<std::chrono::microseconds> idleTimeout; // Give up once the file hasn't grown for this long. Never, if unset
+    };
+
+    /**
+     * Reads a capture while whatever's recording it is still writing it, like tail -f.
+     *
+     * Running out of file isn't the end of the input, it just means the rest hasn't been written yet. Reads wait
+     * for it to show up (inotify, or polling every so often) and pick up exactly where they left off, so the processor
+     * never sees a short read for a packet that's only half written.
+     *
+     * Following ends when the file's been idle for idleTimeout, or somebody calls stop(). If that happens between
+     * packets, it's the end of the file. In the middle of one, it's a short read like any other cut off capture
+     */
+    class followInputSource_t : public inputSource_t
+    {
+    public:
+        /**
+         * @brief Construct a new followInputSource_t object
+         *
+         * @param path      File to follow. If we can't open it, the source behaves like a closed stream
+         * @param config    How to wait for more data
+         */
+        followInputSource_t(const std::string &path, const followConfig_t &config = followConfig_t());
+        ~followInputSource_t() override;
+
+        // We own fds, so no copying them around
+        followInputSource_t(const followInputSource_t &) = delete;
+        followInputSource_t &operator=(const followInputSource_t &) = delete;
+
+        std::optional<failReason_t> checkValidity() override;
+        const std::byte *read(size_t numBytes) override;
+        size_t maxReadSize() const override { return std::numeric_limits<size_t>::max(); }
+        bool seek(size_t offset) override;
+
+        /**
+         * @brief Stops following. Wakes up a read that's waiting. Safe to call from any thread
+         */
+        void stop();
+
+        /**
+         * @brief If inotify is what's waking us up, rather than polling
+         */
+        bool isUsingInotify() const { return m_inotifyFd >= 0; }
+
+    private:
+        /**
+         * @brief Reads whatever the file has past what we've buffered
+         *
+         * @return False if there wasn't anything
+         */
+        bool fill();
+
+        /**
+         * @brief Waits for the file to change, or for a poll interval to go by
+         *
+         * @return False if we're done following
+         */
+        bool waitForData();
+
+        followConfig_t m_config; // How to wait for more data
+
+        int m_fd;           // File we're following
+        int m_inotifyFd;    // Tells us when the file changes. -1 if we're polling
+        int m_stopFd;       // eventfd that stop() pokes so waiting reads wake up
+        bool m_isBadStream; // If reading the file ever actually failed
+
+        bufferedInputSource_t m_buffer;                     // Everything read from the file that the processor hasn't had yet
+        std::chrono::steady_clock::time_point m_lastGrowth; // Last time the file had something new for us
+    };
+};
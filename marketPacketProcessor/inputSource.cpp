@@ -0,0 +1,276 @@
+#include "inputSource.h"
+
+#include <algorithm>
+#include <assert.h>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace marketPacket
+{
+    // How much we let pile up behind the read position before telling the kernel it can have it back
+    constexpr const size_t MAPPED_RELEASE_WINDOW = 64 * 1024 * 1024;
+
+    bool inputSource_t::readInto(std::byte *dst, size_t numBytes)
+    {
+        while (numBytes > 0)
+        {
+            size_t chunkSize = std::min(numBytes, maxReadSize());
+            const std::byte *chunk = read(chunkSize);
+            if (chunk == nullptr)
+            {
+                return false;
+            }
+
+            std::memcpy(dst, chunk, chunkSize);
+            dst += chunkSize;
+            numBytes -= chunkSize;
+        }
+
+        return true;
+    }
+
+    std::optional<failReason_t> streamInputSource_t::checkValidity()
+    {
+        // Don't process, just return early
+        if (!m_inputStream.is_open())
+        {
+            return INPUT_STREAM_CLOSED;
+        }
+
+        // Do a quick peek to set flags if we're at the end of a file
+        m_inputStream.peek();
+        if (!m_inputStream.good())
+        {
+            return m_inputStream.eof() ? END_OF_FILE : BAD_STREAM;
+        }
+
+        return std::nullopt;
+    }
+
+    const std::byte *streamInputSource_t::read(size_t numBytes)
+    {
+        assert(numBytes <= READ_BUFFER_SIZE);
+
+        if (!(m_inputStream.read(reinterpret_cast<char *>(m_readBuffer.data()), numBytes)))
+        {
+            return nullptr;
+        }
+
+        return m_readBuffer.data();
+    }
+
+    bool streamInputSource_t::readInto(std::byte *dst, size_t numBytes)
+    {
+        // No point bouncing through our own buffer
+        return m_inputStream.read(reinterpret_cast<char *>(dst), numBytes).good();
+    }
+
+    bool streamInputSource_t::seek(size_t offset)
+    {
+        if (!m_inputStream.is_open())
+        {
+            return false;
+        }
+
+        // Hitting the end of the file sets flags seekg() won't clear for us
+        m_inputStream.clear();
+        return m_inputStream.seekg(offset).good();
+    }
+
+    std::optional<failReason_t> memoryInputSource_t::checkValidity()
+    {
+        if (m_offset == m_size)
+        {
+            return END_OF_FILE;
+        }
+
+        return std::nullopt;
+    }
+
+    const std::byte *memoryInputSource_t::read(size_t numBytes)
+    {
+        if (m_size - m_offset < numBytes)
+        {
+            // Mirror a short stream read, whatever was left is gone
+            m_offset = m_size;
+            return nullptr;
+        }
+
+        const std::byte *readPtr = m_data + m_offset;
+        m_offset += numBytes;
+
+        return readPtr;
+    }
+
+    bool memoryInputSource_t::seek(size_t offset)
+    {
+        if (offset > m_size)
+        {
+            return false;
+        }
+
+        m_offset = offset;
+        return true;
+    }
+
+    std::optional<failReason_t> bufferedInputSource_t::checkValidity()
+    {
+        if (m_isEndOfInput && unreadSize() == 0)
+        {
+            return END_OF_FILE;
+        }
+
+        return std::nullopt;
+    }
+
+    const std::byte *bufferedInputSource_t::read(size_t numBytes)
+    {
+        if (unreadSize() < numBytes)
+        {
+            // Mirror a short stream read, whatever was left is gone
+            m_readOffset = m_size;
+            return nullptr;
+        }
+
+        const std::byte *readPtr = m_buffer.data() + m_readOffset;
+        m_readOffset += numBytes;
+
+        return readPtr;
+    }
+
+    std::byte *bufferedInputSource_t::prepareAppend(size_t numBytes)
+    {
+        if (m_buffer.size() - m_size < numBytes)
+        {
+            // Slide what's left down over what's been read before resorting to growing
+            if (m_readOffset != 0)
+            {
+                std::memmove(m_buffer.data(), m_buffer.data() + m_readOffset, unreadSize());
+                m_size -= m_readOffset;
+                m_readOffset = 0;
+            }
+
+            if (m_buffer.size() - m_size < numBytes)
+            {
+                m_buffer.resize(std::max(m_size + numBytes, m_buffer.size() * 2));
+            }
+        }
+
+        return m_buffer.data() + m_size;
+    }
+
+    mappedFile_t::mappedFile_t(const std::string &path)
+        : m_isOpen(false),
+          m_data(nullptr),
+          m_size(0)
+    {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            return;
+        }
+
+        struct stat st;
+        if (::fstat(fd, &st) != 0)
+        {
+            ::close(fd);
+            return;
+        }
+
+        // mmap() won't map nothing, but an empty file is still a perfectly open (and finished) file
+        m_isOpen = true;
+        if (st.st_size > 0)
+        {
+            void *data = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data == MAP_FAILED)
+            {
+                m_isOpen = false;
+            }
+            else
+            {
+                m_data = static_cast<const std::byte *>(data);
+                m_size = st.st_size;
+
+                // We only ever walk forward, so let the kernel read ahead aggressively
+                ::madvise(data, m_size, MADV_SEQUENTIAL);
+            }
+        }
+
+        // The mapping keeps its own reference to the file
+        ::close(fd);
+    }
+
+    mappedFile_t::~mappedFile_t()
+    {
+        if (m_data != nullptr)
+        {
+            ::munmap(const_cast<std::byte *>(m_data), m_size);
+        }
+    }
+
+    std::optional<failReason_t> mappedInputSource_t::checkValidity()
+    {
+        if (!m_file.isOpen())
+        {
+            return INPUT_STREAM_CLOSED;
+        }
+
+        if (m_offset == m_file.size())
+        {
+            return END_OF_FILE;
+        }
+
+        return std::nullopt;
+    }
+
+    const std::byte *mappedInputSource_t::read(size_t numBytes)
+    {
+        if (m_file.size() - m_offset < numBytes)
+        {
+            // Mirror a short stream read, whatever was left is gone
+            m_offset = m_file.size();
+            return nullptr;
+        }
+
+        // Whatever we handed out last time is dead now
+        releaseConsumed(m_offset);
+
+        const std::byte *readPtr = m_file.data() + m_offset;
+        m_offset += numBytes;
+
+        return readPtr;
+    }
+
+    bool mappedInputSource_t::seek(size_t offset)
+    {
+        if (!m_file.isOpen() || offset > m_file.size())
+        {
+            return false;
+        }
+
+        // Released pages fault back in from the file if we go backwards, just have to stop counting them as released
+        static const size_t pageSize = ::sysconf(_SC_PAGESIZE);
+        m_releasedUpTo = std::min(m_releasedUpTo, offset & ~(pageSize - 1));
+        m_offset = offset;
+
+        return true;
+    }
+
+    void mappedInputSource_t::releaseConsumed(size_t upTo)
+    {
+        if (upTo - m_releasedUpTo < MAPPED_RELEASE_WINDOW)
+        {
+            return;
+        }
+
+        // madvise() only works on whole pages
+        static const size_t pageSize = ::sysconf(_SC_PAGESIZE);
+        size_t releaseTo = upTo & ~(pageSize - 1);
+
+        ::madvise(const_cast<std::byte *>(m_file.data()) + m_releasedUpTo, releaseTo - m_releasedUpTo, MADV_DONTNEED);
+        m_releasedUpTo = releaseTo;
+    }
+};
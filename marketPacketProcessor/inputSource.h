@@ -0,0 +1,232 @@
+#pragma once
+
+#include <array>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "marketPacketHelpers/marketPacketHelpers.h"
+
+namespace marketPacket
+{
+    /**
+     * Where a processor gets its bytes from.
+     *
+     * Sources hand back ptrs rather than copying into a caller's buffer so backends that already
+     * have the data in memory (mmap, etc) can let the processor decode it in place
+     */
+    class inputSource_t
+    {
+    public:
+        virtual ~inputSource_t() = default;
+
+        /**
+         * @brief Checks to see if there's more data we can read
+         *
+         * @return If there isn't, why
+         */
+        virtual std::optional<failReason_t> checkValidity() = 0;
+
+        /**
+         * @brief Consumes the next numBytes of input
+         *
+         *  NOTE: The ptr is only good until the next call to read()
+         *
+         * @param numBytes How many bytes we want. Must be <= maxReadSize()
+         * @return Ptr to numBytes contiguous bytes, nullptr if we couldn't get all of them
+         */
+        virtual const std::byte *read(size_t numBytes) = 0;
+
+        /**
+         * @brief Largest single read() this source can satisfy
+         */
+        virtual size_t maxReadSize() const = 0;
+
+        /**
+         * @brief Consumes the next numBytes of input into somebody else's buffer, for when the bytes have to outlive the next read()
+         *
+         *  By default, this is read() in chunks and copied out. Sources that can land the bytes straight in dst should
+         *
+         * @param dst       Where to put the bytes. Needs room for numBytes
+         * @param numBytes  How many bytes we want. No limit
+         * @return False if we couldn't get all of them
+         */
+        virtual bool readInto(std::byte *dst, size_t numBytes);
+
+        /**
+         * @brief Moves the read position to an absolute offset in the input. Clears any end of file / bad read state
+         *
+         *  By default, sources can't seek. Anything backed by a file or memory should be able to
+         *
+         * @param offset Where the next read() should start from
+         * @return False if we can't get there
+         */
+        virtual bool seek(size_t /*offset*/) { return false; }
+    };
+
+    /**
+     * Classic buffered reads through an ifstream
+     */
+    class streamInputSource_t : public inputSource_t
+    {
+    public:
+        /**
+         * @brief Construct a new streamInputSource_t object
+         *
+         * @param iStream Stream we'll be reading from
+         */
+        streamInputSource_t(std::ifstream &&iStream)
+            : m_readBuffer(),
+              m_inputStream(std::move(iStream)){};
+
+        std::optional<failReason_t> checkValidity() override;
+        const std::byte *read(size_t numBytes) override;
+        size_t maxReadSize() const override { return READ_BUFFER_SIZE; }
+        bool readInto(std::byte *dst, size_t numBytes) override;
+        bool seek(size_t offset) override;
+
+    private:
+        alignas(64) std::array<std::byte, READ_BUFFER_SIZE> m_readBuffer; // Where we read parts of the packet into
+        std::ifstream m_inputStream;                                      // Input stream
+    };
+
+    /**
+     * Reads out of memory somebody else owns. No copies
+     */
+    class memoryInputSource_t : public inputSource_t
+    {
+    public:
+        /**
+         * @brief Construct a new memoryInputSource_t object
+         *
+         * @param data  Start of the bytes to read. Has to outlive the source
+         * @param size  How many bytes there are
+         */
+        memoryInputSource_t(const std::byte *data, size_t size)
+            : m_data(data),
+              m_size(size),
+              m_offset(0){};
+
+        std::optional<failReason_t> checkValidity() override;
+        const std::byte *read(size_t numBytes) override;
+        size_t maxReadSize() const override { return std::numeric_limits<size_t>::max(); }
+        bool seek(size_t offset) override;
+
+    private:
+        const std::byte *m_data; // Start of what we're reading
+        size_t m_size;           // How much there is to read
+        size_t m_offset;         // How far in we've read
+    };
+
+    /**
+     * Bytes somebody else pushes in as they show up (off a socket, a pipe, etc.), handed out without copying again.
+     *
+     * Never blocks. Asking for more than has been pushed is a failed read, so whoever's pushing should only let a
+     * processor loose on whole packets until they call markEndOfInput()
+     */
+    class bufferedInputSource_t : public inputSource_t
+    {
+    public:
+        /**
+         * @brief Construct a new bufferedInputSource_t object
+         */
+        bufferedInputSource_t()
+            : m_buffer(),
+              m_readOffset(0),
+              m_size(0),
+              m_isEndOfInput(false){};
+
+        std::optional<failReason_t> checkValidity() override;
+        const std::byte *read(size_t numBytes) override;
+        size_t maxReadSize() const override { return std::numeric_limits<size_t>::max(); }
+
+        /**
+         * @brief Makes room for at least numBytes more at the end. Invalidates anything read() handed out
+         *
+         * @return Where to put them. Call commitAppend() with however many actually got put there
+         */
+        std::byte *prepareAppend(size_t numBytes);
+        void commitAppend(size_t numBytes) { m_size += numBytes; }
+
+        /**
+         * @brief Nothing more is coming. Reads past what's buffered fail, and an empty buffer is the end of the file
+         */
+        void markEndOfInput() { m_isEndOfInput = true; }
+
+        /**
+         * @brief Everything pushed in that hasn't been read yet
+         */
+        const std::byte *unreadData() const { return m_buffer.data() + m_readOffset; }
+        size_t unreadSize() const { return m_size - m_readOffset; }
+
+    private:
+        std::vector<std::byte> m_buffer; // Everything pushed in, minus whatever got compacted away
+        size_t m_readOffset;             // Where the next read() starts
+        size_t m_size;                   // How much of the buffer has been pushed in
+        bool m_isEndOfInput;             // If nothing more is coming
+    };
+
+    /**
+     * Read only mapping of a whole file. Unmaps itself when it goes away
+     */
+    class mappedFile_t
+    {
+    public:
+        /**
+         * @brief Maps a file in
+         *
+         * @param path File to map. If we can't, isOpen() tells you so
+         */
+        mappedFile_t(const std::string &path);
+        ~mappedFile_t();
+
+        // We own the mapping, so no copying it around
+        mappedFile_t(const mappedFile_t &) = delete;
+        mappedFile_t &operator=(const mappedFile_t &) = delete;
+
+        bool isOpen() const { return m_isOpen; }
+        const std::byte *data() const { return m_data; }
+        size_t size() const { return m_size; }
+
+    private:
+        bool m_isOpen;           // Did we manage to open the file at all
+        const std::byte *m_data; // Start of the mapping
+        size_t m_size;           // Size of the mapping
+    };
+
+    /**
+     * Maps the whole capture into memory and hands out ptrs straight into the mapping.
+     * No copies, no syscalls per read
+     */
+    class mappedInputSource_t : public inputSource_t
+    {
+    public:
+        /**
+         * @brief Construct a new mappedInputSource_t object
+         *
+         * @param path File to map. If we can't map it, the source behaves like a closed stream
+         */
+        mappedInputSource_t(const std::string &path)
+            : m_file(path),
+              m_offset(0),
+              m_releasedUpTo(0){};
+
+        std::optional<failReason_t> checkValidity() override;
+        const std::byte *read(size_t numBytes) override;
+        size_t maxReadSize() const override { return std::numeric_limits<size_t>::max(); }
+        bool seek(size_t offset) override;
+
+    private:
+        /**
+         * @brief Lets the kernel drop pages we're never coming back to so huge captures don't balloon our RSS
+         *
+         * @param upTo Everything before this offset is fair game
+         */
+        void releaseConsumed(size_t upTo);
+
+        mappedFile_t m_file;   // The whole capture
+        size_t m_offset;       // How far into the mapping we've read
+        size_t m_releasedUpTo; // Everything before this has been handed back to the kernel
+    };
+};
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <optional>
+#include <ostream>
+
+#include "marketPacketHelpers/histogram.h"
+#include "marketPacketHelpers/latencyStamp.h"
+#include "marketPacketHelpers/marketPacketHelpers.h"
+
+namespace marketPacket
+{
+    // Nanoseconds, to within 1%
+    using latencyHistogram_t = logLinearHistogram_t<7>;
+
+    /**
+     * Sits in front of another handler and, for every update, works out how long it's been since the generator
+     * stamped it (see generatorConfig_t::stampLatency) before passing it along. That's the whole trip, generator to
+     * handler, with whatever's in between (socket, file, input source, validation) included.
+     *
+     * Sees every update whether the handler it's in front of wants it or not, so updates only it cares about still
+     * get timed. Everything else the handler has (onPacketBegin(), onFlush(), etc.) gets passed straight through
+     *
+     *  e.g. basicMarketPacketProcessor_t<latencyHandler_t<tradeOutput_t>>
+     *
+     * @tparam handler_t What gets the updates after they've been timed
+     */
+    template <typename handler_t>
+    class latencyHandler_t
+    {
+    public:
+        /**
+         * @brief Construct a new latencyHandler_t object
+         *
+         * @param handler What gets the updates after they've been timed
+         */
+        latencyHandler_t(handler_t &&handler = handler_t())
+            : m_latencies(),
+              m_numUnstamped(0),
+              m_handler(std::move(handler)){};
+
+        void onTrade(const trade_t &t)
+        {
+            record(reinterpret_cast<const std::byte *>(&t));
+            if constexpr (requires { m_handler.onTrade(t); })
+            {
+                m_handler.onTrade(t);
+            }
+        }
+
+        void onQuote(const quote_t &q)
+        {
+            record(reinterpret_cast<const std::byte *>(&q));
+            if constexpr (requires { m_handler.onQuote(q); })
+            {
+                m_handler.onQuote(q);
+            }
+        }
+
+        // Whatever else the handler has, as is
+        void onPacketBegin(const packetHeader_t &ph)
+            requires requires(handler_t &h) { h.onPacketBegin(ph); }
+        {
+            m_handler.onPacketBegin(ph);
+        }
+
+        decltype(auto) onPacketEnd()
+            requires requires(handler_t &h) { h.onPacketEnd(); }
+        {
+            return m_handler.onPacketEnd();
+        }
+
+        decltype(auto) onFlush()
+            requires requires(handler_t &h) { h.onFlush(); }
+        {
+            return m_handler.onFlush();
+        }
+
+        /**
+         * @brief Wire to handler latency of every stamped update so far, in nanoseconds
+         */
+        const latencyHistogram_t &latencies() const { return m_latencies; }
+
+        /**
+         * @brief Updates that came in without a stamp, so didn't get timed
+         */
+        size_t numUnstamped() const { return m_numUnstamped; }
+
+        /**
+         * @brief Writes out the usual percentiles, e.g. when shutting down
+         */
+        void writeReport(std::ostream &os) const
+        {
+            os << "Latency (ns) over " << m_latencies.count() << " updates:"
+               << " min " << m_latencies.min()
+               << " p50 " << m_latencies.percentile(50)
+               << " p90 " << m_latencies.percentile(90)
+               << " p99 " << m_latencies.percentile(99)
+               << " p99.9 " << m_latencies.percentile(99.9)
+               << " p99.99 " << m_latencies.percentile(99.99)
+               << " max " << m_latencies.max();
+
+            if (m_numUnstamped > 0)
+            {
+                os << " (" << m_numUnstamped << " unstamped)";
+            }
+            os << '\n';
+        }
+
+        handler_t &handler() { return m_handler; }
+        const handler_t &handler() const { return m_handler; }
+
+    private:
+        void record(const std::byte *update)
+        {
+            uint64_t stamp = readLatencyStamp(update);
+            if (stamp == 0)
+            {
+                m_numUnstamped++;
+                return;
+            }
+
+            m_latencies.record(latencyStampAge(stamp, latencyClockNs()));
+        }
+
+        latencyHistogram_t m_latencies; // Every stamped update's latency
+        size_t m_numUnstamped;          // Updates we couldn't time
+
+        handler_t m_handler; // What gets the updates after us
+    };
+};
@@ -1,261 +1,126 @@
 #include "marketPacketProcessor.h"
 
-#include <fstream>
+#include <algorithm>
 #include <assert.h>
+#include <filesystem>
 
 namespace marketPacket
 {
-    void marketPacketProcessor_t::initialize()
+    void marketPacketProcessor_t::initialize(const processorConfig_t &config)
     {
         // Make sure this only gets called once
-        if (m_state != state_t::UNINITIALIZED)
+        if (isInitialized())
         {
             assert(false);
             return;
         }
 
-        m_tradeLocs.reserve(READ_BUFFER_SIZE / UPDATE_SIZE);
-        m_state = state_t::CHECK_STREAM_VALIDITY;
+        assert(config.checkpointInterval > 0);
+        m_checkpointPath = config.checkpointPath;
+        m_checkpointInterval = config.checkpointInterval;
+
+        handler().initialize(config.outputFormat);
+        basicMarketPacketProcessor_t::initialize(config.symbolFilter);
     }
 
     const std::optional<failReason_t> &marketPacketProcessor_t::processNextPacket(const std::optional<size_t> &numPacketsToProcess)
     {
-        resetPerRunVariables(numPacketsToProcess);
-
-        runStateMachine();
+        if (!m_checkpointPath.has_value())
+        {
+            return basicMarketPacketProcessor_t::processNextPacket(numPacketsToProcess);
+        }
 
-        return m_failReason;
-    }
+        m_checkpointFailReason.reset();
 
-    void marketPacketProcessor_t::runStateMachine()
-    {
-        while (!m_failReason.has_value())
+        // Stop at every checkpoint along the way. Each run ends with a flush, so the output lines up with the input
+        std::optional<size_t> packetsLeft = numPacketsToProcess;
+        while (true)
         {
-            switch (m_state)
-            {
+            size_t packetsToCheckpoint = m_checkpointInterval - packetNum() % m_checkpointInterval;
+            size_t packetsThisRun = std::min(packetsLeft.value_or(packetsToCheckpoint), packetsToCheckpoint);
 
-            case state_t::UNINITIALIZED:
-            {
-                uninitialized();
-                m_state = state_t::CHECK_STREAM_VALIDITY;
-                break;
-            }
+            const auto &failReason = basicMarketPacketProcessor_t::processNextPacket(packetsThisRun);
 
-            case state_t::CHECK_STREAM_VALIDITY:
+            // Running out of input happens between packets, so that's worth a checkpoint too.
+            // Anything else could have stopped halfway through a packet, with some of its output already gone out
+            bool isCheckpoint = failReason.has_value() ? failReason.value() == END_OF_FILE
+                                                       : packetNum() % m_checkpointInterval == 0;
+            if (isCheckpoint)
             {
-                if (m_numPacketsToProcess.has_value() && m_numPacketsProcessed == m_numPacketsToProcess.value())
+                const auto &checkpointFailReason = writeCheckpoint();
+                if (checkpointFailReason.has_value())
                 {
-                    // This is our stopping condition
-                    return;
+                    m_checkpointFailReason.emplace(checkpointFailReason.value());
+                    return m_checkpointFailReason;
                 }
-
-                checkStreamValidity();
-                m_state = state_t::READ_HEADER;
-                break;
             }
 
-            case state_t::READ_HEADER:
+            if (failReason.has_value())
             {
-                readHeader();
-                m_state = state_t::READ_PART_BODY;
-                break;
+                return failReason;
             }
 
-            case state_t::READ_PART_BODY:
+            if (packetsLeft.has_value())
             {
-                readPartBody();
-                m_state = state_t::WRITE_UPDATES;
-                break;
-            }
-
-            case state_t::WRITE_UPDATES:
-            {
-                writeUpdates();
-
-                if (doneWithPacket())
+                packetsLeft.value() -= packetsThisRun;
+                if (packetsLeft.value() == 0)
                 {
-                    m_numPacketsProcessed++;
-                    m_state = state_t::CHECK_STREAM_VALIDITY;
-                    break;
+                    return failReason;
                 }
-
-                // If we're not done with the packet yet, go and read some more
-                m_state = state_t::READ_PART_BODY;
-                break;
-            }
-
-            default:
-            {
-                assert(false);
-                m_failReason.emplace(INVALID_STATE);
-                return;
-            }
             }
         }
     }
 
-    void marketPacketProcessor_t::uninitialized()
+    std::optional<failReason_t> marketPacketProcessor_t::resumeFromCheckpoint()
     {
-        m_failReason.emplace(UNINITIALIZED);
-        return;
-    }
-
-    void marketPacketProcessor_t::checkStreamValidity()
-    {
-        // Don't process, just return early
-        if (!m_inputStream.is_open())
-        {
-            m_failReason.emplace(INPUT_STREAM_CLOSED);
-            return;
-        }
-
-        // Do a quick peek to set flags if we're at the end of a file
-        m_inputStream.peek();
-        if (!m_inputStream.good())
-        {
-            if (m_inputStream.eof())
-            {
-                m_failReason.emplace(END_OF_FILE);
-            }
-            else
-            {
-                m_failReason.emplace(BAD_STREAM);
-            }
-            return;
-        }
-    }
-
-    void marketPacketProcessor_t::readHeader()
-    {
-        // Assume it's a packet header
-        if (!(m_inputStream.read(reinterpret_cast<char *>(&m_packetHeader), PACKET_HEADER_SIZE)))
-        {
-            m_failReason.emplace(PACKET_HEADER_READ_FAILED);
-            return;
-        }
-
-        // Probably not a good thing
-        if (m_packetHeader.packetLength < PACKET_HEADER_SIZE)
+        if (!isInitialized())
         {
-            m_failReason.emplace(PACKET_HEADER_POORLY_FORMED);
-            return;
+            return UNINITIALIZED;
         }
 
-        // Reset our state info now that we know about the header
-        resetPerPacketVariables();
-    }
-
-    void marketPacketProcessor_t::readPartBody()
-    {
-        // Figure out how much of the buffer we need to use
-        size_t bytesLeft = m_bodySize - m_bodyBytesInterpreted;
-        size_t validDataInBuffer = (bytesLeft < READ_BUFFER_SIZE) ? bytesLeft : READ_BUFFER_SIZE;
-
-        // Read what needs to be read
-        if (!(m_inputStream.read(reinterpret_cast<char *>(m_readBuffer.data()), validDataInBuffer)).good())
+        if (!m_checkpointPath.has_value())
         {
-            m_failReason.emplace(PACKET_READ_FAILED);
-            return;
+            return CHECKPOINT_READ_FAILED;
         }
 
-        // Read the buffer until we run out of material
-        // A few tricks here because we know READ_BUFFER_SIZE % UPDATE_SIZE = 0
-        size_t bufferOffset = 0;
-        while (bufferOffset < validDataInBuffer)
+        // Never got as far as the first checkpoint, so start from the top
+        processorCheckpoint_t checkpoint{};
+        if (std::filesystem::exists(m_checkpointPath.value()))
         {
-            const std::byte *currBufferPos = m_readBuffer.data() + bufferOffset;
-            const updateHeader_t *uh = reinterpret_cast<const updateHeader_t *>(currBufferPos);
-            if (!isUpdateValid(uh))
-            {
-                m_failReason.emplace(UPDATE_POORLY_FORMED);
-                return;
-            }
-
-            // Mark down we've 'read' an update of somesort
-            bufferOffset += uh->length;
-            m_bodyBytesInterpreted += uh->length;
-            m_numUpdatesRead++;
-
-            switch (uh->type)
-            {
-            case updateType_e::TRADE:
-            {
-                // Just mark down where the trade update is for now
-                m_tradeLocs.emplace_back(currBufferPos);
-                break;
-            }
-
-            case updateType_e::QUOTE:
-            {
-                // Currently, we don't care about quotes. We could though
-                break;
-            }
-
-            default:
+            const auto &failReason = loadCheckpoint(m_checkpointPath.value(), checkpoint);
+            if (failReason.has_value())
             {
-                // You really shouldn't be able to get here
-                assert(false);
-                m_failReason.emplace(UPDATE_POORLY_FORMED);
-                return;
-            }
+                return failReason;
             }
         }
-    }
 
-    void marketPacketProcessor_t::writeUpdates()
-    {
-        // Take all the ptrs we know about and write the information to the output stream
-        for (const std::byte *tradePtr : m_tradeLocs)
+        size_t oldInputOffset = inputOffset();
+        size_t oldPacketNum = packetNum();
+
+        const auto &failReason = seekToOffset(checkpoint.inputOffset, checkpoint.packetNum);
+        if (failReason.has_value())
         {
-            appendTradePtrToStream(reinterpret_cast<const trade_t *>(tradePtr));
+            return failReason;
         }
 
-        m_tradeLocs.clear();
-    }
-
-    bool marketPacketProcessor_t::doneWithPacket()
-    {
-        return m_numUpdatesRead == m_numUpdatesPacket;
-    }
-
-    void marketPacketProcessor_t::resetPerRunVariables(const std::optional<size_t> &numPacketsToProcess)
-    {
-        m_numPacketsToProcess = numPacketsToProcess;
-        m_numPacketsProcessed = 0;
-    }
-
-    void marketPacketProcessor_t::resetPerPacketVariables()
-    {
-        m_numUpdatesPacket = m_packetHeader.numMarketUpdates;
-        m_numUpdatesRead = 0;
-
-        m_bodySize = m_packetHeader.packetLength - PACKET_HEADER_SIZE;
-        m_bodyBytesInterpreted = 0;
-    }
-
-    bool marketPacketProcessor_t::isUpdateValid(const updateHeader_t * uh)
-    {
-        // Is both the length and type something we'd expect?
-        if (uh->length == UPDATE_SIZE && (uh->type == updateType_e::TRADE || uh->type == updateType_e::QUOTE))
+        if (!handler().truncateTo(checkpoint.outputOffset))
         {
-            return true;
+            // Input and output have to move together, so put the input back
+            seekToOffset(oldInputOffset, oldPacketNum);
+            return OUTPUT_RESUME_FAILED;
         }
 
-        return false;
+        return std::nullopt;
     }
 
-    /**
-     * std::format (C++20) would do a lot better here if it was available
-     */
-    void marketPacketProcessor_t::appendTradePtrToStream(const trade_t *t)
+    std::optional<failReason_t> marketPacketProcessor_t::writeCheckpoint()
     {
-        // We're relying that the outputStream knows how to buffer it's own writes
-        m_outputStream << generateTradeString(t) << '\n';
-
-        // This is just a weird case
-        if (!m_outputStream.good())
+        // The checkpoint can't claim output that a power cut would take back
+        if (!handler().sync())
         {
-            m_failReason.emplace(TRADE_WRITE_FAILED);
+            return CHECKPOINT_WRITE_FAILED;
         }
+
+        return saveCheckpoint(m_checkpointPath.value(), {inputOffset(), packetNum(), handler().bytesWritten()});
     }
 };
@@ -1,46 +1,102 @@
 #pragma once
 
 #include <array>
+#include <assert.h>
+#include <cstring>
 #include <fstream>
 #include <iostream>
 #include <memory>
 #include <optional>
-#include <vector>
+#include <string>
+#include <type_traits>
 
 #include "marketPacketHelpers/marketPacketHelpers.h"
+#include "inputSource.h"
+#include "outputSink.h"
+#include "packetDecode.h"
+#include "packetIndex.h"
+#include "processorCheckpoint.h"
+#include "processorStats.h"
+#include "symbolFilter.h"
+#include "tradeOutput.h"
+#include "updateKernels.h"
 
 namespace marketPacket
 {
     /**
-     * Processes input stream one packet at a time and translates to output stream
+     * @brief Knobs for how a processor behaves. Defaults give you the classic behavior
+     */
+    struct processorConfig_t
+    {
+        outputFormat_e outputFormat = outputFormat_e::TEXT;  // What the output sink sees
+        std::shared_ptr<const symbolFilter_t> symbolFilter; // If set, only trades for these symbols get written out
+
+        std::optional<std::string> checkpointPath;                        // If set, where progress gets saved every so often
+        size_t checkpointInterval = DEFAULT_PROCESSOR_CHECKPOINT_INTERVAL; // How many packets between checkpoints
+    };
+
+    /**
+     * Processes input stream one packet at a time and hands every update straight to a handler, as it's decoded.
+     *
+     * The handler is a template parameter, so every call into it is known at compile time and can get inlined into
+     * the decode loop. A handler is anything with some of:
+     *
+     *  void onTrade(const trade_t &t);                 // Every valid trade, in order
+     *  void onQuote(const quote_t &q);                 // Every valid quote, in order
+     *  void onPacketBegin(const packetHeader_t &ph);   // Before any of a packet's updates
+     *  ? onPacketEnd();                                // After a packet's updates, even if the packet got cut short
+     *  ? onFlush();                                    // Every time processNextPacket() is about to return
+     *
+     * Only onTrade() or onQuote() is required. Whatever a handler doesn't have just doesn't get called, and if it
+     * doesn't care about quotes (or trades), the decode loop doesn't even walk over them.
+     * onPacketEnd() and onFlush() can return either void or std::optional<failReason_t>, to stop the processor
+     *
+     * Given a symbol filter, updates for anything not in it get thrown out as each chunk is validated, so the handler
+     * never even sees them
+     *
+     * Built with stats on (see processorStats.h), every state machine state gets timed in TSC cycles, so stats() can
+     * tell you if a slow run is stuck reading or stuck in the handler
+     *
+     * @tparam handler_t What gets the decoded updates
      */
-    class marketPacketProcessor_t
+    template <typename handler_t>
+    class basicMarketPacketProcessor_t
     {
     public:
         /**
-         * @brief Construct a new marketPacketProcessor_t object
+         * @brief Construct a new basicMarketPacketProcessor_t object
          *
-         * @param iStream   Input stream, where we get our data from
-         * @param oStream   Output stream, where to write the interpreted updates
+         * @param inputSource   Where we get our data from
+         * @param handler       What gets the decoded updates
          */
-        marketPacketProcessor_t(std::ifstream&& iStream, std::ofstream&& oStream)
+        basicMarketPacketProcessor_t(std::unique_ptr<inputSource_t> &&inputSource, handler_t &&handler = handler_t())
             : m_state(state_t::UNINITIALIZED),
               m_failReason(),
+              m_numPacketsProcessed(),
               m_numPacketsToProcess(),
+              m_inputOffset(),
+              m_packetNum(),
               m_bodySize(),
               m_bodyBytesInterpreted(),
               m_numUpdatesPacket(),
               m_numUpdatesRead(),
+              m_isPacketOpen(false),
               m_packetHeader(),
-              m_readBuffer(),
-              m_tradeLocs(),
-              m_inputStream(std::move(iStream)),
-              m_outputStream(std::move(oStream)){};
+              m_tradeMask(),
+              m_symbolMask(),
+              m_symbolFilter(),
+              m_chunk(),
+              m_numUpdatesInChunk(),
+              m_inputSource(std::move(inputSource)),
+              m_handler(std::move(handler)),
+              m_stats(){};
 
         /**
          * @brief Sets up the processor for use. Processor won't work unless this is called
+         *
+         * @param symbolFilter If set, only updates for these symbols make it to the handler
          */
-        void initialize();
+        void initialize(std::shared_ptr<const symbolFilter_t> symbolFilter = nullptr);
 
         /**
          * @brief If available, processes the next packet in the input stream.
@@ -49,7 +105,61 @@ namespace marketPacket
          */
         const std::optional<failReason_t> &processNextPacket(const std::optional<size_t> &numPacketsToProcess = std::nullopt);
 
+        /**
+         * @brief Jumps to the start of a packet, so the next processNextPacket() picks up from there
+         *
+         *  Works forwards or backwards, and gets a processor that's hit the end of the input (or a bad packet) going again
+         *
+         * @param index     Index built from the capture we're reading
+         * @param packetNum Which packet, counting from 0
+         * @return If we couldn't get there, why. The processor is left where it was
+         */
+        std::optional<failReason_t> seekToPacket(const packetIndex_t &index, size_t packetNum);
+
+        /**
+         * @brief Where the next packet starts in the input. Only moves once a whole packet's been handled
+         */
+        size_t inputOffset() const { return m_inputOffset; }
+
+        /**
+         * @brief Which packet is up next, counting from 0 at the start of the input
+         */
+        size_t packetNum() const { return m_packetNum; }
+
+        /**
+         * @brief Whatever's been getting our updates
+         */
+        handler_t &handler() { return m_handler; }
+        const handler_t &handler() const { return m_handler; }
+
+        /**
+         * @brief Snapshot of per state cycles and packet / update / byte counts since construction (or resetStats())
+         *
+         *  Empty, with isEnabled false, unless the build has stats turned on
+         */
+        processorStats_t stats() const { return m_stats.snapshot(); }
+        void resetStats() { m_stats.reset(); }
+
+    protected:
+        /**
+         * @brief If initialize() has been called
+         */
+        bool isInitialized() const { return m_state != state_t::UNINITIALIZED; }
+
+        /**
+         * @brief Jumps to a packet we already know the offset of, so the next processNextPacket() picks up from there
+         *
+         * @param offset    Where the packet's header starts in the input
+         * @param packetNum Which packet that is, counting from 0
+         * @return If we couldn't get there, why. The processor is left where it was
+         */
+        std::optional<failReason_t> seekToOffset(size_t offset, size_t packetNum);
+
     private:
+        static constexpr bool HANDLES_TRADES = requires(handler_t &h, const trade_t &t) { h.onTrade(t); };
+        static constexpr bool HANDLES_QUOTES = requires(handler_t &h, const quote_t &q) { h.onQuote(q); };
+        static_assert(HANDLES_TRADES || HANDLES_QUOTES, "A handler that doesn't take trades or quotes won't get anything");
+
         /**
          * @brief Possible states for a processor to be in
          */
@@ -61,7 +171,7 @@ namespace marketPacket
             CHECK_STREAM_VALIDITY,
             READ_HEADER,
             READ_PART_BODY,
-            WRITE_UPDATES
+            HANDLE_UPDATES
         };
 
         /**
@@ -69,10 +179,10 @@ namespace marketPacket
          */
         void runStateMachine();
         void uninitialized();       // Tells user processor isn't initialized
-        void checkStreamValidity(); // Makes sure input stream has data and can be read from
+        void checkStreamValidity(); // Makes sure input source has data and can be read from
         void readHeader();          // Reads in a header to get metadata about body and how to read it
-        void readPartBody();        // Buffered reads packet body
-        void writeUpdates();        // Takes buffered reads and interprets them to output stream as readable updates
+        void readPartBody();        // Buffered reads and validates the next chunk of the packet body
+        void handleUpdates();       // Hands every update in the chunk to the handler
 
         /**
          * @brief Checks conditions to see if we can move on from the current packet
@@ -81,14 +191,6 @@ namespace marketPacket
          */
         bool doneWithPacket();
 
-        /**
-         * @brief Checks if ptr points to something we'd consider a valid update
-         *
-         * @param updatePtr Ptr into read buffer on what we assume is the start to an update
-         * @return If the pointer points to a valid header update
-         */
-        bool isUpdateValid(const updateHeader_t * uh);
-
         /**
          * @brief Certain variables need to be reset per run and/or per packet
          */
@@ -96,28 +198,490 @@ namespace marketPacket
         void resetPerPacketVariables();
 
         /**
-         * @brief Outputs relevant information about trade to output stream
+         * @brief Lets the handler know the packet it's been getting updates for is over, if there is one
+         */
+        void endPacket();
+
+        /**
+         * @brief Hands every update in the chunk whose trade mask bit matches (and gets through the symbol filter) to onUpdate
          *
-         * @param t trade ptr
+         * @param wantTrades    If we're after trades (set bits) or quotes (clear bits)
+         * @param onUpdate      Gets a ptr to each update
          */
-        void appendTradePtrToStream(const trade_t *t);
+        template <typename onUpdate_t>
+        void forEachUpdate(bool wantTrades, onUpdate_t &&onUpdate);
+
+        /**
+         * @brief Calls a handler hook that might return a reason to stop, and stops if it does
+         */
+        template <typename hook_t>
+        void callStoppableHook(hook_t &&hook);
 
         state_t m_state;                          // Current state of processor
         std::optional<failReason_t> m_failReason; // If processNextPacket() returns false, the reason
 
         std::size_t m_numPacketsProcessed;           // In this run, how many packets have we seen so far
         std::optional<size_t> m_numPacketsToProcess; // If set, how many packets to try to read. Otherwise, go until failure
+        size_t m_inputOffset;                        // Where the next packet starts in the input
+        size_t m_packetNum;                          // Which packet is next, counting from the start of the input
 
         size_t m_bodySize;             // Size of the packet body
         size_t m_bodyBytesInterpreted; // Number of bytes in the body have been interpreted so far
         size_t m_numUpdatesPacket;     // Number of updates in this packet body
         size_t m_numUpdatesRead;       // Number of updates we've read so far
+        bool m_isPacketOpen;           // If the handler's been told a packet began, but not that it ended
 
         packetHeader_t m_packetHeader;                        // Packet header we read into
-        std::array<std::byte, READ_BUFFER_SIZE> m_readBuffer; // Where we read parts of the packet body into
-        std::vector<const std::byte *> m_tradeLocs;           // Locations, by ptr, of trades we need to interpret
+        std::array<uint64_t, TRADE_MASK_WORDS> m_tradeMask;   // Which updates in the current chunk are trades
+        std::array<uint64_t, TRADE_MASK_WORDS> m_symbolMask;  // Which updates in the current chunk got through the symbol filter
+        std::shared_ptr<const symbolFilter_t> m_symbolFilter; // If set, what updates have to get through
+        const std::byte *m_chunk;                             // Current chunk of the body, valid until the next read
+        size_t m_numUpdatesInChunk;                           // How many (already validated) updates are in the chunk
+
+        std::unique_ptr<inputSource_t> m_inputSource; // Where we read parts of the packet from
+        handler_t m_handler;                          // What gets the decoded updates
+
+        [[no_unique_address]] processorStatsRecorder_t<PROCESSOR_STATS_ENABLED> m_stats; // Per state cycles and counters, if they're built in
+    };
+
+    /**
+     * Processes input stream one packet at a time and translates to output stream
+     *
+     * Given a checkpoint path, every checkpoint interval packets the output gets flushed and where we are in the input
+     * and output gets saved. After a crash, resumeFromCheckpoint() puts both back to the last checkpoint, so a restart
+     * only redoes the packets since then instead of the whole capture
+     */
+    class marketPacketProcessor_t : public basicMarketPacketProcessor_t<tradeOutput_t>
+    {
+    public:
+        /**
+         * @brief Construct a new marketPacketProcessor_t object
+         *
+         * @param iStream   Input stream, where we get our data from
+         * @param oStream   Output stream, where to write the interpreted updates
+         */
+        marketPacketProcessor_t(std::ifstream&& iStream, std::ofstream&& oStream)
+            : marketPacketProcessor_t(std::make_unique<streamInputSource_t>(std::move(iStream)), std::move(oStream)){};
+
+        /**
+         * @brief Construct a new marketPacketProcessor_t object reading from any input backend
+         *
+         *  e.g. std::make_unique<mappedInputSource_t>(path) to decode a capture in place without copying it
+         *
+         * @param inputSource   Where we get our data from
+         * @param oStream       Output stream, where to write the interpreted updates
+         */
+        marketPacketProcessor_t(std::unique_ptr<inputSource_t>&& inputSource, std::ofstream&& oStream)
+            : marketPacketProcessor_t(std::move(inputSource), std::make_unique<streamOutputSink_t>(std::move(oStream))){};
+
+        /**
+         * @brief Construct a new marketPacketProcessor_t object with any input and output backend
+         *
+         *  e.g. std::make_unique<fdOutputSink_t>(path) to skip iostreams entirely on the way out
+         *
+         * @param inputSource   Where we get our data from
+         * @param outputSink    Where to write the interpreted updates
+         */
+        marketPacketProcessor_t(std::unique_ptr<inputSource_t>&& inputSource, std::unique_ptr<outputSink_t>&& outputSink)
+            : basicMarketPacketProcessor_t(std::move(inputSource), tradeOutput_t(std::move(outputSink))),
+              m_checkpointPath(),
+              m_checkpointInterval(),
+              m_checkpointFailReason(){};
+
+        /**
+         * @brief Sets up the processor for use. Processor won't work unless this is called
+         *
+         * @param config How the processor should behave
+         */
+        void initialize(const processorConfig_t &config = processorConfig_t());
+
+        /**
+         * @brief If available, processes the next packet in the input stream. Saves a checkpoint at every interval along the way
+         *
+         * @return If we didn't do any work, why
+         */
+        const std::optional<failReason_t> &processNextPacket(const std::optional<size_t> &numPacketsToProcess = std::nullopt);
+
+        /**
+         * @brief Puts the input and output back to where the last checkpoint left them, so processing picks up from there
+         *
+         *  Without a checkpoint on disk, that's the very start. Either way, any output past that point gets thrown away,
+         *  so the output sink has to be able to truncateTo() (e.g. fdOutputSink_t(path, false))
+         *
+         * @return If we couldn't, why. The processor is left where it was
+         */
+        std::optional<failReason_t> resumeFromCheckpoint();
+
+    private:
+        /**
+         * @brief Marks down where we are now. Only good right after a flush, at a packet boundary
+         */
+        std::optional<failReason_t> writeCheckpoint();
 
-        std::ifstream m_inputStream;  // Input stream
-        std::ofstream m_outputStream; // Output stream
+        std::optional<std::string> m_checkpointPath;        // If set, where checkpoints go
+        size_t m_checkpointInterval;                        // Packets between checkpoints
+        std::optional<failReason_t> m_checkpointFailReason; // If saving a checkpoint is why we stopped
     };
+
+    template <typename handler_t>
+    void basicMarketPacketProcessor_t<handler_t>::initialize(std::shared_ptr<const symbolFilter_t> symbolFilter)
+    {
+        // Make sure this only gets called once
+        if (m_state != state_t::UNINITIALIZED)
+        {
+            assert(false);
+            return;
+        }
+
+        m_symbolFilter = std::move(symbolFilter);
+        m_state = state_t::CHECK_STREAM_VALIDITY;
+    }
+
+    template <typename handler_t>
+    const std::optional<failReason_t> &basicMarketPacketProcessor_t<handler_t>::processNextPacket(const std::optional<size_t> &numPacketsToProcess)
+    {
+        resetPerRunVariables(numPacketsToProcess);
+
+        runStateMachine();
+
+        // If we bailed halfway through a packet, the handler still needs to hear it's over
+        endPacket();
+
+        // Don't leave anything sitting around in the handler between calls
+        if constexpr (requires { m_handler.onFlush(); })
+        {
+            callStoppableHook([this]
+                              { return m_handler.onFlush(); });
+        }
+
+        return m_failReason;
+    }
+
+    template <typename handler_t>
+    std::optional<failReason_t> basicMarketPacketProcessor_t<handler_t>::seekToPacket(const packetIndex_t &index, size_t packetNum)
+    {
+        if (m_state == state_t::UNINITIALIZED)
+        {
+            return UNINITIALIZED;
+        }
+
+        const auto &offset = index.packetOffset(packetNum);
+        if (!offset.has_value())
+        {
+            return PACKET_NOT_INDEXED;
+        }
+
+        return seekToOffset(offset.value(), packetNum);
+    }
+
+    template <typename handler_t>
+    std::optional<failReason_t> basicMarketPacketProcessor_t<handler_t>::seekToOffset(size_t offset, size_t packetNum)
+    {
+        if (m_state == state_t::UNINITIALIZED)
+        {
+            return UNINITIALIZED;
+        }
+
+        if (!m_inputSource->seek(offset))
+        {
+            return SEEK_FAILED;
+        }
+
+        // Whatever packet we were in the middle of got wrapped up when processNextPacket() returned,
+        // so all that's left is forgetting why we stopped
+        m_failReason.reset();
+        m_state = state_t::CHECK_STREAM_VALIDITY;
+
+        m_inputOffset = offset;
+        m_packetNum = packetNum;
+
+        return std::nullopt;
+    }
+
+    template <typename handler_t>
+    void basicMarketPacketProcessor_t<handler_t>::runStateMachine()
+    {
+        while (!m_failReason.has_value())
+        {
+            switch (m_state)
+            {
+
+            case state_t::UNINITIALIZED:
+            {
+                uninitialized();
+                m_state = state_t::CHECK_STREAM_VALIDITY;
+                break;
+            }
+
+            case state_t::CHECK_STREAM_VALIDITY:
+            {
+                if (m_numPacketsToProcess.has_value() && m_numPacketsProcessed == m_numPacketsToProcess.value())
+                {
+                    // This is our stopping condition
+                    return;
+                }
+
+                [[maybe_unused]] const auto &timer = m_stats.timeStage(processorStage_e::CHECK_STREAM_VALIDITY);
+                checkStreamValidity();
+                m_state = state_t::READ_HEADER;
+                break;
+            }
+
+            case state_t::READ_HEADER:
+            {
+                [[maybe_unused]] const auto &timer = m_stats.timeStage(processorStage_e::READ_HEADER);
+                readHeader();
+                m_state = state_t::READ_PART_BODY;
+                break;
+            }
+
+            case state_t::READ_PART_BODY:
+            {
+                [[maybe_unused]] const auto &timer = m_stats.timeStage(processorStage_e::READ_PART_BODY);
+                readPartBody();
+                m_state = state_t::HANDLE_UPDATES;
+                break;
+            }
+
+            case state_t::HANDLE_UPDATES:
+            {
+                [[maybe_unused]] const auto &timer = m_stats.timeStage(processorStage_e::HANDLE_UPDATES);
+                handleUpdates();
+
+                if (doneWithPacket())
+                {
+                    endPacket();
+                    m_numPacketsProcessed++;
+                    m_stats.countPacket();
+
+                    // Header and body are all the way in, so the next packet starts right after
+                    m_inputOffset += m_packetHeader.packetLength;
+                    m_packetNum++;
+                    m_state = state_t::CHECK_STREAM_VALIDITY;
+                    break;
+                }
+
+                // If we're not done with the packet yet, go and read some more
+                m_state = state_t::READ_PART_BODY;
+                break;
+            }
+
+            default:
+            {
+                assert(false);
+                m_failReason.emplace(INVALID_STATE);
+                return;
+            }
+            }
+        }
+    }
+
+    template <typename handler_t>
+    void basicMarketPacketProcessor_t<handler_t>::uninitialized()
+    {
+        m_failReason.emplace(UNINITIALIZED);
+        return;
+    }
+
+    template <typename handler_t>
+    void basicMarketPacketProcessor_t<handler_t>::checkStreamValidity()
+    {
+        const auto &failReason = m_inputSource->checkValidity();
+        if (failReason.has_value())
+        {
+            m_failReason.emplace(failReason.value());
+            return;
+        }
+    }
+
+    template <typename handler_t>
+    void basicMarketPacketProcessor_t<handler_t>::readHeader()
+    {
+        const auto &failReason = readPacketHeader(*m_inputSource, m_packetHeader);
+        if (failReason.has_value())
+        {
+            m_failReason.emplace(failReason.value());
+            return;
+        }
+        m_stats.countBytes(PACKET_HEADER_SIZE);
+
+        // Reset our state info now that we know about the header
+        resetPerPacketVariables();
+
+        m_isPacketOpen = true;
+        if constexpr (requires { m_handler.onPacketBegin(m_packetHeader); })
+        {
+            m_handler.onPacketBegin(m_packetHeader);
+        }
+    }
+
+    template <typename handler_t>
+    void basicMarketPacketProcessor_t<handler_t>::readPartBody()
+    {
+        // Figure out how much of the body we can take in one go
+        size_t bytesLeft = m_bodySize - m_bodyBytesInterpreted;
+        size_t maxReadSize = m_inputSource->maxReadSize();
+        size_t validDataInBuffer = (bytesLeft < maxReadSize) ? bytesLeft : maxReadSize;
+
+        // Read what needs to be read
+        const std::byte *readBuffer = m_inputSource->read(validDataInBuffer);
+        if (readBuffer == nullptr)
+        {
+            m_failReason.emplace(PACKET_READ_FAILED);
+            return;
+        }
+
+        const auto &failReason = decodeChunk(readBuffer, validDataInBuffer, m_symbolFilter.get(), m_tradeMask.data(), m_symbolMask.data());
+        if (failReason.has_value())
+        {
+            m_failReason.emplace(failReason.value());
+            return;
+        }
+
+        // Mark down we've 'read' the updates
+        size_t numUpdatesInBuffer = validDataInBuffer / UPDATE_SIZE;
+        m_bodyBytesInterpreted += validDataInBuffer;
+        m_numUpdatesRead += numUpdatesInBuffer;
+        m_stats.countBytes(validDataInBuffer);
+        m_stats.countUpdates(m_tradeMask.data(), numUpdatesInBuffer);
+
+        m_chunk = readBuffer;
+        m_numUpdatesInChunk = numUpdatesInBuffer;
+    }
+
+    template <typename handler_t>
+    void basicMarketPacketProcessor_t<handler_t>::handleUpdates()
+    {
+        // Only walk over what the handler actually wants. Both means walking the chunk in order so they interleave properly
+        if constexpr (HANDLES_TRADES && HANDLES_QUOTES)
+        {
+            auto onUpdate = [this](size_t updateIdx)
+            {
+                const std::byte *updatePtr = m_chunk + updateIdx * UPDATE_SIZE;
+                if ((m_tradeMask[updateIdx / 64] >> (updateIdx % 64)) & 1)
+                {
+                    m_handler.onTrade(*reinterpret_cast<const trade_t *>(updatePtr));
+                }
+                else
+                {
+                    m_handler.onQuote(*reinterpret_cast<const quote_t *>(updatePtr));
+                }
+            };
+
+            if (m_symbolFilter)
+            {
+                // Filtered chunks are mostly updates nobody wants, so only visit the ones that got through
+                for (size_t word = 0; word < (m_numUpdatesInChunk + 63) / 64; word++)
+                {
+                    for (uint64_t wanted = m_symbolMask[word]; wanted != 0; wanted &= wanted - 1)
+                    {
+                        onUpdate(word * 64 + __builtin_ctzll(wanted));
+                    }
+                }
+            }
+            else
+            {
+                for (size_t updateIdx = 0; updateIdx < m_numUpdatesInChunk; updateIdx++)
+                {
+                    onUpdate(updateIdx);
+                }
+            }
+        }
+        else if constexpr (HANDLES_TRADES)
+        {
+            forEachUpdate(true, [this](const std::byte *updatePtr)
+                          { m_handler.onTrade(*reinterpret_cast<const trade_t *>(updatePtr)); });
+        }
+        else
+        {
+            forEachUpdate(false, [this](const std::byte *updatePtr)
+                          { m_handler.onQuote(*reinterpret_cast<const quote_t *>(updatePtr)); });
+        }
+
+        m_numUpdatesInChunk = 0;
+    }
+
+    template <typename handler_t>
+    template <typename onUpdate_t>
+    void basicMarketPacketProcessor_t<handler_t>::forEachUpdate(bool wantTrades, onUpdate_t &&onUpdate)
+    {
+        for (size_t word = 0; word < (m_numUpdatesInChunk + 63) / 64; word++)
+        {
+            // Quotes are the clear bits, but anything past the end of the chunk is clear too
+            uint64_t wanted = wantTrades ? m_tradeMask[word] : ~m_tradeMask[word];
+            if (m_symbolFilter)
+            {
+                wanted &= m_symbolMask[word];
+            }
+            size_t updatesInWord = m_numUpdatesInChunk - word * 64;
+            if (updatesInWord < 64)
+            {
+                wanted &= (uint64_t(1) << updatesInWord) - 1;
+            }
+
+            for (; wanted != 0; wanted &= wanted - 1)
+            {
+                size_t updateIdx = word * 64 + __builtin_ctzll(wanted);
+                onUpdate(m_chunk + updateIdx * UPDATE_SIZE);
+            }
+        }
+    }
+
+    template <typename handler_t>
+    bool basicMarketPacketProcessor_t<handler_t>::doneWithPacket()
+    {
+        return m_numUpdatesRead == m_numUpdatesPacket;
+    }
+
+    template <typename handler_t>
+    void basicMarketPacketProcessor_t<handler_t>::resetPerRunVariables(const std::optional<size_t> &numPacketsToProcess)
+    {
+        m_numPacketsToProcess = numPacketsToProcess;
+        m_numPacketsProcessed = 0;
+    }
+
+    template <typename handler_t>
+    void basicMarketPacketProcessor_t<handler_t>::resetPerPacketVariables()
+    {
+        m_numUpdatesPacket = m_packetHeader.numMarketUpdates;
+        m_numUpdatesRead = 0;
+
+        m_bodySize = m_packetHeader.packetLength - PACKET_HEADER_SIZE;
+        m_bodyBytesInterpreted = 0;
+    }
+
+    template <typename handler_t>
+    void basicMarketPacketProcessor_t<handler_t>::endPacket()
+    {
+        if (!m_isPacketOpen)
+        {
+            return;
+        }
+        m_isPacketOpen = false;
+
+        if constexpr (requires { m_handler.onPacketEnd(); })
+        {
+            callStoppableHook([this]
+                              { return m_handler.onPacketEnd(); });
+        }
+    }
+
+    template <typename handler_t>
+    template <typename hook_t>
+    void basicMarketPacketProcessor_t<handler_t>::callStoppableHook(hook_t &&hook)
+    {
+        if constexpr (std::is_void_v<decltype(hook())>)
+        {
+            hook();
+        }
+        else
+        {
+            // First reason we stopped is the one that sticks
+            const std::optional<failReason_t> &failReason = hook();
+            if (failReason.has_value() && !m_failReason.has_value())
+            {
+                m_failReason.emplace(failReason.value());
+            }
+        }
+    }
 };
@@ -0,0 +1,253 @@
+#include "multiStreamProcessor.h"
+
+#include <array>
+#include <assert.h>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+namespace marketPacket
+{
+    // Most ready streams we hear about per epoll_wait(). Anything past this just shows up next time around
+    constexpr const size_t MAX_EPOLL_EVENTS = 64;
+
+    multiStreamProcessor_t::~multiStreamProcessor_t()
+    {
+        for (auto &stream : m_streams)
+        {
+            if (stream->fd >= 0)
+            {
+                ::close(stream->fd);
+            }
+        }
+
+        if (m_epollFd >= 0)
+        {
+            ::close(m_epollFd);
+        }
+    }
+
+    void multiStreamProcessor_t::initialize(const multiStreamConfig_t &config)
+    {
+        // Make sure this only gets called once
+        if (m_isInitialized)
+        {
+            assert(false);
+            return;
+        }
+
+        m_config = config;
+        m_epollFd = ::epoll_create1(EPOLL_CLOEXEC);
+        if (m_epollFd < 0)
+        {
+            m_failReason.emplace(EPOLL_FAILED);
+        }
+
+        m_isInitialized = true;
+    }
+
+    std::optional<size_t> multiStreamProcessor_t::addStream(int fd, std::unique_ptr<outputSink_t> &&outputSink)
+    {
+        if (fd < 0)
+        {
+            return std::nullopt;
+        }
+
+        // Either way, the fd's ours now
+        int flags = ::fcntl(fd, F_GETFL);
+        if (!m_isInitialized || m_epollFd < 0 || flags < 0 || ::fcntl(fd, F_SETFL, flags | O_NONBLOCK) != 0)
+        {
+            ::close(fd);
+            return std::nullopt;
+        }
+
+        size_t streamIdx = m_streams.size();
+
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.u64 = streamIdx;
+
+        bool isPolled = true;
+        if (::epoll_ctl(m_epollFd, EPOLL_CTL_ADD, fd, &event) != 0)
+        {
+            // Regular files always read as ready, so epoll won't take them. We'll just keep reading them instead
+            if (errno != EPERM)
+            {
+                ::close(fd);
+                return std::nullopt;
+            }
+            isPolled = false;
+        }
+
+        auto stream = std::make_unique<stream_t>();
+        auto inputSource = std::make_unique<bufferedInputSource_t>();
+
+        stream->fd = fd;
+        stream->isPolled = isPolled;
+        stream->inputSource = inputSource.get();
+        stream->processor = std::make_unique<marketPacketProcessor_t>(std::move(inputSource), std::move(outputSink));
+        stream->processor->initialize(m_config.processorConfig);
+
+        m_streams.push_back(std::move(stream));
+        m_numOpenStreams++;
+
+        return streamIdx;
+    }
+
+    std::optional<size_t> multiStreamProcessor_t::addStream(const std::string &path, std::unique_ptr<outputSink_t> &&outputSink)
+    {
+        // Opening a FIFO waits on a writer here, otherwise we'd read an end of file before anybody showed up
+        return addStream(::open(path.c_str(), O_RDONLY | O_CLOEXEC), std::move(outputSink));
+    }
+
+    const std::optional<failReason_t> &multiStreamProcessor_t::processAllStreams()
+    {
+        // Already been through the streams, or never will be
+        if (m_failReason.has_value())
+        {
+            return m_failReason;
+        }
+
+        if (!m_isInitialized)
+        {
+            m_failReason.emplace(UNINITIALIZED);
+            return m_failReason;
+        }
+
+        std::array<epoll_event, MAX_EPOLL_EVENTS> events;
+        while (m_numOpenStreams > 0)
+        {
+            // Don't sleep on epoll if there's a file we could be reading
+            bool hasUnpolledStreams = false;
+            for (auto &stream : m_streams)
+            {
+                hasUnpolledStreams |= (stream->fd >= 0 && !stream->isPolled);
+            }
+
+            int numEvents = ::epoll_wait(m_epollFd, events.data(), events.size(), hasUnpolledStreams ? 0 : -1);
+            if (numEvents < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+
+                m_failReason.emplace(EPOLL_FAILED);
+                return m_failReason;
+            }
+
+            for (int eventIdx = 0; eventIdx < numEvents; eventIdx++)
+            {
+                serviceStream(*m_streams[events[eventIdx].data.u64]);
+            }
+
+            if (hasUnpolledStreams)
+            {
+                for (auto &stream : m_streams)
+                {
+                    if (!stream->isPolled)
+                    {
+                        serviceStream(*stream);
+                    }
+                }
+            }
+        }
+
+        m_failReason.emplace(END_OF_FILE);
+        return m_failReason;
+    }
+
+    void multiStreamProcessor_t::serviceStream(stream_t &stream)
+    {
+        // Already done with this one
+        if (stream.fd < 0)
+        {
+            return;
+        }
+
+        std::byte *dst = stream.inputSource->prepareAppend(m_config.readSize);
+        ssize_t bytesRead = ::read(stream.fd, dst, m_config.readSize);
+        if (bytesRead < 0)
+        {
+            // Spurious wakeup, epoll will let us know when there's really something
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+            {
+                return;
+            }
+
+            closeStream(stream, BAD_STREAM);
+            return;
+        }
+
+        if (bytesRead == 0)
+        {
+            // Nothing more is coming, so whatever's left gets processed like the end of any other input
+            stream.inputSource->markEndOfInput();
+            processPackets(stream, std::nullopt);
+            return;
+        }
+
+        stream.inputSource->commitAppend(bytesRead);
+        processPackets(stream, countWholePackets(stream));
+    }
+
+    std::optional<size_t> multiStreamProcessor_t::countWholePackets(const stream_t &stream) const
+    {
+        const std::byte *data = stream.inputSource->unreadData();
+        size_t size = stream.inputSource->unreadSize();
+
+        size_t numPackets = 0;
+        size_t offset = 0;
+        while (size - offset >= PACKET_HEADER_SIZE)
+        {
+            packetHeader_t ph;
+            std::memcpy(&ph, data + offset, PACKET_HEADER_SIZE);
+
+            // Garbage. Let the processor go at it so it fails exactly like it would have anyway
+            if (ph.packetLength < PACKET_HEADER_SIZE)
+            {
+                return std::nullopt;
+            }
+
+            // Rest of it hasn't shown up yet
+            if (size - offset < ph.packetLength)
+            {
+                break;
+            }
+
+            offset += ph.packetLength;
+            numPackets++;
+        }
+
+        return numPackets;
+    }
+
+    void multiStreamProcessor_t::processPackets(stream_t &stream, const std::optional<size_t> &numPackets)
+    {
+        if (numPackets.has_value() && numPackets.value() == 0)
+        {
+            return;
+        }
+
+        const std::optional<failReason_t> &failReason = stream.processor->processNextPacket(numPackets);
+        if (failReason.has_value())
+        {
+            closeStream(stream, failReason.value());
+        }
+    }
+
+    void multiStreamProcessor_t::closeStream(stream_t &stream, failReason_t failReason)
+    {
+        if (stream.isPolled)
+        {
+            ::epoll_ctl(m_epollFd, EPOLL_CTL_DEL, stream.fd, nullptr);
+        }
+        ::close(stream.fd);
+        stream.fd = -1;
+
+        stream.failReason.emplace(failReason);
+        m_numOpenStreams--;
+    }
+};
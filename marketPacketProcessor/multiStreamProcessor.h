@@ -0,0 +1,136 @@
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "marketPacketHelpers/marketPacketHelpers.h"
+#include "inputSource.h"
+#include "marketPacketProcessor.h"
+#include "outputSink.h"
+
+namespace marketPacket
+{
+    /**
+     * @brief Knobs for how a multi stream processor behaves
+     */
+    struct multiStreamConfig_t
+    {
+        processorConfig_t processorConfig; // How each stream's processor behaves
+        size_t readSize = 64 * 1024;       // Most we read off a stream each time it's ready, so one busy stream can't starve the rest
+    };
+
+    /**
+     * Processes many streams (files, pipes, sockets, ...) on one thread.
+     *
+     * Every stream gets its own marketPacketProcessor_t fed by a bufferedInputSource_t. An epoll loop waits for any of
+     * them to have data, reads what's there without blocking, and lets the stream's processor loose on however many
+     * whole packets have shown up. A stream that's waiting on the rest of a packet just sits there until more arrives.
+     *
+     * Regular files can't be waited on with epoll, but they never block either, so they get read from every time
+     * around the loop. Each stream's output is exactly what a processor reading it start to finish would have written
+     */
+    class multiStreamProcessor_t
+    {
+    public:
+        /**
+         * @brief Construct a new multiStreamProcessor_t object
+         */
+        multiStreamProcessor_t()
+            : m_isInitialized(false),
+              m_config(),
+              m_failReason(),
+              m_epollFd(-1),
+              m_streams(),
+              m_numOpenStreams(0){};
+        ~multiStreamProcessor_t();
+
+        // We own fds, so no copying them around
+        multiStreamProcessor_t(const multiStreamProcessor_t &) = delete;
+        multiStreamProcessor_t &operator=(const multiStreamProcessor_t &) = delete;
+
+        /**
+         * @brief Sets up the processor for use. Processor won't work unless this is called
+         *
+         * @param config How to read streams and how each stream's processor should behave
+         */
+        void initialize(const multiStreamConfig_t &config = multiStreamConfig_t());
+
+        /**
+         * @brief Adds a stream to process. We take the fd over and close it once the stream's done
+         *
+         *  NOTE: A stream that fails gets closed right away, so whoever's writing to it can get an EPIPE (or SIGPIPE)
+         *
+         * @param fd            Anything we can read() from. Gets switched to non-blocking
+         * @param outputSink    Where to write the stream's interpreted updates
+         * @return Stream's index, nothing if we couldn't add it
+         */
+        std::optional<size_t> addStream(int fd, std::unique_ptr<outputSink_t> &&outputSink);
+
+        /**
+         * @brief Opens a path (file, FIFO, ...) and adds it as a stream
+         */
+        std::optional<size_t> addStream(const std::string &path, std::unique_ptr<outputSink_t> &&outputSink);
+
+        /**
+         * @brief Processes every stream until they've all ended or failed
+         *
+         * @return Why we stopped. END_OF_FILE once every stream is done, however each of them ended up
+         */
+        const std::optional<failReason_t> &processAllStreams();
+
+        /**
+         * @brief Why a stream stopped. Nothing if it hasn't yet
+         */
+        const std::optional<failReason_t> &streamFailReason(size_t streamIdx) const { return m_streams[streamIdx]->failReason; }
+
+        /**
+         * @brief How many streams have been added
+         */
+        size_t numStreams() const { return m_streams.size(); }
+
+    private:
+        /**
+         * @brief Everything about one stream
+         */
+        struct stream_t
+        {
+            int fd = -1;                                        // Where the bytes come from. -1 once we've closed it
+            bool isPolled = false;                              // If epoll is watching it. Regular files can't be
+            bufferedInputSource_t *inputSource = nullptr;       // Owned by the processor, we push bytes in through here
+            std::unique_ptr<marketPacketProcessor_t> processor; // Decodes the stream
+            std::optional<failReason_t> failReason;             // Why the stream stopped
+        };
+
+        /**
+         * @brief Reads whatever's ready off a stream and processes every whole packet that's shown up
+         */
+        void serviceStream(stream_t &stream);
+
+        /**
+         * @brief Counts how many whole packets are sitting in a stream's buffer
+         *
+         * @return Nothing if there's a header in there a processor would choke on
+         */
+        std::optional<size_t> countWholePackets(const stream_t &stream) const;
+
+        /**
+         * @brief Runs a stream's processor over some packets. Nothing means everything that's left
+         */
+        void processPackets(stream_t &stream, const std::optional<size_t> &numPackets);
+
+        /**
+         * @brief Stops watching a stream, closes it, and marks down why
+         */
+        void closeStream(stream_t &stream, failReason_t failReason);
+
+        bool m_isInitialized;                     // If initialize() has been called
+        multiStreamConfig_t m_config;             // How we were asked to behave
+        std::optional<failReason_t> m_failReason; // Why we stopped
+
+        int m_epollFd;                                    // Waits on every stream that can be waited on
+        std::vector<std::unique_ptr<stream_t>> m_streams; // Every stream, by index
+        size_t m_numOpenStreams;                          // Streams that haven't stopped yet
+    };
+};
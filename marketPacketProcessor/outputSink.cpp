@@ -0,0 +1,101 @@
+#include "outputSink.h"
+
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace marketPacket
+{
+    bool streamOutputSink_t::write(const char *data, size_t numBytes)
+    {
+        return m_outputStream.write(data, numBytes).good();
+    }
+
+    bool streamOutputSink_t::sync()
+    {
+        return m_outputStream.flush().good();
+    }
+
+    fdOutputSink_t::fdOutputSink_t(const std::string &path, bool truncate)
+        : m_fd(::open(path.c_str(), O_WRONLY | O_CREAT | (truncate ? O_TRUNC : 0), 0644)),
+          m_ownsFd(true)
+    {
+    }
+
+    fdOutputSink_t::~fdOutputSink_t()
+    {
+        if (m_ownsFd && m_fd >= 0)
+        {
+            ::close(m_fd);
+        }
+    }
+
+    bool fdOutputSink_t::write(const char *data, size_t numBytes)
+    {
+        if (m_fd < 0)
+        {
+            return false;
+        }
+
+        // write(2) is allowed to come up short, especially on pipes and sockets
+        while (numBytes > 0)
+        {
+            ssize_t written = ::write(m_fd, data, numBytes);
+            if (written < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                return false;
+            }
+
+            data += written;
+            numBytes -= written;
+        }
+
+        return true;
+    }
+
+    bool fdOutputSink_t::truncateTo(size_t size)
+    {
+        // Pipes and sockets can't take back what's already gone out, and a file that's shorter than that never had it
+        struct stat fileStat;
+        if (m_fd < 0 || ::fstat(m_fd, &fileStat) != 0 || !S_ISREG(fileStat.st_mode) || static_cast<size_t>(fileStat.st_size) < size)
+        {
+            return false;
+        }
+
+        return ::ftruncate(m_fd, size) == 0 && ::lseek(m_fd, size, SEEK_SET) == static_cast<off_t>(size);
+    }
+
+    bool fdOutputSink_t::sync()
+    {
+        struct stat fileStat;
+        if (m_fd < 0 || ::fstat(m_fd, &fileStat) != 0)
+        {
+            return false;
+        }
+
+        // Pipes and sockets have nothing on disk to sync
+        return !S_ISREG(fileStat.st_mode) || ::fdatasync(m_fd) == 0;
+    }
+
+    bool memoryOutputSink_t::write(const char *data, size_t numBytes)
+    {
+        m_output.append(data, numBytes);
+        return true;
+    }
+
+    bool memoryOutputSink_t::truncateTo(size_t size)
+    {
+        if (size > m_output.size())
+        {
+            return false;
+        }
+
+        m_output.resize(size);
+        return true;
+    }
+};
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <fstream>
+#include <string>
+
+#include "marketPacketHelpers/marketPacketHelpers.h"
+
+namespace marketPacket
+{
+    /**
+     * Where a processor dumps its batched output.
+     *
+     * Processors format into their own big buffer and only hand it over here when it fills up,
+     * so a sink sees few, large writes
+     */
+    class outputSink_t
+    {
+    public:
+        virtual ~outputSink_t() = default;
+
+        /**
+         * @brief Writes all of data out
+         *
+         * @return False if we couldn't get it all out
+         */
+        virtual bool write(const char *data, size_t numBytes) = 0;
+
+        /**
+         * @brief Throws away everything past the first size bytes of output, and carries on writing from there
+         *
+         *  By default, sinks can't. Anything backed by a file or memory should be able to
+         *
+         * @param size How much of the output to keep
+         * @return False if we couldn't
+         */
+        virtual bool truncateTo(size_t /*size*/) { return false; }
+
+        /**
+         * @brief Makes sure everything written so far would survive the machine going down, not just the process
+         *
+         *  By default, there's nowhere more durable for it to go (memory, pipes, sockets). Anything backed by a file should push it to disk
+         *
+         * @return False if we couldn't
+         */
+        virtual bool sync() { return true; }
+    };
+
+    /**
+     * Writes through an ofstream
+     */
+    class streamOutputSink_t : public outputSink_t
+    {
+    public:
+        /**
+         * @brief Construct a new streamOutputSink_t object
+         *
+         * @param oStream Stream we'll be writing to
+         */
+        streamOutputSink_t(std::ofstream &&oStream)
+            : m_outputStream(std::move(oStream)){};
+
+        bool write(const char *data, size_t numBytes) override;
+
+        /**
+         * @brief Flushes the stream. ofstream has no way to get at the descriptor, so that's as far as it goes
+         */
+        bool sync() override;
+
+    private:
+        std::ofstream m_outputStream; // Output stream
+    };
+
+    /**
+     * Plain write(2) calls on a file descriptor, no extra layer of buffering in between
+     */
+    class fdOutputSink_t : public outputSink_t
+    {
+    public:
+        /**
+         * @brief Opens a file to write to
+         *
+         * @param path      File to write to. If we can't open it, every write fails
+         * @param truncate  If whatever's already in the file goes. Keep it to truncateTo() a checkpoint instead
+         */
+        fdOutputSink_t(const std::string &path, bool truncate = true);
+
+        /**
+         * @brief Writes to an already open descriptor (pipe, socket, etc.)
+         *
+         * @param fd        Descriptor to write to
+         * @param ownsFd    If we should close it when we're done
+         */
+        fdOutputSink_t(int fd, bool ownsFd)
+            : m_fd(fd),
+              m_ownsFd(ownsFd){};
+
+        ~fdOutputSink_t() override;
+
+        // We (might) own the descriptor, so no copying it around
+        fdOutputSink_t(const fdOutputSink_t &) = delete;
+        fdOutputSink_t &operator=(const fdOutputSink_t &) = delete;
+
+        bool write(const char *data, size_t numBytes) override;
+        bool truncateTo(size_t size) override;
+        bool sync() override;
+
+    private:
+        int m_fd;      // Where we write to
+        bool m_ownsFd; // If we need to close m_fd
+    };
+
+    /**
+     * Appends to a string somebody else owns. Handy for holding output until it can go out in the right order
+     */
+    class memoryOutputSink_t : public outputSink_t
+    {
+    public:
+        /**
+         * @brief Construct a new memoryOutputSink_t object
+         *
+         * @param output Where to append to. Has to outlive the sink
+         */
+        memoryOutputSink_t(std::string &output)
+            : m_output(output){};
+
+        bool write(const char *data, size_t numBytes) override;
+        bool truncateTo(size_t size) override;
+
+    private:
+        std::string &m_output; // Everything written so far
+    };
+};
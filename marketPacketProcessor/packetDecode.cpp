@@ -0,0 +1,55 @@
+#include "packetDecode.h"
+
+#include <cstring>
+
+#include "updateKernels.h"
+
+namespace marketPacket
+{
+    std::optional<failReason_t> readPacketHeader(inputSource_t &inputSource, packetHeader_t &ph)
+    {
+        // Assume it's a packet header
+        const std::byte *headerPtr = inputSource.read(PACKET_HEADER_SIZE);
+        if (headerPtr == nullptr)
+        {
+            return PACKET_HEADER_READ_FAILED;
+        }
+        std::memcpy(&ph, headerPtr, PACKET_HEADER_SIZE);
+
+        // Probably not a good thing
+        if (ph.packetLength < PACKET_HEADER_SIZE)
+        {
+            return PACKET_HEADER_POORLY_FORMED;
+        }
+
+        return std::nullopt;
+    }
+
+    std::optional<failReason_t> decodeChunk(const std::byte *chunk,
+                                            size_t chunkSize,
+                                            const symbolFilter_t *symbolFilter,
+                                            uint64_t *tradeMask,
+                                            uint64_t *symbolMask)
+    {
+        // Every update is UPDATE_SIZE bytes, anything that doesn't divide evenly has a bad update in it somewhere
+        if (chunkSize % UPDATE_SIZE != 0)
+        {
+            return UPDATE_POORLY_FORMED;
+        }
+
+        // Validate and sort out the whole chunk in one go rather than one update at a time
+        size_t numUpdates = chunkSize / UPDATE_SIZE;
+        if (classifyUpdates(chunk, numUpdates, tradeMask) != numUpdates)
+        {
+            return UPDATE_POORLY_FORMED;
+        }
+
+        // Same goes for figuring out which ones anybody cares about
+        if (symbolFilter != nullptr)
+        {
+            symbolFilter->match(chunk, numUpdates, symbolMask);
+        }
+
+        return std::nullopt;
+    }
+};
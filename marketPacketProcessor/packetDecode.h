@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+
+#include "marketPacketHelpers/marketPacketHelpers.h"
+#include "inputSource.h"
+#include "symbolFilter.h"
+
+namespace marketPacket
+{
+    /**
+     * Decode steps every processor shares, whether it's working a packet at a time or a batch at a time.
+     * Anything about how a header gets read or a body gets validated belongs in here, so it only ever changes in one place
+     */
+
+    /**
+     * @brief Reads the next packet header and makes sure it's something we can work with
+     *
+     *  ASSUMPTION: inputSource has already passed checkValidity()
+     *
+     * @param inputSource   Where to read it from
+     * @param ph            Gets the header, as long as it could be read at all
+     * @return PACKET_HEADER_READ_FAILED or PACKET_HEADER_POORLY_FORMED if it's no good
+     */
+    std::optional<failReason_t> readPacketHeader(inputSource_t &inputSource, packetHeader_t &ph);
+
+    /**
+     * @brief Validates a run of packet body, and works out which updates are trades and which get through the filter
+     *
+     * @param chunk         Start of the run
+     * @param chunkSize     How many bytes are in the run. No more than MAX_UPDATES_IN_BODY updates worth
+     * @param symbolFilter  If set, what updates have to get through
+     * @param tradeMask     Bit i gets set if update i is a trade. Needs TRADE_MASK_WORDS words
+     * @param symbolMask    Bit i gets set if update i got through the filter. Needs TRADE_MASK_WORDS words, untouched without a filter
+     * @return UPDATE_POORLY_FORMED if any update in the run is off. Nothing in the run should be used then
+     */
+    std::optional<failReason_t> decodeChunk(const std::byte *chunk,
+                                            size_t chunkSize,
+                                            const symbolFilter_t *symbolFilter,
+                                            uint64_t *tradeMask,
+                                            uint64_t *symbolMask);
+};
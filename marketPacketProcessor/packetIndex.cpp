@@ -0,0 +1,143 @@
+#include "packetIndex.h"
+
+#include <assert.h>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#include "inputSource.h"
+
+namespace marketPacket
+{
+    namespace
+    {
+        constexpr const char INDEX_MAGIC[4] = {'M', 'P', 'I', 'X'};
+        constexpr const uint32_t INDEX_VERSION = 1;
+
+        /**
+         * @brief What the sidecar starts with. Checkpoints and relative offsets follow, in that order
+         */
+        struct indexFileHeader_t
+        {
+            char magic[4];               // Always INDEX_MAGIC
+            uint32_t version;            // Always INDEX_VERSION
+            uint64_t checkpointInterval; // Packets between full offsets
+            uint64_t numPackets;         // How many relative offsets there are
+            uint64_t captureSize;        // How big the capture was when it got indexed
+        };
+    }
+
+    std::optional<failReason_t> packetIndex_t::build(const std::string &capturePath)
+    {
+        assert(m_checkpointInterval > 0 && m_checkpointInterval <= MAX_INDEX_CHECKPOINT_INTERVAL);
+
+        mappedFile_t capture(capturePath);
+        if (!capture.isOpen())
+        {
+            return INPUT_STREAM_CLOSED;
+        }
+
+        m_checkpoints.clear();
+        m_relativeOffsets.clear();
+        m_captureSize = capture.size();
+
+        size_t offset = 0;
+        while (capture.size() - offset >= PACKET_HEADER_SIZE)
+        {
+            packetHeader_t ph;
+            std::memcpy(&ph, capture.data() + offset, PACKET_HEADER_SIZE);
+
+            // Either garbage or cut off. No processor's getting past this point anyways
+            if (ph.packetLength < PACKET_HEADER_SIZE || capture.size() - offset < ph.packetLength)
+            {
+                break;
+            }
+
+            addPacket(offset);
+            offset += ph.packetLength;
+        }
+
+        return std::nullopt;
+    }
+
+    std::optional<failReason_t> packetIndex_t::save(const std::string &indexPath) const
+    {
+        indexFileHeader_t header;
+        std::memcpy(header.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC));
+        header.version = INDEX_VERSION;
+        header.checkpointInterval = m_checkpointInterval;
+        header.numPackets = m_relativeOffsets.size();
+        header.captureSize = m_captureSize;
+
+        std::ofstream indexStream(indexPath, std::ios::binary | std::ios::trunc);
+        indexStream.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        indexStream.write(reinterpret_cast<const char *>(m_checkpoints.data()), m_checkpoints.size() * sizeof(uint64_t));
+        indexStream.write(reinterpret_cast<const char *>(m_relativeOffsets.data()), m_relativeOffsets.size() * sizeof(uint32_t));
+
+        if (!indexStream.flush())
+        {
+            return INDEX_WRITE_FAILED;
+        }
+
+        return std::nullopt;
+    }
+
+    std::optional<failReason_t> packetIndex_t::load(const std::string &indexPath, const std::string &capturePath)
+    {
+        std::ifstream indexStream(indexPath, std::ios::binary);
+
+        indexFileHeader_t header;
+        if (!indexStream.read(reinterpret_cast<char *>(&header), sizeof(header)) ||
+            std::memcmp(header.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC)) != 0 ||
+            header.version != INDEX_VERSION ||
+            header.checkpointInterval == 0 ||
+            header.checkpointInterval > MAX_INDEX_CHECKPOINT_INTERVAL)
+        {
+            return INDEX_READ_FAILED;
+        }
+
+        // A capture of a different size can't have the same packets. Only the size gets checked, a rewrite that keeps it slips through
+        std::error_code ec;
+        size_t captureSize = std::filesystem::file_size(capturePath, ec);
+        if (ec || captureSize != header.captureSize)
+        {
+            return INDEX_DOESNT_MATCH;
+        }
+
+        size_t numCheckpoints = (header.numPackets + header.checkpointInterval - 1) / header.checkpointInterval;
+        std::vector<uint64_t> checkpoints(numCheckpoints);
+        std::vector<uint32_t> relativeOffsets(header.numPackets);
+        if (!indexStream.read(reinterpret_cast<char *>(checkpoints.data()), checkpoints.size() * sizeof(uint64_t)) ||
+            !indexStream.read(reinterpret_cast<char *>(relativeOffsets.data()), relativeOffsets.size() * sizeof(uint32_t)))
+        {
+            return INDEX_READ_FAILED;
+        }
+
+        m_checkpointInterval = header.checkpointInterval;
+        m_captureSize = header.captureSize;
+        m_checkpoints.swap(checkpoints);
+        m_relativeOffsets.swap(relativeOffsets);
+
+        return std::nullopt;
+    }
+
+    std::optional<size_t> packetIndex_t::packetOffset(size_t packetNum) const
+    {
+        if (packetNum >= m_relativeOffsets.size())
+        {
+            return std::nullopt;
+        }
+
+        return m_checkpoints[packetNum / m_checkpointInterval] + m_relativeOffsets[packetNum];
+    }
+
+    void packetIndex_t::addPacket(size_t offset)
+    {
+        if (m_relativeOffsets.size() % m_checkpointInterval == 0)
+        {
+            m_checkpoints.push_back(offset);
+        }
+
+        m_relativeOffsets.push_back(offset - m_checkpoints.back());
+    }
+};
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "marketPacketHelpers/marketPacketHelpers.h"
+
+namespace marketPacket
+{
+    // How many packets between full offsets in the index. Everything in between is stored relative to the last one
+    constexpr const size_t DEFAULT_INDEX_CHECKPOINT_INTERVAL = 4096;
+
+    // Relative offsets are 32 bits, so the packets between checkpoints can't add up to more than that
+    constexpr const size_t MAX_INDEX_CHECKPOINT_INTERVAL = std::numeric_limits<uint32_t>::max() /
+                                                            std::numeric_limits<decltype(packetHeader_t::packetLength)>::max();
+
+    /**
+     * Where every packet in a capture starts, so a processor can jump straight to packet N instead of walking there.
+     *
+     * Every checkpoint interval packets we keep a full 64 bit offset, and every packet keeps a 32 bit offset relative
+     * to the checkpoint before it. Looking up a packet is two array reads, and the whole thing costs a little over
+     * 4 bytes per packet, in memory and on disk
+     */
+    class packetIndex_t
+    {
+    public:
+        /**
+         * @brief Construct a new, empty packetIndex_t object
+         *
+         * @param checkpointInterval How many packets between full offsets. Can't be more than MAX_INDEX_CHECKPOINT_INTERVAL
+         */
+        packetIndex_t(size_t checkpointInterval = DEFAULT_INDEX_CHECKPOINT_INTERVAL)
+            : m_checkpointInterval(checkpointInterval),
+              m_captureSize(0),
+              m_checkpoints(),
+              m_relativeOffsets(){};
+
+        /**
+         * @brief Where the index for a capture lives by default, right next to it
+         */
+        static std::string sidecarPath(const std::string &capturePath) { return capturePath + ".idx"; }
+
+        /**
+         * @brief Walks a capture header to header and marks down where each packet starts
+         *
+         *  Stops at the first packet that's cut off or nonsense, same place a processor would
+         *
+         * @param capturePath Capture to index
+         * @return If we couldn't, why
+         */
+        std::optional<failReason_t> build(const std::string &capturePath);
+
+        /**
+         * @brief Writes the index out as a sidecar file
+         *
+         * @param indexPath Where to write it. Usually sidecarPath()
+         * @return If we couldn't, why
+         */
+        std::optional<failReason_t> save(const std::string &indexPath) const;
+
+        /**
+         * @brief Reads a sidecar file back in, as long as the capture is still the size it was when it got indexed
+         *
+         * @param indexPath     Sidecar to read
+         * @param capturePath   Capture it's supposed to go with
+         * @return If we couldn't, why. INDEX_DOESNT_MATCH if the capture's size changed
+         */
+        std::optional<failReason_t> load(const std::string &indexPath, const std::string &capturePath);
+
+        /**
+         * @brief How many packets we know about
+         */
+        size_t numPackets() const { return m_relativeOffsets.size(); }
+
+        /**
+         * @brief Where a packet's header starts in the capture
+         *
+         * @param packetNum Which packet, counting from 0
+         * @return Byte offset, if we know about that packet
+         */
+        std::optional<size_t> packetOffset(size_t packetNum) const;
+
+    private:
+        /**
+         * @brief Marks down where the next packet starts
+         */
+        void addPacket(size_t offset);
+
+        size_t m_checkpointInterval; // Packets between full offsets
+        size_t m_captureSize;        // How big the capture was when we indexed it. Catches stale sidecars
+
+        std::vector<uint64_t> m_checkpoints;     // Full offset of every m_checkpointInterval'th packet
+        std::vector<uint32_t> m_relativeOffsets; // Every packet's offset from the checkpoint before it
+    };
+};
@@ -0,0 +1,191 @@
+#include "parallelPacketProcessor.h"
+
+#include <assert.h>
+#include <cstring>
+#include <thread>
+
+namespace marketPacket
+{
+    // How many ranges can be done (or in progress) but not yet written, per worker. Bounds how much output we hold onto
+    constexpr const size_t RANGES_IN_FLIGHT_PER_WORKER = 2;
+
+    void parallelPacketProcessor_t::initialize(const parallelProcessorConfig_t &config)
+    {
+        // Make sure this only gets called once
+        if (m_isInitialized)
+        {
+            assert(false);
+            return;
+        }
+
+        m_config = config;
+        if (m_config.numThreads == 0)
+        {
+            m_config.numThreads = std::max(1u, std::thread::hardware_concurrency());
+        }
+
+        // A worker's checkpoint only covers its own range, no use resuming from it
+        m_config.processorConfig.checkpointPath.reset();
+
+        m_isInitialized = true;
+    }
+
+    const std::optional<failReason_t> &parallelPacketProcessor_t::processAllPackets()
+    {
+        // Already been through the capture, or never will be
+        if (m_failReason.has_value())
+        {
+            return m_failReason;
+        }
+
+        if (!m_isInitialized)
+        {
+            m_failReason.emplace(UNINITIALIZED);
+            return m_failReason;
+        }
+
+        if (!m_inputFile.isOpen())
+        {
+            m_failReason.emplace(INPUT_STREAM_CLOSED);
+            return m_failReason;
+        }
+
+        findPacketRanges();
+
+        m_results = std::vector<rangeResult_t>(m_ranges.size());
+        m_nextRangeToProcess = 0;
+        m_nextRangeToWrite = 0;
+        m_stopWorkers = false;
+
+        std::vector<std::thread> workers;
+        for (size_t i = 0; i < std::min(m_config.numThreads, m_ranges.size()); i++)
+        {
+            workers.emplace_back(&parallelPacketProcessor_t::processRanges, this);
+        }
+
+        writeResults();
+
+        for (auto &worker : workers)
+        {
+            worker.join();
+        }
+
+        return m_failReason;
+    }
+
+    void parallelPacketProcessor_t::findPacketRanges()
+    {
+        m_ranges.clear();
+
+        const std::byte *data = m_inputFile.data();
+        size_t size = m_inputFile.size();
+
+        size_t rangeBegin = 0;
+        size_t offset = 0;
+        while (size - offset >= PACKET_HEADER_SIZE)
+        {
+            packetHeader_t ph;
+            std::memcpy(&ph, data + offset, PACKET_HEADER_SIZE);
+
+            // Either garbage or cut off. Whoever processes the tail will find out which
+            if (ph.packetLength < PACKET_HEADER_SIZE || size - offset < ph.packetLength)
+            {
+                break;
+            }
+
+            offset += ph.packetLength;
+            if (offset - rangeBegin >= m_config.rangeSize)
+            {
+                m_ranges.push_back({rangeBegin, offset});
+                rangeBegin = offset;
+            }
+        }
+
+        // Whatever's left over, good packets or not
+        if (rangeBegin != size)
+        {
+            m_ranges.push_back({rangeBegin, size});
+        }
+    }
+
+    void parallelPacketProcessor_t::processRanges()
+    {
+        const size_t maxRangesInFlight = m_config.numThreads * RANGES_IN_FLIGHT_PER_WORKER;
+
+        while (true)
+        {
+            size_t rangeIdx;
+            {
+                // Don't get too far ahead of the writer or we'll hold the whole output in memory
+                std::unique_lock lock(m_mutex);
+                m_rangeDone.wait(lock, [&]
+                                 { return m_stopWorkers || m_nextRangeToProcess < m_nextRangeToWrite + maxRangesInFlight; });
+
+                if (m_stopWorkers || m_nextRangeToProcess == m_ranges.size())
+                {
+                    return;
+                }
+
+                rangeIdx = m_nextRangeToProcess++;
+            }
+
+            const packetRange_t &range = m_ranges[rangeIdx];
+            std::string output;
+            marketPacketProcessor_t mpp(std::make_unique<memoryInputSource_t>(m_inputFile.data() + range.begin, range.end - range.begin),
+                                        std::make_unique<memoryOutputSink_t>(output));
+            mpp.initialize(m_config.processorConfig);
+
+            const std::optional<failReason_t> &failReason = mpp.processNextPacket();
+
+            {
+                std::lock_guard lock(m_mutex);
+                m_results[rangeIdx].output.swap(output);
+                m_results[rangeIdx].failReason.emplace(failReason.value_or(END_OF_FILE));
+                m_results[rangeIdx].isDone = true;
+            }
+            m_rangeDone.notify_all();
+        }
+    }
+
+    void parallelPacketProcessor_t::writeResults()
+    {
+        for (size_t rangeIdx = 0; rangeIdx < m_ranges.size(); rangeIdx++)
+        {
+            // Workers never touch a range again once it's done, so no need to hold the lock past this
+            {
+                std::unique_lock lock(m_mutex);
+                m_rangeDone.wait(lock, [&]
+                                 { return m_results[rangeIdx].isDone; });
+            }
+            rangeResult_t &result = m_results[rangeIdx];
+
+            if (!m_outputSink->write(result.output.data(), result.output.size()))
+            {
+                m_failReason.emplace(TRADE_WRITE_FAILED);
+            }
+            else if (result.failReason.value() != END_OF_FILE)
+            {
+                // Stopped early, so would a single processor have. Nothing after this matters
+                m_failReason.emplace(result.failReason.value());
+            }
+
+            // Don't hang on to output we're done with
+            std::string().swap(result.output);
+
+            {
+                std::lock_guard lock(m_mutex);
+                m_nextRangeToWrite = rangeIdx + 1;
+                m_stopWorkers = m_failReason.has_value();
+            }
+            m_rangeDone.notify_all();
+
+            if (m_failReason.has_value())
+            {
+                return;
+            }
+        }
+
+        // Made it through every range
+        m_failReason.emplace(END_OF_FILE);
+    }
+};
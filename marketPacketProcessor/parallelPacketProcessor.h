@@ -0,0 +1,128 @@
+#pragma once
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "marketPacketHelpers/marketPacketHelpers.h"
+#include "inputSource.h"
+#include "marketPacketProcessor.h"
+#include "outputSink.h"
+
+namespace marketPacket
+{
+    /**
+     * @brief Knobs for how a parallel processor splits up the work
+     */
+    struct parallelProcessorConfig_t
+    {
+        processorConfig_t processorConfig;   // How each worker's processor behaves. checkpointPath is ignored, see below
+        size_t numThreads = 0;               // How many workers. 0 means one per core
+        size_t rangeSize = 16 * 1024 * 1024; // Roughly how much input a worker chews on at a time
+    };
+
+    /**
+     * Processes a whole capture across multiple cores.
+     *
+     * Packet boundaries get found up front by hopping from header to header, then contiguous runs of packets
+     * are handed out to workers, each with its own marketPacketProcessor_t. Worker output is stitched back
+     * together in packet order, so the output is identical to a single processor going through the capture
+     *
+     * Workers don't checkpoint. Each only ever sees its own range, so a checkpoint from one of them says nothing about
+     * how far the capture as a whole got, and they'd all be fighting over the same file. Runs here are all or nothing
+     */
+    class parallelPacketProcessor_t
+    {
+    public:
+        /**
+         * @brief Construct a new parallelPacketProcessor_t object
+         *
+         * @param inputPath     Capture to process. Gets mapped in so workers can share it
+         * @param outputSink    Where to write the interpreted updates
+         */
+        parallelPacketProcessor_t(const std::string &inputPath, std::unique_ptr<outputSink_t> &&outputSink)
+            : m_isInitialized(false),
+              m_config(),
+              m_failReason(),
+              m_inputFile(inputPath),
+              m_outputSink(std::move(outputSink)),
+              m_ranges(),
+              m_results(),
+              m_mutex(),
+              m_rangeDone(),
+              m_nextRangeToProcess(),
+              m_nextRangeToWrite(),
+              m_stopWorkers(){};
+
+        /**
+         * @brief Sets up the processor for use. Processor won't work unless this is called
+         *
+         * @param config How to split up the work and how each worker should behave
+         */
+        void initialize(const parallelProcessorConfig_t &config = parallelProcessorConfig_t());
+
+        /**
+         * @brief Processes every packet in the capture
+         *
+         * @return Why we stopped. END_OF_FILE if we made it all the way through, same as marketPacketProcessor_t
+         */
+        const std::optional<failReason_t> &processAllPackets();
+
+    private:
+        /**
+         * @brief A contiguous run of whole packets, by offset into the capture
+         */
+        struct packetRange_t
+        {
+            size_t begin;
+            size_t end;
+        };
+
+        /**
+         * @brief What a worker made out of a range
+         */
+        struct rangeResult_t
+        {
+            std::string output;                     // Everything the worker's processor wrote out
+            std::optional<failReason_t> failReason; // Why the worker's processor stopped
+            bool isDone = false;                    // If the worker is finished with it
+        };
+
+        /**
+         * @brief Hops from packet header to packet header and cuts the capture up into ranges
+         *
+         *  Anything after the last packet we can make sense of gets tacked on to the last range,
+         *  so whichever worker gets it fails exactly like a single processor would
+         */
+        void findPacketRanges();
+
+        /**
+         * @brief Worker loop, grabs ranges until there are none left
+         */
+        void processRanges();
+
+        /**
+         * @brief Writes finished ranges out in order, stops at the first one that didn't process cleanly
+         */
+        void writeResults();
+
+        bool m_isInitialized;                     // If initialize() has been called
+        parallelProcessorConfig_t m_config;       // How we were asked to behave
+        std::optional<failReason_t> m_failReason; // Why we stopped
+
+        mappedFile_t m_inputFile;                   // The whole capture, shared by every worker
+        std::unique_ptr<outputSink_t> m_outputSink; // Where stitched together output goes
+
+        std::vector<packetRange_t> m_ranges;  // How the capture got split up
+        std::vector<rangeResult_t> m_results; // Per range output, in packet order
+
+        std::mutex m_mutex;                  // Guards everything below and the isDone flags in m_results
+        std::condition_variable m_rangeDone; // Signalled whenever a range finishes or gets written
+        size_t m_nextRangeToProcess;         // Next range a worker should pick up
+        size_t m_nextRangeToWrite;           // Next range that needs writing
+        bool m_stopWorkers;                  // Something went wrong, no point doing any more
+    };
+};
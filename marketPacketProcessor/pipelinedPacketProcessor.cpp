@@ -0,0 +1,315 @@
+#include "pipelinedPacketProcessor.h"
+
+#include <assert.h>
+#include <cstring>
+#include <thread>
+
+#include "packetDecode.h"
+#include "updateKernels.h"
+
+namespace marketPacket
+{
+    void pipelinedPacketProcessor_t::initialize(const processorConfig_t &config)
+    {
+        // Make sure this only gets called once
+        if (m_isInitialized)
+        {
+            assert(false);
+            return;
+        }
+
+        for (packetBatch_t &batch : m_batches)
+        {
+            batch.data = std::make_unique<std::byte[]>(PIPELINE_BATCH_SIZE);
+        }
+
+        m_symbolFilter = config.symbolFilter;
+        m_tradeOutput.initialize(config.outputFormat);
+        m_isInitialized = true;
+    }
+
+    const std::optional<failReason_t> &pipelinedPacketProcessor_t::processAllPackets()
+    {
+        // Already been through the stream, or never will be
+        if (m_failReason.has_value())
+        {
+            return m_failReason;
+        }
+
+        if (!m_isInitialized)
+        {
+            m_failReason.emplace(UNINITIALIZED);
+            return m_failReason;
+        }
+
+        // Every batch starts out free. The threads don't exist yet, so pushing from here is fine
+        for (batchHandle_t handle = 0; handle < PIPELINE_NUM_BATCHES; handle++)
+        {
+            m_freeBatches.ring.tryPush(handle);
+        }
+
+        std::thread reader(&pipelinedPacketProcessor_t::readBatches, this);
+        std::thread decoder(&pipelinedPacketProcessor_t::decodeBatches, this);
+
+        writeBatches();
+
+        reader.join();
+        decoder.join();
+
+        return m_failReason;
+    }
+
+    void pipelinedPacketProcessor_t::readBatches()
+    {
+        batchHandle_t handle;
+        while (popBatch(m_freeBatches, handle))
+        {
+            packetBatch_t &batch = m_batches[handle];
+            fillBatch(batch);
+
+            // Whoever gets the last batch knows to stop, so we can too
+            bool isLastBatch = batch.failReason.has_value();
+            if (!pushBatch(m_readBatches, handle) || isLastBatch)
+            {
+                return;
+            }
+        }
+    }
+
+    void pipelinedPacketProcessor_t::decodeBatches()
+    {
+        batchHandle_t handle;
+        while (popBatch(m_readBatches, handle))
+        {
+            packetBatch_t &batch = m_batches[handle];
+            decodeBatch(batch);
+
+            bool isLastBatch = batch.failReason.has_value();
+            if (!pushBatch(m_decodedBatches, handle) || isLastBatch)
+            {
+                // Nothing after this gets written, don't let the reader keep going
+                stopStages();
+                return;
+            }
+        }
+    }
+
+    void pipelinedPacketProcessor_t::writeBatches()
+    {
+        // The decoder always sends a last batch unless we tell it to stop, so no need to ever give up waiting here.
+        // It stops the moment it's sent it too, which would otherwise have us bail before we've picked it up
+        while (true)
+        {
+            batchHandle_t handle;
+            popBatch(m_decodedBatches, handle, false);
+
+            packetBatch_t &batch = m_batches[handle];
+
+            size_t packetBegin = 0;
+            size_t tradeIdx = 0;
+            for (size_t packetIdx = 0; packetIdx < batch.packetEnds.size() && !m_failReason.has_value(); packetIdx++)
+            {
+                packetHeader_t ph;
+                std::memcpy(&ph, batch.data.get() + packetBegin, PACKET_HEADER_SIZE);
+
+                m_tradeOutput.onPacketBegin(ph);
+                for (; tradeIdx < batch.packetTradeEnds[packetIdx]; tradeIdx++)
+                {
+                    m_tradeOutput.onTrade(*reinterpret_cast<const trade_t *>(batch.data.get() + batch.tradeOffsets[tradeIdx]));
+                }
+
+                const auto &failReason = m_tradeOutput.onPacketEnd();
+                if (failReason.has_value())
+                {
+                    m_failReason.emplace(failReason.value());
+                }
+
+                packetBegin = batch.packetEnds[packetIdx];
+            }
+
+            if (!m_failReason.has_value() && batch.failReason.has_value())
+            {
+                // Don't leave anything sitting around in the buffer once we're done
+                const auto &failReason = m_tradeOutput.onFlush();
+                m_failReason.emplace(failReason.value_or(batch.failReason.value()));
+            }
+
+            if (m_failReason.has_value())
+            {
+                stopStages();
+                return;
+            }
+
+            // Free ring holds every batch there is, this can't fail
+            pushBatch(m_freeBatches, handle);
+        }
+    }
+
+    void pipelinedPacketProcessor_t::fillBatch(packetBatch_t &batch)
+    {
+        batch.size = 0;
+        batch.packetEnds.clear();
+        batch.failReason.reset();
+
+        while (true)
+        {
+            // If the last batch ran out of room, we've already got the next header
+            packetHeader_t ph;
+            if (m_pendingHeader.has_value())
+            {
+                ph = m_pendingHeader.value();
+                m_pendingHeader.reset();
+            }
+            else
+            {
+                const auto &failReason = m_inputSource->checkValidity();
+                if (failReason.has_value())
+                {
+                    batch.failReason.emplace(failReason.value());
+                    return;
+                }
+
+                const auto &headerFailReason = readPacketHeader(*m_inputSource, ph);
+                if (headerFailReason.has_value())
+                {
+                    batch.failReason.emplace(headerFailReason.value());
+                    return;
+                }
+            }
+
+            // Packets never get split across batches. A fresh batch always has room
+            if (PIPELINE_BATCH_SIZE - batch.size < ph.packetLength)
+            {
+                m_pendingHeader = ph;
+                return;
+            }
+
+            std::byte *packetPtr = batch.data.get() + batch.size;
+            std::memcpy(packetPtr, &ph, PACKET_HEADER_SIZE);
+            if (!m_inputSource->readInto(packetPtr + PACKET_HEADER_SIZE, ph.packetLength - PACKET_HEADER_SIZE))
+            {
+                batch.failReason.emplace(PACKET_READ_FAILED);
+                return;
+            }
+
+            batch.size += ph.packetLength;
+            batch.packetEnds.push_back(batch.size);
+        }
+    }
+
+    void pipelinedPacketProcessor_t::decodeBatch(packetBatch_t &batch)
+    {
+        std::array<uint64_t, TRADE_MASK_WORDS> tradeMask;
+        std::array<uint64_t, TRADE_MASK_WORDS> symbolMask;
+
+        batch.tradeOffsets.clear();
+        batch.packetTradeEnds.clear();
+
+        size_t packetBegin = 0;
+        for (size_t packetIdx = 0; packetIdx < batch.packetEnds.size(); packetIdx++)
+        {
+            size_t bodyBegin = packetBegin + PACKET_HEADER_SIZE;
+            size_t bodySize = batch.packetEnds[packetIdx] - bodyBegin;
+            size_t numUpdates = bodySize / UPDATE_SIZE;
+
+            // The whole body is in the batch, so it's all one chunk
+            const auto &failReason = decodeChunk(batch.data.get() + bodyBegin, bodySize, m_symbolFilter.get(), tradeMask.data(), symbolMask.data());
+            if (failReason.has_value())
+            {
+                // A bad update trumps whatever stopped the reader later on
+                batch.packetEnds.resize(packetIdx);
+                batch.failReason.reset();
+                batch.failReason.emplace(failReason.value());
+                return;
+            }
+
+            for (size_t word = 0; word < (numUpdates + 63) / 64; word++)
+            {
+                uint64_t trades = m_symbolFilter ? tradeMask[word] & symbolMask[word] : tradeMask[word];
+                for (; trades != 0; trades &= trades - 1)
+                {
+                    size_t updateIdx = word * 64 + __builtin_ctzll(trades);
+                    batch.tradeOffsets.push_back(bodyBegin + updateIdx * UPDATE_SIZE);
+                }
+            }
+            batch.packetTradeEnds.push_back(batch.tradeOffsets.size());
+
+            packetBegin = batch.packetEnds[packetIdx];
+        }
+    }
+
+    bool pipelinedPacketProcessor_t::pushBatch(batchQueue_t &queue, batchHandle_t handle)
+    {
+        return waitOn(queue, true, [&]
+                      { return queue.ring.tryPush(handle); });
+    }
+
+    bool pipelinedPacketProcessor_t::popBatch(batchQueue_t &queue, batchHandle_t &handle, bool canStop)
+    {
+        return waitOn(queue, canStop, [&]
+                      { return queue.ring.tryPop(handle); });
+    }
+
+    template <typename tryOp_t>
+    bool pipelinedPacketProcessor_t::waitOn(batchQueue_t &queue, bool canStop, tryOp_t &&tryOp)
+    {
+        for (size_t spin = 0;; spin++)
+        {
+            // Once we've spun long enough, say we're going to sleep before taking a look,
+            // so anybody who changes the ring (or stops us) after that look knows to wake us
+            bool isSleepy = spin >= PIPELINE_SPINS_BEFORE_SLEEP;
+            uint32_t numChanges = 0;
+            if (isSleepy)
+            {
+                queue.numSleepers.fetch_add(1);
+                numChanges = queue.numChanges.load();
+            }
+
+            bool isDone = tryOp();
+            bool isStopping = !isDone && canStop && m_stopStages.load();
+
+            if (isSleepy)
+            {
+                if (!isDone && !isStopping)
+                {
+                    queue.numChanges.wait(numChanges);
+                }
+                queue.numSleepers.fetch_sub(1);
+            }
+            else if (!isDone && !isStopping)
+            {
+                // Other side is usually only a moment away, no point paying for a sleep and a wake up
+                std::this_thread::yield();
+            }
+
+            if (isDone)
+            {
+                wake(queue);
+                return true;
+            }
+
+            if (isStopping)
+            {
+                return false;
+            }
+        }
+    }
+
+    void pipelinedPacketProcessor_t::wake(batchQueue_t &queue)
+    {
+        queue.numChanges.fetch_add(1);
+        if (queue.numSleepers.load() != 0)
+        {
+            queue.numChanges.notify_all();
+        }
+    }
+
+    void pipelinedPacketProcessor_t::stopStages()
+    {
+        m_stopStages.store(true);
+        for (batchQueue_t *queue : {&m_freeBatches, &m_readBatches, &m_decodedBatches})
+        {
+            wake(*queue);
+        }
+    }
+};
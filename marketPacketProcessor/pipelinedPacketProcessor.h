@@ -0,0 +1,161 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "marketPacketHelpers/marketPacketHelpers.h"
+#include "inputSource.h"
+#include "marketPacketProcessor.h"
+#include "outputSink.h"
+#include "spscRing.h"
+#include "symbolFilter.h"
+#include "tradeOutput.h"
+
+namespace marketPacket
+{
+    // How big each batch of whole packets handed between stages is. Has to fit the largest possible packet
+    constexpr const size_t PIPELINE_BATCH_SIZE = 1024 * 1024;
+
+    // How many batches exist. Once they're all in flight, the reader has to wait on the writer
+    constexpr const size_t PIPELINE_NUM_BATCHES = 8;
+
+    // How many times a stage looks at an empty (or full) ring before it goes to sleep on it
+    constexpr const size_t PIPELINE_SPINS_BEFORE_SLEEP = 256;
+
+    static_assert(PIPELINE_BATCH_SIZE >= std::numeric_limits<decltype(packetHeader_t::packetLength)>::max());
+
+    /**
+     * Processes a stream with reading, decoding and writing each on their own thread.
+     *
+     * The reader fills batches with whole packets, the decoder validates them and finds the trades, and the
+     * writer formats them out. Stages pass batch handles to each other over lock-free rings so nothing gets
+     * copied between them, and disk, decode and output all overlap. Output and failure reasons are identical
+     * to a marketPacketProcessor_t that reads whole packets at a time (e.g. from a mappedInputSource_t), and the
+     * reader and decoder go through the same packetDecode.h steps it does, so the two can't drift apart.
+     *
+     * A stage waiting on another spins for a little while, then sleeps on the ring until it changes, so a stalled
+     * pipeline doesn't hold on to three cores doing nothing
+     */
+    class pipelinedPacketProcessor_t
+    {
+    public:
+        /**
+         * @brief Construct a new pipelinedPacketProcessor_t object
+         *
+         * @param inputSource   Where we get our data from. Only ever touched by the reader thread
+         * @param outputSink    Where to write the interpreted updates. Only ever touched by the writer thread
+         */
+        pipelinedPacketProcessor_t(std::unique_ptr<inputSource_t> &&inputSource, std::unique_ptr<outputSink_t> &&outputSink)
+            : m_isInitialized(false),
+              m_failReason(),
+              m_batches(),
+              m_freeBatches(),
+              m_readBatches(),
+              m_decodedBatches(),
+              m_stopStages(false),
+              m_symbolFilter(),
+              m_pendingHeader(),
+              m_inputSource(std::move(inputSource)),
+              m_tradeOutput(std::move(outputSink)){};
+
+        /**
+         * @brief Sets up the processor for use. Processor won't work unless this is called
+         *
+         * @param config How the output should look
+         */
+        void initialize(const processorConfig_t &config = processorConfig_t());
+
+        /**
+         * @brief Processes every packet in the stream
+         *
+         * @return Why we stopped. END_OF_FILE if we made it all the way through, same as marketPacketProcessor_t
+         */
+        const std::optional<failReason_t> &processAllPackets();
+
+    private:
+        /**
+         * @brief A bunch of whole packets, and everything the stages have figured out about them
+         */
+        struct packetBatch_t
+        {
+            std::unique_ptr<std::byte[]> data;      // The packets, back to back
+            size_t size;                            // How much of data is filled
+            std::vector<size_t> packetEnds;         // Reader: where each packet ends in data
+            std::vector<uint32_t> tradeOffsets;     // Decoder: where each trade starts in data
+            std::vector<size_t> packetTradeEnds;    // Decoder: per packet, where its trades end in tradeOffsets
+            std::optional<failReason_t> failReason; // Set if this is the last batch, why whoever made it stopped
+        };
+
+        using batchHandle_t = uint32_t;
+        using batchRing_t = spscRing_t<batchHandle_t, PIPELINE_NUM_BATCHES>;
+
+        /**
+         * @brief A ring between two stages, and what it takes for either of them to sleep on it
+         */
+        struct batchQueue_t
+        {
+            batchRing_t ring;                      // The batch handles themselves
+            std::atomic<uint32_t> numChanges = 0;  // Bumped after every push and pop, and on stopping. What sleepers wait on
+            std::atomic<uint32_t> numSleepers = 0; // Stages asleep (or about to be) on this, so nobody pays to wake no one
+        };
+
+        /**
+         * @brief Stage loops, each runs on its own thread
+         */
+        void readBatches();   // Fills free batches with whole packets
+        void decodeBatches(); // Validates read batches and finds the trades
+        void writeBatches();  // Formats decoded batches out and hands them back to the reader
+
+        /**
+         * @brief Reads packets into the batch until it's full or the input stops
+         */
+        void fillBatch(packetBatch_t &batch);
+
+        /**
+         * @brief Validates every packet in the batch. On a bad one, drops it and everything after it
+         */
+        void decodeBatch(packetBatch_t &batch);
+
+        /**
+         * @brief Waits on a queue until there's room / something in it
+         *
+         * @param canStop If getting told to stop while waiting should make us give up
+         * @return False if we got told to stop while waiting
+         */
+        bool pushBatch(batchQueue_t &queue, batchHandle_t handle);
+        bool popBatch(batchQueue_t &queue, batchHandle_t &handle, bool canStop = true);
+
+        /**
+         * @brief Keeps trying tryOp() on the queue's ring, spinning at first and then sleeping until it changes
+         */
+        template <typename tryOp_t>
+        bool waitOn(batchQueue_t &queue, bool canStop, tryOp_t &&tryOp);
+
+        /**
+         * @brief Lets whoever might be asleep on the queue know it's changed
+         */
+        void wake(batchQueue_t &queue);
+
+        /**
+         * @brief Tells every stage to stop waiting on the others and bail, waking any that are asleep
+         */
+        void stopStages();
+
+        bool m_isInitialized;                     // If initialize() has been called
+        std::optional<failReason_t> m_failReason; // Why we stopped
+
+        std::array<packetBatch_t, PIPELINE_NUM_BATCHES> m_batches; // Every batch there is. Stages pass around indices into this
+        batchQueue_t m_freeBatches;                                // Writer -> Reader
+        batchQueue_t m_readBatches;                                // Reader -> Decoder
+        batchQueue_t m_decodedBatches;                             // Decoder -> Writer
+        std::atomic<bool> m_stopStages;                            // Once set, stages stop waiting on each other and bail
+
+        std::shared_ptr<const symbolFilter_t> m_symbolFilter; // Decoder: if set, only trades for these symbols get through
+        std::optional<packetHeader_t> m_pendingHeader;        // Reader: header of a packet that didn't fit in the last batch
+        std::unique_ptr<inputSource_t> m_inputSource;         // Reader: where we get our data from
+        tradeOutput_t m_tradeOutput;                          // Writer: formats trades and flushes them to the output sink
+    };
+};
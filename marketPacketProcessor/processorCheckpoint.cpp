@@ -0,0 +1,100 @@
+#include "processorCheckpoint.h"
+
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <fstream>
+#include <unistd.h>
+
+namespace marketPacket
+{
+    namespace
+    {
+        constexpr const char CHECKPOINT_MAGIC[4] = {'M', 'P', 'C', 'K'};
+        constexpr const uint32_t CHECKPOINT_VERSION = 1;
+
+        /**
+         * @brief Writes a whole file out and waits for it to hit the disk
+         */
+        bool writeDurably(const std::string &path, const char *data, size_t numBytes)
+        {
+            int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            if (fd < 0)
+            {
+                return false;
+            }
+
+            bool isWritten = ::write(fd, data, numBytes) == static_cast<ssize_t>(numBytes) && ::fsync(fd) == 0;
+            return ::close(fd) == 0 && isWritten;
+        }
+
+        /**
+         * @brief Waits for a directory's entries (like a rename) to hit the disk
+         */
+        bool syncDirectory(const std::filesystem::path &directory)
+        {
+            int fd = ::open(directory.empty() ? "." : directory.c_str(), O_RDONLY | O_DIRECTORY);
+            if (fd < 0)
+            {
+                return false;
+            }
+
+            bool isSynced = ::fsync(fd) == 0;
+            ::close(fd);
+            return isSynced;
+        }
+
+        /**
+         * @brief Everything that's in a checkpoint file
+         */
+        struct checkpointFile_t
+        {
+            char magic[4];                    // Always CHECKPOINT_MAGIC
+            uint32_t version;                 // Always CHECKPOINT_VERSION
+            processorCheckpoint_t checkpoint; // The actual checkpoint
+        };
+    }
+
+    std::optional<failReason_t> saveCheckpoint(const std::string &path, const processorCheckpoint_t &checkpoint)
+    {
+        checkpointFile_t file;
+        std::memcpy(file.magic, CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC));
+        file.version = CHECKPOINT_VERSION;
+        file.checkpoint = checkpoint;
+
+        // Has to be on disk before the rename, or a power cut could leave the new name pointing at nothing
+        const std::string tempPath = path + ".tmp";
+        if (!writeDurably(tempPath, reinterpret_cast<const char *>(&file), sizeof(file)))
+        {
+            return CHECKPOINT_WRITE_FAILED;
+        }
+
+        // rename() swaps the whole file at once. Nobody ever sees half a checkpoint
+        std::error_code ec;
+        std::filesystem::rename(tempPath, path, ec);
+        if (ec || !syncDirectory(std::filesystem::path(path).parent_path()))
+        {
+            return CHECKPOINT_WRITE_FAILED;
+        }
+
+        return std::nullopt;
+    }
+
+    std::optional<failReason_t> loadCheckpoint(const std::string &path, processorCheckpoint_t &checkpoint)
+    {
+        std::ifstream checkpointStream(path, std::ios::binary);
+
+        // Every packet is at least a header, so a checkpoint claiming otherwise is garbage
+        checkpointFile_t file;
+        if (!checkpointStream.read(reinterpret_cast<char *>(&file), sizeof(file)) ||
+            std::memcmp(file.magic, CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC)) != 0 ||
+            file.version != CHECKPOINT_VERSION ||
+            file.checkpoint.inputOffset < file.checkpoint.packetNum * PACKET_HEADER_SIZE)
+        {
+            return CHECKPOINT_READ_FAILED;
+        }
+
+        checkpoint = file.checkpoint;
+        return std::nullopt;
+    }
+};
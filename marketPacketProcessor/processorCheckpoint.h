@@ -0,0 +1,42 @@
+#pragma once
+
+#include <optional>
+#include <string>
+
+#include "marketPacketHelpers/marketPacketHelpers.h"
+
+namespace marketPacket
+{
+    // How many packets between checkpoints, unless told otherwise
+    constexpr const size_t DEFAULT_PROCESSOR_CHECKPOINT_INTERVAL = 64 * 1024;
+
+    /**
+     * How far a processor got, taken at a packet boundary right after its output was flushed.
+     * Everything before inputOffset made exactly outputOffset bytes of output, so a restart can pick up from there
+     */
+    struct processorCheckpoint_t
+    {
+        uint64_t inputOffset;  // Where the next packet starts in the input
+        uint64_t packetNum;    // How many packets came before it
+        uint64_t outputOffset; // How much output those packets made
+    };
+
+    /**
+     * @brief Writes a checkpoint out. It lands in a temp file first, gets synced to disk and renamed over the old one,
+     *        so a crash or power cut halfway through leaves the last checkpoint in one piece
+     *
+     * @param path          Where to write it
+     * @param checkpoint    What to write
+     * @return If we couldn't, why
+     */
+    std::optional<failReason_t> saveCheckpoint(const std::string &path, const processorCheckpoint_t &checkpoint);
+
+    /**
+     * @brief Reads a checkpoint back in
+     *
+     * @param path          Checkpoint to read
+     * @param checkpoint    Where to put it. Untouched if we couldn't
+     * @return If we couldn't, why
+     */
+    std::optional<failReason_t> loadCheckpoint(const std::string &path, processorCheckpoint_t &checkpoint);
+};
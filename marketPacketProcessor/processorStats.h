@@ -0,0 +1,156 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+#include "marketPacketHelpers/histogram.h"
+#include "marketPacketHelpers/tscClock.h"
+
+namespace marketPacket
+{
+    // Per state timings and counters cost a couple of TSC reads every time the state machine moves, so they're off
+    // unless the build asks for them: bazel build --define processor_stats=on (which defines MARKET_PACKET_PROCESSOR_STATS).
+    // Off, all of it compiles away to nothing
+#ifdef MARKET_PACKET_PROCESSOR_STATS
+    constexpr const bool PROCESSOR_STATS_ENABLED = true;
+#else
+    constexpr const bool PROCESSOR_STATS_ENABLED = false;
+#endif
+
+    /**
+     * @brief The processor's state machine states worth timing
+     */
+    enum class processorStage_e : uint8_t
+    {
+        CHECK_STREAM_VALIDITY = 0, // Asking the input source if there's more. I/O
+        READ_HEADER,               // Reading a packet header. I/O
+        READ_PART_BODY,            // Reading and validating a chunk of body. I/O, plus the classify kernel
+        HANDLE_UPDATES             // Handing updates to the handler. Formatting and output, for a marketPacketProcessor_t
+    };
+    constexpr const size_t NUM_PROCESSOR_STAGES = 4;
+
+    constexpr std::string_view processorStageName(processorStage_e stage)
+    {
+        constexpr std::array<std::string_view, NUM_PROCESSOR_STAGES> NAMES{"CHECK_STREAM_VALIDITY", "READ_HEADER", "READ_PART_BODY", "HANDLE_UPDATES"};
+        return NAMES[static_cast<size_t>(stage)];
+    }
+
+    // TSC cycles per visit to a state, to within 12.5%
+    using cycleHistogram_t = logLinearHistogram_t<3>;
+
+    /**
+     * @brief Snapshot of everything a processor has counted. Turn cycles into time with tscToNs()
+     */
+    struct processorStats_t
+    {
+        bool isEnabled = false; // If the build had stats turned on. Everything's 0 otherwise
+
+        std::array<cycleHistogram_t, NUM_PROCESSOR_STAGES> stageCycles; // Cycles per visit to each state
+
+        uint64_t numPackets = 0; // Whole packets handled
+        uint64_t numTrades = 0;  // Trades decoded, before any symbol filter
+        uint64_t numQuotes = 0;  // Quotes decoded, before any symbol filter
+        uint64_t numBytes = 0;   // Bytes read from the input
+
+        const cycleHistogram_t &cycles(processorStage_e stage) const { return stageCycles[static_cast<size_t>(stage)]; }
+
+        /**
+         * @brief Every cycle spent in any state
+         */
+        uint64_t totalCycles() const
+        {
+            uint64_t total = 0;
+            for (const auto &histogram : stageCycles)
+            {
+                total += histogram.sum();
+            }
+            return total;
+        }
+    };
+
+    /**
+     * What a processor keeps its stats in. Only the enabled one does anything, the other's empty and every call on
+     * it is an empty inline function
+     */
+    template <bool IS_ENABLED>
+    class processorStatsRecorder_t;
+
+    template <>
+    class processorStatsRecorder_t<true>
+    {
+    public:
+        /**
+         * @brief Marks down the cycles between construction and destruction against a state
+         */
+        class stageTimer_t
+        {
+        public:
+            stageTimer_t(cycleHistogram_t &histogram)
+                : m_histogram(histogram),
+                  m_startTsc(readTsc()){};
+            ~stageTimer_t() { m_histogram.record(readTsc() - m_startTsc); }
+
+            stageTimer_t(const stageTimer_t &) = delete;
+            stageTimer_t &operator=(const stageTimer_t &) = delete;
+
+        private:
+            cycleHistogram_t &m_histogram; // Where the cycles go
+            uint64_t m_startTsc;           // When the state started
+        };
+
+        processorStatsRecorder_t()
+            : m_stats()
+        {
+            m_stats.isEnabled = true;
+        }
+
+        stageTimer_t timeStage(processorStage_e stage) { return stageTimer_t(m_stats.stageCycles[static_cast<size_t>(stage)]); }
+
+        void countPacket() { m_stats.numPackets++; }
+        void countBytes(size_t numBytes) { m_stats.numBytes += numBytes; }
+
+        /**
+         * @brief Counts a chunk's trades and quotes off its trade mask
+         */
+        void countUpdates(const uint64_t *tradeMask, size_t numUpdates)
+        {
+            uint64_t numTrades = 0;
+            for (size_t word = 0; word < (numUpdates + 63) / 64; word++)
+            {
+                numTrades += __builtin_popcountll(tradeMask[word]);
+            }
+
+            m_stats.numTrades += numTrades;
+            m_stats.numQuotes += numUpdates - numTrades;
+        }
+
+        const processorStats_t &snapshot() const { return m_stats; }
+        void reset()
+        {
+            m_stats = processorStats_t();
+            m_stats.isEnabled = true;
+        }
+
+    private:
+        processorStats_t m_stats; // Everything so far
+    };
+
+    template <>
+    class processorStatsRecorder_t<false>
+    {
+    public:
+        struct stageTimer_t
+        {
+        };
+
+        stageTimer_t timeStage(processorStage_e /*stage*/) { return {}; }
+
+        void countPacket() {}
+        void countBytes(size_t /*numBytes*/) {}
+        void countUpdates(const uint64_t * /*tradeMask*/, size_t /*numUpdates*/) {}
+
+        processorStats_t snapshot() const { return {}; }
+        void reset() {}
+    };
+};
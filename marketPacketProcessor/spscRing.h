@@ -0,0 +1,88 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+namespace marketPacket
+{
+    /**
+     * Bounded, lock-free ring for exactly one producer thread and one consumer thread.
+     *
+     * Each side keeps a cached copy of the other side's index so it only has to touch the shared
+     * cache line when it thinks the ring is full (producer) or empty (consumer)
+     *
+     * @tparam T        What gets passed around. Keep it small (a handle, an index), it gets copied in and out
+     * @tparam CAPACITY How many items the ring holds. Has to be a power of two
+     */
+    template <typename T, size_t CAPACITY>
+    class spscRing_t
+    {
+        static_assert(CAPACITY != 0 && (CAPACITY & (CAPACITY - 1)) == 0, "Capacity has to be a power of two");
+
+    public:
+        spscRing_t()
+            : m_head(0),
+              m_cachedTail(0),
+              m_tail(0),
+              m_cachedHead(0),
+              m_slots(){};
+
+        // Other threads hold references to us, moving would pull the rug out from under them
+        spscRing_t(const spscRing_t &) = delete;
+        spscRing_t &operator=(const spscRing_t &) = delete;
+
+        /**
+         * @brief Producer only. Adds an item to the back of the ring
+         *
+         * @return False if the ring is full
+         */
+        bool tryPush(const T &item)
+        {
+            const size_t tail = m_tail.load(std::memory_order_relaxed);
+            if (tail - m_cachedHead == CAPACITY)
+            {
+                m_cachedHead = m_head.load(std::memory_order_acquire);
+                if (tail - m_cachedHead == CAPACITY)
+                {
+                    return false;
+                }
+            }
+
+            m_slots[tail & (CAPACITY - 1)] = item;
+            m_tail.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * @brief Consumer only. Takes an item off the front of the ring
+         *
+         * @return False if the ring is empty
+         */
+        bool tryPop(T &item)
+        {
+            const size_t head = m_head.load(std::memory_order_relaxed);
+            if (head == m_cachedTail)
+            {
+                m_cachedTail = m_tail.load(std::memory_order_acquire);
+                if (head == m_cachedTail)
+                {
+                    return false;
+                }
+            }
+
+            item = m_slots[head & (CAPACITY - 1)];
+            m_head.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+    private:
+        alignas(64) std::atomic<size_t> m_head; // Next slot to pop. Only the consumer writes it
+        size_t m_cachedTail;                    // Consumer's last look at m_tail
+
+        alignas(64) std::atomic<size_t> m_tail; // Next slot to push. Only the producer writes it
+        size_t m_cachedHead;                    // Producer's last look at m_head
+
+        alignas(64) std::array<T, CAPACITY> m_slots; // The items themselves
+    };
+};
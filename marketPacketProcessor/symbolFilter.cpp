@@ -0,0 +1,188 @@
+#include "symbolFilter.h"
+
+#include <cstddef>
+#include <cstring>
+#include <immintrin.h>
+
+namespace marketPacket
+{
+    namespace
+    {
+        // Where the symbol starts in an update
+        constexpr const size_t SYMBOL_OFFSET = sizeof(updateHeader_t);
+
+        // The prefilter hash has to be cheap to do 16 at a time, so it sticks to 32 bit multiplies. The first 4 symbol
+        // characters are one dword, the 5th is the top byte of the dword one character further along
+        constexpr const uint32_t HASH_LO_MULTIPLIER = 0x9E3779B1;
+        constexpr const uint32_t HASH_HI_MULTIPLIER = 0x85EBCA77;
+
+        static_assert(SYMBOL_LENGTH == 5, "Prefilter hash assumes symbols are exactly one dword and a byte");
+        static_assert(offsetof(quote_t, symbol) == SYMBOL_OFFSET && offsetof(trade_t, symbol) == SYMBOL_OFFSET);
+
+        uint32_t prefilterHash(const std::byte *update)
+        {
+            uint32_t lo;
+            uint32_t hi;
+            std::memcpy(&lo, update + SYMBOL_OFFSET, sizeof(lo));
+            std::memcpy(&hi, update + SYMBOL_OFFSET + 1, sizeof(hi));
+
+            return ((lo * HASH_LO_MULTIPLIER) ^ ((hi >> 24) * HASH_HI_MULTIPLIER)) >> (32 - SYMBOL_FILTER_BITS);
+        }
+
+        void clearMatchMask(size_t numUpdates, uint64_t *matchMask)
+        {
+            std::memset(matchMask, 0, ((numUpdates + 63) / 64) * sizeof(uint64_t));
+        }
+
+        using matchFn_t = void (symbolFilter_t::*)(const std::byte *, size_t, uint64_t *) const;
+
+        matchFn_t pickKernel()
+        {
+            // We run during static init, possibly before the runtime has gotten around to this itself
+            __builtin_cpu_init();
+
+            if (__builtin_cpu_supports("avx512f"))
+            {
+                return &symbolFilter_t::matchAvx512;
+            }
+            if (__builtin_cpu_supports("avx2"))
+            {
+                return &symbolFilter_t::matchAvx2;
+            }
+            return &symbolFilter_t::matchScalar;
+        }
+
+        const matchFn_t ACTIVE_KERNEL = pickKernel();
+    }
+
+    symbolFilter_t::symbolFilter_t(const std::vector<std::string> &symbols)
+        : m_prefilter(),
+          m_symbols(symbols.size())
+    {
+        for (const std::string &symbol : symbols)
+        {
+            const auto &key = packSymbol(std::string_view(symbol));
+            if (!key.has_value())
+            {
+                continue;
+            }
+            m_symbols.findOrInsert(key.value());
+
+            // Lay it out like an update so it hashes the same way
+            update_t update{};
+            std::memcpy(reinterpret_cast<std::byte *>(&update) + SYMBOL_OFFSET, symbol.data(), SYMBOL_LENGTH);
+
+            uint32_t bit = prefilterHash(reinterpret_cast<const std::byte *>(&update));
+            m_prefilter[bit / 32] |= uint32_t(1) << (bit % 32);
+        }
+    }
+
+    void symbolFilter_t::match(const std::byte *updates, size_t numUpdates, uint64_t *matchMask) const
+    {
+        (this->*ACTIVE_KERNEL)(updates, numUpdates, matchMask);
+    }
+
+    bool symbolFilter_t::mightContain(const std::byte *update) const
+    {
+        uint32_t bit = prefilterHash(update);
+        return (m_prefilter[bit / 32] >> (bit % 32)) & 1;
+    }
+
+    void symbolFilter_t::confirmCandidates(const std::byte *updates, size_t start, uint32_t candidates, uint64_t *matchMask) const
+    {
+        for (; candidates != 0; candidates &= candidates - 1)
+        {
+            size_t updateIdx = start + __builtin_ctz(candidates);
+            const std::byte *update = updates + updateIdx * UPDATE_SIZE;
+
+            if (contains(packSymbol(reinterpret_cast<const char *>(update + SYMBOL_OFFSET))))
+            {
+                matchMask[updateIdx / 64] |= uint64_t(1) << (updateIdx % 64);
+            }
+        }
+    }
+
+    void symbolFilter_t::matchTail(const std::byte *updates, size_t start, size_t numUpdates, uint64_t *matchMask) const
+    {
+        for (size_t updateIdx = start; updateIdx < numUpdates; updateIdx++)
+        {
+            if (mightContain(updates + updateIdx * UPDATE_SIZE))
+            {
+                confirmCandidates(updates, updateIdx, 1, matchMask);
+            }
+        }
+    }
+
+    void symbolFilter_t::matchScalar(const std::byte *updates, size_t numUpdates, uint64_t *matchMask) const
+    {
+        clearMatchMask(numUpdates, matchMask);
+        matchTail(updates, 0, numUpdates, matchMask);
+    }
+
+    __attribute__((target("avx2")))
+    void symbolFilter_t::matchAvx2(const std::byte *updates, size_t numUpdates, uint64_t *matchMask) const
+    {
+        clearMatchMask(numUpdates, matchMask);
+
+        const __m256i updateOffsets = _mm256_setr_epi32(0, 1 * UPDATE_SIZE, 2 * UPDATE_SIZE, 3 * UPDATE_SIZE,
+                                                        4 * UPDATE_SIZE, 5 * UPDATE_SIZE, 6 * UPDATE_SIZE, 7 * UPDATE_SIZE);
+        const __m256i loMultiplier = _mm256_set1_epi32(HASH_LO_MULTIPLIER);
+        const __m256i hiMultiplier = _mm256_set1_epi32(HASH_HI_MULTIPLIER);
+        const __m256i bitInWord = _mm256_set1_epi32(31);
+        const __m256i one = _mm256_set1_epi32(1);
+        const int *prefilter = reinterpret_cast<const int *>(m_prefilter.data());
+
+        size_t i = 0;
+        for (; i + 8 <= numUpdates; i += 8)
+        {
+            const std::byte *p = updates + i * UPDATE_SIZE + SYMBOL_OFFSET;
+
+            // Same hash as prefilterHash(), 8 symbols at a time
+            __m256i lo = _mm256_i32gather_epi32(reinterpret_cast<const int *>(p), updateOffsets, 1);
+            __m256i hi = _mm256_srli_epi32(_mm256_i32gather_epi32(reinterpret_cast<const int *>(p + 1), updateOffsets, 1), 24);
+            __m256i hash = _mm256_xor_si256(_mm256_mullo_epi32(lo, loMultiplier), _mm256_mullo_epi32(hi, hiMultiplier));
+            hash = _mm256_srli_epi32(hash, 32 - SYMBOL_FILTER_BITS);
+
+            // Pull each symbol's prefilter word and check its bit
+            __m256i words = _mm256_i32gather_epi32(prefilter, _mm256_srli_epi32(hash, 5), 4);
+            __m256i bits = _mm256_and_si256(_mm256_srlv_epi32(words, _mm256_and_si256(hash, bitInWord)), one);
+
+            uint32_t candidates = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(bits, one)));
+            confirmCandidates(updates, i, candidates, matchMask);
+        }
+
+        matchTail(updates, i, numUpdates, matchMask);
+    }
+
+    __attribute__((target("avx512f")))
+    void symbolFilter_t::matchAvx512(const std::byte *updates, size_t numUpdates, uint64_t *matchMask) const
+    {
+        clearMatchMask(numUpdates, matchMask);
+
+        const __m512i updateOffsets = _mm512_mullo_epi32(_mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15),
+                                                         _mm512_set1_epi32(UPDATE_SIZE));
+        const __m512i loMultiplier = _mm512_set1_epi32(HASH_LO_MULTIPLIER);
+        const __m512i hiMultiplier = _mm512_set1_epi32(HASH_HI_MULTIPLIER);
+        const __m512i bitInWord = _mm512_set1_epi32(31);
+        const __m512i one = _mm512_set1_epi32(1);
+        const int *prefilter = reinterpret_cast<const int *>(m_prefilter.data());
+
+        size_t i = 0;
+        for (; i + 16 <= numUpdates; i += 16)
+        {
+            const std::byte *p = updates + i * UPDATE_SIZE + SYMBOL_OFFSET;
+
+            // Same as the AVX2 kernel, 16 at a time
+            __m512i lo = _mm512_i32gather_epi32(updateOffsets, p, 1);
+            __m512i hi = _mm512_srli_epi32(_mm512_i32gather_epi32(updateOffsets, p + 1, 1), 24);
+            __m512i hash = _mm512_xor_si512(_mm512_mullo_epi32(lo, loMultiplier), _mm512_mullo_epi32(hi, hiMultiplier));
+            hash = _mm512_srli_epi32(hash, 32 - SYMBOL_FILTER_BITS);
+
+            __m512i words = _mm512_i32gather_epi32(_mm512_srli_epi32(hash, 5), prefilter, 4);
+            uint32_t candidates = _mm512_test_epi32_mask(_mm512_srlv_epi32(words, _mm512_and_si512(hash, bitInWord)), one);
+            confirmCandidates(updates, i, candidates, matchMask);
+        }
+
+        matchTail(updates, i, numUpdates, matchMask);
+    }
+};
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "marketPacketHelpers/marketPacketHelpers.h"
+#include "marketPacketHelpers/symbolTable.h"
+
+namespace marketPacket
+{
+    // Log2 of how many bits the prefilter has. 64K bits is 8KB, which sits comfortably in L1
+    constexpr const size_t SYMBOL_FILTER_BITS = 16;
+    constexpr const size_t SYMBOL_FILTER_WORDS = (size_t(1) << SYMBOL_FILTER_BITS) / 32;
+
+    /**
+     * A set of symbols somebody's subscribed to, and kernels that check a whole chunk of updates against it at once.
+     *
+     * Every subscribed symbol sets one bit in a small bitmap. Kernels hash the symbols of 8 or 16 updates at a time
+     * and check the bitmap with a gather, so almost every update for a symbol nobody wants gets thrown out without
+     * leaving the vector registers. The odd one that gets through is checked for real against a symbolTable_t
+     */
+    class symbolFilter_t
+    {
+    public:
+        /**
+         * @brief Construct a new symbolFilter_t object
+         *
+         * @param symbols What to let through. Anything that isn't SYMBOL_LENGTH long can't show up in an update, so it's ignored
+         */
+        symbolFilter_t(const std::vector<std::string> &symbols);
+
+        /**
+         * @brief Checks a contiguous run of updates against the filter. Picks the widest kernel the CPU supports
+         *
+         * @param updates       Start of the run, assumed to be numUpdates * UPDATE_SIZE bytes
+         * @param numUpdates    How many updates are in the run. Must be <= MAX_UPDATES_IN_BODY
+         * @param matchMask     Bit i gets set if update i is for a symbol in the filter. Needs (numUpdates + 63) / 64 words
+         */
+        void match(const std::byte *updates, size_t numUpdates, uint64_t *matchMask) const;
+
+        /**
+         * @brief The individual kernels. Only call the SIMD ones if the CPU supports them
+         */
+        void matchScalar(const std::byte *updates, size_t numUpdates, uint64_t *matchMask) const;
+        void matchAvx2(const std::byte *updates, size_t numUpdates, uint64_t *matchMask) const;
+        void matchAvx512(const std::byte *updates, size_t numUpdates, uint64_t *matchMask) const;
+
+        /**
+         * @brief If a symbol is in the filter
+         */
+        bool contains(symbolKey_t key) const { return m_symbols.find(key).has_value(); }
+
+        /**
+         * @brief How many distinct symbols are in the filter
+         */
+        size_t size() const { return m_symbols.size(); }
+
+    private:
+        /**
+         * @brief Checks the updates the prefilter let through for real, and handles whatever didn't fit into a full SIMD group
+         *
+         * @param candidates Bit i set if update start + i got past the prefilter
+         */
+        void confirmCandidates(const std::byte *updates, size_t start, uint32_t candidates, uint64_t *matchMask) const;
+        void matchTail(const std::byte *updates, size_t start, size_t numUpdates, uint64_t *matchMask) const;
+
+        /**
+         * @brief If an update's symbol gets past the prefilter
+         */
+        bool mightContain(const std::byte *update) const;
+
+        std::array<uint32_t, SYMBOL_FILTER_WORDS> m_prefilter; // One bit set per subscribed symbol
+        symbolTable_t m_symbols;                               // The real set, for whatever gets past the prefilter
+    };
+};
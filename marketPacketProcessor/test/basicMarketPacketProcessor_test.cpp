@@ -0,0 +1,201 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include <vector>
+
+#include "marketPacketGenerator/marketPacketGenerator.h"
+#include "marketPacketHelpers/marketPacketHelpers.h"
+#include "marketPacketProcessor/marketPacketProcessor.h"
+
+namespace test
+{
+  // Ideally, all these go into a config file
+  const std::string INPUT_PATH = "./handler_input_test.dat";
+
+  constexpr const size_t NUM_PACKETS_TO_GENERATE = 100;
+
+  /**
+   * @brief Marks down everything it sees, in the order it sees it
+   */
+  struct recordingHandler_t
+  {
+    std::vector<marketPacket::updateType_e> updateTypes;
+    std::vector<uint64_t> tradePrices;
+    std::vector<uint64_t> quoteTimes;
+    size_t numPacketsBegun = 0;
+    size_t numPacketsEnded = 0;
+    size_t numFlushes = 0;
+
+    void onTrade(const marketPacket::trade_t &t)
+    {
+      updateTypes.push_back(t.updateHeader.type);
+      tradePrices.push_back(t.tradePrice);
+    }
+
+    void onQuote(const marketPacket::quote_t &q)
+    {
+      updateTypes.push_back(q.updateHeader.type);
+      quoteTimes.push_back(q.timeOfDay);
+    }
+
+    void onPacketBegin(const marketPacket::packetHeader_t &) { numPacketsBegun++; }
+    void onPacketEnd() { numPacketsEnded++; }
+    void onFlush() { numFlushes++; }
+  };
+
+  /**
+   * @brief Only cares about trades
+   */
+  struct tradeCountingHandler_t
+  {
+    size_t numTrades = 0;
+    void onTrade(const marketPacket::trade_t &) { numTrades++; }
+  };
+
+  /**
+   * @brief Only cares about quotes
+   */
+  struct quoteCountingHandler_t
+  {
+    size_t numQuotes = 0;
+    void onQuote(const marketPacket::quote_t &) { numQuotes++; }
+  };
+
+  /**
+   * @brief Calls it quits after a set number of packets
+   */
+  struct stoppingHandler_t
+  {
+    size_t packetsLeft = 3;
+    void onTrade(const marketPacket::trade_t &) {}
+
+    std::optional<marketPacket::failReason_t> onPacketEnd()
+    {
+      if (--packetsLeft == 0)
+      {
+        return marketPacket::INVALID_STATE;
+      }
+      return std::nullopt;
+    }
+  };
+
+  /**
+   * @brief Reads the capture the slow, obvious way so there's something to compare against
+   */
+  recordingHandler_t walkCapture()
+  {
+    recordingHandler_t expected;
+    std::ifstream capture(INPUT_PATH);
+
+    marketPacket::packetHeader_t ph;
+    while (capture.read(reinterpret_cast<char *>(&ph), sizeof(ph)))
+    {
+      expected.numPacketsBegun++;
+      for (size_t i = 0; i < ph.numMarketUpdates; i++)
+      {
+        marketPacket::update_t update;
+        capture.read(reinterpret_cast<char *>(&update), sizeof(update));
+
+        if (update.updateHeader.type == marketPacket::updateType_e::TRADE)
+        {
+          expected.onTrade(*reinterpret_cast<marketPacket::trade_t *>(&update));
+        }
+        else
+        {
+          expected.onQuote(*reinterpret_cast<marketPacket::quote_t *>(&update));
+        }
+      }
+      expected.numPacketsEnded++;
+    }
+
+    return expected;
+  }
+
+  void generateInput()
+  {
+    marketPacket::marketPacketGenerator_t mpg(std::ofstream{INPUT_PATH});
+    mpg.initialize();
+
+    ASSERT_FALSE(mpg.generatePackets(NUM_PACKETS_TO_GENERATE, marketPacket::MAX_UPDATES_ALLOWED_IN_PACKET).has_value());
+  }
+
+  TEST(basicMarketPacketProcessorTest, everyUpdateInOrder)
+  {
+    generateInput();
+    recordingHandler_t expected = walkCapture();
+
+    // Streaming splits big packets into chunks, mapping hands over whole packets. Both should see the same thing
+    std::vector<std::unique_ptr<marketPacket::inputSource_t>> inputSources;
+    inputSources.emplace_back(std::make_unique<marketPacket::streamInputSource_t>(std::ifstream{INPUT_PATH}));
+    inputSources.emplace_back(std::make_unique<marketPacket::mappedInputSource_t>(INPUT_PATH));
+
+    for (auto &inputSource : inputSources)
+    {
+      marketPacket::basicMarketPacketProcessor_t<recordingHandler_t> mpp(std::move(inputSource));
+      mpp.initialize();
+
+      ASSERT_EQ(mpp.processNextPacket().value(), marketPacket::END_OF_FILE);
+
+      const recordingHandler_t &handler = mpp.handler();
+      EXPECT_EQ(handler.updateTypes, expected.updateTypes);
+      EXPECT_EQ(handler.tradePrices, expected.tradePrices);
+      EXPECT_EQ(handler.quoteTimes, expected.quoteTimes);
+      EXPECT_EQ(handler.numPacketsBegun, NUM_PACKETS_TO_GENERATE);
+      EXPECT_EQ(handler.numPacketsEnded, NUM_PACKETS_TO_GENERATE);
+      EXPECT_EQ(handler.numFlushes, 1);
+    }
+  }
+
+  TEST(basicMarketPacketProcessorTest, onlyTradesOrOnlyQuotes)
+  {
+    generateInput();
+    recordingHandler_t expected = walkCapture();
+
+    {
+      marketPacket::basicMarketPacketProcessor_t<tradeCountingHandler_t> mpp(std::make_unique<marketPacket::streamInputSource_t>(std::ifstream{INPUT_PATH}));
+      mpp.initialize();
+
+      ASSERT_EQ(mpp.processNextPacket().value(), marketPacket::END_OF_FILE);
+      EXPECT_EQ(mpp.handler().numTrades, expected.tradePrices.size());
+    }
+
+    {
+      marketPacket::basicMarketPacketProcessor_t<quoteCountingHandler_t> mpp(std::make_unique<marketPacket::streamInputSource_t>(std::ifstream{INPUT_PATH}));
+      mpp.initialize();
+
+      ASSERT_EQ(mpp.processNextPacket().value(), marketPacket::END_OF_FILE);
+      EXPECT_EQ(mpp.handler().numQuotes, expected.quoteTimes.size());
+    }
+  }
+
+  TEST(basicMarketPacketProcessorTest, handlerCanStopProcessor)
+  {
+    generateInput();
+
+    marketPacket::basicMarketPacketProcessor_t<stoppingHandler_t> mpp(std::make_unique<marketPacket::mappedInputSource_t>(INPUT_PATH));
+    mpp.initialize();
+
+    EXPECT_EQ(mpp.processNextPacket().value(), marketPacket::INVALID_STATE);
+    EXPECT_EQ(mpp.handler().packetsLeft, 0);
+  }
+
+  TEST(basicMarketPacketProcessorTest, cutOffPacketStillEnds)
+  {
+    marketPacket::packetHeader_t ph{sizeof(marketPacket::packetHeader_t) + 2 * sizeof(marketPacket::trade_t), 2};
+    marketPacket::trade_t trade{
+        .updateHeader = {marketPacket::UPDATE_SIZE, marketPacket::updateType_e::TRADE}};
+
+    {
+      std::ofstream genStream(INPUT_PATH);
+      ASSERT_TRUE(genStream.write(reinterpret_cast<char *>(&ph), sizeof(ph)));
+      ASSERT_TRUE(genStream.write(reinterpret_cast<char *>(&trade), sizeof(trade)));
+    }
+
+    marketPacket::basicMarketPacketProcessor_t<recordingHandler_t> mpp(std::make_unique<marketPacket::mappedInputSource_t>(INPUT_PATH));
+    mpp.initialize();
+
+    EXPECT_EQ(mpp.processNextPacket().value(), marketPacket::PACKET_READ_FAILED);
+    EXPECT_EQ(mpp.handler().numPacketsBegun, 1);
+    EXPECT_EQ(mpp.handler().numPacketsEnded, 1);
+    EXPECT_TRUE(mpp.handler().updateTypes.empty());
+  }
+}
@@ -0,0 +1,229 @@
+#include <gtest/gtest.h>
+#include <arpa/inet.h>
+#include <cstring>
+#include <netinet/in.h>
+#include <sstream>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+
+#include "marketPacketGenerator/marketPacketGenerator.h"
+#include "marketPacketHelpers/marketPacketHelpers.h"
+#include "marketPacketProcessor/datagramInputSource.h"
+#include "marketPacketProcessor/marketPacketProcessor.h"
+
+namespace test
+{
+  // Ideally, all these go into a config file
+  const std::string INPUT_PATH = "./datagram_input_test.dat";
+  const std::string SOCKET_PATH = "./datagram_test.sock";
+
+  constexpr const size_t NUM_PACKETS_TO_GENERATE = 20;
+
+  // Few enough small packets that they all fit in a socket's receive queue at once
+  constexpr const size_t NUM_QUEUED_PACKETS = 32;
+  constexpr const size_t NUM_QUEUED_MAX_UPDATES = 8;
+
+  std::string readWholeFile(const std::string &path)
+  {
+    std::stringstream ss;
+    ss << std::ifstream(path).rdbuf();
+    return ss.str();
+  }
+
+  std::string generateInput(size_t numPackets, size_t numMaxUpdates)
+  {
+    {
+      marketPacket::marketPacketGenerator_t mpg(std::ofstream{INPUT_PATH});
+      mpg.initialize();
+
+      EXPECT_FALSE(mpg.generatePackets(numPackets, numMaxUpdates).has_value());
+    }
+
+    return readWholeFile(INPUT_PATH);
+  }
+
+  /**
+   * @brief What a plain old processor makes of some input
+   */
+  std::string processSerially(const std::string &input)
+  {
+    std::string output;
+    marketPacket::marketPacketProcessor_t mpp(std::make_unique<marketPacket::memoryInputSource_t>(reinterpret_cast<const std::byte *>(input.data()), input.size()),
+                                              std::make_unique<marketPacket::memoryOutputSink_t>(output));
+    mpp.initialize();
+
+    EXPECT_EQ(mpp.processNextPacket().value(), marketPacket::END_OF_FILE);
+    return output;
+  }
+
+  /**
+   * @brief Sends every packet in a capture as its own datagram, then an empty one to end it
+   */
+  void sendCapture(int fd, const std::string &capture)
+  {
+    size_t offset = 0;
+    while (offset < capture.size())
+    {
+      marketPacket::packetHeader_t ph;
+      std::memcpy(&ph, capture.data() + offset, sizeof(ph));
+
+      ASSERT_EQ(::send(fd, capture.data() + offset, ph.packetLength, 0), ph.packetLength);
+      offset += ph.packetLength;
+    }
+
+    ASSERT_EQ(::send(fd, nullptr, 0, 0), 0);
+  }
+
+  TEST(datagramInputSourceTest, matchesFileProcessing)
+  {
+    const std::string input = generateInput(NUM_PACKETS_TO_GENERATE, marketPacket::MAX_UPDATES_ALLOWED_IN_PACKET);
+
+    int fds[2];
+    ASSERT_EQ(::socketpair(AF_UNIX, SOCK_DGRAM, 0, fds), 0);
+
+    // Way more than fits in the socket at once, so the sender has to keep up with us
+    std::thread sender([&]
+                       { sendCapture(fds[1], input); });
+
+    std::string output;
+    auto datagramSource = std::make_unique<marketPacket::datagramInputSource_t>(fds[0], true);
+    const marketPacket::datagramInputSource_t &source = *datagramSource;
+
+    marketPacket::marketPacketProcessor_t mpp(std::move(datagramSource), std::make_unique<marketPacket::memoryOutputSink_t>(output));
+    mpp.initialize();
+
+    EXPECT_EQ(mpp.processNextPacket().value(), marketPacket::END_OF_FILE);
+    sender.join();
+    ::close(fds[1]);
+
+    EXPECT_EQ(output, processSerially(input));
+    EXPECT_EQ(source.numDatagrams(), NUM_PACKETS_TO_GENERATE + 1);
+  }
+
+  TEST(datagramInputSourceTest, batchesWhatsWaiting)
+  {
+    const std::string input = generateInput(NUM_QUEUED_PACKETS, NUM_QUEUED_MAX_UPDATES);
+
+    // Plain loopback UDP this time
+    int receiveFd = ::socket(AF_INET, SOCK_DGRAM, 0);
+    int sendFd = ::socket(AF_INET, SOCK_DGRAM, 0);
+    ASSERT_GE(receiveFd, 0);
+    ASSERT_GE(sendFd, 0);
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t addrLen = sizeof(addr);
+    ASSERT_EQ(::bind(receiveFd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)), 0);
+    ASSERT_EQ(::getsockname(receiveFd, reinterpret_cast<sockaddr *>(&addr), &addrLen), 0);
+    ASSERT_EQ(::connect(sendFd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)), 0);
+
+    // Everything's already waiting before we start, so one recvmmsg() should pick it all up
+    sendCapture(sendFd, input);
+    ::close(sendFd);
+
+    std::string output;
+    auto datagramSource = std::make_unique<marketPacket::datagramInputSource_t>(receiveFd, true);
+    const marketPacket::datagramInputSource_t &source = *datagramSource;
+
+    marketPacket::marketPacketProcessor_t mpp(std::move(datagramSource), std::make_unique<marketPacket::memoryOutputSink_t>(output));
+    mpp.initialize();
+
+    EXPECT_EQ(mpp.processNextPacket().value(), marketPacket::END_OF_FILE);
+    EXPECT_EQ(output, processSerially(input));
+    EXPECT_EQ(source.numDatagrams(), NUM_QUEUED_PACKETS + 1);
+    EXPECT_EQ(source.numBatches(), 1);
+  }
+
+  TEST(datagramInputSourceTest, generatorSendsToSocketPath)
+  {
+    auto datagramSource = std::make_unique<marketPacket::datagramInputSource_t>(SOCKET_PATH);
+    const marketPacket::datagramInputSource_t &source = *datagramSource;
+
+    int sendFd = ::socket(AF_UNIX, SOCK_DGRAM, 0);
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    std::strcpy(addr.sun_path, SOCKET_PATH.c_str());
+    ASSERT_EQ(::connect(sendFd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)), 0);
+
+    std::thread sender([sendFd]
+                       {
+                         marketPacket::marketPacketGenerator_t mpg(sendFd);
+                         mpg.initialize();
+
+                         EXPECT_FALSE(mpg.generatePackets(NUM_PACKETS_TO_GENERATE, marketPacket::MAX_UPDATES_ALLOWED_IN_PACKET).has_value());
+                         EXPECT_FALSE(mpg.sendEndOfInput().has_value());
+                       });
+
+    std::string output;
+    marketPacket::marketPacketProcessor_t mpp(std::move(datagramSource), std::make_unique<marketPacket::memoryOutputSink_t>(output));
+    mpp.initialize();
+
+    EXPECT_EQ(mpp.processNextPacket().value(), marketPacket::END_OF_FILE);
+    sender.join();
+    ::close(sendFd);
+
+    EXPECT_EQ(mpp.packetNum(), NUM_PACKETS_TO_GENERATE);
+    EXPECT_EQ(source.numDatagrams(), NUM_PACKETS_TO_GENERATE + 1);
+  }
+
+  TEST(datagramInputSourceTest, packetPerDatagram)
+  {
+    marketPacket::packetHeader_t ph{sizeof(marketPacket::packetHeader_t) + sizeof(marketPacket::trade_t), 1};
+    marketPacket::trade_t trade{
+        .updateHeader = {marketPacket::UPDATE_SIZE, marketPacket::updateType_e::TRADE},
+        .symbol = {'A', 'B', 'C', 'D', 'E'}};
+
+    std::string packet(reinterpret_cast<const char *>(&ph), sizeof(ph));
+    packet.append(reinterpret_cast<const char *>(&trade), sizeof(trade));
+
+    int fds[2];
+    ASSERT_EQ(::socketpair(AF_UNIX, SOCK_DGRAM, 0, fds), 0);
+
+    // Junk after a packet stays in its datagram
+    std::string paddedPacket = packet + "junk";
+    ASSERT_EQ(::send(fds[1], paddedPacket.data(), paddedPacket.size(), 0), paddedPacket.size());
+    ASSERT_EQ(::send(fds[1], packet.data(), packet.size(), 0), packet.size());
+
+    // A packet can't spill over into the next datagram
+    ph.packetLength += sizeof(marketPacket::trade_t);
+    ph.numMarketUpdates++;
+    std::memcpy(packet.data(), &ph, sizeof(ph));
+    ASSERT_EQ(::send(fds[1], packet.data(), packet.size(), 0), packet.size());
+    ASSERT_EQ(::send(fds[1], &trade, sizeof(trade), 0), sizeof(trade));
+
+    std::string output;
+    marketPacket::marketPacketProcessor_t mpp(std::make_unique<marketPacket::datagramInputSource_t>(fds[0], true),
+                                              std::make_unique<marketPacket::memoryOutputSink_t>(output));
+    mpp.initialize();
+
+    EXPECT_FALSE(mpp.processNextPacket(2).has_value());
+    EXPECT_EQ(mpp.processNextPacket().value(), marketPacket::PACKET_READ_FAILED);
+    ::close(fds[1]);
+
+    std::string tradeString = marketPacket::generateTradeString(&trade) + "\n";
+    EXPECT_EQ(output, tradeString + tradeString);
+  }
+
+  TEST(datagramInputSourceTest, idleTimeout)
+  {
+    int fds[2];
+    ASSERT_EQ(::socketpair(AF_UNIX, SOCK_DGRAM, 0, fds), 0);
+
+    marketPacket::datagramConfig_t config;
+    config.idleTimeout = std::chrono::milliseconds(10);
+
+    marketPacket::datagramInputSource_t source(fds[0], true, config);
+    EXPECT_EQ(source.checkValidity().value(), marketPacket::END_OF_FILE);
+    EXPECT_EQ(source.read(1), nullptr);
+    ::close(fds[1]);
+  }
+
+  TEST(datagramInputSourceTest, badSocket)
+  {
+    marketPacket::datagramInputSource_t source("./does_not_exist/datagram_test.sock");
+    EXPECT_EQ(source.checkValidity().value(), marketPacket::INPUT_STREAM_CLOSED);
+  }
+}
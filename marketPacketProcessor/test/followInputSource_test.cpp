@@ -0,0 +1,148 @@
+#include <gtest/gtest.h>
+#include <sstream>
+#include <thread>
+
+#include "marketPacketGenerator/marketPacketGenerator.h"
+#include "marketPacketHelpers/marketPacketHelpers.h"
+#include "marketPacketProcessor/followInputSource.h"
+#include "marketPacketProcessor/marketPacketProcessor.h"
+
+namespace test
+{
+  // Ideally, all these go into a config file
+  const std::string INPUT_PATH = "./follow_input_test.dat";
+  const std::string FOLLOWED_PATH = "./follow_followed_test.dat";
+
+  constexpr const size_t NUM_PACKETS_TO_GENERATE = 20;
+
+  std::string readWholeFile(const std::string &path)
+  {
+    std::stringstream ss;
+    ss << std::ifstream(path).rdbuf();
+    return ss.str();
+  }
+
+  void generateInput()
+  {
+    marketPacket::marketPacketGenerator_t mpg(std::ofstream{INPUT_PATH});
+    mpg.initialize();
+
+    ASSERT_FALSE(mpg.generatePackets(NUM_PACKETS_TO_GENERATE, marketPacket::MAX_UPDATES_ALLOWED_IN_PACKET).has_value());
+  }
+
+  /**
+   * @brief What a plain old processor makes of some input, and why it stopped
+   */
+  std::pair<std::string, std::string> processSerially(const std::string &input)
+  {
+    std::string output;
+    marketPacket::marketPacketProcessor_t mpp(std::make_unique<marketPacket::memoryInputSource_t>(reinterpret_cast<const std::byte *>(input.data()), input.size()),
+                                              std::make_unique<marketPacket::memoryOutputSink_t>(output));
+    mpp.initialize();
+
+    std::string failReason(mpp.processNextPacket().value());
+    return {output, failReason};
+  }
+
+  /**
+   * @brief Plays recorder. Appends data to the followed file in uneven chunks, flushing each one, with little pauses in between
+   */
+  std::thread startRecorder(const std::string &data)
+  {
+    return std::thread([&data]
+                       {
+                         std::ofstream recording(FOLLOWED_PATH, std::ios::app);
+                         size_t offset = 0;
+                         for (size_t chunk = 1; offset < data.size(); chunk = (chunk * 7 + 13) % 99991)
+                         {
+                           size_t chunkSize = std::min(chunk, data.size() - offset);
+                           recording.write(data.data() + offset, chunkSize).flush();
+                           offset += chunkSize;
+                           std::this_thread::sleep_for(std::chrono::microseconds(200));
+                         } });
+  }
+
+  /**
+   * @brief Follows the file while the recorder writes it, and checks we end up where a processor reading the finished file would
+   */
+  void expectSameAsFinishedFile(const std::string &data, const marketPacket::followConfig_t &config)
+  {
+    std::ofstream(FOLLOWED_PATH, std::ios::trunc);
+
+    std::string output;
+    auto inputSource = std::make_unique<marketPacket::followInputSource_t>(FOLLOWED_PATH, config);
+    EXPECT_EQ(inputSource->isUsingInotify(), config.useInotify);
+
+    marketPacket::marketPacketProcessor_t mpp(std::move(inputSource), std::make_unique<marketPacket::memoryOutputSink_t>(output));
+    mpp.initialize();
+
+    std::thread recorder = startRecorder(data);
+    std::string failReason(mpp.processNextPacket().value());
+    recorder.join();
+
+    const auto &[expectedOutput, expectedFailReason] = processSerially(data);
+    EXPECT_EQ(failReason, expectedFailReason);
+    EXPECT_TRUE(output == expectedOutput);
+  }
+
+  TEST(followInputSourceTest, inotify)
+  {
+    generateInput();
+
+    marketPacket::followConfig_t config;
+    config.idleTimeout = std::chrono::milliseconds(200);
+    expectSameAsFinishedFile(readWholeFile(INPUT_PATH), config);
+  }
+
+  TEST(followInputSourceTest, polling)
+  {
+    generateInput();
+
+    marketPacket::followConfig_t config;
+    config.useInotify = false;
+    config.idleTimeout = std::chrono::milliseconds(200);
+    expectSameAsFinishedFile(readWholeFile(INPUT_PATH), config);
+  }
+
+  TEST(followInputSourceTest, recorderStopsMidPacket)
+  {
+    generateInput();
+    std::string data = readWholeFile(INPUT_PATH);
+
+    marketPacket::followConfig_t config;
+    config.idleTimeout = std::chrono::milliseconds(100);
+    expectSameAsFinishedFile(data.substr(0, data.size() - 10), config);
+  }
+
+  TEST(followInputSourceTest, stop)
+  {
+    generateInput();
+    std::string data = readWholeFile(INPUT_PATH);
+    std::ofstream(FOLLOWED_PATH, std::ios::trunc);
+
+    // No idle timeout, so only stop() gets us out
+    std::string output;
+    auto inputSource = std::make_unique<marketPacket::followInputSource_t>(FOLLOWED_PATH);
+    marketPacket::followInputSource_t *follower = inputSource.get();
+
+    marketPacket::marketPacketProcessor_t mpp(std::move(inputSource), std::make_unique<marketPacket::memoryOutputSink_t>(output));
+    mpp.initialize();
+
+    std::thread recorder([&]
+                         {
+                           startRecorder(data).join();
+                           std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                           follower->stop(); });
+
+    EXPECT_EQ(mpp.processNextPacket().value(), marketPacket::END_OF_FILE);
+    recorder.join();
+
+    EXPECT_TRUE(output == processSerially(data).first);
+  }
+
+  TEST(followInputSourceTest, missingFile)
+  {
+    marketPacket::followInputSource_t inputSource("./follow_doesnt_exist.dat");
+    EXPECT_EQ(inputSource.checkValidity().value(), marketPacket::INPUT_STREAM_CLOSED);
+  }
+}
@@ -0,0 +1,159 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include <sstream>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+
+#include "marketPacketGenerator/marketPacketGenerator.h"
+#include "marketPacketHelpers/latencyStamp.h"
+#include "marketPacketHelpers/marketPacketHelpers.h"
+#include "marketPacketProcessor/datagramInputSource.h"
+#include "marketPacketProcessor/latencyHandler.h"
+#include "marketPacketProcessor/marketPacketProcessor.h"
+
+namespace test
+{
+  // Ideally, all these go into a config file
+  const std::string INPUT_PATH = "./latency_input_test.dat";
+  const std::string SOCKET_PATH = "./latency_test.sock";
+
+  constexpr const size_t NUM_PACKETS_TO_GENERATE = 50;
+  constexpr const size_t MAX_UPDATES = 32;
+
+  using latencyProcessor_t = marketPacket::basicMarketPacketProcessor_t<marketPacket::latencyHandler_t<marketPacket::tradeOutput_t>>;
+
+  std::string generateCapture(bool stampLatency)
+  {
+    {
+      marketPacket::marketPacketGenerator_t mpg(std::ofstream{INPUT_PATH});
+      mpg.initialize({.seed = 5, .stampLatency = stampLatency});
+      EXPECT_FALSE(mpg.generatePackets(NUM_PACKETS_TO_GENERATE, MAX_UPDATES).has_value());
+    }
+
+    std::stringstream ss;
+    ss << std::ifstream(INPUT_PATH).rdbuf();
+    return ss.str();
+  }
+
+  size_t countUpdates(const std::string &capture)
+  {
+    size_t numUpdates = 0;
+    for (size_t offset = 0; offset < capture.size();)
+    {
+      marketPacket::packetHeader_t ph;
+      std::memcpy(&ph, capture.data() + offset, sizeof(ph));
+      numUpdates += ph.numMarketUpdates;
+      offset += ph.packetLength;
+    }
+    return numUpdates;
+  }
+
+  std::unique_ptr<marketPacket::inputSource_t> memoryInput(const std::string &capture)
+  {
+    return std::make_unique<marketPacket::memoryInputSource_t>(reinterpret_cast<const std::byte *>(capture.data()), capture.size());
+  }
+
+  latencyProcessor_t createLatencyProcessor(std::unique_ptr<marketPacket::inputSource_t> &&inputSource, std::string &output)
+  {
+    latencyProcessor_t processor(std::move(inputSource), marketPacket::tradeOutput_t(std::make_unique<marketPacket::memoryOutputSink_t>(output)));
+    processor.handler().handler().initialize(marketPacket::outputFormat_e::TEXT);
+    processor.initialize();
+    return processor;
+  }
+
+  TEST(latencyHandlerTest, stampRoundTrip)
+  {
+    marketPacket::update_t update{};
+    std::byte *updatePtr = reinterpret_cast<std::byte *>(&update);
+
+    // Nothing but padding gets touched
+    marketPacket::writeLatencyStamp(updatePtr, 0x123456789ABCDEF0);
+    EXPECT_EQ(marketPacket::readLatencyStamp(updatePtr), 0x56789ABCDEF0);
+    for (size_t i = 0; i < marketPacket::LATENCY_STAMP_OFFSET; i++)
+    {
+      EXPECT_EQ(updatePtr[i], std::byte{0});
+    }
+
+    // Clock wrapping past the stamp's 48 bits in between is fine
+    EXPECT_EQ(marketPacket::latencyStampAge(0x56789ABCDEF0, 0x56789ABCDEF0 + 100), 100);
+    EXPECT_EQ(marketPacket::latencyStampAge(marketPacket::LATENCY_STAMP_MASK - 10, marketPacket::LATENCY_STAMP_MASK + 1 + 20), 31);
+  }
+
+  TEST(latencyHandlerTest, timesEveryUpdate)
+  {
+    const std::string capture = generateCapture(true);
+
+    std::string output;
+    latencyProcessor_t processor = createLatencyProcessor(memoryInput(capture), output);
+    EXPECT_EQ(processor.processNextPacket().value(), marketPacket::END_OF_FILE);
+
+    const auto &latencies = processor.handler().latencies();
+    EXPECT_EQ(latencies.count(), countUpdates(capture));
+    EXPECT_EQ(processor.handler().numUnstamped(), 0);
+    EXPECT_GT(latencies.min(), 0);
+
+    // Stamps don't get in the way of anything else
+    std::string plainOutput;
+    marketPacket::marketPacketProcessor_t mpp(memoryInput(capture), std::make_unique<marketPacket::memoryOutputSink_t>(plainOutput));
+    mpp.initialize();
+    EXPECT_EQ(mpp.processNextPacket().value(), marketPacket::END_OF_FILE);
+    EXPECT_EQ(output, plainOutput);
+  }
+
+  TEST(latencyHandlerTest, unstampedUpdates)
+  {
+    const std::string capture = generateCapture(false);
+
+    std::string output;
+    latencyProcessor_t processor = createLatencyProcessor(memoryInput(capture), output);
+    EXPECT_EQ(processor.processNextPacket().value(), marketPacket::END_OF_FILE);
+
+    EXPECT_EQ(processor.handler().latencies().count(), 0);
+    EXPECT_EQ(processor.handler().numUnstamped(), countUpdates(capture));
+
+    std::stringstream report;
+    processor.handler().writeReport(report);
+    EXPECT_NE(report.str().find("unstamped"), std::string::npos);
+  }
+
+  TEST(latencyHandlerTest, generatorToProcessorOverSocket)
+  {
+    auto datagramSource = std::make_unique<marketPacket::datagramInputSource_t>(SOCKET_PATH);
+
+    int sendFd = ::socket(AF_UNIX, SOCK_DGRAM, 0);
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    std::strcpy(addr.sun_path, SOCKET_PATH.c_str());
+    ASSERT_EQ(::connect(sendFd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)), 0);
+
+    // Threads stamp too, each packet as it goes out
+    std::thread sender([sendFd]
+                       {
+                         marketPacket::marketPacketGenerator_t mpg(sendFd);
+                         mpg.initialize({.numThreads = 2, .stampLatency = true});
+
+                         EXPECT_FALSE(mpg.generatePackets(NUM_PACKETS_TO_GENERATE, MAX_UPDATES).has_value());
+                         EXPECT_FALSE(mpg.sendEndOfInput().has_value());
+                       });
+
+    std::string output;
+    latencyProcessor_t processor = createLatencyProcessor(std::move(datagramSource), output);
+    EXPECT_EQ(processor.processNextPacket().value(), marketPacket::END_OF_FILE);
+    sender.join();
+    ::close(sendFd);
+
+    const auto &latencies = processor.handler().latencies();
+    EXPECT_EQ(processor.handler().numUnstamped(), 0);
+    EXPECT_GT(latencies.count(), NUM_PACKETS_TO_GENERATE);
+
+    // Same box, so nowhere near a second
+    EXPECT_LT(latencies.max(), 1000000000);
+    EXPECT_LE(latencies.percentile(50), latencies.percentile(99));
+
+    std::stringstream report;
+    processor.handler().writeReport(report);
+    EXPECT_NE(report.str().find("p99.9 "), std::string::npos);
+  }
+}
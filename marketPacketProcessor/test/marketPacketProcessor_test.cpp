@@ -1,9 +1,11 @@
 #include <gtest/gtest.h>
 #include <cstring>
+#include <sstream>
 
 #include "marketPacketGenerator/marketPacketGenerator.h"
 #include "marketPacketHelpers/marketPacketHelpers.h"
 #include "marketPacketProcessor/marketPacketProcessor.h"
+#include "marketPacketProcessor/uringInputSource.h"
 
 namespace test
 {
@@ -19,6 +21,32 @@ namespace test
     return marketPacket::marketPacketProcessor_t(std::ifstream{INPUT_PATH}, std::ofstream{OUTPUT_PATH});
   }
 
+  /**
+   * @brief Create a Processor that maps the input instead of streaming it
+   */
+  marketPacket::marketPacketProcessor_t createMappedProcessor()
+  {
+    return marketPacket::marketPacketProcessor_t(std::make_unique<marketPacket::mappedInputSource_t>(INPUT_PATH), std::ofstream{OUTPUT_PATH});
+  }
+
+  /**
+   * @brief Create a Processor that reads the input through io_uring (or whatever it falls back to)
+   */
+  marketPacket::marketPacketProcessor_t createUringProcessor(const marketPacket::uringConfig_t &config = marketPacket::uringConfig_t())
+  {
+    return marketPacket::marketPacketProcessor_t(marketPacket::uringInputSource_t::create(INPUT_PATH, config), std::ofstream{OUTPUT_PATH});
+  }
+
+  /**
+   * @brief Slurps a whole file so outputs can be compared
+   */
+  std::string readWholeFile(const std::string &path)
+  {
+    std::stringstream ss;
+    ss << std::ifstream(path).rdbuf();
+    return ss.str();
+  }
+
   TEST(marketPacketProcessorTest, noInit)
   {
     marketPacket::marketPacketProcessor_t mpp = createDefaultProcessor();
@@ -250,4 +278,320 @@ namespace test
       ASSERT_EQ(mpp.processNextPacket().value(), marketPacket::END_OF_FILE);
     }
   }
+
+  TEST(marketPacketProcessorTest, mappedNoFile)
+  {
+    marketPacket::marketPacketProcessor_t mpp(std::make_unique<marketPacket::mappedInputSource_t>("./does_not_exist.dat"), std::ofstream{OUTPUT_PATH});
+    mpp.initialize();
+
+    EXPECT_EQ(mpp.processNextPacket().value(), marketPacket::INPUT_STREAM_CLOSED);
+  }
+
+  TEST(marketPacketProcessorTest, mappedEmptyFile)
+  {
+    ASSERT_TRUE(std::ofstream(INPUT_PATH).good());
+
+    marketPacket::marketPacketProcessor_t mpp = createMappedProcessor();
+    mpp.initialize();
+
+    EXPECT_EQ(mpp.processNextPacket().value(), marketPacket::END_OF_FILE);
+  }
+
+  TEST(marketPacketProcessorTest, mappedShortPacketHeader)
+  {
+    marketPacket::packetHeader_t ph{0, 0};
+    ASSERT_TRUE(std::ofstream(INPUT_PATH).write(reinterpret_cast<char *>(&ph), sizeof(ph) - 1));
+
+    marketPacket::marketPacketProcessor_t mpp = createMappedProcessor();
+    mpp.initialize();
+
+    EXPECT_EQ(mpp.processNextPacket().value(), marketPacket::PACKET_HEADER_READ_FAILED);
+  }
+
+  TEST(marketPacketProcessorTest, mappedShortPacketBody)
+  {
+    marketPacket::packetHeader_t ph{sizeof(marketPacket::packetHeader_t) + 2 * sizeof(marketPacket::trade_t), 2};
+    marketPacket::trade_t trade{
+        .updateHeader = {marketPacket::UPDATE_SIZE, marketPacket::updateType_e::TRADE}};
+
+    {
+      std::ofstream genStream(INPUT_PATH);
+      ASSERT_TRUE(genStream.write(reinterpret_cast<char *>(&ph), sizeof(ph)));
+      ASSERT_TRUE(genStream.write(reinterpret_cast<char *>(&trade), sizeof(trade)));
+    }
+
+    marketPacket::marketPacketProcessor_t mpp = createMappedProcessor();
+    mpp.initialize();
+
+    EXPECT_EQ(mpp.processNextPacket().value(), marketPacket::PACKET_READ_FAILED);
+  }
+
+  /**
+   * Decoding in place has to give us exactly what streaming through the read buffer does
+   */
+  TEST(marketPacketProcessorTest, mappedMatchesStream)
+  {
+    constexpr const size_t NUM_PACKETS_TO_GENERATE = 200;
+
+    {
+      marketPacket::marketPacketGenerator_t mpg(std::ofstream{INPUT_PATH});
+      mpg.initialize();
+
+      ASSERT_FALSE(mpg.generatePackets(NUM_PACKETS_TO_GENERATE, marketPacket::MAX_UPDATES_ALLOWED_IN_PACKET).has_value());
+    }
+
+    {
+      marketPacket::marketPacketProcessor_t mpp = createDefaultProcessor();
+      mpp.initialize();
+
+      ASSERT_EQ(mpp.processNextPacket().value(), marketPacket::END_OF_FILE);
+    }
+    std::string streamOutput = readWholeFile(OUTPUT_PATH);
+
+    {
+      marketPacket::marketPacketProcessor_t mpp = createMappedProcessor();
+      mpp.initialize();
+
+      ASSERT_FALSE(mpp.processNextPacket(NUM_PACKETS_TO_GENERATE).has_value());
+      ASSERT_EQ(mpp.processNextPacket().value(), marketPacket::END_OF_FILE);
+    }
+    std::string mappedOutput = readWholeFile(OUTPUT_PATH);
+
+    EXPECT_FALSE(streamOutput.empty());
+    EXPECT_EQ(streamOutput, mappedOutput);
+  }
+
+  /**
+   * Going around iostreams with write(2) shouldn't change a single byte
+   */
+  TEST(marketPacketProcessorTest, fdSinkMatchesStream)
+  {
+    constexpr const size_t NUM_PACKETS_TO_GENERATE = 200;
+
+    {
+      marketPacket::marketPacketGenerator_t mpg(std::ofstream{INPUT_PATH});
+      mpg.initialize();
+
+      ASSERT_FALSE(mpg.generatePackets(NUM_PACKETS_TO_GENERATE, marketPacket::MAX_UPDATES_ALLOWED_IN_PACKET).has_value());
+    }
+
+    {
+      marketPacket::marketPacketProcessor_t mpp = createDefaultProcessor();
+      mpp.initialize();
+
+      ASSERT_EQ(mpp.processNextPacket().value(), marketPacket::END_OF_FILE);
+    }
+    std::string streamOutput = readWholeFile(OUTPUT_PATH);
+
+    {
+      marketPacket::marketPacketProcessor_t mpp(std::make_unique<marketPacket::streamInputSource_t>(std::ifstream{INPUT_PATH}),
+                                                std::make_unique<marketPacket::fdOutputSink_t>(OUTPUT_PATH));
+      mpp.initialize();
+
+      // Output should be there after every call, not just when the processor goes away
+      ASSERT_FALSE(mpp.processNextPacket(NUM_PACKETS_TO_GENERATE).has_value());
+      EXPECT_EQ(streamOutput, readWholeFile(OUTPUT_PATH));
+
+      ASSERT_EQ(mpp.processNextPacket().value(), marketPacket::END_OF_FILE);
+    }
+
+    EXPECT_FALSE(streamOutput.empty());
+    EXPECT_EQ(streamOutput, readWholeFile(OUTPUT_PATH));
+  }
+
+  TEST(marketPacketProcessorTest, fdSinkCantOpen)
+  {
+    marketPacket::packetHeader_t ph{sizeof(marketPacket::packetHeader_t) + sizeof(marketPacket::trade_t), 1};
+    marketPacket::trade_t trade{
+        .updateHeader = {marketPacket::UPDATE_SIZE, marketPacket::updateType_e::TRADE}};
+
+    {
+      std::ofstream genStream(INPUT_PATH);
+      ASSERT_TRUE(genStream.write(reinterpret_cast<char *>(&ph), sizeof(ph)));
+      ASSERT_TRUE(genStream.write(reinterpret_cast<char *>(&trade), sizeof(trade)));
+    }
+
+    marketPacket::marketPacketProcessor_t mpp(std::make_unique<marketPacket::streamInputSource_t>(std::ifstream{INPUT_PATH}),
+                                              std::make_unique<marketPacket::fdOutputSink_t>("./no_such_dir/output.dat"));
+    mpp.initialize();
+
+    EXPECT_EQ(mpp.processNextPacket(1).value(), marketPacket::TRADE_WRITE_FAILED);
+  }
+
+  /**
+   * Re-framed trades should be something another processor can pick right back up,
+   * and give the exact same text as going straight from the original input
+   */
+  TEST(marketPacketProcessorTest, binaryPacketsChain)
+  {
+    constexpr const size_t NUM_PACKETS_TO_GENERATE = 200;
+    const std::string BINARY_PATH = "./binary_test.dat";
+
+    {
+      marketPacket::marketPacketGenerator_t mpg(std::ofstream{INPUT_PATH});
+      mpg.initialize();
+
+      ASSERT_FALSE(mpg.generatePackets(NUM_PACKETS_TO_GENERATE, marketPacket::MAX_UPDATES_ALLOWED_IN_PACKET).has_value());
+    }
+
+    {
+      marketPacket::marketPacketProcessor_t mpp = createDefaultProcessor();
+      mpp.initialize();
+
+      ASSERT_EQ(mpp.processNextPacket().value(), marketPacket::END_OF_FILE);
+    }
+    std::string directOutput = readWholeFile(OUTPUT_PATH);
+
+    {
+      marketPacket::marketPacketProcessor_t mpp(std::ifstream{INPUT_PATH}, std::ofstream{BINARY_PATH});
+      mpp.initialize({.outputFormat = marketPacket::outputFormat_e::BINARY_PACKETS});
+
+      ASSERT_EQ(mpp.processNextPacket().value(), marketPacket::END_OF_FILE);
+    }
+
+    {
+      marketPacket::marketPacketProcessor_t mpp(std::ifstream{BINARY_PATH}, std::ofstream{OUTPUT_PATH});
+      mpp.initialize();
+
+      ASSERT_EQ(mpp.processNextPacket().value(), marketPacket::END_OF_FILE);
+    }
+
+    EXPECT_FALSE(directOutput.empty());
+    EXPECT_EQ(directOutput, readWholeFile(OUTPUT_PATH));
+  }
+
+  TEST(marketPacketProcessorTest, binaryRecordsOnlyTrades)
+  {
+    marketPacket::packetHeader_t ph{sizeof(marketPacket::packetHeader_t) + 3 * marketPacket::UPDATE_SIZE, 3};
+    marketPacket::trade_t trade1{
+        .updateHeader = {marketPacket::UPDATE_SIZE, marketPacket::updateType_e::TRADE},
+        .tradeSize = 1,
+        .tradePrice = 2};
+    marketPacket::quote_t quote{
+        .updateHeader = {marketPacket::UPDATE_SIZE, marketPacket::updateType_e::QUOTE}};
+    marketPacket::trade_t trade2{
+        .updateHeader = {marketPacket::UPDATE_SIZE, marketPacket::updateType_e::TRADE},
+        .tradeSize = 3,
+        .tradePrice = 4};
+
+    {
+      std::ofstream genStream(INPUT_PATH);
+      ASSERT_TRUE(genStream.write(reinterpret_cast<char *>(&ph), sizeof(ph)));
+      ASSERT_TRUE(genStream.write(reinterpret_cast<char *>(&trade1), sizeof(trade1)));
+      ASSERT_TRUE(genStream.write(reinterpret_cast<char *>(&quote), sizeof(quote)));
+      ASSERT_TRUE(genStream.write(reinterpret_cast<char *>(&trade2), sizeof(trade2)));
+    }
+
+    {
+      marketPacket::marketPacketProcessor_t mpp = createDefaultProcessor();
+      mpp.initialize({.outputFormat = marketPacket::outputFormat_e::BINARY_RECORDS});
+
+      ASSERT_EQ(mpp.processNextPacket().value(), marketPacket::END_OF_FILE);
+    }
+
+    std::string expected(reinterpret_cast<char *>(&trade1), sizeof(trade1));
+    expected.append(reinterpret_cast<char *>(&trade2), sizeof(trade2));
+    EXPECT_EQ(expected, readWholeFile(OUTPUT_PATH));
+  }
+
+  TEST(marketPacketProcessorTest, binaryPacketsSkipQuoteOnlyPackets)
+  {
+    marketPacket::packetHeader_t ph{sizeof(marketPacket::packetHeader_t) + sizeof(marketPacket::quote_t), 1};
+    marketPacket::quote_t quote{
+        .updateHeader = {marketPacket::UPDATE_SIZE, marketPacket::updateType_e::QUOTE}};
+
+    {
+      std::ofstream genStream(INPUT_PATH);
+      ASSERT_TRUE(genStream.write(reinterpret_cast<char *>(&ph), sizeof(ph)));
+      ASSERT_TRUE(genStream.write(reinterpret_cast<char *>(&quote), sizeof(quote)));
+    }
+
+    {
+      marketPacket::marketPacketProcessor_t mpp = createDefaultProcessor();
+      mpp.initialize({.outputFormat = marketPacket::outputFormat_e::BINARY_PACKETS});
+
+      ASSERT_EQ(mpp.processNextPacket().value(), marketPacket::END_OF_FILE);
+    }
+
+    EXPECT_TRUE(readWholeFile(OUTPUT_PATH).empty());
+  }
+
+  TEST(marketPacketProcessorTest, uringNoFile)
+  {
+    marketPacket::marketPacketProcessor_t mpp(std::make_unique<marketPacket::uringInputSource_t>("./does_not_exist.dat"), std::ofstream{OUTPUT_PATH});
+    mpp.initialize();
+
+    EXPECT_EQ(mpp.processNextPacket().value(), marketPacket::INPUT_STREAM_CLOSED);
+  }
+
+  TEST(marketPacketProcessorTest, uringEmptyFile)
+  {
+    ASSERT_TRUE(std::ofstream(INPUT_PATH).good());
+
+    marketPacket::marketPacketProcessor_t mpp = createUringProcessor();
+    mpp.initialize();
+
+    EXPECT_EQ(mpp.processNextPacket().value(), marketPacket::END_OF_FILE);
+  }
+
+  TEST(marketPacketProcessorTest, uringShortPacketBody)
+  {
+    marketPacket::packetHeader_t ph{sizeof(marketPacket::packetHeader_t) + 2 * sizeof(marketPacket::trade_t), 2};
+    marketPacket::trade_t trade{
+        .updateHeader = {marketPacket::UPDATE_SIZE, marketPacket::updateType_e::TRADE}};
+
+    {
+      std::ofstream genStream(INPUT_PATH);
+      ASSERT_TRUE(genStream.write(reinterpret_cast<char *>(&ph), sizeof(ph)));
+      ASSERT_TRUE(genStream.write(reinterpret_cast<char *>(&trade), sizeof(trade)));
+    }
+
+    marketPacket::marketPacketProcessor_t mpp = createUringProcessor();
+    mpp.initialize();
+
+    EXPECT_EQ(mpp.processNextPacket().value(), marketPacket::PACKET_READ_FAILED);
+  }
+
+  /**
+   * However the reads get queued up, we should end up with exactly what streaming gives us
+   */
+  TEST(marketPacketProcessorTest, uringMatchesStream)
+  {
+    constexpr const size_t NUM_PACKETS_TO_GENERATE = 200;
+
+    {
+      marketPacket::marketPacketGenerator_t mpg(std::ofstream{INPUT_PATH});
+      mpg.initialize();
+
+      ASSERT_FALSE(mpg.generatePackets(NUM_PACKETS_TO_GENERATE, marketPacket::MAX_UPDATES_ALLOWED_IN_PACKET).has_value());
+    }
+
+    {
+      marketPacket::marketPacketProcessor_t mpp = createDefaultProcessor();
+      mpp.initialize();
+
+      ASSERT_EQ(mpp.processNextPacket().value(), marketPacket::END_OF_FILE);
+    }
+    std::string streamOutput = readWholeFile(OUTPUT_PATH);
+    EXPECT_FALSE(streamOutput.empty());
+
+    // Defaults, tiny buffers so nearly every packet straddles two of them, and direct I/O
+    std::vector<marketPacket::uringConfig_t> configs{
+        {},
+        {.queueDepth = 2, .bufferSize = 4096, .registerBuffers = false},
+        {.directIo = true}};
+
+    for (const auto &config : configs)
+    {
+      {
+        marketPacket::marketPacketProcessor_t mpp = createUringProcessor(config);
+        mpp.initialize();
+
+        ASSERT_FALSE(mpp.processNextPacket(NUM_PACKETS_TO_GENERATE).has_value());
+        ASSERT_EQ(mpp.processNextPacket().value(), marketPacket::END_OF_FILE);
+      }
+
+      EXPECT_EQ(streamOutput, readWholeFile(OUTPUT_PATH));
+    }
+  }
 }
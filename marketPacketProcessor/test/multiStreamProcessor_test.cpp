@@ -0,0 +1,190 @@
+#include <gtest/gtest.h>
+#include <csignal>
+#include <fcntl.h>
+#include <sstream>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+
+#include "marketPacketGenerator/marketPacketGenerator.h"
+#include "marketPacketHelpers/marketPacketHelpers.h"
+#include "marketPacketProcessor/marketPacketProcessor.h"
+#include "marketPacketProcessor/multiStreamProcessor.h"
+
+namespace test
+{
+  // Ideally, all these go into a config file
+  const std::string INPUT_PATH = "./multistream_input_test.dat";
+
+  constexpr const size_t NUM_PACKETS_TO_GENERATE = 20;
+  constexpr const size_t NUM_PIPES = 16;
+
+  std::string readWholeFile(const std::string &path)
+  {
+    std::stringstream ss;
+    ss << std::ifstream(path).rdbuf();
+    return ss.str();
+  }
+
+  void generateInput()
+  {
+    marketPacket::marketPacketGenerator_t mpg(std::ofstream{INPUT_PATH});
+    mpg.initialize();
+
+    ASSERT_FALSE(mpg.generatePackets(NUM_PACKETS_TO_GENERATE, marketPacket::MAX_UPDATES_ALLOWED_IN_PACKET).has_value());
+  }
+
+  /**
+   * @brief What a plain old processor makes of some input, and why it stopped
+   */
+  std::pair<std::string, std::string> processSerially(const std::string &input)
+  {
+    std::string output;
+    marketPacket::marketPacketProcessor_t mpp(std::make_unique<marketPacket::memoryInputSource_t>(reinterpret_cast<const std::byte *>(input.data()), input.size()),
+                                              std::make_unique<marketPacket::memoryOutputSink_t>(output));
+    mpp.initialize();
+
+    std::string failReason(mpp.processNextPacket().value());
+    return {output, failReason};
+  }
+
+  /**
+   * @brief Dribbles data into an fd in uneven chunks, so packets show up in pieces, then closes it
+   */
+  std::thread startWriter(int fd, const std::string &data)
+  {
+    return std::thread([fd, &data]
+                       {
+                         size_t offset = 0;
+                         for (size_t chunk = 1; offset < data.size(); chunk = (chunk * 7 + 13) % 9973)
+                         {
+                           ssize_t written = ::write(fd, data.data() + offset, std::min(chunk, data.size() - offset));
+                           if (written <= 0)
+                           {
+                             break;
+                           }
+                           offset += written;
+                         }
+                         ::close(fd); });
+  }
+
+  TEST(multiStreamProcessorTest, fileSocketAndPipes)
+  {
+    generateInput();
+    std::string input = readWholeFile(INPUT_PATH);
+    const auto &[expectedOutput, expectedFailReason] = processSerially(input);
+    ASSERT_EQ(expectedFailReason, marketPacket::END_OF_FILE);
+
+    marketPacket::multiStreamProcessor_t msp;
+    msp.initialize();
+
+    std::vector<std::string> outputs(NUM_PIPES + 2);
+    std::vector<std::thread> writers;
+
+    // Regular file, epoll won't take it
+    ASSERT_TRUE(msp.addStream(INPUT_PATH, std::make_unique<marketPacket::memoryOutputSink_t>(outputs[0])).has_value());
+
+    // Local socket
+    int sockets[2];
+    ASSERT_EQ(::socketpair(AF_UNIX, SOCK_STREAM, 0, sockets), 0);
+    ASSERT_TRUE(msp.addStream(sockets[0], std::make_unique<marketPacket::memoryOutputSink_t>(outputs[1])).has_value());
+    writers.push_back(startWriter(sockets[1], input));
+
+    // Lots of pipes, all going at once
+    for (size_t pipeIdx = 0; pipeIdx < NUM_PIPES; pipeIdx++)
+    {
+      int pipeFds[2];
+      ASSERT_EQ(::pipe(pipeFds), 0);
+      ASSERT_TRUE(msp.addStream(pipeFds[0], std::make_unique<marketPacket::memoryOutputSink_t>(outputs[pipeIdx + 2])).has_value());
+      writers.push_back(startWriter(pipeFds[1], input));
+    }
+
+    ASSERT_EQ(msp.processAllStreams().value(), marketPacket::END_OF_FILE);
+    for (auto &writer : writers)
+    {
+      writer.join();
+    }
+
+    ASSERT_EQ(msp.numStreams(), outputs.size());
+    for (size_t streamIdx = 0; streamIdx < outputs.size(); streamIdx++)
+    {
+      EXPECT_EQ(msp.streamFailReason(streamIdx).value(), marketPacket::END_OF_FILE);
+      EXPECT_TRUE(outputs[streamIdx] == expectedOutput) << "Stream " << streamIdx;
+    }
+  }
+
+  TEST(multiStreamProcessorTest, badStreamsFailLikeSerial)
+  {
+    generateInput();
+    std::string input = readWholeFile(INPUT_PATH);
+
+    // Cut off mid packet, cut off mid header, and a header that makes no sense
+    std::vector<std::string> inputs{input.substr(0, input.size() - 10), input.substr(0, input.size() / 2) + "\x01"};
+    std::string garbage = input.substr(0, input.size() / 3);
+    marketPacket::packetHeader_t ph = {1, 1};
+    garbage.append(reinterpret_cast<const char *>(&ph), sizeof(ph));
+    inputs.push_back(garbage + input);
+
+    // Streams that fail get closed on the writer, which is fine, as long as it doesn't take the whole test down
+    std::signal(SIGPIPE, SIG_IGN);
+
+    marketPacket::multiStreamProcessor_t msp;
+    msp.initialize();
+
+    std::vector<std::string> outputs(inputs.size());
+    std::vector<std::thread> writers;
+    for (size_t streamIdx = 0; streamIdx < inputs.size(); streamIdx++)
+    {
+      int pipeFds[2];
+      ASSERT_EQ(::pipe(pipeFds), 0);
+      ASSERT_EQ(msp.addStream(pipeFds[0], std::make_unique<marketPacket::memoryOutputSink_t>(outputs[streamIdx])).value(), streamIdx);
+      writers.push_back(startWriter(pipeFds[1], inputs[streamIdx]));
+    }
+
+    ASSERT_EQ(msp.processAllStreams().value(), marketPacket::END_OF_FILE);
+    for (auto &writer : writers)
+    {
+      writer.join();
+    }
+
+    for (size_t streamIdx = 0; streamIdx < inputs.size(); streamIdx++)
+    {
+      const auto &[expectedOutput, expectedFailReason] = processSerially(inputs[streamIdx]);
+      EXPECT_NE(expectedFailReason, marketPacket::END_OF_FILE);
+      EXPECT_EQ(msp.streamFailReason(streamIdx).value(), expectedFailReason);
+      EXPECT_TRUE(outputs[streamIdx] == expectedOutput) << "Stream " << streamIdx;
+    }
+  }
+
+  TEST(multiStreamProcessorTest, emptyAndMissingStreams)
+  {
+    marketPacket::multiStreamProcessor_t msp;
+    msp.initialize();
+
+    std::string output;
+    EXPECT_FALSE(msp.addStream("./multistream_doesnt_exist.dat", std::make_unique<marketPacket::memoryOutputSink_t>(output)).has_value());
+    EXPECT_FALSE(msp.addStream(-1, std::make_unique<marketPacket::memoryOutputSink_t>(output)).has_value());
+
+    int pipeFds[2];
+    ASSERT_EQ(::pipe(pipeFds), 0);
+    ASSERT_TRUE(msp.addStream(pipeFds[0], std::make_unique<marketPacket::memoryOutputSink_t>(output)).has_value());
+    ::close(pipeFds[1]);
+
+    EXPECT_EQ(msp.processAllStreams().value(), marketPacket::END_OF_FILE);
+    EXPECT_EQ(msp.streamFailReason(0).value(), marketPacket::END_OF_FILE);
+    EXPECT_TRUE(output.empty());
+  }
+
+  TEST(multiStreamProcessorTest, uninitialized)
+  {
+    marketPacket::multiStreamProcessor_t msp;
+
+    int pipeFds[2];
+    ASSERT_EQ(::pipe(pipeFds), 0);
+    std::string output;
+    EXPECT_FALSE(msp.addStream(pipeFds[0], std::make_unique<marketPacket::memoryOutputSink_t>(output)).has_value());
+    ::close(pipeFds[1]);
+
+    EXPECT_EQ(msp.processAllStreams().value(), marketPacket::UNINITIALIZED);
+  }
+}
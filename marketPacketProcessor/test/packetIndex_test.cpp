@@ -0,0 +1,244 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include <sstream>
+
+#include "marketPacketGenerator/marketPacketGenerator.h"
+#include "marketPacketHelpers/marketPacketHelpers.h"
+#include "marketPacketProcessor/marketPacketProcessor.h"
+#include "marketPacketProcessor/packetIndex.h"
+#include "marketPacketProcessor/uringInputSource.h"
+
+namespace test
+{
+  // Ideally, all these go into a config file
+  const std::string INPUT_PATH = "./index_input_test.dat";
+  const std::string TAIL_INPUT_PATH = "./index_tail_input_test.dat";
+  const std::string OUTPUT_PATH = "./index_output_test.dat";
+
+  constexpr const size_t NUM_HEAD_PACKETS = 150;
+  constexpr const size_t NUM_TAIL_PACKETS = 50;
+
+  // Small so the tests cross plenty of checkpoints
+  constexpr const size_t SMALL_CHECKPOINT_INTERVAL = 16;
+
+  std::string readWholeFile(const std::string &path)
+  {
+    std::stringstream ss;
+    ss << std::ifstream(path).rdbuf();
+    return ss.str();
+  }
+
+  void generatePackets(const std::string &path, size_t numPackets)
+  {
+    marketPacket::marketPacketGenerator_t mpg(std::ofstream{path});
+    mpg.initialize();
+
+    ASSERT_FALSE(mpg.generatePackets(numPackets, marketPacket::MAX_UPDATES_ALLOWED_IN_PACKET).has_value());
+  }
+
+  /**
+   * @brief Capture is a head and a tail glued together, so we know exactly what processing from the start of the tail looks like
+   */
+  void generateHeadAndTail()
+  {
+    generatePackets(INPUT_PATH, NUM_HEAD_PACKETS);
+    generatePackets(TAIL_INPUT_PATH, NUM_TAIL_PACKETS);
+
+    std::ofstream(INPUT_PATH, std::ios::app) << std::ifstream(TAIL_INPUT_PATH).rdbuf();
+  }
+
+  /**
+   * @brief Walks the capture the slow way and checks every offset the index gives back
+   */
+  void expectOffsetsMatchWalk(const marketPacket::packetIndex_t &index)
+  {
+    std::ifstream capture(INPUT_PATH);
+
+    size_t offset = 0;
+    for (size_t packetNum = 0; packetNum < index.numPackets(); packetNum++)
+    {
+      ASSERT_EQ(index.packetOffset(packetNum), offset);
+
+      marketPacket::packetHeader_t ph;
+      capture.seekg(offset);
+      ASSERT_TRUE(capture.read(reinterpret_cast<char *>(&ph), sizeof(ph)));
+      offset += ph.packetLength;
+    }
+
+    EXPECT_FALSE(index.packetOffset(index.numPackets()).has_value());
+  }
+
+  TEST(packetIndexTest, buildNoFile)
+  {
+    marketPacket::packetIndex_t index;
+    EXPECT_EQ(index.build("./does_not_exist.dat"), marketPacket::INPUT_STREAM_CLOSED);
+  }
+
+  TEST(packetIndexTest, buildMatchesWalk)
+  {
+    generateHeadAndTail();
+
+    marketPacket::packetIndex_t index(SMALL_CHECKPOINT_INTERVAL);
+    ASSERT_FALSE(index.build(INPUT_PATH).has_value());
+
+    EXPECT_EQ(index.numPackets(), NUM_HEAD_PACKETS + NUM_TAIL_PACKETS);
+    expectOffsetsMatchWalk(index);
+  }
+
+  TEST(packetIndexTest, buildStopsAtCutOffPacket)
+  {
+    generatePackets(INPUT_PATH, NUM_HEAD_PACKETS);
+
+    // Half a packet on the end shouldn't get indexed
+    marketPacket::packetHeader_t ph{sizeof(marketPacket::packetHeader_t) + 2 * sizeof(marketPacket::trade_t), 2};
+    ASSERT_TRUE(std::ofstream(INPUT_PATH, std::ios::app).write(reinterpret_cast<char *>(&ph), sizeof(ph)));
+
+    marketPacket::packetIndex_t index(SMALL_CHECKPOINT_INTERVAL);
+    ASSERT_FALSE(index.build(INPUT_PATH).has_value());
+
+    EXPECT_EQ(index.numPackets(), NUM_HEAD_PACKETS);
+  }
+
+  TEST(packetIndexTest, saveAndLoad)
+  {
+    generateHeadAndTail();
+    const std::string indexPath = marketPacket::packetIndex_t::sidecarPath(INPUT_PATH);
+
+    {
+      marketPacket::packetIndex_t index(SMALL_CHECKPOINT_INTERVAL);
+      ASSERT_FALSE(index.build(INPUT_PATH).has_value());
+      ASSERT_FALSE(index.save(indexPath).has_value());
+    }
+
+    // Checkpoint interval comes from the file, not whatever we constructed with
+    marketPacket::packetIndex_t index;
+    ASSERT_FALSE(index.load(indexPath, INPUT_PATH).has_value());
+
+    EXPECT_EQ(index.numPackets(), NUM_HEAD_PACKETS + NUM_TAIL_PACKETS);
+    expectOffsetsMatchWalk(index);
+  }
+
+  TEST(packetIndexTest, loadBadIndex)
+  {
+    generatePackets(INPUT_PATH, NUM_HEAD_PACKETS);
+    const std::string indexPath = marketPacket::packetIndex_t::sidecarPath(INPUT_PATH);
+
+    marketPacket::packetIndex_t index;
+    ASSERT_TRUE(std::ofstream(indexPath).write("nonsense", 8));
+    EXPECT_EQ(index.load(indexPath, INPUT_PATH), marketPacket::INDEX_READ_FAILED);
+    EXPECT_EQ(index.load("./does_not_exist.idx", INPUT_PATH), marketPacket::INDEX_READ_FAILED);
+  }
+
+  TEST(packetIndexTest, loadStaleIndex)
+  {
+    generatePackets(INPUT_PATH, NUM_HEAD_PACKETS);
+    const std::string indexPath = marketPacket::packetIndex_t::sidecarPath(INPUT_PATH);
+
+    {
+      marketPacket::packetIndex_t index;
+      ASSERT_FALSE(index.build(INPUT_PATH).has_value());
+      ASSERT_FALSE(index.save(indexPath).has_value());
+    }
+
+    // Capture got regenerated out from under the index
+    generatePackets(INPUT_PATH, NUM_HEAD_PACKETS + 1);
+
+    marketPacket::packetIndex_t index;
+    EXPECT_EQ(index.load(indexPath, INPUT_PATH), marketPacket::INDEX_DOESNT_MATCH);
+  }
+
+  TEST(packetIndexTest, seekNotInitialized)
+  {
+    generatePackets(INPUT_PATH, NUM_HEAD_PACKETS);
+
+    marketPacket::packetIndex_t index;
+    ASSERT_FALSE(index.build(INPUT_PATH).has_value());
+
+    marketPacket::marketPacketProcessor_t mpp(std::ifstream{INPUT_PATH}, std::ofstream{OUTPUT_PATH});
+    EXPECT_EQ(mpp.seekToPacket(index, 0), marketPacket::UNINITIALIZED);
+  }
+
+  TEST(packetIndexTest, seekPastIndex)
+  {
+    generatePackets(INPUT_PATH, NUM_HEAD_PACKETS);
+
+    marketPacket::packetIndex_t index;
+    ASSERT_FALSE(index.build(INPUT_PATH).has_value());
+
+    marketPacket::marketPacketProcessor_t mpp(std::ifstream{INPUT_PATH}, std::ofstream{OUTPUT_PATH});
+    mpp.initialize();
+    EXPECT_EQ(mpp.seekToPacket(index, NUM_HEAD_PACKETS), marketPacket::PACKET_NOT_INDEXED);
+  }
+
+  /**
+   * Jumping to the start of the tail has to give us exactly what processing the tail on its own does, whatever we're reading with
+   */
+  TEST(packetIndexTest, seekToTail)
+  {
+    generateHeadAndTail();
+
+    {
+      marketPacket::marketPacketProcessor_t mpp(std::ifstream{TAIL_INPUT_PATH}, std::ofstream{OUTPUT_PATH});
+      mpp.initialize();
+      ASSERT_EQ(mpp.processNextPacket().value(), marketPacket::END_OF_FILE);
+    }
+    std::string tailOutput = readWholeFile(OUTPUT_PATH);
+    EXPECT_FALSE(tailOutput.empty());
+
+    marketPacket::packetIndex_t index(SMALL_CHECKPOINT_INTERVAL);
+    ASSERT_FALSE(index.build(INPUT_PATH).has_value());
+
+    std::vector<std::unique_ptr<marketPacket::inputSource_t>> inputSources;
+    inputSources.emplace_back(std::make_unique<marketPacket::streamInputSource_t>(std::ifstream{INPUT_PATH}));
+    inputSources.emplace_back(std::make_unique<marketPacket::mappedInputSource_t>(INPUT_PATH));
+    inputSources.emplace_back(marketPacket::uringInputSource_t::create(INPUT_PATH));
+
+    for (auto &inputSource : inputSources)
+    {
+      {
+        marketPacket::marketPacketProcessor_t mpp(std::move(inputSource), std::ofstream{OUTPUT_PATH});
+        mpp.initialize();
+
+        ASSERT_FALSE(mpp.seekToPacket(index, NUM_HEAD_PACKETS).has_value());
+        ASSERT_EQ(mpp.processNextPacket().value(), marketPacket::END_OF_FILE);
+      }
+
+      EXPECT_EQ(tailOutput, readWholeFile(OUTPUT_PATH));
+    }
+  }
+
+  /**
+   * Once a processor's hit the end, seeking back should get it going again like nothing happened
+   */
+  TEST(packetIndexTest, seekBackAfterEndOfFile)
+  {
+    generateHeadAndTail();
+
+    marketPacket::packetIndex_t index(SMALL_CHECKPOINT_INTERVAL);
+    ASSERT_FALSE(index.build(INPUT_PATH).has_value());
+
+    std::vector<std::unique_ptr<marketPacket::inputSource_t>> inputSources;
+    inputSources.emplace_back(std::make_unique<marketPacket::streamInputSource_t>(std::ifstream{INPUT_PATH}));
+    inputSources.emplace_back(std::make_unique<marketPacket::mappedInputSource_t>(INPUT_PATH));
+    inputSources.emplace_back(marketPacket::uringInputSource_t::create(INPUT_PATH));
+
+    for (auto &inputSource : inputSources)
+    {
+      std::string firstPass;
+      {
+        marketPacket::marketPacketProcessor_t mpp(std::move(inputSource), std::make_unique<marketPacket::memoryOutputSink_t>(firstPass));
+        mpp.initialize();
+
+        ASSERT_EQ(mpp.processNextPacket().value(), marketPacket::END_OF_FILE);
+        size_t firstPassSize = firstPass.size();
+
+        ASSERT_FALSE(mpp.seekToPacket(index, 0).has_value());
+        ASSERT_EQ(mpp.processNextPacket().value(), marketPacket::END_OF_FILE);
+
+        // Second pass went through every packet again
+        ASSERT_EQ(firstPass.size(), 2 * firstPassSize);
+        EXPECT_EQ(firstPass.substr(0, firstPassSize), firstPass.substr(firstPassSize));
+      }
+    }
+  }
+}
@@ -0,0 +1,150 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <sstream>
+
+#include "marketPacketGenerator/marketPacketGenerator.h"
+#include "marketPacketHelpers/marketPacketHelpers.h"
+#include "marketPacketProcessor/marketPacketProcessor.h"
+#include "marketPacketProcessor/parallelPacketProcessor.h"
+
+namespace test
+{
+  // Ideally, all these go into a config file
+  const std::string INPUT_PATH = "./parallel_input_test.dat";
+  const std::string SERIAL_OUTPUT_PATH = "./parallel_serial_output_test.dat";
+  const std::string PARALLEL_OUTPUT_PATH = "./parallel_output_test.dat";
+  const std::string CHECKPOINT_PATH = "./parallel_checkpoint_test.dat";
+
+  constexpr const size_t NUM_PACKETS_TO_GENERATE = 300;
+
+  // Small enough that even a modest capture gets split up plenty
+  constexpr const size_t SMALL_RANGE_SIZE = 64 * 1024;
+
+  std::string readWholeFile(const std::string &path)
+  {
+    std::stringstream ss;
+    ss << std::ifstream(path).rdbuf();
+    return ss.str();
+  }
+
+  void generateInput()
+  {
+    marketPacket::marketPacketGenerator_t mpg(std::ofstream{INPUT_PATH});
+    mpg.initialize();
+
+    ASSERT_FALSE(mpg.generatePackets(NUM_PACKETS_TO_GENERATE, marketPacket::MAX_UPDATES_ALLOWED_IN_PACKET).has_value());
+  }
+
+  /**
+   * @brief Runs both a single processor and a parallel one over the input, and makes sure they agree on everything
+   */
+  void expectSameAsSerial(const marketPacket::parallelProcessorConfig_t &config)
+  {
+    std::string serialFailReason;
+    {
+      marketPacket::marketPacketProcessor_t mpp(std::make_unique<marketPacket::mappedInputSource_t>(INPUT_PATH),
+                                                std::make_unique<marketPacket::fdOutputSink_t>(SERIAL_OUTPUT_PATH));
+      mpp.initialize(config.processorConfig);
+      serialFailReason = mpp.processNextPacket().value();
+    }
+
+    std::string parallelFailReason;
+    {
+      marketPacket::parallelPacketProcessor_t ppp(INPUT_PATH, std::make_unique<marketPacket::fdOutputSink_t>(PARALLEL_OUTPUT_PATH));
+      ppp.initialize(config);
+      parallelFailReason = ppp.processAllPackets().value();
+    }
+
+    EXPECT_EQ(serialFailReason, parallelFailReason);
+    EXPECT_EQ(readWholeFile(SERIAL_OUTPUT_PATH), readWholeFile(PARALLEL_OUTPUT_PATH));
+  }
+
+  TEST(parallelPacketProcessorTest, noInit)
+  {
+    marketPacket::parallelPacketProcessor_t ppp(INPUT_PATH, std::make_unique<marketPacket::fdOutputSink_t>(PARALLEL_OUTPUT_PATH));
+    EXPECT_EQ(ppp.processAllPackets().value(), marketPacket::UNINITIALIZED);
+  }
+
+  TEST(parallelPacketProcessorTest, noFile)
+  {
+    marketPacket::parallelPacketProcessor_t ppp("./does_not_exist.dat", std::make_unique<marketPacket::fdOutputSink_t>(PARALLEL_OUTPUT_PATH));
+    ppp.initialize();
+
+    EXPECT_EQ(ppp.processAllPackets().value(), marketPacket::INPUT_STREAM_CLOSED);
+  }
+
+  TEST(parallelPacketProcessorTest, emptyFile)
+  {
+    ASSERT_TRUE(std::ofstream(INPUT_PATH).good());
+    expectSameAsSerial({});
+  }
+
+  TEST(parallelPacketProcessorTest, matchesSerial)
+  {
+    generateInput();
+
+    for (size_t numThreads : {1, 2, 4, 7})
+    {
+      expectSameAsSerial({.numThreads = numThreads, .rangeSize = SMALL_RANGE_SIZE});
+    }
+  }
+
+  TEST(parallelPacketProcessorTest, matchesSerialBinary)
+  {
+    generateInput();
+    expectSameAsSerial({.processorConfig = {.outputFormat = marketPacket::outputFormat_e::BINARY_PACKETS},
+                        .numThreads = 4,
+                        .rangeSize = SMALL_RANGE_SIZE});
+  }
+
+  TEST(parallelPacketProcessorTest, truncatedCapture)
+  {
+    generateInput();
+
+    // Chop off the back half of the last update
+    std::filesystem::resize_file(INPUT_PATH, std::filesystem::file_size(INPUT_PATH) - marketPacket::UPDATE_SIZE / 2);
+    expectSameAsSerial({.numThreads = 4, .rangeSize = SMALL_RANGE_SIZE});
+  }
+
+  TEST(parallelPacketProcessorTest, badUpdateMidCapture)
+  {
+    generateInput();
+
+    // Stomp on an update somewhere in the middle of the capture, everything after it should be dropped
+    {
+      std::fstream corrupt(INPUT_PATH, std::ios::in | std::ios::out | std::ios::binary);
+      size_t offset = 0;
+      for (size_t i = 0; i < NUM_PACKETS_TO_GENERATE / 2; i++)
+      {
+        marketPacket::packetHeader_t ph;
+        corrupt.seekg(offset);
+        ASSERT_TRUE(corrupt.read(reinterpret_cast<char *>(&ph), sizeof(ph)));
+        offset += ph.packetLength;
+      }
+
+      marketPacket::updateHeader_t badHeader{marketPacket::UPDATE_SIZE, marketPacket::updateType_e::INVALID};
+      corrupt.seekp(offset + sizeof(marketPacket::packetHeader_t));
+      ASSERT_TRUE(corrupt.write(reinterpret_cast<char *>(&badHeader), sizeof(badHeader)));
+    }
+
+    expectSameAsSerial({.numThreads = 4, .rangeSize = SMALL_RANGE_SIZE});
+  }
+
+  TEST(parallelPacketProcessorTest, workersDontCheckpoint)
+  {
+    generateInput();
+    std::filesystem::remove(CHECKPOINT_PATH);
+
+    marketPacket::parallelProcessorConfig_t config;
+    config.processorConfig.checkpointPath = CHECKPOINT_PATH;
+    config.processorConfig.checkpointInterval = 1;
+    config.numThreads = 4;
+    config.rangeSize = SMALL_RANGE_SIZE;
+
+    marketPacket::parallelPacketProcessor_t ppp(INPUT_PATH, std::make_unique<marketPacket::fdOutputSink_t>(PARALLEL_OUTPUT_PATH));
+    ppp.initialize(config);
+
+    EXPECT_EQ(ppp.processAllPackets().value(), marketPacket::END_OF_FILE);
+    EXPECT_FALSE(std::filesystem::exists(CHECKPOINT_PATH));
+  }
+}
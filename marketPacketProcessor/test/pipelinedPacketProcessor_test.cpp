@@ -0,0 +1,196 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <sstream>
+#include <thread>
+
+#include "marketPacketGenerator/marketPacketGenerator.h"
+#include "marketPacketHelpers/marketPacketHelpers.h"
+#include "marketPacketProcessor/marketPacketProcessor.h"
+#include "marketPacketProcessor/pipelinedPacketProcessor.h"
+#include "marketPacketProcessor/spscRing.h"
+
+namespace test
+{
+  // Ideally, all these go into a config file
+  const std::string INPUT_PATH = "./pipelined_input_test.dat";
+  const std::string SERIAL_OUTPUT_PATH = "./pipelined_serial_output_test.dat";
+  const std::string PIPELINED_OUTPUT_PATH = "./pipelined_output_test.dat";
+
+  // Comfortably more than PIPELINE_NUM_BATCHES worth of batches, so the reader has to wait on the writer
+  constexpr const size_t NUM_PACKETS_TO_GENERATE = 2000;
+
+  std::string readWholeFile(const std::string &path)
+  {
+    std::stringstream ss;
+    ss << std::ifstream(path).rdbuf();
+    return ss.str();
+  }
+
+  void generateInput()
+  {
+    marketPacket::marketPacketGenerator_t mpg(std::ofstream{INPUT_PATH});
+    mpg.initialize();
+
+    ASSERT_FALSE(mpg.generatePackets(NUM_PACKETS_TO_GENERATE, marketPacket::MAX_UPDATES_ALLOWED_IN_PACKET).has_value());
+  }
+
+  /**
+   * @brief Runs both a single threaded processor and a pipelined one over the input, and makes sure they agree on everything
+   */
+  void expectSameAsSerial(const marketPacket::processorConfig_t &config)
+  {
+    std::string serialFailReason;
+    {
+      marketPacket::marketPacketProcessor_t mpp(std::make_unique<marketPacket::mappedInputSource_t>(INPUT_PATH),
+                                                std::make_unique<marketPacket::fdOutputSink_t>(SERIAL_OUTPUT_PATH));
+      mpp.initialize(config);
+      serialFailReason = mpp.processNextPacket().value();
+    }
+
+    // Stream and mapped sources get the body into a batch differently, make sure both work
+    std::vector<std::unique_ptr<marketPacket::inputSource_t>> inputSources;
+    inputSources.emplace_back(std::make_unique<marketPacket::streamInputSource_t>(std::ifstream{INPUT_PATH}));
+    inputSources.emplace_back(std::make_unique<marketPacket::mappedInputSource_t>(INPUT_PATH));
+
+    for (auto &inputSource : inputSources)
+    {
+      std::string pipelinedFailReason;
+      {
+        marketPacket::pipelinedPacketProcessor_t ppp(std::move(inputSource), std::make_unique<marketPacket::fdOutputSink_t>(PIPELINED_OUTPUT_PATH));
+        ppp.initialize(config);
+        pipelinedFailReason = ppp.processAllPackets().value();
+      }
+
+      EXPECT_EQ(serialFailReason, pipelinedFailReason);
+      EXPECT_EQ(readWholeFile(SERIAL_OUTPUT_PATH), readWholeFile(PIPELINED_OUTPUT_PATH));
+    }
+  }
+
+  TEST(spscRingTest, fullAndEmpty)
+  {
+    marketPacket::spscRing_t<int, 4> ring;
+
+    int item;
+    EXPECT_FALSE(ring.tryPop(item));
+
+    for (int i = 0; i < 4; i++)
+    {
+      EXPECT_TRUE(ring.tryPush(i));
+    }
+    EXPECT_FALSE(ring.tryPush(4));
+
+    for (int i = 0; i < 4; i++)
+    {
+      ASSERT_TRUE(ring.tryPop(item));
+      EXPECT_EQ(item, i);
+    }
+    EXPECT_FALSE(ring.tryPop(item));
+  }
+
+  TEST(spscRingTest, acrossThreads)
+  {
+    constexpr const size_t NUM_ITEMS = 100000;
+    marketPacket::spscRing_t<size_t, 64> ring;
+
+    std::thread producer([&]
+                         {
+                           for (size_t i = 0; i < NUM_ITEMS; i++)
+                           {
+                             while (!ring.tryPush(i))
+                             {
+                               std::this_thread::yield();
+                             }
+                           } });
+
+    // Everything has to come out once, in order
+    for (size_t i = 0; i < NUM_ITEMS; i++)
+    {
+      size_t item;
+      while (!ring.tryPop(item))
+      {
+        std::this_thread::yield();
+      }
+      ASSERT_EQ(item, i);
+    }
+
+    producer.join();
+  }
+
+  TEST(pipelinedPacketProcessorTest, noInit)
+  {
+    marketPacket::pipelinedPacketProcessor_t ppp(std::make_unique<marketPacket::mappedInputSource_t>(INPUT_PATH),
+                                                 std::make_unique<marketPacket::fdOutputSink_t>(PIPELINED_OUTPUT_PATH));
+    EXPECT_EQ(ppp.processAllPackets().value(), marketPacket::UNINITIALIZED);
+  }
+
+  TEST(pipelinedPacketProcessorTest, noFile)
+  {
+    marketPacket::pipelinedPacketProcessor_t ppp(std::make_unique<marketPacket::mappedInputSource_t>("./does_not_exist.dat"),
+                                                 std::make_unique<marketPacket::fdOutputSink_t>(PIPELINED_OUTPUT_PATH));
+    ppp.initialize();
+
+    EXPECT_EQ(ppp.processAllPackets().value(), marketPacket::INPUT_STREAM_CLOSED);
+  }
+
+  TEST(pipelinedPacketProcessorTest, emptyFile)
+  {
+    ASSERT_TRUE(std::ofstream(INPUT_PATH).good());
+    expectSameAsSerial({});
+  }
+
+  TEST(pipelinedPacketProcessorTest, matchesSerial)
+  {
+    generateInput();
+    expectSameAsSerial({});
+  }
+
+  TEST(pipelinedPacketProcessorTest, matchesSerialBinary)
+  {
+    generateInput();
+    expectSameAsSerial({.outputFormat = marketPacket::outputFormat_e::BINARY_PACKETS});
+  }
+
+  TEST(pipelinedPacketProcessorTest, truncatedCapture)
+  {
+    generateInput();
+
+    // Chop off the back half of the last update
+    std::filesystem::resize_file(INPUT_PATH, std::filesystem::file_size(INPUT_PATH) - marketPacket::UPDATE_SIZE / 2);
+    expectSameAsSerial({});
+  }
+
+  TEST(pipelinedPacketProcessorTest, badUpdateMidCapture)
+  {
+    generateInput();
+
+    // Stomp on an update somewhere in the middle of the capture, everything after it should be dropped
+    {
+      std::fstream corrupt(INPUT_PATH, std::ios::in | std::ios::out | std::ios::binary);
+      size_t offset = 0;
+      for (size_t i = 0; i < NUM_PACKETS_TO_GENERATE / 2; i++)
+      {
+        marketPacket::packetHeader_t ph;
+        corrupt.seekg(offset);
+        ASSERT_TRUE(corrupt.read(reinterpret_cast<char *>(&ph), sizeof(ph)));
+        offset += ph.packetLength;
+      }
+
+      marketPacket::updateHeader_t badHeader{marketPacket::UPDATE_SIZE, marketPacket::updateType_e::INVALID};
+      corrupt.seekp(offset + sizeof(marketPacket::packetHeader_t));
+      ASSERT_TRUE(corrupt.write(reinterpret_cast<char *>(&badHeader), sizeof(badHeader)));
+    }
+
+    expectSameAsSerial({});
+  }
+
+  TEST(pipelinedPacketProcessorTest, writeFailureStopsEveryStage)
+  {
+    generateInput();
+
+    marketPacket::pipelinedPacketProcessor_t ppp(std::make_unique<marketPacket::mappedInputSource_t>(INPUT_PATH),
+                                                 std::make_unique<marketPacket::fdOutputSink_t>("./no_such_dir/output.dat"));
+    ppp.initialize();
+
+    EXPECT_EQ(ppp.processAllPackets().value(), marketPacket::TRADE_WRITE_FAILED);
+  }
+}
@@ -0,0 +1,228 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <sstream>
+
+#include "marketPacketGenerator/marketPacketGenerator.h"
+#include "marketPacketHelpers/marketPacketHelpers.h"
+#include "marketPacketProcessor/marketPacketProcessor.h"
+#include "marketPacketProcessor/processorCheckpoint.h"
+
+namespace test
+{
+  // Ideally, all these go into a config file
+  const std::string INPUT_PATH = "./checkpoint_input_test.dat";
+  const std::string OUTPUT_PATH = "./checkpoint_output_test.dat";
+  const std::string EXPECTED_OUTPUT_PATH = "./checkpoint_expected_output_test.dat";
+  const std::string CHECKPOINT_PATH = "./checkpoint_test.ckpt";
+
+  constexpr const size_t NUM_PACKETS_TO_GENERATE = 200;
+
+  // Small so the tests cross plenty of checkpoints
+  constexpr const size_t SMALL_CHECKPOINT_INTERVAL = 16;
+
+  std::string readWholeFile(const std::string &path)
+  {
+    std::stringstream ss;
+    ss << std::ifstream(path).rdbuf();
+    return ss.str();
+  }
+
+  /**
+   * @brief Makes a capture and processes it start to finish in one go, so there's something to compare against
+   */
+  void generateInputAndExpectedOutput()
+  {
+    {
+      marketPacket::marketPacketGenerator_t mpg(std::ofstream{INPUT_PATH});
+      mpg.initialize();
+
+      ASSERT_FALSE(mpg.generatePackets(NUM_PACKETS_TO_GENERATE, marketPacket::MAX_UPDATES_ALLOWED_IN_PACKET).has_value());
+    }
+
+    marketPacket::marketPacketProcessor_t mpp(std::make_unique<marketPacket::mappedInputSource_t>(INPUT_PATH),
+                                              std::make_unique<marketPacket::fdOutputSink_t>(EXPECTED_OUTPUT_PATH));
+    mpp.initialize();
+
+    ASSERT_EQ(mpp.processNextPacket().value(), marketPacket::END_OF_FILE);
+    std::filesystem::remove(CHECKPOINT_PATH);
+  }
+
+  marketPacket::processorConfig_t checkpointConfig()
+  {
+    marketPacket::processorConfig_t config;
+    config.checkpointPath = CHECKPOINT_PATH;
+    config.checkpointInterval = SMALL_CHECKPOINT_INTERVAL;
+    return config;
+  }
+
+  TEST(processorCheckpointTest, saveAndLoad)
+  {
+    marketPacket::processorCheckpoint_t checkpoint{1234, 5, 678};
+    ASSERT_FALSE(marketPacket::saveCheckpoint(CHECKPOINT_PATH, checkpoint).has_value());
+
+    marketPacket::processorCheckpoint_t loaded{};
+    ASSERT_FALSE(marketPacket::loadCheckpoint(CHECKPOINT_PATH, loaded).has_value());
+    EXPECT_EQ(loaded.inputOffset, checkpoint.inputOffset);
+    EXPECT_EQ(loaded.packetNum, checkpoint.packetNum);
+    EXPECT_EQ(loaded.outputOffset, checkpoint.outputOffset);
+
+    // Nothing left lying around from getting there
+    EXPECT_FALSE(std::filesystem::exists(CHECKPOINT_PATH + ".tmp"));
+  }
+
+  TEST(processorCheckpointTest, saveFailures)
+  {
+    // Nowhere to put the temp file
+    EXPECT_EQ(marketPacket::saveCheckpoint("./does_not_exist/checkpoint.ckpt", {0, 0, 0}), marketPacket::CHECKPOINT_WRITE_FAILED);
+
+    // A sink that was never open can't promise anything made it to disk
+    marketPacket::fdOutputSink_t closedSink("./does_not_exist/output.dat");
+    EXPECT_FALSE(closedSink.sync());
+
+    marketPacket::fdOutputSink_t openSink(OUTPUT_PATH);
+    ASSERT_TRUE(openSink.write("abc", 3));
+    EXPECT_TRUE(openSink.sync());
+  }
+
+  TEST(processorCheckpointTest, loadGarbage)
+  {
+    marketPacket::processorCheckpoint_t loaded{};
+    EXPECT_EQ(marketPacket::loadCheckpoint("./does_not_exist.ckpt", loaded), marketPacket::CHECKPOINT_READ_FAILED);
+
+    std::ofstream(CHECKPOINT_PATH) << "This is definitely not a checkpoint";
+    EXPECT_EQ(marketPacket::loadCheckpoint(CHECKPOINT_PATH, loaded), marketPacket::CHECKPOINT_READ_FAILED);
+  }
+
+  TEST(processorCheckpointTest, checkpointsLineUp)
+  {
+    generateInputAndExpectedOutput();
+    const std::string expectedOutput = readWholeFile(EXPECTED_OUTPUT_PATH);
+
+    marketPacket::marketPacketProcessor_t mpp(std::make_unique<marketPacket::mappedInputSource_t>(INPUT_PATH),
+                                              std::make_unique<marketPacket::fdOutputSink_t>(OUTPUT_PATH));
+    mpp.initialize(checkpointConfig());
+
+    // Stops short of the next checkpoint, so the last one on disk is behind where we are
+    ASSERT_FALSE(mpp.processNextPacket(3 * SMALL_CHECKPOINT_INTERVAL + 5).has_value());
+    EXPECT_EQ(mpp.packetNum(), 3 * SMALL_CHECKPOINT_INTERVAL + 5);
+
+    marketPacket::processorCheckpoint_t checkpoint{};
+    ASSERT_FALSE(marketPacket::loadCheckpoint(CHECKPOINT_PATH, checkpoint).has_value());
+    EXPECT_EQ(checkpoint.packetNum, 3 * SMALL_CHECKPOINT_INTERVAL);
+
+    // Output up to the checkpoint has to be exactly what the packets before it make
+    std::ifstream capture(INPUT_PATH);
+    size_t offset = 0;
+    for (size_t packetNum = 0; packetNum < checkpoint.packetNum; packetNum++)
+    {
+      marketPacket::packetHeader_t ph;
+      capture.seekg(offset);
+      ASSERT_TRUE(capture.read(reinterpret_cast<char *>(&ph), sizeof(ph)));
+      offset += ph.packetLength;
+    }
+    EXPECT_EQ(checkpoint.inputOffset, offset);
+    EXPECT_EQ(readWholeFile(OUTPUT_PATH).substr(0, checkpoint.outputOffset), expectedOutput.substr(0, checkpoint.outputOffset));
+
+    // Running out of input leaves a checkpoint right at the end
+    ASSERT_EQ(mpp.processNextPacket().value(), marketPacket::END_OF_FILE);
+    ASSERT_FALSE(marketPacket::loadCheckpoint(CHECKPOINT_PATH, checkpoint).has_value());
+    EXPECT_EQ(checkpoint.packetNum, NUM_PACKETS_TO_GENERATE);
+    EXPECT_EQ(checkpoint.inputOffset, std::filesystem::file_size(INPUT_PATH));
+    EXPECT_EQ(checkpoint.outputOffset, expectedOutput.size());
+    EXPECT_EQ(readWholeFile(OUTPUT_PATH), expectedOutput);
+  }
+
+  TEST(processorCheckpointTest, resumeAfterCrash)
+  {
+    generateInputAndExpectedOutput();
+
+    // 'Crash' a little past a checkpoint, with output for packets after it already written
+    {
+      marketPacket::marketPacketProcessor_t mpp(std::make_unique<marketPacket::mappedInputSource_t>(INPUT_PATH),
+                                                std::make_unique<marketPacket::fdOutputSink_t>(OUTPUT_PATH));
+      mpp.initialize(checkpointConfig());
+
+      ASSERT_FALSE(mpp.processNextPacket(5 * SMALL_CHECKPOINT_INTERVAL + 7).has_value());
+    }
+
+    // Both kinds of input should get back to the same place
+    std::vector<std::unique_ptr<marketPacket::inputSource_t>> inputSources;
+    inputSources.emplace_back(std::make_unique<marketPacket::streamInputSource_t>(std::ifstream{INPUT_PATH}));
+    inputSources.emplace_back(std::make_unique<marketPacket::mappedInputSource_t>(INPUT_PATH));
+
+    marketPacket::processorCheckpoint_t checkpoint{};
+    ASSERT_FALSE(marketPacket::loadCheckpoint(CHECKPOINT_PATH, checkpoint).has_value());
+
+    for (auto &inputSource : inputSources)
+    {
+      // Each resume starts from the same checkpoint, with a bit too much output after it
+      ASSERT_FALSE(marketPacket::saveCheckpoint(CHECKPOINT_PATH, checkpoint).has_value());
+      std::ofstream(OUTPUT_PATH, std::ios::app) << "Half a line of output from a packet that never finished";
+
+      marketPacket::marketPacketProcessor_t mpp(std::move(inputSource), std::make_unique<marketPacket::fdOutputSink_t>(OUTPUT_PATH, false));
+      mpp.initialize(checkpointConfig());
+
+      ASSERT_FALSE(mpp.resumeFromCheckpoint().has_value());
+      EXPECT_EQ(mpp.inputOffset(), checkpoint.inputOffset);
+      EXPECT_EQ(mpp.packetNum(), 5 * SMALL_CHECKPOINT_INTERVAL);
+      EXPECT_EQ(mpp.handler().bytesWritten(), checkpoint.outputOffset);
+
+      ASSERT_EQ(mpp.processNextPacket().value(), marketPacket::END_OF_FILE);
+      EXPECT_EQ(mpp.packetNum(), NUM_PACKETS_TO_GENERATE);
+      EXPECT_EQ(readWholeFile(OUTPUT_PATH), readWholeFile(EXPECTED_OUTPUT_PATH));
+    }
+  }
+
+  TEST(processorCheckpointTest, resumeWithoutCheckpoint)
+  {
+    generateInputAndExpectedOutput();
+    std::ofstream(OUTPUT_PATH) << "Output from some other run entirely";
+
+    marketPacket::marketPacketProcessor_t mpp(std::make_unique<marketPacket::mappedInputSource_t>(INPUT_PATH),
+                                              std::make_unique<marketPacket::fdOutputSink_t>(OUTPUT_PATH, false));
+    mpp.initialize(checkpointConfig());
+
+    // Nothing to go back to means starting over, output and all
+    ASSERT_FALSE(mpp.resumeFromCheckpoint().has_value());
+    EXPECT_EQ(mpp.packetNum(), 0);
+
+    ASSERT_EQ(mpp.processNextPacket().value(), marketPacket::END_OF_FILE);
+    EXPECT_EQ(readWholeFile(OUTPUT_PATH), readWholeFile(EXPECTED_OUTPUT_PATH));
+  }
+
+  TEST(processorCheckpointTest, resumeFailures)
+  {
+    generateInputAndExpectedOutput();
+
+    {
+      marketPacket::marketPacketProcessor_t mpp(std::make_unique<marketPacket::mappedInputSource_t>(INPUT_PATH),
+                                                std::make_unique<marketPacket::fdOutputSink_t>(OUTPUT_PATH));
+      EXPECT_EQ(mpp.resumeFromCheckpoint(), marketPacket::UNINITIALIZED);
+
+      // Nowhere to resume from without a checkpoint path
+      mpp.initialize();
+      EXPECT_EQ(mpp.resumeFromCheckpoint(), marketPacket::CHECKPOINT_READ_FAILED);
+    }
+
+    {
+      // ofstreams can't take output back
+      marketPacket::marketPacketProcessor_t mpp(std::make_unique<marketPacket::mappedInputSource_t>(INPUT_PATH), std::ofstream{OUTPUT_PATH});
+      mpp.initialize(checkpointConfig());
+
+      EXPECT_EQ(mpp.resumeFromCheckpoint(), marketPacket::OUTPUT_RESUME_FAILED);
+      EXPECT_EQ(mpp.packetNum(), 0);
+    }
+
+    {
+      // Checkpoint promises more output than there is
+      ASSERT_FALSE(marketPacket::saveCheckpoint(CHECKPOINT_PATH, {0, 0, 1024}).has_value());
+      std::ofstream(OUTPUT_PATH) << "Too short";
+
+      marketPacket::marketPacketProcessor_t mpp(std::make_unique<marketPacket::mappedInputSource_t>(INPUT_PATH),
+                                                std::make_unique<marketPacket::fdOutputSink_t>(OUTPUT_PATH, false));
+      mpp.initialize(checkpointConfig());
+
+      EXPECT_EQ(mpp.resumeFromCheckpoint(), marketPacket::OUTPUT_RESUME_FAILED);
+    }
+  }
+}
@@ -0,0 +1,128 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include <sstream>
+#include <type_traits>
+
+#include "marketPacketGenerator/marketPacketGenerator.h"
+#include "marketPacketHelpers/marketPacketHelpers.h"
+#include "marketPacketProcessor/marketPacketProcessor.h"
+#include "marketPacketProcessor/processorStats.h"
+
+namespace test
+{
+  // Ideally, all these go into a config file
+  const std::string INPUT_PATH = "./stats_input_test.dat";
+
+  constexpr const size_t NUM_PACKETS_TO_GENERATE = 100;
+  constexpr const size_t MAX_UPDATES = 64;
+
+  /**
+   * @brief Generates a capture and hands back exactly what got written
+   */
+  std::string generateCapture()
+  {
+    {
+      marketPacket::marketPacketGenerator_t mpg(std::ofstream{INPUT_PATH});
+      mpg.initialize({.seed = 3});
+      EXPECT_FALSE(mpg.generatePackets(NUM_PACKETS_TO_GENERATE, MAX_UPDATES).has_value());
+    }
+
+    std::stringstream ss;
+    ss << std::ifstream(INPUT_PATH).rdbuf();
+    return ss.str();
+  }
+
+  TEST(processorStatsTest, recorderTimesStages)
+  {
+    marketPacket::processorStatsRecorder_t<true> recorder;
+    EXPECT_TRUE(recorder.snapshot().isEnabled);
+
+    for (size_t i = 0; i < 2; i++)
+    {
+      [[maybe_unused]] const auto &timer = recorder.timeStage(marketPacket::processorStage_e::READ_HEADER);
+    }
+
+    const marketPacket::processorStats_t &stats = recorder.snapshot();
+    EXPECT_EQ(stats.cycles(marketPacket::processorStage_e::READ_HEADER).count(), 2);
+    EXPECT_EQ(stats.cycles(marketPacket::processorStage_e::READ_PART_BODY).count(), 0);
+    EXPECT_EQ(stats.totalCycles(), stats.cycles(marketPacket::processorStage_e::READ_HEADER).sum());
+  }
+
+  TEST(processorStatsTest, recorderCounts)
+  {
+    marketPacket::processorStatsRecorder_t<true> recorder;
+
+    // 70 updates, trades at 0, 3 and 65
+    uint64_t tradeMask[2] = {0b1001, 0b10};
+    recorder.countUpdates(tradeMask, 70);
+    recorder.countBytes(70 * marketPacket::UPDATE_SIZE);
+    recorder.countPacket();
+
+    EXPECT_EQ(recorder.snapshot().numTrades, 3);
+    EXPECT_EQ(recorder.snapshot().numQuotes, 67);
+    EXPECT_EQ(recorder.snapshot().numBytes, 70 * marketPacket::UPDATE_SIZE);
+    EXPECT_EQ(recorder.snapshot().numPackets, 1);
+
+    recorder.reset();
+    EXPECT_TRUE(recorder.snapshot().isEnabled);
+    EXPECT_EQ(recorder.snapshot().numTrades, 0);
+  }
+
+  TEST(processorStatsTest, disabledIsFree)
+  {
+    // Nothing to store, nothing to report
+    EXPECT_TRUE(std::is_empty_v<marketPacket::processorStatsRecorder_t<false>>);
+    EXPECT_FALSE(marketPacket::processorStatsRecorder_t<false>().snapshot().isEnabled);
+  }
+
+  TEST(processorStatsTest, processorStats)
+  {
+    const std::string capture = generateCapture();
+
+    size_t numUpdates = 0, numTrades = 0;
+    for (size_t offset = 0; offset < capture.size();)
+    {
+      marketPacket::packetHeader_t ph;
+      std::memcpy(&ph, capture.data() + offset, sizeof(ph));
+      for (size_t i = 0; i < ph.numMarketUpdates; i++)
+      {
+        numTrades += capture[offset + sizeof(ph) + i * marketPacket::UPDATE_SIZE + marketPacket::TYPE_OFFSET] ==
+                     static_cast<char>(marketPacket::updateType_e::TRADE);
+      }
+      numUpdates += ph.numMarketUpdates;
+      offset += ph.packetLength;
+    }
+
+    std::string output;
+    marketPacket::marketPacketProcessor_t mpp(std::make_unique<marketPacket::memoryInputSource_t>(reinterpret_cast<const std::byte *>(capture.data()), capture.size()),
+                                              std::make_unique<marketPacket::memoryOutputSink_t>(output));
+    mpp.initialize();
+    EXPECT_EQ(mpp.processNextPacket().value(), marketPacket::END_OF_FILE);
+
+    const marketPacket::processorStats_t stats = mpp.stats();
+    EXPECT_EQ(stats.isEnabled, marketPacket::PROCESSOR_STATS_ENABLED);
+    if (!marketPacket::PROCESSOR_STATS_ENABLED)
+    {
+      EXPECT_EQ(stats.numPackets, 0);
+      EXPECT_EQ(stats.totalCycles(), 0);
+      return;
+    }
+
+    EXPECT_EQ(stats.numPackets, NUM_PACKETS_TO_GENERATE);
+    EXPECT_EQ(stats.numTrades, numTrades);
+    EXPECT_EQ(stats.numQuotes, numUpdates - numTrades);
+    EXPECT_EQ(stats.numBytes, capture.size());
+
+    // One validity check past the last packet finds the end of the file
+    EXPECT_EQ(stats.cycles(marketPacket::processorStage_e::CHECK_STREAM_VALIDITY).count(), NUM_PACKETS_TO_GENERATE + 1);
+    EXPECT_EQ(stats.cycles(marketPacket::processorStage_e::READ_HEADER).count(), NUM_PACKETS_TO_GENERATE);
+    EXPECT_GE(stats.cycles(marketPacket::processorStage_e::READ_PART_BODY).count(), NUM_PACKETS_TO_GENERATE);
+    EXPECT_EQ(stats.cycles(marketPacket::processorStage_e::HANDLE_UPDATES).count(),
+              stats.cycles(marketPacket::processorStage_e::READ_PART_BODY).count());
+    EXPECT_GT(stats.cycles(marketPacket::processorStage_e::HANDLE_UPDATES).sum(), 0);
+
+    mpp.resetStats();
+    EXPECT_EQ(mpp.stats().numPackets, 0);
+    EXPECT_EQ(mpp.stats().totalCycles(), 0);
+  }
+}
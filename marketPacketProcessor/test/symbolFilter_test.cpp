@@ -0,0 +1,231 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include <set>
+#include <vector>
+
+#include "marketPacketGenerator/marketPacketGenerator.h"
+#include "marketPacketHelpers/marketPacketHelpers.h"
+#include "marketPacketProcessor/marketPacketProcessor.h"
+#include "marketPacketProcessor/parallelPacketProcessor.h"
+#include "marketPacketProcessor/pipelinedPacketProcessor.h"
+#include "marketPacketProcessor/symbolFilter.h"
+
+namespace test
+{
+  // Ideally, all these go into a config file
+  const std::string INPUT_PATH = "./filter_input_test.dat";
+
+  constexpr const size_t NUM_PACKETS_TO_GENERATE = 50;
+
+  // How our processes typically look: a few hundred names out of a much bigger universe
+  constexpr const size_t NUM_SUBSCRIBED = 300;
+  constexpr const size_t NUM_UNSUBSCRIBED = 5000;
+
+  std::vector<std::string> generateUniqueSymbols(size_t numSymbols)
+  {
+    std::set<std::string> seen;
+    std::vector<std::string> symbols;
+    while (symbols.size() < numSymbols)
+    {
+      std::string symbol = marketPacket::generateRandomSymbol();
+      if (seen.insert(symbol).second)
+      {
+        symbols.push_back(symbol);
+      }
+    }
+
+    return symbols;
+  }
+
+  void generateInput()
+  {
+    marketPacket::marketPacketGenerator_t mpg(std::ofstream{INPUT_PATH});
+    mpg.initialize();
+
+    ASSERT_FALSE(mpg.generatePackets(NUM_PACKETS_TO_GENERATE, marketPacket::MAX_UPDATES_ALLOWED_IN_PACKET).has_value());
+  }
+
+  /**
+   * @brief Every update in the capture, in order
+   */
+  std::vector<marketPacket::update_t> readUpdates()
+  {
+    std::vector<marketPacket::update_t> updates;
+    std::ifstream capture(INPUT_PATH);
+
+    marketPacket::packetHeader_t ph;
+    while (capture.read(reinterpret_cast<char *>(&ph), sizeof(ph)))
+    {
+      for (size_t i = 0; i < ph.numMarketUpdates; i++)
+      {
+        marketPacket::update_t update;
+        capture.read(reinterpret_cast<char *>(&update), sizeof(update));
+        updates.push_back(update);
+      }
+    }
+
+    return updates;
+  }
+
+  /**
+   * @brief Marks down every update it sees, in the order it sees it
+   */
+  struct recordingHandler_t
+  {
+    std::vector<std::string> symbols;
+
+    void onTrade(const marketPacket::trade_t &t) { symbols.emplace_back(t.symbol, marketPacket::SYMBOL_LENGTH); }
+    void onQuote(const marketPacket::quote_t &q) { symbols.emplace_back(q.symbol, marketPacket::SYMBOL_LENGTH); }
+  };
+
+  TEST(symbolFilterTest, kernelsAgree)
+  {
+    std::vector<std::string> symbols = generateUniqueSymbols(NUM_SUBSCRIBED + NUM_UNSUBSCRIBED);
+    marketPacket::symbolFilter_t filter(std::vector<std::string>(symbols.begin(), symbols.begin() + NUM_SUBSCRIBED));
+
+    std::vector<marketPacket::update_t> updates(marketPacket::MAX_UPDATES_IN_BODY);
+    for (marketPacket::update_t &update : updates)
+    {
+      // Plenty of hits, but mostly misses
+      const std::string &symbol = (marketPacket::rand() % 4 == 0) ? symbols[marketPacket::rand() % NUM_SUBSCRIBED]
+                                                                   : symbols[NUM_SUBSCRIBED + marketPacket::rand() % NUM_UNSUBSCRIBED];
+      std::memcpy(reinterpret_cast<marketPacket::quote_t *>(&update)->symbol, symbol.data(), marketPacket::SYMBOL_LENGTH);
+    }
+    const std::byte *updatePtr = reinterpret_cast<const std::byte *>(updates.data());
+
+    std::vector<decltype(&marketPacket::symbolFilter_t::matchScalar)> kernels{&marketPacket::symbolFilter_t::matchScalar};
+    if (__builtin_cpu_supports("avx2"))
+    {
+      kernels.push_back(&marketPacket::symbolFilter_t::matchAvx2);
+    }
+    if (__builtin_cpu_supports("avx512f"))
+    {
+      kernels.push_back(&marketPacket::symbolFilter_t::matchAvx512);
+    }
+
+    // Lengths that don't fill out a whole SIMD group, as well as the biggest there is
+    for (size_t numUpdates : {size_t(0), size_t(1), size_t(7), size_t(8), size_t(17), size_t(100), marketPacket::MAX_UPDATES_IN_BODY})
+    {
+      std::array<uint64_t, marketPacket::TRADE_MASK_WORDS> expected{};
+      for (size_t i = 0; i < numUpdates; i++)
+      {
+        const char *symbol = reinterpret_cast<const marketPacket::quote_t *>(&updates[i])->symbol;
+        if (filter.contains(marketPacket::packSymbol(symbol)))
+        {
+          expected[i / 64] |= uint64_t(1) << (i % 64);
+        }
+      }
+
+      for (auto kernel : kernels)
+      {
+        // Leftovers from a bigger chunk shouldn't survive
+        std::array<uint64_t, marketPacket::TRADE_MASK_WORDS> matchMask;
+        matchMask.fill(~uint64_t(0));
+
+        (filter.*kernel)(updatePtr, numUpdates, matchMask.data());
+        for (size_t word = 0; word < (numUpdates + 63) / 64; word++)
+        {
+          EXPECT_EQ(matchMask[word], expected[word]) << "numUpdates " << numUpdates << " word " << word;
+        }
+      }
+    }
+  }
+
+  TEST(symbolFilterTest, ignoresSymbolsThatCantMatch)
+  {
+    marketPacket::symbolFilter_t filter({"ABCDE", "ABCDE", "ABCD", "ABCDEF", ""});
+
+    EXPECT_EQ(filter.size(), 1);
+    EXPECT_TRUE(filter.contains(marketPacket::packSymbol(std::string_view("ABCDE")).value()));
+    EXPECT_FALSE(filter.contains(marketPacket::packSymbol(std::string_view("ABCDF")).value()));
+  }
+
+  TEST(symbolFilterTest, handlerOnlySeesSubscribed)
+  {
+    generateInput();
+    std::vector<marketPacket::update_t> updates = readUpdates();
+
+    // Every third update's symbol, so there's both in every chunk
+    std::vector<std::string> subscribed;
+    for (size_t i = 0; i < updates.size(); i += 3)
+    {
+      subscribed.emplace_back(reinterpret_cast<const marketPacket::quote_t *>(&updates[i])->symbol, marketPacket::SYMBOL_LENGTH);
+    }
+    std::set<std::string> subscribedSet(subscribed.begin(), subscribed.end());
+
+    recordingHandler_t expected;
+    for (const marketPacket::update_t &update : updates)
+    {
+      std::string symbol(reinterpret_cast<const marketPacket::quote_t *>(&update)->symbol, marketPacket::SYMBOL_LENGTH);
+      if (subscribedSet.count(symbol) != 0)
+      {
+        expected.symbols.push_back(symbol);
+      }
+    }
+
+    marketPacket::basicMarketPacketProcessor_t<recordingHandler_t> mpp(std::make_unique<marketPacket::mappedInputSource_t>(INPUT_PATH));
+    mpp.initialize(std::make_shared<marketPacket::symbolFilter_t>(subscribed));
+    ASSERT_EQ(mpp.processNextPacket().value(), marketPacket::END_OF_FILE);
+
+    EXPECT_EQ(mpp.handler().symbols, expected.symbols);
+  }
+
+  TEST(symbolFilterTest, processorsOnlyWriteSubscribed)
+  {
+    generateInput();
+    std::vector<marketPacket::update_t> updates = readUpdates();
+
+    // Every other update's symbol. Generated symbols repeat now and then, so what gets through has to be worked out after
+    std::vector<std::string> subscribed;
+    for (size_t i = 0; i < updates.size(); i += 2)
+    {
+      subscribed.emplace_back(reinterpret_cast<const marketPacket::quote_t *>(&updates[i])->symbol, marketPacket::SYMBOL_LENGTH);
+    }
+    std::set<std::string> subscribedSet(subscribed.begin(), subscribed.end());
+
+    std::string expectedOutput;
+    for (const marketPacket::update_t &update : updates)
+    {
+      const marketPacket::trade_t *trade = reinterpret_cast<const marketPacket::trade_t *>(&update);
+      if (update.updateHeader.type == marketPacket::updateType_e::TRADE &&
+          subscribedSet.count(std::string(trade->symbol, marketPacket::SYMBOL_LENGTH)) != 0)
+      {
+        expectedOutput += marketPacket::generateTradeString(trade) + "\n";
+      }
+    }
+
+    marketPacket::processorConfig_t config;
+    config.symbolFilter = std::make_shared<marketPacket::symbolFilter_t>(subscribed);
+
+    {
+      std::string output;
+      marketPacket::marketPacketProcessor_t mpp(std::make_unique<marketPacket::mappedInputSource_t>(INPUT_PATH),
+                                                std::make_unique<marketPacket::memoryOutputSink_t>(output));
+      mpp.initialize(config);
+      ASSERT_EQ(mpp.processNextPacket().value(), marketPacket::END_OF_FILE);
+      EXPECT_EQ(output, expectedOutput);
+    }
+
+    {
+      std::string output;
+      marketPacket::pipelinedPacketProcessor_t ppp(std::make_unique<marketPacket::mappedInputSource_t>(INPUT_PATH),
+                                                   std::make_unique<marketPacket::memoryOutputSink_t>(output));
+      ppp.initialize(config);
+      ASSERT_EQ(ppp.processAllPackets().value(), marketPacket::END_OF_FILE);
+      EXPECT_EQ(output, expectedOutput);
+    }
+
+    {
+      std::string output;
+      marketPacket::parallelProcessorConfig_t parallelConfig;
+      parallelConfig.processorConfig = config;
+      parallelConfig.numThreads = 2;
+      parallelConfig.rangeSize = 64 * 1024;
+
+      marketPacket::parallelPacketProcessor_t ppp(INPUT_PATH, std::make_unique<marketPacket::memoryOutputSink_t>(output));
+      ppp.initialize(parallelConfig);
+      ASSERT_EQ(ppp.processAllPackets().value(), marketPacket::END_OF_FILE);
+      EXPECT_EQ(output, expectedOutput);
+    }
+  }
+}
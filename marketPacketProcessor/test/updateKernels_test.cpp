@@ -0,0 +1,138 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include <vector>
+
+#include "marketPacketHelpers/marketPacketHelpers.h"
+#include "marketPacketProcessor/updateKernels.h"
+
+namespace test
+{
+  struct namedKernel_t
+  {
+    const char *name;
+    const char *cpuFeature;
+    marketPacket::classifyUpdatesFn_t fn;
+  };
+
+  const std::vector<namedKernel_t> ALL_KERNELS{
+      {"scalar", nullptr, marketPacket::classifyUpdatesScalar},
+      {"sse4.2", "sse4.2", marketPacket::classifyUpdatesSse42},
+      {"avx2", "avx2", marketPacket::classifyUpdatesAvx2},
+      {"avx512", "avx512f", marketPacket::classifyUpdatesAvx512},
+      {"dispatched", nullptr, marketPacket::classifyUpdates},
+  };
+
+  bool cpuSupports(const char *feature)
+  {
+    if (feature == nullptr)
+    {
+      return true;
+    }
+
+    // __builtin_cpu_supports() only takes literals
+    if (std::strcmp(feature, "sse4.2") == 0)
+    {
+      return __builtin_cpu_supports("sse4.2");
+    }
+    if (std::strcmp(feature, "avx2") == 0)
+    {
+      return __builtin_cpu_supports("avx2");
+    }
+    if (std::strcmp(feature, "avx512f") == 0)
+    {
+      return __builtin_cpu_supports("avx512f");
+    }
+    return false;
+  }
+
+  /**
+   * @brief Fills a buffer with random, but valid, trades and quotes
+   */
+  std::vector<marketPacket::update_t> createRandomUpdates(size_t numUpdates)
+  {
+    std::vector<marketPacket::update_t> updates(numUpdates);
+    for (auto &update : updates)
+    {
+      for (auto &b : update.data)
+      {
+        b = static_cast<std::byte>(marketPacket::rand());
+      }
+
+      update.updateHeader = {marketPacket::UPDATE_SIZE, (marketPacket::rand() % 2) ? marketPacket::updateType_e::TRADE : marketPacket::updateType_e::QUOTE};
+    }
+    return updates;
+  }
+
+  /**
+   * @brief Runs a kernel and checks it against the obvious one-at-a-time walk
+   */
+  void checkKernel(const namedKernel_t &kernel, const std::vector<marketPacket::update_t> &updates)
+  {
+    size_t expectedValid = updates.size();
+    for (size_t i = 0; i < updates.size(); i++)
+    {
+      if (!marketPacket::isUpdateValid(&updates[i].updateHeader))
+      {
+        expectedValid = i;
+        break;
+      }
+    }
+
+    std::array<uint64_t, marketPacket::TRADE_MASK_WORDS> tradeMask;
+    tradeMask.fill(~0ull);
+
+    size_t numValid = kernel.fn(reinterpret_cast<const std::byte *>(updates.data()), updates.size(), tradeMask.data());
+    ASSERT_EQ(numValid, expectedValid) << kernel.name;
+
+    // The mask only means something if everything was valid
+    if (numValid != updates.size())
+    {
+      return;
+    }
+
+    for (size_t i = 0; i < updates.size(); i++)
+    {
+      bool isTrade = (tradeMask[i / 64] >> (i % 64)) & 1;
+      EXPECT_EQ(isTrade, updates[i].updateHeader.type == marketPacket::updateType_e::TRADE) << kernel.name << " update " << i;
+    }
+  }
+
+  TEST(updateKernelsTest, allValid)
+  {
+    // Odd sizes so every kernel has to fall back to its tail loop at some point
+    for (size_t numUpdates : {0ul, 1ul, 3ul, 7ul, 16ul, 63ul, 64ul, 65ul, 1000ul, marketPacket::MAX_UPDATES_IN_BODY})
+    {
+      auto updates = createRandomUpdates(numUpdates);
+      for (const auto &kernel : ALL_KERNELS)
+      {
+        if (cpuSupports(kernel.cpuFeature))
+        {
+          checkKernel(kernel, updates);
+        }
+      }
+    }
+  }
+
+  TEST(updateKernelsTest, badUpdateAnywhere)
+  {
+    constexpr const size_t NUM_UPDATES = 100;
+
+    for (size_t badIdx = 0; badIdx < NUM_UPDATES; badIdx++)
+    {
+      auto badType = createRandomUpdates(NUM_UPDATES);
+      badType[badIdx].updateHeader.type = marketPacket::updateType_e::INVALID;
+
+      auto badLength = createRandomUpdates(NUM_UPDATES);
+      badLength[badIdx].updateHeader.length = marketPacket::UPDATE_SIZE | 0x100;
+
+      for (const auto &kernel : ALL_KERNELS)
+      {
+        if (cpuSupports(kernel.cpuFeature))
+        {
+          checkKernel(kernel, badType);
+          checkKernel(kernel, badLength);
+        }
+      }
+    }
+  }
+}
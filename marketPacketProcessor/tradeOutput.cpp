@@ -0,0 +1,151 @@
+#include "tradeOutput.h"
+
+#include <assert.h>
+#include <cstring>
+
+namespace marketPacket
+{
+    void tradeOutput_t::initialize(outputFormat_e format)
+    {
+        m_format = format;
+        m_outputBuffer = std::make_unique<char[]>(OUTPUT_BUFFER_SIZE);
+    }
+
+    void tradeOutput_t::onPacketBegin(const packetHeader_t &ph)
+    {
+        if (m_format != outputFormat_e::BINARY_PACKETS)
+        {
+            return;
+        }
+
+        // We have to come back and fill in the header once we know how many trades there were,
+        // so the whole re-framed packet needs to fit in the buffer. It can't be longer than what came in
+        if (OUTPUT_BUFFER_SIZE - m_outputBufferUsed < ph.packetLength)
+        {
+            flushBuffer();
+        }
+
+        m_packetOutputStart = m_outputBufferUsed;
+        m_outputBufferUsed += PACKET_HEADER_SIZE;
+    }
+
+    std::optional<failReason_t> tradeOutput_t::onPacketEnd()
+    {
+        if (m_packetOutputStart.has_value())
+        {
+            size_t packetStart = m_packetOutputStart.value();
+            size_t packetLength = m_outputBufferUsed - packetStart;
+            m_packetOutputStart.reset();
+
+            if (packetLength == PACKET_HEADER_SIZE)
+            {
+                // No trades, no packet
+                m_outputBufferUsed = packetStart;
+            }
+            else
+            {
+                packetHeader_t ph{static_cast<uint16_t>(packetLength), static_cast<uint16_t>((packetLength - PACKET_HEADER_SIZE) / sizeof(trade_t))};
+                std::memcpy(m_outputBuffer.get() + packetStart, &ph, PACKET_HEADER_SIZE);
+            }
+        }
+
+        if (m_writeFailed)
+        {
+            return TRADE_WRITE_FAILED;
+        }
+
+        return std::nullopt;
+    }
+
+    void tradeOutput_t::onTrade(const trade_t &t)
+    {
+        switch (m_format)
+        {
+        case outputFormat_e::TEXT:
+        {
+            appendTradeString(t);
+            break;
+        }
+
+        case outputFormat_e::BINARY_RECORDS:
+        case outputFormat_e::BINARY_PACKETS:
+        {
+            appendTradeRecord(t);
+            break;
+        }
+
+        default:
+        {
+            // You really shouldn't be able to get here
+            assert(false);
+            break;
+        }
+        }
+    }
+
+    std::optional<failReason_t> tradeOutput_t::onFlush()
+    {
+        flushBuffer();
+
+        if (m_writeFailed)
+        {
+            return TRADE_WRITE_FAILED;
+        }
+
+        return std::nullopt;
+    }
+
+    void tradeOutput_t::flushBuffer()
+    {
+        // Flushing a packet before its header is filled in would send garbage
+        assert(!m_packetOutputStart.has_value());
+
+        if (m_outputBufferUsed != 0 && !m_outputSink->write(m_outputBuffer.get(), m_outputBufferUsed))
+        {
+            m_writeFailed = true;
+        }
+
+        m_bytesWritten += m_outputBufferUsed;
+        m_outputBufferUsed = 0;
+    }
+
+    bool tradeOutput_t::truncateTo(size_t bytesWritten)
+    {
+        // Anything still in the buffer would land after the cut
+        assert(m_outputBufferUsed == 0 && !m_packetOutputStart.has_value());
+
+        if (!m_outputSink->truncateTo(bytesWritten))
+        {
+            return false;
+        }
+
+        m_bytesWritten = bytesWritten;
+        return true;
+    }
+
+    void tradeOutput_t::appendTradeString(const trade_t &t)
+    {
+        // Make sure the next trade has room, no matter how long it ends up being
+        if (OUTPUT_BUFFER_SIZE - m_outputBufferUsed < MAX_TRADE_STRING_LENGTH)
+        {
+            flushBuffer();
+        }
+
+        char *tradeEnd = formatTrade(m_outputBuffer.get() + m_outputBufferUsed, &t);
+        *tradeEnd++ = '\n';
+
+        m_outputBufferUsed = tradeEnd - m_outputBuffer.get();
+    }
+
+    void tradeOutput_t::appendTradeRecord(const trade_t &t)
+    {
+        // Mid packet, onPacketBegin() already made sure the whole packet fits
+        if (OUTPUT_BUFFER_SIZE - m_outputBufferUsed < sizeof(trade_t))
+        {
+            flushBuffer();
+        }
+
+        std::memcpy(m_outputBuffer.get() + m_outputBufferUsed, &t, sizeof(trade_t));
+        m_outputBufferUsed += sizeof(trade_t);
+    }
+};
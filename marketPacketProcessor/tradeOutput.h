@@ -0,0 +1,123 @@
+#pragma once
+
+#include <memory>
+#include <optional>
+
+#include "marketPacketHelpers/marketPacketHelpers.h"
+#include "outputSink.h"
+
+namespace marketPacket
+{
+    /**
+     * @brief How a processor writes out the trades it finds
+     */
+    enum class outputFormat_e : uint8_t
+    {
+        TEXT = 0,       // One human readable line per trade
+        BINARY_RECORDS, // Raw trade_t records, back to back
+        BINARY_PACKETS  // Raw trade_t records re-framed under a new packetHeader_t per input packet. Another processor can read it
+    };
+
+    /**
+     * Formats trades into one big buffer and hands it to an output sink when it fills up.
+     *
+     * Anything that turns trades into output (a processor, the writer stage of a pipeline, etc.)
+     * goes through here so every one of them writes exactly the same bytes. It's also the
+     * handler marketPacketProcessor_t plugs into basicMarketPacketProcessor_t
+     */
+    class tradeOutput_t
+    {
+    public:
+        /**
+         * @brief Construct a new tradeOutput_t object
+         *
+         * @param outputSink Where the buffer gets flushed to
+         */
+        tradeOutput_t(std::unique_ptr<outputSink_t> &&outputSink)
+            : m_format(outputFormat_e::TEXT),
+              m_outputBuffer(),
+              m_outputBufferUsed(),
+              m_packetOutputStart(),
+              m_bytesWritten(),
+              m_writeFailed(false),
+              m_outputSink(std::move(outputSink)){};
+
+        /**
+         * @brief Sets up the buffer. Nothing can be appended until this is called
+         *
+         * @param format What the output sink should see
+         */
+        void initialize(outputFormat_e format);
+
+        /**
+         * @brief For BINARY_PACKETS, leaves room for a new packet header before this packet's trades
+         *
+         * @param ph Header of the incoming packet. The re-framed one can't be any longer
+         */
+        void onPacketBegin(const packetHeader_t &ph);
+
+        /**
+         * @brief Formats a trade into the buffer in whatever format we were set up with
+         */
+        void onTrade(const trade_t &t);
+
+        /**
+         * @brief For BINARY_PACKETS, fills in the header left by onPacketBegin(), or drops it if no trades showed up
+         *
+         * @return TRADE_WRITE_FAILED if the buffer filled up along the way and didn't make it out
+         */
+        std::optional<failReason_t> onPacketEnd();
+
+        /**
+         * @brief Hands everything in the buffer over to the output sink
+         *
+         * @return TRADE_WRITE_FAILED if any write to the sink has ever failed
+         */
+        std::optional<failReason_t> onFlush();
+
+        /**
+         * @brief How much has made it out to the output sink so far
+         */
+        size_t bytesWritten() const { return m_bytesWritten; }
+
+        /**
+         * @brief Throws away all the output past bytesWritten, and carries on from there. Only between flushes
+         *
+         * @return False if the output sink can't
+         */
+        bool truncateTo(size_t bytesWritten);
+
+        /**
+         * @brief Makes sure everything the output sink has taken is on disk. Doesn't flush
+         *
+         * @return False if the output sink couldn't
+         */
+        bool sync() { return m_outputSink->sync(); }
+
+    private:
+        /**
+         * @brief Hands everything in the buffer over to the output sink, and marks it down if that didn't work
+         */
+        void flushBuffer();
+
+        /**
+         * @brief Outputs relevant information about trade to output buffer
+         */
+        void appendTradeString(const trade_t &t);
+
+        /**
+         * @brief Copies the raw trade to the output buffer as is
+         */
+        void appendTradeRecord(const trade_t &t);
+
+        outputFormat_e m_format; // What the output sink sees
+
+        std::unique_ptr<char[]> m_outputBuffer;    // Where we format updates before they go out in one big write
+        size_t m_outputBufferUsed;                 // How much of the output buffer is filled
+        std::optional<size_t> m_packetOutputStart; // Where the header of the packet we're re-framing goes, if we're mid packet
+
+        size_t m_bytesWritten;                      // Everything the sink has taken so far
+        bool m_writeFailed;                         // If the sink ever let us down
+        std::unique_ptr<outputSink_t> m_outputSink; // Where the output buffer gets flushed to
+    };
+};
@@ -0,0 +1,216 @@
+#include "updateKernels.h"
+
+#include <cstring>
+#include <immintrin.h>
+
+namespace marketPacket
+{
+    namespace
+    {
+        // The first 4 bytes of an update as one little endian dword are length | type << 16 | symbol[0] << 24.
+        // Masking off the symbol byte leaves something we can compare against in a single instruction
+        constexpr const uint32_t HEADER_MASK = 0x00FFFFFF;
+        constexpr const uint32_t TRADE_HEADER = UPDATE_SIZE | (static_cast<uint32_t>(updateType_e::TRADE) << 16);
+        constexpr const uint32_t QUOTE_HEADER = UPDATE_SIZE | (static_cast<uint32_t>(updateType_e::QUOTE) << 16);
+
+        static_assert(TYPE_OFFSET == 2, "Header packing above assumes the type sits right after the length");
+
+        /**
+         * @brief Finishes off whatever didn't fit into a full SIMD group
+         */
+        size_t classifyTail(const std::byte *updates, size_t start, size_t numUpdates, uint64_t *tradeMask)
+        {
+            for (size_t i = start; i < numUpdates; i++)
+            {
+                const updateHeader_t *uh = reinterpret_cast<const updateHeader_t *>(updates + i * UPDATE_SIZE);
+                if (!isUpdateValid(uh))
+                {
+                    return i;
+                }
+
+                tradeMask[i / 64] |= static_cast<uint64_t>(uh->type == updateType_e::TRADE) << (i % 64);
+            }
+
+            return numUpdates;
+        }
+
+        void clearTradeMask(size_t numUpdates, uint64_t *tradeMask)
+        {
+            std::memset(tradeMask, 0, ((numUpdates + 63) / 64) * sizeof(uint64_t));
+        }
+
+        struct kernel_t
+        {
+            classifyUpdatesFn_t fn;
+            std::string_view name;
+        };
+
+        kernel_t pickKernel()
+        {
+            // We run during static init, possibly before the runtime has gotten around to this itself
+            __builtin_cpu_init();
+
+            if (__builtin_cpu_supports("avx512f"))
+            {
+                return {classifyUpdatesAvx512, "avx512"};
+            }
+            if (__builtin_cpu_supports("avx2"))
+            {
+                return {classifyUpdatesAvx2, "avx2"};
+            }
+            if (__builtin_cpu_supports("sse4.2"))
+            {
+                return {classifyUpdatesSse42, "sse4.2"};
+            }
+            return {classifyUpdatesScalar, "scalar"};
+        }
+
+        const kernel_t ACTIVE_KERNEL = pickKernel();
+
+        /**
+         * @brief Loads the front half of two updates into the two 128 bit lanes of one register
+         */
+        __attribute__((target("avx2")))
+        inline __m256i loadUpdatePair(const std::byte *lo, const std::byte *hi)
+        {
+            return _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(lo))),
+                                           _mm_loadu_si128(reinterpret_cast<const __m128i *>(hi)), 1);
+        }
+
+        /**
+         * @brief Loads the front half of four updates into the four 128 bit lanes of one register
+         */
+        __attribute__((target("avx512f")))
+        inline __m512i loadUpdateQuad(const std::byte *u0, const std::byte *u1, const std::byte *u2, const std::byte *u3)
+        {
+            __m512i quad = _mm512_castsi128_si512(_mm_loadu_si128(reinterpret_cast<const __m128i *>(u0)));
+            quad = _mm512_inserti32x4(quad, _mm_loadu_si128(reinterpret_cast<const __m128i *>(u1)), 1);
+            quad = _mm512_inserti32x4(quad, _mm_loadu_si128(reinterpret_cast<const __m128i *>(u2)), 2);
+            return _mm512_inserti32x4(quad, _mm_loadu_si128(reinterpret_cast<const __m128i *>(u3)), 3);
+        }
+    }
+
+    size_t classifyUpdates(const std::byte *updates, size_t numUpdates, uint64_t *tradeMask)
+    {
+        return ACTIVE_KERNEL.fn(updates, numUpdates, tradeMask);
+    }
+
+    std::string_view activeClassifyKernelName()
+    {
+        return ACTIVE_KERNEL.name;
+    }
+
+    size_t classifyUpdatesScalar(const std::byte *updates, size_t numUpdates, uint64_t *tradeMask)
+    {
+        clearTradeMask(numUpdates, tradeMask);
+        return classifyTail(updates, 0, numUpdates, tradeMask);
+    }
+
+    __attribute__((target("sse4.2")))
+    size_t classifyUpdatesSse42(const std::byte *updates, size_t numUpdates, uint64_t *tradeMask)
+    {
+        clearTradeMask(numUpdates, tradeMask);
+
+        const __m128i headerMask = _mm_set1_epi32(HEADER_MASK);
+        const __m128i tradeHeader = _mm_set1_epi32(TRADE_HEADER);
+        const __m128i quoteHeader = _mm_set1_epi32(QUOTE_HEADER);
+
+        size_t i = 0;
+        for (; i + 4 <= numUpdates; i += 4)
+        {
+            const std::byte *p = updates + i * UPDATE_SIZE;
+
+            // Pull the first dword out of 4 consecutive updates: [u0 u1 u2 u3]
+            __m128i u0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+            __m128i u1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + UPDATE_SIZE));
+            __m128i u2 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 2 * UPDATE_SIZE));
+            __m128i u3 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 3 * UPDATE_SIZE));
+            __m128i headers = _mm_unpacklo_epi64(_mm_unpacklo_epi32(u0, u1), _mm_unpacklo_epi32(u2, u3));
+            headers = _mm_and_si128(headers, headerMask);
+
+            uint32_t trades = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(headers, tradeHeader)));
+            uint32_t quotes = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(headers, quoteHeader)));
+            uint32_t valid = trades | quotes;
+            if (valid != 0xF)
+            {
+                return i + __builtin_ctz(~valid);
+            }
+
+            tradeMask[i / 64] |= static_cast<uint64_t>(trades) << (i % 64);
+        }
+
+        return classifyTail(updates, i, numUpdates, tradeMask);
+    }
+
+    __attribute__((target("avx2")))
+    size_t classifyUpdatesAvx2(const std::byte *updates, size_t numUpdates, uint64_t *tradeMask)
+    {
+        clearTradeMask(numUpdates, tradeMask);
+
+        const __m256i headerMask = _mm256_set1_epi32(HEADER_MASK);
+        const __m256i tradeHeader = _mm256_set1_epi32(TRADE_HEADER);
+        const __m256i quoteHeader = _mm256_set1_epi32(QUOTE_HEADER);
+
+        size_t i = 0;
+        for (; i + 8 <= numUpdates; i += 8)
+        {
+            const std::byte *p = updates + i * UPDATE_SIZE;
+
+            // Same idea as the SSE kernel, but each 128 bit lane handles its own group of 4
+            __m256i a = loadUpdatePair(p, p + 4 * UPDATE_SIZE);
+            __m256i b = loadUpdatePair(p + UPDATE_SIZE, p + 5 * UPDATE_SIZE);
+            __m256i c = loadUpdatePair(p + 2 * UPDATE_SIZE, p + 6 * UPDATE_SIZE);
+            __m256i d = loadUpdatePair(p + 3 * UPDATE_SIZE, p + 7 * UPDATE_SIZE);
+            __m256i headers = _mm256_unpacklo_epi64(_mm256_unpacklo_epi32(a, b), _mm256_unpacklo_epi32(c, d));
+            headers = _mm256_and_si256(headers, headerMask);
+
+            uint32_t trades = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(headers, tradeHeader)));
+            uint32_t quotes = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(headers, quoteHeader)));
+            uint32_t valid = trades | quotes;
+            if (valid != 0xFF)
+            {
+                return i + __builtin_ctz(~valid);
+            }
+
+            tradeMask[i / 64] |= static_cast<uint64_t>(trades) << (i % 64);
+        }
+
+        return classifyTail(updates, i, numUpdates, tradeMask);
+    }
+
+    __attribute__((target("avx512f")))
+    size_t classifyUpdatesAvx512(const std::byte *updates, size_t numUpdates, uint64_t *tradeMask)
+    {
+        clearTradeMask(numUpdates, tradeMask);
+
+        const __m512i headerMask = _mm512_set1_epi32(HEADER_MASK);
+        const __m512i tradeHeader = _mm512_set1_epi32(TRADE_HEADER);
+        const __m512i quoteHeader = _mm512_set1_epi32(QUOTE_HEADER);
+
+        size_t i = 0;
+        for (; i + 16 <= numUpdates; i += 16)
+        {
+            const std::byte *p = updates + i * UPDATE_SIZE;
+
+            // Four 128 bit lanes each doing the SSE kernel's shuffle. Beats a gather by a good margin
+            __m512i a = loadUpdateQuad(p, p + 4 * UPDATE_SIZE, p + 8 * UPDATE_SIZE, p + 12 * UPDATE_SIZE);
+            __m512i b = loadUpdateQuad(p + UPDATE_SIZE, p + 5 * UPDATE_SIZE, p + 9 * UPDATE_SIZE, p + 13 * UPDATE_SIZE);
+            __m512i c = loadUpdateQuad(p + 2 * UPDATE_SIZE, p + 6 * UPDATE_SIZE, p + 10 * UPDATE_SIZE, p + 14 * UPDATE_SIZE);
+            __m512i d = loadUpdateQuad(p + 3 * UPDATE_SIZE, p + 7 * UPDATE_SIZE, p + 11 * UPDATE_SIZE, p + 15 * UPDATE_SIZE);
+            __m512i headers = _mm512_unpacklo_epi64(_mm512_unpacklo_epi32(a, b), _mm512_unpacklo_epi32(c, d));
+            headers = _mm512_and_si512(headers, headerMask);
+
+            uint32_t trades = _mm512_cmpeq_epi32_mask(headers, tradeHeader);
+            uint32_t quotes = _mm512_cmpeq_epi32_mask(headers, quoteHeader);
+            uint32_t valid = trades | quotes;
+            if (valid != 0xFFFF)
+            {
+                return i + __builtin_ctz(~valid);
+            }
+
+            tradeMask[i / 64] |= static_cast<uint64_t>(trades) << (i % 64);
+        }
+
+        return classifyTail(updates, i, numUpdates, tradeMask);
+    }
+};
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+
+#include "marketPacketHelpers/marketPacketHelpers.h"
+
+namespace marketPacket
+{
+    // Most updates a single packet body can possibly hold
+    constexpr const size_t MAX_UPDATES_IN_BODY = (std::numeric_limits<decltype(packetHeader_t::packetLength)>::max() - PACKET_HEADER_SIZE) / UPDATE_SIZE;
+    constexpr const size_t TRADE_MASK_WORDS = (MAX_UPDATES_IN_BODY + 63) / 64;
+
+    /**
+     * @brief Classifies a contiguous run of updates.
+     *
+     *  Every update is exactly UPDATE_SIZE bytes, so the kernels can look at many headers at once
+     *  instead of walking them one at a time.
+     *
+     * @param updates       Start of the run, assumed to be numUpdates * UPDATE_SIZE bytes
+     * @param numUpdates    How many updates are in the run. Must be <= MAX_UPDATES_IN_BODY
+     * @param tradeMask     Bit i gets set if update i is a trade. Needs (numUpdates + 63) / 64 words
+     * @return Number of leading valid updates. Anything less than numUpdates means update[return] is poorly formed
+     */
+    using classifyUpdatesFn_t = size_t (*)(const std::byte *updates, size_t numUpdates, uint64_t *tradeMask);
+
+    /**
+     * @brief Picks the widest kernel the CPU we're running on supports. Resolved once
+     */
+    size_t classifyUpdates(const std::byte *updates, size_t numUpdates, uint64_t *tradeMask);
+
+    /**
+     * @brief The individual kernels. Only call the SIMD ones if the CPU supports them
+     */
+    size_t classifyUpdatesScalar(const std::byte *updates, size_t numUpdates, uint64_t *tradeMask);
+    size_t classifyUpdatesSse42(const std::byte *updates, size_t numUpdates, uint64_t *tradeMask);
+    size_t classifyUpdatesAvx2(const std::byte *updates, size_t numUpdates, uint64_t *tradeMask);
+    size_t classifyUpdatesAvx512(const std::byte *updates, size_t numUpdates, uint64_t *tradeMask);
+
+    /**
+     * @brief Which kernel classifyUpdates() ended up using. Mostly for benchmarks / logging
+     */
+    std::string_view activeClassifyKernelName();
+
+    /**
+     * @brief Checks if ptr points to something we'd consider a valid update
+     *
+     * @param uh Ptr into read buffer on what we assume is the start to an update
+     * @return If the pointer points to a valid header update
+     */
+    inline bool isUpdateValid(const updateHeader_t *uh)
+    {
+        // Is both the length and type something we'd expect?
+        return uh->length == UPDATE_SIZE && (uh->type == updateType_e::TRADE || uh->type == updateType_e::QUOTE);
+    }
+};
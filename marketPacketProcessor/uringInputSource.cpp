@@ -0,0 +1,470 @@
+#include "uringInputSource.h"
+
+#include <algorithm>
+#include <assert.h>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace marketPacket
+{
+    namespace
+    {
+        // No liburing, so the three syscalls get called directly
+        int ioUringSetup(unsigned entries, io_uring_params *params)
+        {
+            return static_cast<int>(::syscall(__NR_io_uring_setup, entries, params));
+        }
+
+        int ioUringEnter(int ringFd, unsigned toSubmit, unsigned minComplete, unsigned flags)
+        {
+            return static_cast<int>(::syscall(__NR_io_uring_enter, ringFd, toSubmit, minComplete, flags, nullptr, 0));
+        }
+
+        int ioUringRegister(int ringFd, unsigned opcode, const void *arg, unsigned numArgs)
+        {
+            return static_cast<int>(::syscall(__NR_io_uring_register, ringFd, opcode, arg, numArgs));
+        }
+
+        unsigned *ringField(void *ringPtr, uint32_t offset)
+        {
+            return reinterpret_cast<unsigned *>(static_cast<char *>(ringPtr) + offset);
+        }
+    }
+
+    std::unique_ptr<inputSource_t> uringInputSource_t::create(const std::string &path, const uringConfig_t &config)
+    {
+        auto uringSource = std::make_unique<uringInputSource_t>(path, config);
+        if (uringSource->isRingUp())
+        {
+            return uringSource;
+        }
+
+        // Old kernel, seccomp, whatever. Plain blocking reads still work
+        return std::make_unique<streamInputSource_t>(std::ifstream(path, std::ios::binary));
+    }
+
+    uringInputSource_t::uringInputSource_t(const std::string &path, const uringConfig_t &config)
+        : m_config(config),
+          m_fd(-1),
+          m_ringFd(-1),
+          m_ioError(false),
+          m_nextFileOffset(0),
+          m_sqRingPtr(MAP_FAILED),
+          m_sqRingSize(0),
+          m_cqRingPtr(MAP_FAILED),
+          m_cqRingSize(0),
+          m_sqes(nullptr),
+          m_sqesSize(0),
+          m_sqHead(nullptr),
+          m_sqTail(nullptr),
+          m_sqMask(nullptr),
+          m_sqArray(nullptr),
+          m_cqHead(nullptr),
+          m_cqTail(nullptr),
+          m_cqMask(nullptr),
+          m_cqes(nullptr),
+          m_bufferMemory(nullptr),
+          m_buffers(),
+          m_currentBuffer(0),
+          m_currentOffset(0),
+          m_stitchBuffer(std::make_unique<std::byte[]>(URING_MAX_READ_SIZE))
+    {
+        assert(m_config.queueDepth > 0);
+        assert(m_config.bufferSize > 0 && m_config.bufferSize % ::sysconf(_SC_PAGESIZE) == 0);
+
+        if (m_config.directIo)
+        {
+            m_fd = ::open(path.c_str(), O_RDONLY | O_DIRECT);
+        }
+
+        // Plenty of filesystems (tmpfs, etc.) won't do O_DIRECT. The page cache is still better than nothing
+        if (m_fd < 0)
+        {
+            m_config.directIo = false;
+            m_fd = ::open(path.c_str(), O_RDONLY);
+        }
+
+        if (m_fd < 0)
+        {
+            return;
+        }
+
+        if (!setupRing())
+        {
+            teardownRing();
+            return;
+        }
+
+        // Get every buffer going right away
+        startReading(0);
+    }
+
+    uringInputSource_t::~uringInputSource_t()
+    {
+        // Can't unmap buffers the kernel might still be writing into
+        while (isRingUp() && std::any_of(m_buffers.begin(), m_buffers.end(), [](const readBuffer_t &buffer)
+                                         { return buffer.inFlight; }))
+        {
+            if (!reapCompletion())
+            {
+                break;
+            }
+        }
+
+        teardownRing();
+
+        if (m_fd >= 0)
+        {
+            ::close(m_fd);
+        }
+    }
+
+    bool uringInputSource_t::setupRing()
+    {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+
+        m_ringFd = ioUringSetup(m_config.queueDepth, &params);
+        if (m_ringFd < 0)
+        {
+            return false;
+        }
+
+        // Submission ring, completion ring and the submission entries all live in memory shared with the kernel
+        m_sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        m_cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        if (params.features & IORING_FEAT_SINGLE_MMAP)
+        {
+            m_sqRingSize = m_cqRingSize = std::max(m_sqRingSize, m_cqRingSize);
+        }
+
+        m_sqRingPtr = ::mmap(nullptr, m_sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ringFd, IORING_OFF_SQ_RING);
+        if (m_sqRingPtr == MAP_FAILED)
+        {
+            return false;
+        }
+
+        if (params.features & IORING_FEAT_SINGLE_MMAP)
+        {
+            m_cqRingPtr = m_sqRingPtr;
+        }
+        else
+        {
+            m_cqRingPtr = ::mmap(nullptr, m_cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ringFd, IORING_OFF_CQ_RING);
+            if (m_cqRingPtr == MAP_FAILED)
+            {
+                return false;
+            }
+        }
+
+        m_sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+        void *sqes = ::mmap(nullptr, m_sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ringFd, IORING_OFF_SQES);
+        if (sqes == MAP_FAILED)
+        {
+            return false;
+        }
+        m_sqes = static_cast<io_uring_sqe *>(sqes);
+
+        m_sqHead = ringField(m_sqRingPtr, params.sq_off.head);
+        m_sqTail = ringField(m_sqRingPtr, params.sq_off.tail);
+        m_sqMask = ringField(m_sqRingPtr, params.sq_off.ring_mask);
+        m_sqArray = ringField(m_sqRingPtr, params.sq_off.array);
+        m_cqHead = ringField(m_cqRingPtr, params.cq_off.head);
+        m_cqTail = ringField(m_cqRingPtr, params.cq_off.tail);
+        m_cqMask = ringField(m_cqRingPtr, params.cq_off.ring_mask);
+        m_cqes = reinterpret_cast<io_uring_cqe *>(static_cast<char *>(m_cqRingPtr) + params.cq_off.cqes);
+
+        // One page aligned chunk for every buffer, which also keeps O_DIRECT happy
+        void *bufferMemory = ::mmap(nullptr, m_config.queueDepth * m_config.bufferSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (bufferMemory == MAP_FAILED)
+        {
+            return false;
+        }
+        m_bufferMemory = static_cast<std::byte *>(bufferMemory);
+
+        std::vector<iovec> iovecs;
+        for (size_t bufferIdx = 0; bufferIdx < m_config.queueDepth; bufferIdx++)
+        {
+            std::byte *data = m_bufferMemory + bufferIdx * m_config.bufferSize;
+            m_buffers.push_back({data, 0, 0, false, false});
+            iovecs.push_back({data, m_config.bufferSize});
+        }
+
+        // Registering is only an optimization, if the kernel won't take them the plain read path is fine
+        if (m_config.registerBuffers && ioUringRegister(m_ringFd, IORING_REGISTER_BUFFERS, iovecs.data(), iovecs.size()) != 0)
+        {
+            m_config.registerBuffers = false;
+        }
+
+        return true;
+    }
+
+    void uringInputSource_t::teardownRing()
+    {
+        if (m_bufferMemory != nullptr)
+        {
+            ::munmap(m_bufferMemory, m_config.queueDepth * m_config.bufferSize);
+            m_bufferMemory = nullptr;
+        }
+
+        if (m_sqes != nullptr)
+        {
+            ::munmap(m_sqes, m_sqesSize);
+            m_sqes = nullptr;
+        }
+
+        if (m_cqRingPtr != MAP_FAILED && m_cqRingPtr != m_sqRingPtr)
+        {
+            ::munmap(m_cqRingPtr, m_cqRingSize);
+        }
+        m_cqRingPtr = MAP_FAILED;
+
+        if (m_sqRingPtr != MAP_FAILED)
+        {
+            ::munmap(m_sqRingPtr, m_sqRingSize);
+            m_sqRingPtr = MAP_FAILED;
+        }
+
+        if (m_ringFd >= 0)
+        {
+            ::close(m_ringFd);
+            m_ringFd = -1;
+        }
+
+        m_buffers.clear();
+    }
+
+    void uringInputSource_t::startReading(size_t fileOffset)
+    {
+        m_nextFileOffset = fileOffset;
+        for (size_t bufferIdx = 0; bufferIdx < m_buffers.size(); bufferIdx++)
+        {
+            readBuffer_t &buffer = m_buffers[bufferIdx];
+            buffer.fileOffset = m_nextFileOffset;
+            buffer.filled = 0;
+            buffer.isFinal = false;
+
+            m_nextFileOffset += m_config.bufferSize;
+            submitRead(bufferIdx);
+        }
+
+        m_currentBuffer = 0;
+        m_currentOffset = 0;
+    }
+
+    void uringInputSource_t::submitRead(size_t bufferIdx)
+    {
+        readBuffer_t &buffer = m_buffers[bufferIdx];
+        assert(!buffer.inFlight);
+
+        unsigned tail = *m_sqTail;
+        unsigned sqeIdx = tail & *m_sqMask;
+        io_uring_sqe &sqe = m_sqes[sqeIdx];
+        std::memset(&sqe, 0, sizeof(sqe));
+
+        sqe.opcode = m_config.registerBuffers ? IORING_OP_READ_FIXED : IORING_OP_READ;
+        sqe.fd = m_fd;
+        sqe.addr = reinterpret_cast<uint64_t>(buffer.data + buffer.filled);
+        sqe.len = m_config.bufferSize - buffer.filled;
+        sqe.off = buffer.fileOffset + buffer.filled;
+        sqe.buf_index = bufferIdx;
+        sqe.user_data = bufferIdx;
+
+        m_sqArray[sqeIdx] = sqeIdx;
+        std::atomic_ref<unsigned>(*m_sqTail).store(tail + 1, std::memory_order_release);
+
+        buffer.inFlight = true;
+
+        // Only ever one outstanding read per buffer, so the submission ring can't be full
+        int submitted;
+        do
+        {
+            submitted = ioUringEnter(m_ringFd, 1, 0, 0);
+        } while (submitted < 0 && errno == EINTR);
+
+        if (submitted != 1)
+        {
+            buffer.inFlight = false;
+            m_ioError = true;
+        }
+    }
+
+    bool uringInputSource_t::reapCompletion()
+    {
+        unsigned head = *m_cqHead;
+        while (head == std::atomic_ref<unsigned>(*m_cqTail).load(std::memory_order_acquire))
+        {
+            if (ioUringEnter(m_ringFd, 0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR)
+            {
+                m_ioError = true;
+                return false;
+            }
+        }
+
+        const io_uring_cqe &cqe = m_cqes[head & *m_cqMask];
+        size_t bufferIdx = cqe.user_data;
+        int result = cqe.res;
+        std::atomic_ref<unsigned>(*m_cqHead).store(head + 1, std::memory_order_release);
+
+        readBuffer_t &buffer = m_buffers[bufferIdx];
+        buffer.inFlight = false;
+
+        if (result < 0)
+        {
+            m_ioError = true;
+        }
+        else if (result == 0)
+        {
+            // Nothing more in the file past this point
+            buffer.isFinal = true;
+        }
+        else
+        {
+            buffer.filled += result;
+
+            // Direct reads only come up short at the end of the file, and can't pick up from an unaligned offset anyway
+            if (buffer.filled < m_config.bufferSize && m_config.directIo)
+            {
+                buffer.isFinal = true;
+            }
+            else if (buffer.filled < m_config.bufferSize)
+            {
+                // Reads are allowed to come up short, go back for the rest
+                submitRead(bufferIdx);
+            }
+        }
+
+        return true;
+    }
+
+    bool uringInputSource_t::ensureData()
+    {
+        while (!m_ioError)
+        {
+            readBuffer_t &buffer = m_buffers[m_currentBuffer];
+            if (buffer.inFlight)
+            {
+                if (!reapCompletion())
+                {
+                    return false;
+                }
+                continue;
+            }
+
+            if (m_currentOffset < buffer.filled)
+            {
+                return true;
+            }
+
+            // Buffer's spent. If the file ended in it, so do we
+            if (buffer.isFinal)
+            {
+                return false;
+            }
+
+            // Otherwise it goes back out for the next chunk of the file, after every other buffer
+            buffer.fileOffset = m_nextFileOffset;
+            buffer.filled = 0;
+            m_nextFileOffset += m_config.bufferSize;
+            submitRead(m_currentBuffer);
+
+            m_currentBuffer = (m_currentBuffer + 1) % m_buffers.size();
+            m_currentOffset = 0;
+        }
+
+        return false;
+    }
+
+    bool uringInputSource_t::seek(size_t offset)
+    {
+        if (!isRingUp() || m_ioError)
+        {
+            return false;
+        }
+
+        // Everything in flight is for the wrong part of the file now, but it still has to land before the buffers get reused
+        while (std::any_of(m_buffers.begin(), m_buffers.end(), [](const readBuffer_t &buffer)
+                           { return buffer.inFlight; }))
+        {
+            if (!reapCompletion())
+            {
+                return false;
+            }
+        }
+
+        // Direct reads have to start on an aligned offset, so start a little early and skip ahead
+        static const size_t pageSize = ::sysconf(_SC_PAGESIZE);
+        size_t alignedOffset = offset & ~(pageSize - 1);
+
+        startReading(alignedOffset);
+        m_currentOffset = offset - alignedOffset;
+
+        return !m_ioError;
+    }
+
+    std::optional<failReason_t> uringInputSource_t::checkValidity()
+    {
+        if (!isRingUp())
+        {
+            return INPUT_STREAM_CLOSED;
+        }
+
+        if (!ensureData())
+        {
+            return m_ioError ? BAD_STREAM : END_OF_FILE;
+        }
+
+        return std::nullopt;
+    }
+
+    const std::byte *uringInputSource_t::read(size_t numBytes)
+    {
+        assert(numBytes <= URING_MAX_READ_SIZE);
+
+        if (!isRingUp())
+        {
+            return nullptr;
+        }
+
+        if (numBytes == 0 || !ensureData())
+        {
+            return numBytes == 0 ? m_stitchBuffer.get() : nullptr;
+        }
+
+        // Most of the time it's all in the one buffer
+        readBuffer_t &buffer = m_buffers[m_currentBuffer];
+        if (buffer.filled - m_currentOffset >= numBytes)
+        {
+            const std::byte *readPtr = buffer.data + m_currentOffset;
+            m_currentOffset += numBytes;
+            return readPtr;
+        }
+
+        // Straddles a buffer boundary, piece it together
+        size_t stitched = 0;
+        while (stitched < numBytes)
+        {
+            if (!ensureData())
+            {
+                // Mirror a short stream read, whatever was left is gone
+                return nullptr;
+            }
+
+            readBuffer_t &stitchFrom = m_buffers[m_currentBuffer];
+            size_t toCopy = std::min(numBytes - stitched, stitchFrom.filled - m_currentOffset);
+            std::memcpy(m_stitchBuffer.get() + stitched, stitchFrom.data + m_currentOffset, toCopy);
+
+            stitched += toCopy;
+            m_currentOffset += toCopy;
+        }
+
+        return m_stitchBuffer.get();
+    }
+};
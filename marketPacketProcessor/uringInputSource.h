@@ -0,0 +1,145 @@
+#pragma once
+
+#include <array>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "marketPacketHelpers/marketPacketHelpers.h"
+#include "inputSource.h"
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+namespace marketPacket
+{
+    // Biggest read() we'll stitch together across buffers. Big enough for any packet
+    constexpr const size_t URING_MAX_READ_SIZE = 64 * 1024;
+
+    /**
+     * @brief Knobs for how hard a uringInputSource_t leans on the device
+     */
+    struct uringConfig_t
+    {
+        size_t queueDepth = 8;          // How many reads we keep in flight at once
+        size_t bufferSize = 256 * 1024; // How big each read is. Has to be a multiple of the page size
+        bool directIo = false;          // Bypass the page cache. Quietly turned off if the filesystem won't do it
+        bool registerBuffers = true;    // Pin the buffers with the kernel up front so it doesn't have to map them on every read
+    };
+
+    /**
+     * Keeps several large reads in flight through io_uring, ahead of wherever the processor is.
+     *
+     * Buffers get handed out in file order. Reads that land inside one buffer get a ptr straight into it,
+     * reads that straddle two get stitched together in a side buffer. Once the processor is past a buffer,
+     * it goes right back to the kernel for the next chunk of the file
+     */
+    class uringInputSource_t : public inputSource_t
+    {
+    public:
+        /**
+         * @brief Opens path with io_uring if the kernel will let us, a plain streamInputSource_t otherwise
+         *
+         * @param path      File to read
+         * @param config    How to set up the ring
+         */
+        static std::unique_ptr<inputSource_t> create(const std::string &path, const uringConfig_t &config = uringConfig_t());
+
+        /**
+         * @brief Construct a new uringInputSource_t object. Check isRingUp() before leaning on it, or use create()
+         *
+         * @param path      File to read. If we can't open it, the source behaves like a closed stream
+         * @param config    How to set up the ring
+         */
+        uringInputSource_t(const std::string &path, const uringConfig_t &config = uringConfig_t());
+        ~uringInputSource_t() override;
+
+        // We own descriptors and mappings, so no copying it around
+        uringInputSource_t(const uringInputSource_t &) = delete;
+        uringInputSource_t &operator=(const uringInputSource_t &) = delete;
+
+        std::optional<failReason_t> checkValidity() override;
+        const std::byte *read(size_t numBytes) override;
+        size_t maxReadSize() const override { return URING_MAX_READ_SIZE; }
+        bool seek(size_t offset) override;
+
+        /**
+         * @brief If io_uring is up and running. False means the kernel (or a sandbox) said no
+         */
+        bool isRingUp() const { return m_ringFd >= 0; }
+
+    private:
+        /**
+         * @brief One of the buffers we cycle through
+         */
+        struct readBuffer_t
+        {
+            std::byte *data;   // Start of the buffer
+            size_t fileOffset; // Where in the file this buffer starts
+            size_t filled;     // How many bytes the kernel has given us so far
+            bool inFlight;     // If there's a read outstanding on it
+            bool isFinal;      // Hit the end of the file filling it, nothing comes after it
+        };
+
+        /**
+         * @brief Ring setup / teardown, all raw syscalls
+         */
+        bool setupRing();
+        void teardownRing();
+
+        /**
+         * @brief Points every buffer at the file, one after the other, starting from fileOffset and gets them all reading
+         */
+        void startReading(size_t fileOffset);
+
+        /**
+         * @brief Queues up a read to fill the rest of a buffer, and tells the kernel about it
+         */
+        void submitRead(size_t bufferIdx);
+
+        /**
+         * @brief Blocks until at least one read finishes, and marks down what came back
+         *
+         * @return False if the ring itself is broken
+         */
+        bool reapCompletion();
+
+        /**
+         * @brief Gets the current buffer to where there's at least one unread byte in it, recycling spent buffers along the way
+         *
+         * @return False if there's nothing left (end of file or an error)
+         */
+        bool ensureData();
+
+        uringConfig_t m_config;  // How we were asked to behave. directIo / registerBuffers get turned off if they didn't work out
+        int m_fd;                // File we're reading
+        int m_ringFd;            // io_uring instance, -1 if we couldn't get one
+        bool m_ioError;          // A read came back with an error
+        size_t m_nextFileOffset; // Where the next buffer we submit should start reading from
+
+        void *m_sqRingPtr;    // Submission ring, shared with the kernel
+        size_t m_sqRingSize;  // Size of the submission ring mapping
+        void *m_cqRingPtr;    // Completion ring. Same mapping as the submission ring on newer kernels
+        size_t m_cqRingSize;  // Size of the completion ring mapping
+        io_uring_sqe *m_sqes; // Submission entries
+        size_t m_sqesSize;    // Size of the submission entries mapping
+
+        // Where the kernel put each ring's bookkeeping inside the mappings
+        unsigned *m_sqHead;
+        unsigned *m_sqTail;
+        unsigned *m_sqMask;
+        unsigned *m_sqArray;
+        unsigned *m_cqHead;
+        unsigned *m_cqTail;
+        unsigned *m_cqMask;
+        io_uring_cqe *m_cqes;
+
+        std::byte *m_bufferMemory;           // Every buffer, in one page aligned mapping
+        std::vector<readBuffer_t> m_buffers; // Buffers in the order they get consumed
+        size_t m_currentBuffer;              // Which buffer we're reading out of
+        size_t m_currentOffset;              // How far into the current buffer we've read
+
+        std::unique_ptr<std::byte[]> m_stitchBuffer; // Where reads straddling two buffers get put back together
+    };
+};
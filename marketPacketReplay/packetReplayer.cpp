@@ -0,0 +1,176 @@
+#include "packetReplayer.h"
+
+#include <algorithm>
+#include <assert.h>
+#include <cstring>
+#include <thread>
+
+#include "marketPacketHelpers/tscClock.h"
+#include "marketPacketProcessor/updateKernels.h"
+
+namespace marketPacket
+{
+    void packetReplayer_t::initialize(const replayConfig_t &config)
+    {
+        // Make sure this only gets called once
+        if (m_isInitialized)
+        {
+            assert(false);
+            return;
+        }
+
+        m_config = config;
+
+        // Biggest packet there can be, so we never have to grow it mid replay
+        m_packet.reserve(std::numeric_limits<decltype(packetHeader_t::packetLength)>::max());
+
+        // Get the calibration spin out of the way now rather than in front of the first wait
+        if (m_config.speed > 0)
+        {
+            tscTicksPerNs();
+        }
+
+        m_isInitialized = true;
+    }
+
+    const std::optional<failReason_t> &packetReplayer_t::replayPackets(const std::optional<size_t> &numPacketsToReplay)
+    {
+        if (!m_isInitialized)
+        {
+            m_failReason.emplace(UNINITIALIZED);
+            return m_failReason;
+        }
+
+        m_failReason.reset();
+
+        for (size_t numReplayed = 0; !numPacketsToReplay.has_value() || numReplayed < numPacketsToReplay.value(); numReplayed++)
+        {
+            if (!readPacket())
+            {
+                return m_failReason;
+            }
+
+            waitForPacket();
+
+            if (!m_outputSink->write(reinterpret_cast<const char *>(m_packet.data()), m_packet.size()))
+            {
+                m_failReason.emplace(REPLAY_WRITE_FAILED);
+                return m_failReason;
+            }
+
+            m_numPacketsSent++;
+        }
+
+        return m_failReason;
+    }
+
+    bool packetReplayer_t::readPacket()
+    {
+        const auto &failReason = m_inputSource->checkValidity();
+        if (failReason.has_value())
+        {
+            m_failReason.emplace(failReason.value());
+            return false;
+        }
+
+        const std::byte *headerPtr = m_inputSource->read(PACKET_HEADER_SIZE);
+        if (headerPtr == nullptr)
+        {
+            m_failReason.emplace(PACKET_HEADER_READ_FAILED);
+            return false;
+        }
+
+        packetHeader_t ph;
+        std::memcpy(&ph, headerPtr, PACKET_HEADER_SIZE);
+
+        // Probably not a good thing
+        if (ph.packetLength < PACKET_HEADER_SIZE)
+        {
+            m_failReason.emplace(PACKET_HEADER_POORLY_FORMED);
+            return false;
+        }
+
+        m_packet.resize(ph.packetLength);
+        std::memcpy(m_packet.data(), &ph, PACKET_HEADER_SIZE);
+        if (!m_inputSource->readInto(m_packet.data() + PACKET_HEADER_SIZE, ph.packetLength - PACKET_HEADER_SIZE))
+        {
+            m_failReason.emplace(PACKET_READ_FAILED);
+            return false;
+        }
+
+        return true;
+    }
+
+    std::optional<uint64_t> packetReplayer_t::packetTime() const
+    {
+        // Don't care if the rest of the packet makes sense, that's for whoever's on the other end to decide
+        for (size_t offset = PACKET_HEADER_SIZE; offset + UPDATE_SIZE <= m_packet.size(); offset += UPDATE_SIZE)
+        {
+            const updateHeader_t *uh = reinterpret_cast<const updateHeader_t *>(m_packet.data() + offset);
+            if (isUpdateValid(uh) && uh->type == updateType_e::QUOTE)
+            {
+                return reinterpret_cast<const quote_t *>(uh)->timeOfDay;
+            }
+        }
+
+        return std::nullopt;
+    }
+
+    void packetReplayer_t::waitForPacket()
+    {
+        if (m_config.speed <= 0)
+        {
+            return;
+        }
+
+        // Only ever move forward through the capture's time
+        const auto &time = packetTime();
+        if (time.has_value() && (!m_lastPacketTime.has_value() || time.value() > m_lastPacketTime.value()))
+        {
+            if (m_lastPacketTime.has_value())
+            {
+                uint64_t gapNs = time.value() - m_lastPacketTime.value();
+                if (m_config.maxGap.has_value())
+                {
+                    gapNs = std::min<uint64_t>(gapNs, m_config.maxGap.value().count());
+                }
+
+                m_scheduledNs += static_cast<uint64_t>(gapNs / m_config.speed);
+            }
+
+            m_lastPacketTime = time;
+        }
+
+        // Everything's scheduled relative to the first packet, which goes out right away
+        if (!m_startTsc.has_value())
+        {
+            m_startTsc = readTsc();
+            return;
+        }
+
+        waitUntil(m_startTsc.value() + nsToTsc(m_scheduledNs));
+    }
+
+    void packetReplayer_t::waitUntil(uint64_t targetTsc)
+    {
+        uint64_t now = readTsc();
+        if (now < targetTsc)
+        {
+            // Sleeping's only good to within tens of microseconds, so stop short and spin the rest
+            uint64_t waitNs = tscToNs(targetTsc - now);
+            if (waitNs > static_cast<uint64_t>(m_config.spinThreshold.count()))
+            {
+                std::this_thread::sleep_for(std::chrono::nanoseconds(waitNs - m_config.spinThreshold.count()));
+            }
+
+            while ((now = readTsc()) < targetTsc)
+            {
+                cpuRelax();
+            }
+        }
+
+        uint64_t latenessNs = tscToNs(now - targetTsc);
+        m_maxLatenessNs = std::max(m_maxLatenessNs, latenessNs);
+        m_totalLatenessNs += latenessNs;
+    }
+};
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "marketPacketHelpers/marketPacketHelpers.h"
+#include "marketPacketProcessor/inputSource.h"
+#include "marketPacketProcessor/outputSink.h"
+
+namespace marketPacket
+{
+    /**
+     * @brief Knobs for how a replay behaves. Defaults replay at the capture's own pace
+     */
+    struct replayConfig_t
+    {
+        double speed = 1.0; // How many times faster than the capture to go. 0 means as fast as the output takes it
+
+        std::optional<std::chrono::nanoseconds> maxGap = std::chrono::seconds(1); // Longer gaps in the capture get cut down to this
+        std::chrono::nanoseconds spinThreshold = std::chrono::microseconds(100);  // Waits longer than this sleep most of the way, then spin
+    };
+
+    /**
+     * Re-emits a capture's packets, whole and untouched, spaced out the way they were when they were captured.
+     *
+     * A packet's time is the timeOfDay of its first quote, taken as nanoseconds. Trades don't carry a time, so packets
+     * without a quote go out right behind the packet before them, and so does anything older than what's already gone out.
+     * Every send time is worked out from when the first packet went out, not when the last one did, so a late packet
+     * doesn't push everything after it back.
+     *
+     * Waiting is a spin on the TSC, so packets go out within tens of nanoseconds of when they should rather than
+     * whenever the scheduler gets around to waking us up. Long waits sleep until just before, then spin the rest
+     *
+     * Every packet is one write() to the sink, so a datagram socket behind an fdOutputSink_t gets one packet per datagram
+     */
+    class packetReplayer_t
+    {
+    public:
+        /**
+         * @brief Construct a new packetReplayer_t object
+         *
+         * @param inputSource   Capture to replay
+         * @param outputSink    Where packets get re-emitted to. File, pipe, socket, whatever
+         */
+        packetReplayer_t(std::unique_ptr<inputSource_t> &&inputSource, std::unique_ptr<outputSink_t> &&outputSink)
+            : m_isInitialized(false),
+              m_failReason(),
+              m_config(),
+              m_packet(),
+              m_numPacketsSent(0),
+              m_startTsc(),
+              m_lastPacketTime(),
+              m_scheduledNs(0),
+              m_maxLatenessNs(0),
+              m_totalLatenessNs(0),
+              m_inputSource(std::move(inputSource)),
+              m_outputSink(std::move(outputSink)){};
+
+        /**
+         * @brief Sets up class to do work
+         *
+         * No work will be done until this is called
+         *
+         * @param config How the replay should behave
+         */
+        void initialize(const replayConfig_t &config = replayConfig_t());
+
+        /**
+         * @brief Replays packets, waiting between them as needed
+         *
+         * @param numPacketsToReplay How many packets to replay. Otherwise, go until failure
+         * @return Why we stopped early, if we did. END_OF_FILE once the whole capture's gone out
+         */
+        const std::optional<failReason_t> &replayPackets(const std::optional<size_t> &numPacketsToReplay = std::nullopt);
+
+        /**
+         * @brief How many packets have gone out
+         */
+        size_t numPacketsSent() const { return m_numPacketsSent; }
+
+        /**
+         * @brief Worst, and total, of how far behind schedule packets went out. Nanoseconds
+         */
+        uint64_t maxLatenessNs() const { return m_maxLatenessNs; }
+        uint64_t totalLatenessNs() const { return m_totalLatenessNs; }
+
+    private:
+        /**
+         * @brief Reads the next whole packet into m_packet
+         *
+         * @return False (with m_failReason set) if we couldn't
+         */
+        bool readPacket();
+
+        /**
+         * @brief timeOfDay of the packet's first quote, if it has one
+         */
+        std::optional<uint64_t> packetTime() const;
+
+        /**
+         * @brief Works out when the packet in m_packet should go out, and waits until then
+         */
+        void waitForPacket();
+
+        /**
+         * @brief Sleeps, then spins, until the TSC gets to target. Keeps track of how late we were if it already has
+         */
+        void waitUntil(uint64_t targetTsc);
+
+        bool m_isInitialized;                     // If initialize() has been called
+        std::optional<failReason_t> m_failReason; // If populated, why we stopped replaying
+        replayConfig_t m_config;                  // How the replay should behave
+
+        std::vector<std::byte> m_packet; // Packet about to go out
+        size_t m_numPacketsSent;         // How many packets have gone out
+
+        std::optional<uint64_t> m_startTsc;       // When the first packet went out
+        std::optional<uint64_t> m_lastPacketTime; // Latest packet time we've seen in the capture
+        uint64_t m_scheduledNs;                   // When the current packet should go out, relative to the first
+        uint64_t m_maxLatenessNs;                 // Worst we've been behind schedule
+        uint64_t m_totalLatenessNs;               // Everything we've been behind schedule
+
+        std::unique_ptr<inputSource_t> m_inputSource; // Capture we're replaying
+        std::unique_ptr<outputSink_t> m_outputSink;   // Where packets get re-emitted
+    };
+};
@@ -0,0 +1,132 @@
+#include <arpa/inet.h>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "marketPacketProcessor/inputSource.h"
+#include "marketPacketProcessor/outputSink.h"
+#include "packetReplayer.h"
+
+/**
+ * Replays a capture at the pace it was captured at, or some multiple of it
+ *
+ *  replay <capture> <output> [speed]
+ *
+ *  output  A file or named pipe, "-" for stdout, "unix:<path>" for a Unix datagram socket or "udp:<ip>:<port>"
+ *  speed   How many times faster than the capture to go (1, 10, 0.5, ...), or "max" for as fast as the output takes it
+ */
+
+namespace
+{
+    /**
+     * @brief Connected datagram socket, or -1 if we couldn't get one
+     */
+    int connectDatagramSocket(std::string_view destination)
+    {
+        if (destination.starts_with("unix:"))
+        {
+            sockaddr_un addr{};
+            addr.sun_family = AF_UNIX;
+
+            std::string_view path = destination.substr(5);
+            if (path.size() >= sizeof(addr.sun_path))
+            {
+                return -1;
+            }
+            path.copy(addr.sun_path, path.size());
+
+            int fd = ::socket(AF_UNIX, SOCK_DGRAM, 0);
+            if (fd >= 0 && ::connect(fd, reinterpret_cast<const sockaddr *>(&addr), sizeof(addr)) != 0)
+            {
+                ::close(fd);
+                return -1;
+            }
+            return fd;
+        }
+
+        // udp:<ip>:<port>
+        std::string_view hostPort = destination.substr(4);
+        size_t colon = hostPort.rfind(':');
+        if (colon == std::string_view::npos)
+        {
+            return -1;
+        }
+
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(std::stoi(std::string(hostPort.substr(colon + 1))));
+        if (::inet_pton(AF_INET, std::string(hostPort.substr(0, colon)).c_str(), &addr.sin_addr) != 1)
+        {
+            return -1;
+        }
+
+        int fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+        if (fd >= 0 && ::connect(fd, reinterpret_cast<const sockaddr *>(&addr), sizeof(addr)) != 0)
+        {
+            ::close(fd);
+            return -1;
+        }
+        return fd;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 3 || argc > 4)
+    {
+        std::cerr << "Usage: " << argv[0] << " <capture> <file | - | unix:<path> | udp:<ip>:<port>> [speed | max]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    const std::string_view output = argv[2];
+    const std::string_view speed = argc == 4 ? argv[3] : "1";
+
+    marketPacket::replayConfig_t config;
+    config.speed = speed == "max" ? 0 : std::stod(std::string(speed));
+
+    // Datagram sockets get a zero length datagram at the end, so whoever's listening knows that's all there is
+    int socketFd = -1;
+    std::unique_ptr<marketPacket::outputSink_t> outputSink;
+    if (output == "-")
+    {
+        outputSink = std::make_unique<marketPacket::fdOutputSink_t>(STDOUT_FILENO, false);
+    }
+    else if (output.starts_with("unix:") || output.starts_with("udp:"))
+    {
+        socketFd = connectDatagramSocket(output);
+        if (socketFd < 0)
+        {
+            std::cerr << "Couldn't connect to " << output << std::endl;
+            return EXIT_FAILURE;
+        }
+        outputSink = std::make_unique<marketPacket::fdOutputSink_t>(socketFd, true);
+    }
+    else
+    {
+        outputSink = std::make_unique<marketPacket::fdOutputSink_t>(std::string(output));
+    }
+
+    marketPacket::packetReplayer_t replayer(std::make_unique<marketPacket::mappedInputSource_t>(argv[1]), std::move(outputSink));
+    replayer.initialize(config);
+
+    const auto &failReason = replayer.replayPackets();
+    if (failReason.value() != marketPacket::END_OF_FILE)
+    {
+        std::cerr << "Reason we stopped replaying early: " << failReason.value() << std::endl;
+    }
+
+    if (socketFd >= 0)
+    {
+        ::send(socketFd, nullptr, 0, 0);
+    }
+
+    std::cerr << "Packets sent: " << replayer.numPacketsSent()
+              << " Max lateness (ns): " << replayer.maxLatenessNs()
+              << " Mean lateness (ns): " << (replayer.numPacketsSent() ? replayer.totalLatenessNs() / replayer.numPacketsSent() : 0) << std::endl;
+
+    return failReason.value() == marketPacket::END_OF_FILE ? EXIT_SUCCESS : EXIT_FAILURE;
+}
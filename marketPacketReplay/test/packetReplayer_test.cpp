@@ -0,0 +1,168 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstring>
+#include <sstream>
+
+#include "marketPacketGenerator/marketPacketGenerator.h"
+#include "marketPacketProcessor/inputSource.h"
+#include "marketPacketProcessor/outputSink.h"
+#include "marketPacketReplay/packetReplayer.h"
+
+namespace test
+{
+  // Ideally, all these go into a config file
+  const std::string INPUT_PATH = "./replay_input_test.dat";
+
+  constexpr const size_t NUM_PACKETS_TO_GENERATE = 20;
+  constexpr const size_t MAX_UPDATES = 16;
+
+  // Every packet starts with a quote 1ms after the last one's
+  constexpr const uint64_t PACKET_TIME_STEP = 1000000;
+
+  /**
+   * @brief Generates a capture and hands back exactly what got written
+   */
+  std::string generateCapture(const marketPacket::workloadProfile_t &workload)
+  {
+    {
+      marketPacket::marketPacketGenerator_t mpg(std::ofstream{INPUT_PATH});
+      mpg.initialize({.seed = 7, .workload = workload});
+      EXPECT_FALSE(mpg.generatePackets(NUM_PACKETS_TO_GENERATE, MAX_UPDATES).has_value());
+    }
+
+    std::stringstream ss;
+    ss << std::ifstream(INPUT_PATH).rdbuf();
+    return ss.str();
+  }
+
+  std::string generatePacedCapture()
+  {
+    return generateCapture({.tradeRatio = 0.0, .startTimeOfDay = 0, .packetTimeStep = PACKET_TIME_STEP});
+  }
+
+  marketPacket::packetReplayer_t createReplayer(const std::string &capture, std::string &output)
+  {
+    return marketPacket::packetReplayer_t(std::make_unique<marketPacket::memoryInputSource_t>(reinterpret_cast<const std::byte *>(capture.data()), capture.size()),
+                                          std::make_unique<marketPacket::memoryOutputSink_t>(output));
+  }
+
+  /**
+   * @brief How long replaying the whole capture takes
+   */
+  std::chrono::nanoseconds timeReplay(const std::string &capture, const marketPacket::replayConfig_t &config)
+  {
+    std::string output;
+    marketPacket::packetReplayer_t replayer = createReplayer(capture, output);
+    replayer.initialize(config);
+
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_EQ(replayer.replayPackets().value(), marketPacket::END_OF_FILE);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    EXPECT_EQ(output, capture);
+    return elapsed;
+  }
+
+  TEST(packetReplayerTest, noInit)
+  {
+    std::string capture, output;
+    EXPECT_EQ(createReplayer(capture, output).replayPackets().value(), marketPacket::UNINITIALIZED);
+  }
+
+  TEST(packetReplayerTest, doubleInit)
+  {
+    std::string capture, output;
+    marketPacket::packetReplayer_t replayer = createReplayer(capture, output);
+    replayer.initialize();
+
+    EXPECT_DEATH(replayer.initialize(), "");
+  }
+
+  TEST(packetReplayerTest, asFastAsPossible)
+  {
+    const std::string capture = generateCapture({});
+
+    std::string output;
+    marketPacket::packetReplayer_t replayer = createReplayer(capture, output);
+    replayer.initialize({.speed = 0});
+
+    // Packets go out whole, as many as we asked for
+    EXPECT_FALSE(replayer.replayPackets(1).has_value());
+    EXPECT_EQ(replayer.numPacketsSent(), 1);
+
+    marketPacket::packetHeader_t ph;
+    std::memcpy(&ph, capture.data(), sizeof(ph));
+    EXPECT_EQ(output.size(), ph.packetLength);
+
+    EXPECT_EQ(replayer.replayPackets().value(), marketPacket::END_OF_FILE);
+    EXPECT_EQ(replayer.numPacketsSent(), NUM_PACKETS_TO_GENERATE);
+    EXPECT_EQ(output, capture);
+  }
+
+  TEST(packetReplayerTest, keepsCapturePace)
+  {
+    const std::string capture = generatePacedCapture();
+    const std::chrono::nanoseconds capturedFor((NUM_PACKETS_TO_GENERATE - 1) * PACKET_TIME_STEP);
+
+    // Never early. Late is up to the scheduler, so only check we're nowhere near the next speed down
+    EXPECT_GE(timeReplay(capture, {}), capturedFor);
+
+    std::chrono::nanoseconds tenTimes = timeReplay(capture, {.speed = 10});
+    EXPECT_GE(tenTimes, capturedFor / 10);
+    EXPECT_LT(tenTimes, capturedFor);
+
+    EXPECT_LT(timeReplay(capture, {.speed = 0}), capturedFor / 10);
+  }
+
+  TEST(packetReplayerTest, gapsGetCut)
+  {
+    // Classic captures have every timeOfDay uniformly random, so gaps are centuries long
+    const std::string capture = generateCapture({.tradeRatio = 0.0});
+
+    EXPECT_LT(timeReplay(capture, {.maxGap = std::chrono::microseconds(100)}), std::chrono::milliseconds(100));
+  }
+
+  TEST(packetReplayerTest, lateness)
+  {
+    const std::string capture = generatePacedCapture();
+
+    std::string output;
+    marketPacket::packetReplayer_t replayer = createReplayer(capture, output);
+    replayer.initialize();
+
+    EXPECT_EQ(replayer.replayPackets().value(), marketPacket::END_OF_FILE);
+
+    // First packet sets the schedule, so it can't be late
+    EXPECT_LE(replayer.maxLatenessNs(), replayer.totalLatenessNs());
+    EXPECT_LE(replayer.totalLatenessNs(), replayer.maxLatenessNs() * (NUM_PACKETS_TO_GENERATE - 1));
+  }
+
+  TEST(packetReplayerTest, badPacket)
+  {
+    std::string capture = generateCapture({});
+
+    // Second packet claims to be shorter than its own header
+    marketPacket::packetHeader_t ph;
+    std::memcpy(&ph, capture.data(), sizeof(ph));
+    marketPacket::packetHeader_t badHeader{1, 0};
+    std::memcpy(capture.data() + ph.packetLength, &badHeader, sizeof(badHeader));
+
+    std::string output;
+    marketPacket::packetReplayer_t replayer = createReplayer(capture, output);
+    replayer.initialize({.speed = 0});
+
+    EXPECT_EQ(replayer.replayPackets().value(), marketPacket::PACKET_HEADER_POORLY_FORMED);
+    EXPECT_EQ(replayer.numPacketsSent(), 1);
+
+    // Cut off halfway through a packet
+    capture.resize(ph.packetLength + sizeof(ph) + 1);
+    std::memcpy(capture.data() + ph.packetLength, capture.data(), sizeof(ph));
+
+    output.clear();
+    marketPacket::packetReplayer_t truncatedReplayer = createReplayer(capture, output);
+    truncatedReplayer.initialize({.speed = 0});
+
+    EXPECT_EQ(truncatedReplayer.replayPackets().value(), marketPacket::PACKET_READ_FAILED);
+    EXPECT_EQ(truncatedReplayer.numPacketsSent(), 1);
+  }
+}